@@ -0,0 +1,180 @@
+/// \file Animation.cpp
+/// \brief Definitions of Animation class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "Animation.hpp"
+
+Animation::Animation (const std::string& fileName)
+  : m_nextTrack (0), m_activeCount (0), m_lastTime (0)
+{
+  std::ifstream inFile (fileName);
+  if (!inFile)
+  {
+    fprintf (stderr, "File %s does not exist; exiting\n", fileName.c_str ());
+    exit (-1);
+  }
+  std::string line;
+  unsigned int lineNumber = 0;
+  while (std::getline (inFile, line))
+  {
+    ++lineNumber;
+    std::istringstream words (line);
+    std::string command;
+    if (!(words >> command) || command[0] == '#')
+      continue;
+    if (command == "track")
+    {
+      Track track;
+      if (!(words >> track.meshName))
+      {
+	fprintf (stderr, "%s:%u: track needs a mesh name; exiting\n",
+		 fileName.c_str (), lineNumber);
+	exit (-1);
+      }
+      track.mesh = nullptr;
+      m_tracks.push_back (track);
+    }
+    else if (command == "key" && !m_tracks.empty ())
+    {
+      Keyframe key;
+      if (!(words >> key.time >> key.position.m_x >> key.position.m_y
+	    >> key.position.m_z))
+      {
+	fprintf (stderr, "%s:%u: key needs a time and position; exiting\n",
+		 fileName.c_str (), lineNumber);
+	exit (-1);
+      }
+      Vector3 axis (1, 0, 0);
+      float angleDegrees = 0;
+      words >> axis.m_x >> axis.m_y >> axis.m_z >> angleDegrees;
+      key.rotation = Quaternion (angleDegrees, axis);
+      std::vector<Keyframe>& keys = m_tracks.back ().keys;
+      if (!keys.empty () && key.time < keys.back ().time)
+      {
+	fprintf (stderr, "%s:%u: keys are out of order; exiting\n",
+		 fileName.c_str (), lineNumber);
+	exit (-1);
+      }
+      keys.push_back (key);
+    }
+    else
+    {
+      fprintf (stderr, "%s:%u: unexpected \"%s\"; exiting\n",
+	       fileName.c_str (), lineNumber, command.c_str ());
+      exit (-1);
+    }
+  }
+  m_tracks.erase (std::remove_if (m_tracks.begin (), m_tracks.end (),
+				  [] (const Track& track) { return track.keys.empty (); }),
+		  m_tracks.end ());
+  std::stable_sort (m_tracks.begin (), m_tracks.end (),
+		    [] (const Track& a, const Track& b)
+		    { return a.keys.front ().time < b.keys.front ().time; });
+}
+
+void
+Animation::bind (Scene& scene)
+{
+  for (Track& track : m_tracks)
+  {
+    MeshHandle handle = scene.findMesh (track.meshName);
+    if (!scene.isValid (handle))
+    {
+      fprintf (stderr, "Animation track for unknown mesh %s; exiting\n",
+	       track.meshName.c_str ());
+      exit (-1);
+    }
+    track.mesh = scene.getMesh (handle);
+    track.boundWorld = track.mesh->getWorld ();
+    track.boundWorld.decompose ();
+  }
+  m_nextTrack = 0;
+  m_active.clear ();
+  m_lastTime = 0;
+}
+
+void
+Animation::apply (double time)
+{
+  if (time < m_lastTime)
+  {
+    // Start over from the bound poses rather than undoing tracks.
+    for (const Track& track : m_tracks)
+      track.mesh->setWorld (track.boundWorld);
+    m_nextTrack = 0;
+    m_active.clear ();
+  }
+  m_lastTime = time;
+  while (m_nextTrack < m_tracks.size ()
+	 && m_tracks[m_nextTrack].keys.front ().time <= time)
+    m_active.push_back (m_nextTrack++);
+
+  // Every started track is evaluated once more after it finishes, so that
+  //   its Mesh ends exactly on the last keyframe.
+  m_activeCount = m_active.size ();
+  size_t kept = 0;
+  for (size_t index : m_active)
+  {
+    const Track& track = m_tracks[index];
+    evaluate (track, time);
+    if (time < track.keys.back ().time)
+      m_active[kept++] = index;
+  }
+  m_active.resize (kept);
+}
+
+double
+Animation::getDuration () const
+{
+  double duration = 0;
+  for (const Track& track : m_tracks)
+    duration = std::max (duration, track.keys.back ().time);
+  return duration;
+}
+
+size_t
+Animation::getActiveTrackCount () const
+{
+  return m_activeCount;
+}
+
+void
+Animation::evaluate (const Track& track, double time)
+{
+  const std::vector<Keyframe>& keys = track.keys;
+  // The first keyframe after time, so that the one before it starts the
+  //   segment time is in.
+  auto next = std::upper_bound (keys.begin (), keys.end (), time,
+				[] (double t, const Keyframe& key) { return t < key.time; });
+  Vector3 position;
+  Quaternion rotation;
+  if (next == keys.end ())
+  {
+    position = keys.back ().position;
+    rotation = keys.back ().rotation;
+  }
+  else if (next == keys.begin ())
+  {
+    position = keys.front ().position;
+    rotation = keys.front ().rotation;
+  }
+  else
+  {
+    const Keyframe& from = *(next - 1);
+    const Keyframe& to = *next;
+    float amount = (time - from.time) / (to.time - from.time);
+    position = from.position * (1 - amount) + to.position * amount;
+    rotation = slerp (from.rotation, to.rotation, amount);
+  }
+  // Decomposed, so the matrix is only built if the Mesh is drawn.
+  track.mesh->setWorld (Transform (track.boundWorld.getRotation () * rotation,
+				   track.boundWorld.getScale (), position));
+}
@@ -0,0 +1,97 @@
+/// \file Animation.hpp
+/// \brief Declaration of Animation class and any associated global functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+#include <string>
+#include <vector>
+
+#include "Mesh.hpp"
+#include "Quaternion.hpp"
+#include "Scene.hpp"
+#include "Transform.hpp"
+#include "Vector3.hpp"
+
+/// \brief A timeline of keyframes that move Meshes around, loaded from a
+///   file.
+///
+/// The timeline is made of tracks, each of which moves one Mesh through a
+///   list of keyframes sorted by time.  Tracks are bound to their Meshes once,
+///   so applying the animation does no name lookups, and only the tracks that
+///   are currently running are evaluated: each one finds its keyframes with a
+///   binary search, blends positions linearly and rotations spherically.  See
+///   chess.anim for the file format.
+class Animation
+{
+public:
+
+  /// \brief Loads an animation.
+  /// \param[in] fileName The name of the file to read the tracks from.
+  /// \post The tracks have been read, but are not bound to any Meshes.
+  Animation (const std::string& fileName);
+
+  /// \brief Attaches every track to the Mesh it names.
+  /// \param[in] scene The Scene containing the Meshes.
+  /// \pre Every Mesh named by a track is in scene.
+  /// \post The tracks will move those Meshes, starting from their current
+  ///   orientations.
+  void
+  bind (Scene& scene);
+
+  /// \brief Moves the Meshes to where they should be at some time.
+  /// \param[in] time The number of seconds since the animation started.
+  /// \pre The animation has been bound.
+  /// \post Every track that has started has put its Mesh where it was at
+  ///   time, or where it finished.
+  void
+  apply (double time);
+
+  /// \brief Gets how long the animation takes.
+  /// \return The time of the last keyframe.
+  double
+  getDuration () const;
+
+  /// \brief Gets the number of tracks that were evaluated by the last apply.
+  /// \return The number of running tracks.
+  size_t
+  getActiveTrackCount () const;
+
+private:
+
+  /// A position and rotation at a moment in time.
+  struct Keyframe
+  {
+    double time;
+    Vector3 position;
+    /// The rotation from the Mesh's bound orientation.
+    Quaternion rotation;
+  };
+
+  /// The keyframes that move one Mesh during one stretch of time.
+  struct Track
+  {
+    std::string meshName;
+    Mesh* mesh;
+    /// Where the Mesh was when the track was bound, decomposed.  Keyframe
+    ///   rotations are relative to its rotation.
+    Transform boundWorld;
+    std::vector<Keyframe> keys;
+  };
+
+  void
+  evaluate (const Track& track, double time);
+
+  /// Sorted by the time of their first keyframes.
+  std::vector<Track> m_tracks;
+  /// The index of the first track that has not started yet.
+  size_t m_nextTrack;
+  /// The indices of the tracks that have started but not finished.
+  std::vector<size_t> m_active;
+  size_t m_activeCount;
+  double m_lastTime;
+};
+
+#endif//ANIMATION_HPP
@@ -0,0 +1,338 @@
+/// \file BenchCompare.cpp
+/// \brief Compares two runs of BenchSuite and fails if the second is
+///   significantly slower.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// Benchmarks are matched by name and size.  A benchmark has regressed only
+///   if both of these hold:
+///   - Its median got slower by more than its noise threshold.  The
+///     threshold is the larger of a fixed minimum and a multiple of the
+///     relative spread of its samples in either run.
+///   - A one-sided Mann-Whitney U test over the samples says the slowdown is
+///     unlikely to be chance.
+///   Improvements are found the same way.  A table is printed, and the exit
+///   status is non-zero if anything regressed.  Build and run with "make
+///   bench-compare", or run BenchCompare.out with two JSON files.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchStats.hpp"
+
+namespace
+{
+  // The default smallest slowdown that counts as a regression, as a
+  //   fraction.
+  const double DEFAULT_THRESHOLD = 0.10;
+  // The default chance of a false alarm that is accepted per benchmark.
+  const double DEFAULT_ALPHA = 0.01;
+
+  // One parsed JSON value.  Only what BenchSuite writes needs to be read.
+  struct JsonValue
+  {
+    enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    JsonValue () : type (NUL), number (0.0) { }
+
+    // The member named key, or nullptr.
+    const JsonValue*
+    get (const std::string& key) const
+    {
+      for (const auto& member : members)
+	if (member.first == key)
+	  return &member.second;
+      return nullptr;
+    }
+
+    Type type;
+    double number;
+    std::string text;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+  };
+
+  // A recursive descent parser that exits with a message on bad input.
+  class JsonParser
+  {
+  public:
+
+    JsonParser (const std::string& fileName, const std::string& source)
+      : m_fileName (fileName), m_source (source), m_position (0)
+    {
+    }
+
+    JsonValue
+    parse ()
+    {
+      JsonValue value = parseValue ();
+      skipSpace ();
+      if (m_position != m_source.size ())
+	fail ("trailing characters");
+      return value;
+    }
+
+  private:
+
+    void
+    fail (const char* what) const
+    {
+      fprintf (stderr, "%s: bad JSON at offset %zu (%s)\n", m_fileName.c_str (),
+	       m_position, what);
+      exit (-1);
+    }
+
+    void
+    skipSpace ()
+    {
+      while (m_position < m_source.size ()
+	     && isspace (static_cast<unsigned char> (m_source[m_position])))
+	++m_position;
+    }
+
+    void
+    expect (char c)
+    {
+      skipSpace ();
+      if (m_position >= m_source.size () || m_source[m_position] != c)
+	fail ("unexpected character");
+      ++m_position;
+    }
+
+    bool
+    accept (char c)
+    {
+      skipSpace ();
+      if (m_position < m_source.size () && m_source[m_position] == c)
+      {
+	++m_position;
+	return true;
+      }
+      return false;
+    }
+
+    bool
+    acceptWord (const char* word)
+    {
+      size_t length = std::char_traits<char>::length (word);
+      if (m_source.compare (m_position, length, word) != 0)
+	return false;
+      m_position += length;
+      return true;
+    }
+
+    std::string
+    parseString ()
+    {
+      expect ('"');
+      std::string text;
+      while (m_position < m_source.size () && m_source[m_position] != '"')
+      {
+	char c = m_source[m_position++];
+	if (c == '\\')
+	{
+	  if (m_position >= m_source.size ())
+	    fail ("unfinished escape");
+	  c = m_source[m_position++];
+	  if (c == 'n')
+	    c = '\n';
+	  else if (c == 't')
+	    c = '\t';
+	  else if (c == 'u')
+	  {
+	    if (m_source.size () - m_position < 4)
+	      fail ("unfinished escape");
+	    // Names are ASCII, so anything else becomes a question mark.
+	    unsigned long code = std::strtoul (m_source.substr (m_position, 4).c_str (),
+					       nullptr, 16);
+	    m_position += 4;
+	    c = (code < 0x80) ? static_cast<char> (code) : '?';
+	  }
+	}
+	text += c;
+      }
+      expect ('"');
+      return text;
+    }
+
+    JsonValue
+    parseValue ()
+    {
+      JsonValue value;
+      skipSpace ();
+      if (m_position >= m_source.size ())
+	fail ("unexpected end");
+      char c = m_source[m_position];
+      if (c == '{')
+      {
+	value.type = JsonValue::OBJECT;
+	++m_position;
+	if (accept ('}'))
+	  return value;
+	do
+	{
+	  std::string key = parseString ();
+	  expect (':');
+	  value.members.emplace_back (key, parseValue ());
+	}
+	while (accept (','));
+	expect ('}');
+      }
+      else if (c == '[')
+      {
+	value.type = JsonValue::ARRAY;
+	++m_position;
+	if (accept (']'))
+	  return value;
+	do
+	  value.elements.push_back (parseValue ());
+	while (accept (','));
+	expect (']');
+      }
+      else if (c == '"')
+      {
+	value.type = JsonValue::STRING;
+	value.text = parseString ();
+      }
+      else if (acceptWord ("true"))
+      {
+	value.type = JsonValue::BOOLEAN;
+	value.number = 1.0;
+      }
+      else if (acceptWord ("false"))
+	value.type = JsonValue::BOOLEAN;
+      else if (acceptWord ("null"))
+	value.type = JsonValue::NUL;
+      else
+      {
+	const char* start = m_source.c_str () + m_position;
+	char* end;
+	value.type = JsonValue::NUMBER;
+	value.number = std::strtod (start, &end);
+	if (end == start)
+	  fail ("expected a value");
+	m_position += end - start;
+      }
+      return value;
+    }
+
+    std::string m_fileName;
+    std::string m_source;
+    size_t m_position;
+  };
+
+  // One benchmark's samples, keyed by name and size.
+  typedef std::pair<std::string, size_t> BenchmarkKey;
+  typedef std::map<BenchmarkKey, std::vector<double>> BenchmarkRun;
+
+  // Reads the benchmarks in a file that BenchSuite wrote.
+  BenchmarkRun
+  readRun (const std::string& fileName)
+  {
+    std::ifstream in (fileName);
+    if (!in)
+    {
+      fprintf (stderr, "Failed to open %s\n", fileName.c_str ());
+      exit (-1);
+    }
+    std::stringstream source;
+    source << in.rdbuf ();
+    JsonValue root = JsonParser (fileName, source.str ()).parse ();
+    const JsonValue* benchmarks = root.get ("benchmarks");
+    if (benchmarks == nullptr || benchmarks->type != JsonValue::ARRAY)
+    {
+      fprintf (stderr, "%s has no benchmarks array\n", fileName.c_str ());
+      exit (-1);
+    }
+    BenchmarkRun run;
+    for (const JsonValue& benchmark : benchmarks->elements)
+    {
+      const JsonValue* name = benchmark.get ("name");
+      const JsonValue* size = benchmark.get ("size");
+      const JsonValue* samples = benchmark.get ("samples");
+      if (name == nullptr || samples == nullptr || samples->type != JsonValue::ARRAY)
+      {
+	fprintf (stderr, "%s has a benchmark without a name or samples\n",
+		 fileName.c_str ());
+	exit (-1);
+      }
+      std::vector<double>& times = run[BenchmarkKey (name->text, (size == nullptr) ? 0
+						     : static_cast<size_t> (size->number))];
+      for (const JsonValue& sample : samples->elements)
+	times.push_back (sample.number);
+    }
+    return run;
+  }
+}
+
+/// \brief Compares the runs.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line arguments: optionally
+///   "--threshold PERCENT", the smallest change that counts, and "--alpha
+///   P", the p-value below which a change is significant, then the baseline
+///   and candidate JSON files.
+/// \return EXIT_SUCCESS if nothing regressed, or EXIT_FAILURE if anything
+///   did.
+int
+main (int argc, char* argv[])
+{
+  double threshold = DEFAULT_THRESHOLD;
+  double alpha = DEFAULT_ALPHA;
+  std::vector<std::string> fileNames;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg (argv[i]);
+    if (arg == "--threshold" && i + 1 < argc)
+      threshold = std::stod (argv[++i]) / 100;
+    else if (arg == "--alpha" && i + 1 < argc)
+      alpha = std::stod (argv[++i]);
+    else if (arg.compare (0, 2, "--") != 0)
+      fileNames.push_back (arg);
+    else
+      fileNames.clear ();
+  }
+  if (fileNames.size () != 2)
+  {
+    fprintf (stderr, "Usage: %s [--threshold PERCENT] [--alpha P] BASELINE CANDIDATE\n",
+	     argv[0]);
+    exit (-1);
+  }
+  BenchmarkRun baseline = readRun (fileNames[0]);
+  BenchmarkRun candidate = readRun (fileNames[1]);
+
+  printf ("%-32s %8s %14s %14s %8s %7s %8s  %s\n", "benchmark", "size", "base_ns",
+	  "cand_ns", "change", "noise", "p_value", "verdict");
+  unsigned int regressions = 0, improvements = 0;
+  for (const auto& entry : baseline)
+  {
+    const BenchmarkKey& key = entry.first;
+    const std::vector<double>& before = entry.second;
+    auto found = candidate.find (key);
+    if (found == candidate.end ())
+    {
+      printf ("%-32s %8zu %14.2f %14s %8s %7s %8s  missing\n", key.first.c_str (),
+	      key.second, median (before), "-", "-", "-", "-");
+      continue;
+    }
+    SampleComparison result = compareSamples (before, found->second, threshold, alpha);
+    regressions += result.verdict == SampleComparison::REGRESSED;
+    improvements += result.verdict == SampleComparison::IMPROVED;
+    printf ("%-32s %8zu %14.2f %14.2f %+7.1f%% %6.1f%% %8.4f  %s\n", key.first.c_str (),
+	    key.second, result.baselineMedian, result.candidateMedian, 100 * result.change,
+	    100 * result.noise, result.p, getVerdictName (result.verdict));
+  }
+  for (const auto& entry : candidate)
+    if (baseline.find (entry.first) == baseline.end ())
+      printf ("%-32s %8zu %14s %14.2f %8s %7s %8s  new\n", entry.first.first.c_str (),
+	      entry.first.second, "-", median (entry.second), "-", "-", "-");
+  printf ("%u regressed, %u improved, of %zu in the baseline\n", regressions, improvements,
+	  baseline.size ());
+  return (regressions == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
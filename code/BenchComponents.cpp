@@ -0,0 +1,163 @@
+/// \file BenchComponents.cpp
+/// \brief Compares culling and recording a Scene one Mesh at a time with
+///   doing the same from a ComponentStore.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// The same objects are put into a Scene and, through Mesh::addTo, a
+///   ComponentStore, on a SoftwareOpenGLContext so no window or GPU is
+///   needed.  They share a few materials, assigned at random so that
+///   sorting has something to do.  Each frame culls and records every
+///   visible object both ways; the store also sorts what it will draw.
+///   Build with "make BenchComponents.out" and run with an optional number
+///   of objects and number of threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CommandBuffer.hpp"
+#include "ComponentStore.hpp"
+#include "Geometry.hpp"
+#include "JobSystem.hpp"
+#include "Material.hpp"
+#include "Mesh.hpp"
+#include "NormalsMesh.hpp"
+#include "Scene.hpp"
+#include "ShaderProgram.hpp"
+#include "SoftwareOpenGLContext.hpp"
+#include "Transform.hpp"
+
+namespace
+{
+  const int WARMUP_FRAMES = 3;
+  const int TIMED_FRAMES = 20;
+  const int NUM_MATERIALS = 8;
+
+  double
+  millisecondsSince (std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>
+      (std::chrono::steady_clock::now () - start).count ();
+  }
+
+  void
+  printRow (const char* name, double cull, double sort, double record,
+	    const CommandBuffer& commands)
+  {
+    printf ("%-10s  %7.3f  %7.3f  %9.3f  %8.3f  %9zu  %8.1f\n", name,
+	    cull / TIMED_FRAMES, sort / TIMED_FRAMES, record / TIMED_FRAMES,
+	    (cull + sort + record) / TIMED_FRAMES, commands.getPacketCount (),
+	    commands.getSize () / 1048576.0);
+  }
+}
+
+/// \brief Runs the benchmark.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line arguments.  The first, if
+///   present, is the number of objects, and the second the number of
+///   threads.
+int
+main (int argc, char* argv[])
+{
+  unsigned int numMeshes = (argc > 1) ? std::stoi (argv[1]) : 100000;
+  unsigned int threads = (argc > 2) ? std::stoi (argv[2]) : 1;
+  JobSystem::resetGlobal (threads);
+
+  SoftwareOpenGLContext context (1);
+  ShaderProgram shader (&context);
+  Scene scene;
+  ComponentStore store;
+  std::vector<Material> materials;
+  for (int i = 0; i < NUM_MATERIALS; ++i)
+  {
+    float shade = (i + 1.0f) / NUM_MATERIALS;
+    materials.push_back (Material (Vector3 (shade, shade, shade)));
+    store.addMaterial (materials.back ());
+  }
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> pickMaterial (0, NUM_MATERIALS - 1);
+
+  std::vector<Triangle> cube = buildCube ();
+  std::vector<float> cubeData = dataWithFaceNormals (cube, computeFaceNormals (cube));
+  std::vector<float> data;
+  std::vector<unsigned int> indices;
+  indexData (cubeData, 6, data, indices);
+  unsigned int side = std::ceil (std::cbrt (numMeshes));
+  for (unsigned int i = 0; i < numMeshes; ++i)
+  {
+    Mesh* mesh = new NormalsMesh (&context, &shader);
+    mesh->addGeometry (data);
+    mesh->addIndices (indices);
+    mesh->prepareVao ();
+    mesh->moveWorld (3.0f * (i % side) - 1.5f * side, Vector3 (1, 0, 0));
+    mesh->moveWorld (3.0f * (i / side % side) - 1.5f * side, Vector3 (0, 1, 0));
+    mesh->moveWorld (-3.0f * (i / side / side), Vector3 (0, 0, 1));
+    int material = pickMaterial (generator);
+    mesh->setMaterial (materials[material]);
+    scene.add (mesh);
+    mesh->addTo (store, material);
+  }
+
+  Transform eye;
+  eye.moveBack (10.0f);
+  Transform view = eye;
+  view.invertRt ();
+  Matrix4 projection;
+  projection.setToPerspectiveProjection (50.0, 4.0 / 3.0, 0.01, 1000.0);
+  CommandBuffer sceneCommands;
+  CommandBuffer storeCommands;
+
+  double sceneCull = 0.0, sceneRecord = 0.0;
+  double storeCull = 0.0, storeSort = 0.0, storeRecord = 0.0;
+  for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; ++frame)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    scene.cull (view, projection);
+    double cullTime = millisecondsSince (start);
+    start = std::chrono::steady_clock::now ();
+    sceneCommands.clear ();
+    scene.recordParallel (sceneCommands, view, projection, eye.getPosition ());
+    double recordTime = millisecondsSince (start);
+    if (frame >= WARMUP_FRAMES)
+    {
+      sceneCull += cullTime;
+      sceneRecord += recordTime;
+    }
+
+    start = std::chrono::steady_clock::now ();
+    store.cull (view, projection);
+    cullTime = millisecondsSince (start);
+    start = std::chrono::steady_clock::now ();
+    store.sortVisible ();
+    double sortTime = millisecondsSince (start);
+    start = std::chrono::steady_clock::now ();
+    storeCommands.clear ();
+    store.record (storeCommands, view, projection, eye.getPosition ());
+    recordTime = millisecondsSince (start);
+    if (frame >= WARMUP_FRAMES)
+    {
+      storeCull += cullTime;
+      storeSort += sortTime;
+      storeRecord += recordTime;
+    }
+  }
+
+  printf ("%u objects, %d materials, %u threads, %d frames\n", numMeshes,
+	  NUM_MATERIALS, threads, TIMED_FRAMES);
+  printf ("layout      cull_ms  sort_ms  record_ms  total_ms  packets    record_mb\n");
+  printRow ("scene", sceneCull, 0.0, sceneRecord, sceneCommands);
+  printRow ("components", storeCull, storeSort, storeRecord, storeCommands);
+  if (scene.getVisibleCount () != store.getVisible ().size ())
+  {
+    fprintf (stderr, "Scene saw %zu objects but the store saw %zu; exiting\n",
+	     scene.getVisibleCount (), store.getVisible ().size ());
+    exit (-1);
+  }
+  return EXIT_SUCCESS;
+}
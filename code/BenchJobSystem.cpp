@@ -0,0 +1,151 @@
+/// \file BenchJobSystem.cpp
+/// \brief Measures how the work done through JobSystem scales from one
+///   thread to one per hardware thread.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// A synthetic Scene of many small Meshes is built on a SoftwareOpenGLContext,
+///   so no window or GPU is needed.  For each thread count, every frame
+///   updates all of the transforms, culls, and records draw packets, and
+///   vertex normals are computed for one larger mesh.  Build with
+///   "make BenchJobSystem.out" and run with an optional number of Meshes.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandBuffer.hpp"
+#include "Geometry.hpp"
+#include "JobSystem.hpp"
+#include "NormalsMesh.hpp"
+#include "Scene.hpp"
+#include "ShaderProgram.hpp"
+#include "SoftwareOpenGLContext.hpp"
+#include "Transform.hpp"
+
+namespace
+{
+  const int WARMUP_FRAMES = 3;
+  const int TIMED_FRAMES = 20;
+
+  double
+  millisecondsSince (std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>
+      (std::chrono::steady_clock::now () - start).count ();
+  }
+
+  // A mesh made of many randomly placed cubes, big enough that computing its
+  //   vertex normals takes a while.
+  std::vector<Triangle>
+  buildManyCubes (unsigned int numCubes)
+  {
+    std::default_random_engine generator;
+    std::uniform_real_distribution<float> distribution (-20.0f, 20.0f);
+    std::vector<Triangle> cube = buildCube ();
+    std::vector<Triangle> faces;
+    for (unsigned int i = 0; i < numCubes; ++i)
+    {
+      Vector3 offset (distribution (generator), distribution (generator),
+		      distribution (generator));
+      for (Triangle triangle : cube)
+      {
+	for (Vector3& vertex : triangle)
+	  vertex += offset;
+	faces.push_back (triangle);
+      }
+    }
+    return faces;
+  }
+}
+
+/// \brief Runs the benchmark.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line arguments.  The first, if
+///   present, is the number of Meshes in the scene.
+int
+main (int argc, char* argv[])
+{
+  unsigned int numMeshes = (argc > 1) ? std::stoi (argv[1]) : 20000;
+  unsigned int maxThreads = std::max (1u, std::thread::hardware_concurrency ());
+
+  SoftwareOpenGLContext context (1);
+  ShaderProgram shader (&context);
+  Scene scene;
+  std::vector<Triangle> cube = buildCube ();
+  std::vector<float> cubeData = dataWithFaceNormals (cube, computeFaceNormals (cube));
+  unsigned int side = std::ceil (std::cbrt (numMeshes));
+  for (unsigned int i = 0; i < numMeshes; ++i)
+  {
+    NormalsMesh* mesh = new NormalsMesh (&context, &shader);
+    std::vector<float> data;
+    std::vector<unsigned int> indices;
+    indexData (cubeData, 6, data, indices);
+    mesh->addGeometry (data);
+    mesh->addIndices (indices);
+    mesh->prepareVao ();
+    mesh->moveWorld (3.0f * (i % side) - 1.5f * side, Vector3 (1, 0, 0));
+    mesh->moveWorld (3.0f * (i / side % side) - 1.5f * side, Vector3 (0, 1, 0));
+    mesh->moveWorld (-3.0f * (i / side / side), Vector3 (0, 0, 1));
+    scene.add ("mesh" + std::to_string (i), mesh);
+  }
+  std::vector<Triangle> bigMesh = buildManyCubes (250);
+  std::vector<Vector3> bigFaceNormals = computeFaceNormals (bigMesh);
+
+  Transform eye;
+  eye.moveBack (10.0f);
+  Transform view = eye;
+  view.invertRt ();
+  Matrix4 projection;
+  projection.setToPerspectiveProjection (50.0, 4.0 / 3.0, 0.01, 1000.0);
+  CommandBuffer commands;
+
+  printf ("%u meshes, %zu triangles for normals, %d frames per thread count\n",
+	  numMeshes, bigMesh.size (), TIMED_FRAMES);
+  printf ("threads  update_ms  cull_ms  record_ms  normals_ms  frame_speedup\n");
+  double baseline = 0.0;
+  for (unsigned int threads = 1; threads <= maxThreads;
+       threads = (threads == maxThreads) ? threads + 1 : std::min (threads * 2, maxThreads))
+  {
+    JobSystem::resetGlobal (threads);
+    double update = 0.0, cull = 0.0, record = 0.0, normals = 0.0;
+    for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; ++frame)
+    {
+      auto start = std::chrono::steady_clock::now ();
+      scene.updateMeshes ([] (Mesh& mesh) { mesh.yaw (1.0f); });
+      double updateTime = millisecondsSince (start);
+      start = std::chrono::steady_clock::now ();
+      scene.cull (view, projection);
+      double cullTime = millisecondsSince (start);
+      start = std::chrono::steady_clock::now ();
+      commands.clear ();
+      scene.recordParallel (commands, view, projection, eye.getPosition ());
+      double recordTime = millisecondsSince (start);
+      if (frame >= WARMUP_FRAMES)
+      {
+	update += updateTime;
+	cull += cullTime;
+	record += recordTime;
+      }
+    }
+    auto start = std::chrono::steady_clock::now ();
+    std::vector<Vector3> vertexNormals = computeVertexNormals (bigMesh, bigFaceNormals);
+    normals = millisecondsSince (start);
+
+    double frame = (update + cull + record) / TIMED_FRAMES;
+    if (threads == 1)
+      baseline = frame;
+    printf ("%7u  %9.3f  %7.3f  %9.3f  %10.1f  %13.2f\n", threads,
+	    update / TIMED_FRAMES, cull / TIMED_FRAMES, record / TIMED_FRAMES,
+	    normals, baseline / frame);
+  }
+  printf ("visible meshes: %zu, packets: %zu\n", scene.getVisibleCount (),
+	  commands.getPacketCount ());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+/// \file BenchMath.cpp
+/// \brief Compares the SIMD matrix and transform math with the scalar code
+///   it replaced.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// Each operation is run over arrays of random matrices, once through the
+///   library (which uses Simd.hpp) and once through a copy of the scalar
+///   version it used to have, and the results are checked against each
+///   other.  The batch transforms are timed per point against a loop of
+///   single-vector products, on interleaved position/normal data.  Build
+///   with "make BenchMath.out", or with -DMATH_NO_SIMD added to CXXFLAGS to
+///   see the library's scalar fallback, and run with an optional number of
+///   matrices and an optional number of threads.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "Matrix3.hpp"
+#include "Matrix4.hpp"
+#include "Transform.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+namespace
+{
+  const int REPETITIONS = 50;
+  // Floats per vertex in the batch transform data: a position and a normal.
+  const size_t STRIDE = 6;
+
+  // The element-by-element versions the library had before Simd.hpp.
+  namespace Scalar
+  {
+    Matrix3
+    multiply (const Matrix3& a, const Matrix3& b)
+    {
+      const float* m = a.data ();
+      const float* n = b.data ();
+      Matrix3 result;
+      float* out = result.data ();
+      for (int col = 0; col < 3; ++col)
+	for (int row = 0; row < 3; ++row)
+	  out[col * 3 + row] = m[row] * n[col * 3] + m[3 + row] * n[col * 3 + 1]
+	    + m[6 + row] * n[col * 3 + 2];
+      return result;
+    }
+
+    Vector3
+    transform (const Matrix3& a, const Vector3& v)
+    {
+      const float* m = a.data ();
+      return Vector3 (m[0] * v.m_x + m[3] * v.m_y + m[6] * v.m_z,
+		      m[1] * v.m_x + m[4] * v.m_y + m[7] * v.m_z,
+		      m[2] * v.m_x + m[5] * v.m_y + m[8] * v.m_z);
+    }
+
+    Transform
+    multiply (const Transform& t1, const Transform& t2)
+    {
+      Matrix3 orientation = multiply (t1.getOrientation (), t2.getOrientation ());
+      Vector3 position = transform (t1.getOrientation (), t2.getPosition ())
+	+ t1.getPosition ();
+      return Transform (orientation, position);
+    }
+
+    Transform
+    invertRt (const Transform& t)
+    {
+      Matrix3 orientation = t.getOrientation ();
+      orientation.transpose ();
+      return Transform (orientation, -1 * transform (orientation, t.getPosition ()));
+    }
+
+    Matrix4
+    multiply (const Matrix4& a, const Matrix4& b)
+    {
+      const float* m = a.data ();
+      const float* n = b.data ();
+      float out[16];
+      for (int col = 0; col < 4; ++col)
+	for (int row = 0; row < 4; ++row)
+	  out[col * 4 + row] = m[row] * n[col * 4] + m[4 + row] * n[col * 4 + 1]
+	    + m[8 + row] * n[col * 4 + 2] + m[12 + row] * n[col * 4 + 3];
+      return Matrix4 (Vector4 (out[0], out[1], out[2], out[3]),
+		      Vector4 (out[4], out[5], out[6], out[7]),
+		      Vector4 (out[8], out[9], out[10], out[11]),
+		      Vector4 (out[12], out[13], out[14], out[15]));
+    }
+
+    Vector4
+    transform (const Matrix4& a, const Vector4& v)
+    {
+      const float* m = a.data ();
+      float out[4];
+      for (int row = 0; row < 4; ++row)
+	out[row] = m[row] * v.m_x + m[4 + row] * v.m_y + m[8 + row] * v.m_z
+	  + m[12 + row] * v.m_w;
+      return Vector4 (out[0], out[1], out[2], out[3]);
+    }
+  }
+
+  float
+  maxDifference (const float* a, const float* b, int count)
+  {
+    float difference = 0;
+    for (int i = 0; i < count; ++i)
+      difference = std::max (difference, std::fabs (a[i] - b[i]));
+    return difference;
+  }
+
+  // Nanoseconds per call of "operation", which handles element i.
+  double
+  nanosecondsPer (size_t count, const std::function<void (size_t)>& operation)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+      for (size_t i = 0; i < count; ++i)
+	operation (i);
+    return std::chrono::duration<double, std::nano>
+      (std::chrono::steady_clock::now () - start).count () / (REPETITIONS * count);
+  }
+
+  void
+  printRow (const char* name, double scalar, double simd, float difference)
+  {
+    printf ("%-20s  %9.2f  %7.2f  %7.2f  %10.1e\n", name, scalar, simd,
+	    scalar / simd, difference);
+  }
+}
+
+/// \brief Runs the benchmark.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line arguments.  The first, if
+///   present, is the number of matrices of each kind.  The second, if
+///   present, is the number of threads for the batch transforms.
+int
+main (int argc, char* argv[])
+{
+  size_t count = (argc > 1) ? std::stoi (argv[1]) : 4096;
+  if (argc > 2)
+    JobSystem::resetGlobal (std::stoi (argv[2]));
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<float> distribution (-1.0f, 1.0f);
+  auto random = [&] () { return distribution (generator); };
+  std::vector<Matrix3> matrices3;
+  std::vector<Vector3> vectors3;
+  std::vector<Transform> transforms;
+  std::vector<Matrix4> matrices4;
+  std::vector<Vector4> vectors4;
+  for (size_t i = 0; i < count + 1; ++i)
+  {
+    matrices3.push_back (Matrix3 (random (), random (), random (), random (), random (),
+				  random (), random (), random (), random ()));
+    vectors3.push_back (Vector3 (random (), random (), random ()));
+    Transform t;
+    t.rotateLocal (180 * random (), Vector3 (random (), random (), random () + 2));
+    t.setPosition (vectors3.back () * 10);
+    transforms.push_back (t);
+    matrices4.push_back (Matrix4 (Vector4 (random (), random (), random (), random ()),
+				  Vector4 (random (), random (), random (), random ()),
+				  Vector4 (random (), random (), random (), random ()),
+				  Vector4 (random (), random (), random (), random ())));
+    vectors4.push_back (Vector4 (random (), random (), random (), random ()));
+  }
+
+  std::vector<Matrix3> outMatrices3 (count), scalarMatrices3 (count);
+  std::vector<Vector3> outVectors3 (count), scalarVectors3 (count);
+  std::vector<Transform> outTransforms (count), scalarTransforms (count);
+  std::vector<Matrix4> outMatrices4 (count), scalarMatrices4 (count);
+  std::vector<Vector4> outVectors4 (count), scalarVectors4 (count);
+  float transformArray[16], scalarArray[16];
+
+  printf ("%zu operands, %d repetitions\n", count, REPETITIONS);
+  printf ("operation             scalar_ns  simd_ns  speedup  max_diff\n");
+  double scalar, simd;
+  float difference;
+
+  scalar = nanosecondsPer (count, [&] (size_t i)
+    { scalarMatrices3[i] = Scalar::multiply (matrices3[i], matrices3[i + 1]); });
+  simd = nanosecondsPer (count, [&] (size_t i)
+    { outMatrices3[i] = matrices3[i] * matrices3[i + 1]; });
+  difference = 0;
+  for (size_t i = 0; i < count; ++i)
+    difference = std::max (difference, maxDifference (outMatrices3[i].data (),
+						      scalarMatrices3[i].data (), 9));
+  printRow ("Matrix3 * Matrix3", scalar, simd, difference);
+
+  scalar = nanosecondsPer (count, [&] (size_t i)
+    { scalarVectors3[i] = Scalar::transform (matrices3[i], vectors3[i]); });
+  simd = nanosecondsPer (count, [&] (size_t i)
+    { outVectors3[i] = matrices3[i] * vectors3[i]; });
+  difference = 0;
+  for (size_t i = 0; i < count; ++i)
+    difference = std::max (difference, maxDifference (&outVectors3[i].m_x,
+						      &scalarVectors3[i].m_x, 3));
+  printRow ("Matrix3 * Vector3", scalar, simd, difference);
+
+  scalar = nanosecondsPer (count, [&] (size_t i)
+    { scalarTransforms[i] = Scalar::multiply (transforms[i], transforms[i + 1]); });
+  simd = nanosecondsPer (count, [&] (size_t i)
+    { outTransforms[i] = transforms[i] * transforms[i + 1]; });
+  difference = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    outTransforms[i].getTransform (transformArray);
+    scalarTransforms[i].getTransform (scalarArray);
+    difference = std::max (difference, maxDifference (transformArray, scalarArray, 16));
+  }
+  printRow ("Transform * Transform", scalar, simd, difference);
+
+  scalar = nanosecondsPer (count, [&] (size_t i)
+    { scalarTransforms[i] = Scalar::invertRt (transforms[i]); });
+  simd = nanosecondsPer (count, [&] (size_t i)
+    {
+      outTransforms[i] = transforms[i];
+      outTransforms[i].invertRt ();
+    });
+  difference = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    outTransforms[i].getTransform (transformArray);
+    scalarTransforms[i].getTransform (scalarArray);
+    difference = std::max (difference, maxDifference (transformArray, scalarArray, 16));
+  }
+  printRow ("Transform::invertRt", scalar, simd, difference);
+
+  scalar = nanosecondsPer (count, [&] (size_t i)
+    { scalarMatrices4[i] = Scalar::multiply (matrices4[i], matrices4[i + 1]); });
+  simd = nanosecondsPer (count, [&] (size_t i)
+    { outMatrices4[i] = matrices4[i] * matrices4[i + 1]; });
+  difference = 0;
+  for (size_t i = 0; i < count; ++i)
+    difference = std::max (difference, maxDifference (outMatrices4[i].data (),
+						      scalarMatrices4[i].data (), 16));
+  printRow ("Matrix4 * Matrix4", scalar, simd, difference);
+
+  scalar = nanosecondsPer (count, [&] (size_t i)
+    { scalarVectors4[i] = Scalar::transform (matrices4[i], vectors4[i]); });
+  simd = nanosecondsPer (count, [&] (size_t i)
+    { outVectors4[i] = matrices4[i] * vectors4[i]; });
+  difference = 0;
+  for (size_t i = 0; i < count; ++i)
+    difference = std::max (difference, maxDifference (outVectors4[i].data (),
+						      scalarVectors4[i].data (), 4));
+  printRow ("Matrix4 * Vector4", scalar, simd, difference);
+
+  // The batches are big enough to be split among threads.
+  size_t numPoints = count * 64;
+  std::vector<float> vertices (numPoints * STRIDE);
+  for (float& f : vertices)
+    f = random ();
+  std::vector<float> outVertices (vertices.size ()), scalarVertices (vertices.size ());
+  const Transform& world = transforms[0];
+  auto timeBatch = [&] (const std::function<void ()>& operation)
+  {
+    auto start = std::chrono::steady_clock::now ();
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+      operation ();
+    return std::chrono::duration<double, std::nano>
+      (std::chrono::steady_clock::now () - start).count () / (REPETITIONS * numPoints);
+  };
+
+  scalar = timeBatch ([&] ()
+    {
+      Matrix3 orientation = world.getOrientation ();
+      Vector3 position = world.getPosition ();
+      for (size_t i = 0; i < vertices.size (); i += STRIDE)
+      {
+	Vector3 p = Scalar::transform (orientation, Vector3 (vertices[i], vertices[i + 1],
+							     vertices[i + 2])) + position;
+	scalarVertices[i] = p.m_x;
+	scalarVertices[i + 1] = p.m_y;
+	scalarVertices[i + 2] = p.m_z;
+      }
+    });
+  simd = timeBatch ([&] ()
+    { world.transformPoints (vertices.data (), outVertices.data (), numPoints, STRIDE); });
+  difference = 0;
+  for (size_t i = 0; i < vertices.size (); i += STRIDE)
+    difference = std::max (difference, maxDifference (&outVertices[i], &scalarVertices[i], 3));
+  printRow ("transformPoints", scalar, simd, difference);
+
+  scalar = timeBatch ([&] ()
+    {
+      Matrix3 orientation = world.getOrientation ();
+      for (size_t i = 3; i < vertices.size (); i += STRIDE)
+      {
+	Vector3 d = Scalar::transform (orientation, Vector3 (vertices[i], vertices[i + 1],
+							     vertices[i + 2]));
+	scalarVertices[i] = d.m_x;
+	scalarVertices[i + 1] = d.m_y;
+	scalarVertices[i + 2] = d.m_z;
+      }
+    });
+  simd = timeBatch ([&] ()
+    { world.transformDirections (vertices.data () + 3, outVertices.data () + 3, numPoints, STRIDE); });
+  difference = 0;
+  for (size_t i = 3; i < vertices.size (); i += STRIDE)
+    difference = std::max (difference, maxDifference (&outVertices[i], &scalarVertices[i], 3));
+  printRow ("transformDirections", scalar, simd, difference);
+  return EXIT_SUCCESS;
+}
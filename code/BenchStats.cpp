@@ -0,0 +1,109 @@
+/// \file BenchStats.cpp
+/// \brief Definitions of the statistics BenchCompare judges benchmark
+///   samples with.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "BenchStats.hpp"
+
+double
+median (std::vector<double> values)
+{
+  if (values.empty ())
+    return 0.0;
+  std::sort (values.begin (), values.end ());
+  size_t middle = values.size () / 2;
+  return (values.size () % 2 == 1) ? values[middle]
+    : (values[middle - 1] + values[middle]) / 2;
+}
+
+double
+relativeSpread (const std::vector<double>& values)
+{
+  double middle = median (values);
+  if (middle <= 0.0)
+    return 0.0;
+  std::vector<double> deviations;
+  for (double value : values)
+    deviations.push_back (std::fabs (value - middle));
+  return 1.4826 * median (deviations) / middle;
+}
+
+double
+mannWhitney (const std::vector<double>& baseline,
+	     const std::vector<double>& candidate, bool larger)
+{
+  std::vector<std::pair<double, bool>> all;
+  for (double value : baseline)
+    all.emplace_back (value, false);
+  for (double value : candidate)
+    all.emplace_back (value, true);
+  std::sort (all.begin (), all.end ());
+  double n1 = baseline.size (), n2 = candidate.size (), n = all.size ();
+  double candidateRanks = 0.0;
+  double ties = 0.0;
+  for (size_t first = 0; first < all.size (); )
+  {
+    size_t last = first;
+    while (last + 1 < all.size () && all[last + 1].first == all[first].first)
+      ++last;
+    // Tied values share the average of their ranks, which start at 1.
+    double rank = (first + last) / 2.0 + 1.0;
+    double count = last - first + 1;
+    ties += count * count * count - count;
+    for (size_t i = first; i <= last; ++i)
+      if (all[i].second)
+	candidateRanks += rank;
+    first = last + 1;
+  }
+  double u = candidateRanks - n2 * (n2 + 1) / 2;
+  double mean = n1 * n2 / 2;
+  double variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+  if (variance <= 0.0)
+    return 1.0;
+  double z = larger ? (u - mean - 0.5) / std::sqrt (variance)
+    : (mean - u - 0.5) / std::sqrt (variance);
+  return 0.5 * std::erfc (z / std::sqrt (2.0));
+}
+
+SampleComparison
+compareSamples (const std::vector<double>& baseline,
+		const std::vector<double>& candidate, double threshold,
+		double alpha)
+{
+  SampleComparison result;
+  result.baselineMedian = median (baseline);
+  result.candidateMedian = median (candidate);
+  result.change = (result.baselineMedian > 0.0)
+    ? result.candidateMedian / result.baselineMedian - 1.0 : 0.0;
+  result.noise = std::max (threshold, NOISE_MULTIPLIER
+			   * std::max (relativeSpread (baseline), relativeSpread (candidate)));
+  result.p = mannWhitney (baseline, candidate, result.change > 0.0);
+  result.verdict = SampleComparison::SAME;
+  if (baseline.size () < MIN_SAMPLES || candidate.size () < MIN_SAMPLES)
+    result.verdict = SampleComparison::TOO_FEW_SAMPLES;
+  else if (std::fabs (result.change) > result.noise && result.p < alpha)
+    result.verdict = (result.change > 0.0) ? SampleComparison::REGRESSED
+      : SampleComparison::IMPROVED;
+  return result;
+}
+
+const char*
+getVerdictName (SampleComparison::Verdict verdict)
+{
+  switch (verdict)
+  {
+  case SampleComparison::TOO_FEW_SAMPLES:
+    return "too few samples";
+  case SampleComparison::REGRESSED:
+    return "REGRESSED";
+  case SampleComparison::IMPROVED:
+    return "improved";
+  default:
+    return "same";
+  }
+}
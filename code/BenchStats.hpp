@@ -0,0 +1,86 @@
+/// \file BenchStats.hpp
+/// \brief Declarations of the statistics BenchCompare judges benchmark
+///   samples with.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef BENCH_STATS_HPP
+#define BENCH_STATS_HPP
+
+#include <cstddef>
+#include <vector>
+
+/// \brief What comparing one benchmark's samples from two runs found.
+struct SampleComparison
+{
+  /// The possible outcomes.
+  enum Verdict { SAME, TOO_FEW_SAMPLES, REGRESSED, IMPROVED };
+
+  /// The median of the baseline samples.
+  double baselineMedian;
+  /// The median of the candidate samples.
+  double candidateMedian;
+  /// How much slower the candidate's median is, as a fraction, which is
+  ///   negative if it is faster.
+  double change;
+  /// The smallest change, as a fraction, that is not noise.
+  double noise;
+  /// The one-sided Mann-Whitney p-value of the change.
+  double p;
+  /// Whether the candidate regressed, improved, or neither.
+  Verdict verdict;
+};
+
+/// The fewest samples in each run that a benchmark is judged on.
+const size_t MIN_SAMPLES = 5;
+
+/// How many times its relative spread a benchmark must change by.
+const double NOISE_MULTIPLIER = 2.0;
+
+/// \brief Gets the median of some values.
+/// \param[in] values The values, in any order.
+/// \return Their median, or 0 if there are none.
+double
+median (std::vector<double> values);
+
+/// \brief Gets how spread out some values are, relative to their size.
+/// \param[in] values The values, in any order.
+/// \return The median absolute deviation, scaled to estimate a standard
+///   deviation and divided by the median, so that one outlier cannot
+///   inflate it, or 0 if the median is not positive.
+double
+relativeSpread (const std::vector<double>& values);
+
+/// \brief Tests whether candidate samples tend to be larger (or smaller)
+///   than baseline samples.
+/// \param[in] baseline The first set of samples.
+/// \param[in] candidate The second set of samples.
+/// \param[in] larger Whether the alternative is that candidate samples are
+///   larger, instead of smaller.
+/// \return The one-sided p-value of a Mann-Whitney U test, from the normal
+///   approximation with tie and continuity corrections, or 1 if every
+///   sample is tied and the variance is 0.
+double
+mannWhitney (const std::vector<double>& baseline,
+	     const std::vector<double>& candidate, bool larger);
+
+/// \brief Compares one benchmark's samples from two runs.
+/// \param[in] baseline The samples from the earlier run.
+/// \param[in] candidate The samples from the later run.
+/// \param[in] threshold The smallest change, as a fraction, that counts.
+/// \param[in] alpha The p-value below which a change is significant.
+/// \return The comparison.  It regressed or improved only if its median
+///   changed by more than the larger of threshold and NOISE_MULTIPLIER
+///   times either run's relative spread, and p is below alpha.
+SampleComparison
+compareSamples (const std::vector<double>& baseline,
+		const std::vector<double>& candidate, double threshold,
+		double alpha);
+
+/// \brief Gets the word BenchCompare prints for a verdict.
+/// \param[in] verdict The verdict.
+/// \return Its name.
+const char*
+getVerdictName (SampleComparison::Verdict verdict);
+
+#endif//BENCH_STATS_HPP
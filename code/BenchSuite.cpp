@@ -0,0 +1,331 @@
+/// \file BenchSuite.cpp
+/// \brief Times the math, geometry and model loading code that the rest of
+///   the program is built on.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// Vector, matrix and Transform operations are timed per call, cycling
+///   through arrays of random operands.  indexData, computeFaceNormals,
+///   computeVertexNormals and loading an OBJ file through NormalsMesh are
+///   timed on bumpy grids of several sizes, so how their cost grows can be
+///   seen.  Models are loaded through a NullOpenGLContext, so only the CPU
+///   side is timed.  Results are printed as they finish and can be written
+///   as JSON for BenchCompare.  Build and run with "make bench", or run
+///   BenchSuite.out with "--json FILE", "--samples N", "--sample-ms MS",
+///   "--filter TEXT" and "--threads N".
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "Geometry.hpp"
+#include "JobSystem.hpp"
+#include "Matrix3.hpp"
+#include "Matrix4.hpp"
+#include "NormalsMesh.hpp"
+#include "NullOpenGLContext.hpp"
+#include "Transform.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+namespace
+{
+  // The number of operands cycled through, a power of two so that the next
+  //   index is a mask.
+  const size_t OPERANDS = 1024;
+  const size_t OPERAND_MASK = OPERANDS - 1;
+  // Triangles in the meshes that geometry is timed on.  Every vertex is
+  //   compared with every other, so these stay small.
+  const size_t GEOMETRY_SIZES[] = { 128, 512, 2048 };
+  // Triangles in the OBJ files that are loaded.
+  const size_t MODEL_SIZES[] = { 2048, 32768, 131072 };
+
+  // A grid of triangles in the XZ plane, with heights that vary so that no
+  //   two neighbouring faces have the same normal.  Neighbouring triangles
+  //   share vertices exactly, as in a real model.
+  std::vector<Triangle>
+  buildGrid (size_t triangles, std::vector<Vector3>& points, size_t& columns)
+  {
+    columns = static_cast<size_t> (std::ceil (std::sqrt (triangles / 2.0)));
+    size_t rows = (triangles / 2 + columns - 1) / columns;
+    points.clear ();
+    for (size_t z = 0; z <= rows; ++z)
+      for (size_t x = 0; x <= columns; ++x)
+	points.push_back (Vector3 (x, 0.25f * std::sin (0.7f * x) * std::cos (0.9f * z), z));
+    std::vector<Triangle> faces;
+    for (size_t quad = 0; faces.size () < triangles; ++quad)
+    {
+      size_t x = quad % columns, z = quad / columns;
+      size_t corner = z * (columns + 1) + x;
+      const Vector3& a = points[corner];
+      const Vector3& b = points[corner + 1];
+      const Vector3& c = points[corner + columns + 1];
+      const Vector3& d = points[corner + columns + 2];
+      faces.push_back (Triangle { { a, c, b } });
+      if (faces.size () < triangles)
+	faces.push_back (Triangle { { b, c, d } });
+    }
+    return faces;
+  }
+
+  // Writes the same grid as an OBJ file.
+  bool
+  writeGridObj (const std::string& fileName, size_t triangles)
+  {
+    std::vector<Vector3> points;
+    size_t columns;
+    buildGrid (triangles, points, columns);
+    FILE* out = fopen (fileName.c_str (), "w");
+    if (out == nullptr)
+      return false;
+    for (const Vector3& p : points)
+      fprintf (out, "v %f %f %f\n", p.m_x, p.m_y, p.m_z);
+    for (size_t quad = 0, written = 0; written < triangles; ++quad)
+    {
+      // OBJ indices start at 1.
+      size_t corner = (quad / columns) * (columns + 1) + quad % columns + 1;
+      fprintf (out, "f %zu %zu %zu\n", corner, corner + columns + 1, corner + 1);
+      if (++written < triangles)
+      {
+	fprintf (out, "f %zu %zu %zu\n", corner + 1, corner + columns + 1,
+		 corner + columns + 2);
+	++written;
+      }
+    }
+    return fclose (out) == 0;
+  }
+
+  void
+  benchVectors (BenchmarkSuite& suite, const std::vector<Vector3>& vectors)
+  {
+    size_t i = 0;
+    suite.run ("Vector3 + Vector3", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (vectors[i] + vectors[(i + 1) & OPERAND_MASK]);
+      });
+    suite.run ("Vector3 * float", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (vectors[i] * 1.5f);
+      });
+    suite.run ("Vector3::dot", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (vectors[i].dot (vectors[(i + 1) & OPERAND_MASK]));
+      });
+    suite.run ("Vector3::cross", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (vectors[i].cross (vectors[(i + 1) & OPERAND_MASK]));
+      });
+    suite.run ("Vector3::length", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (vectors[i].length ());
+      });
+    suite.run ("Vector3::normalize", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	Vector3 v = vectors[i];
+	v.normalize ();
+	doNotOptimize (v);
+      });
+  }
+
+  void
+  benchMatrices (BenchmarkSuite& suite, const std::vector<Matrix3>& matrices3,
+		 const std::vector<Vector3>& vectors3,
+		 const std::vector<Matrix4>& matrices4,
+		 const std::vector<Vector4>& vectors4)
+  {
+    size_t i = 0;
+    suite.run ("Matrix3 * Matrix3", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (matrices3[i] * matrices3[(i + 1) & OPERAND_MASK]);
+      });
+    suite.run ("Matrix3 * Vector3", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (matrices3[i] * vectors3[i]);
+      });
+    suite.run ("Matrix3::invert", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	Matrix3 m = matrices3[i];
+	m.invert ();
+	doNotOptimize (m);
+      });
+    suite.run ("Matrix4 * Matrix4", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (matrices4[i] * matrices4[(i + 1) & OPERAND_MASK]);
+      });
+    suite.run ("Matrix4 * Vector4", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (matrices4[i] * vectors4[i]);
+      });
+  }
+
+  void
+  benchTransforms (BenchmarkSuite& suite, const std::vector<Transform>& transforms)
+  {
+    size_t i = 0;
+    suite.run ("Transform::combine", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	Transform t = transforms[i];
+	t.combine (transforms[(i + 1) & OPERAND_MASK]);
+	doNotOptimize (t);
+      });
+    suite.run ("Transform * Transform", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	doNotOptimize (transforms[i] * transforms[(i + 1) & OPERAND_MASK]);
+      });
+    suite.run ("Transform::invertRt", 0, [&] ()
+      {
+	i = (i + 1) & OPERAND_MASK;
+	Transform t = transforms[i];
+	t.invertRt ();
+	doNotOptimize (t);
+      });
+  }
+
+  void
+  benchGeometry (BenchmarkSuite& suite)
+  {
+    for (size_t size : GEOMETRY_SIZES)
+    {
+      std::vector<Vector3> points;
+      size_t columns;
+      std::vector<Triangle> faces = buildGrid (size, points, columns);
+      std::vector<Vector3> faceNormals = computeFaceNormals (faces);
+      std::vector<Vector3> vertexNormals = computeVertexNormals (faces, faceNormals);
+      std::vector<float> geometry = dataWithVertexNormals (faces, vertexNormals);
+      suite.run ("computeFaceNormals", size, [&] ()
+	{ doNotOptimize (computeFaceNormals (faces).data ()); });
+      suite.run ("computeVertexNormals", size, [&] ()
+	{ doNotOptimize (computeVertexNormals (faces, faceNormals).data ()); });
+      suite.run ("indexData", size, [&] ()
+	{
+	  std::vector<float> data;
+	  std::vector<unsigned int> indices;
+	  indexData (geometry, 6, data, indices);
+	  doNotOptimize (data.data ());
+	  doNotOptimize (indices.data ());
+	});
+    }
+  }
+
+  void
+  benchModels (BenchmarkSuite& suite)
+  {
+    NullOpenGLContext context;
+    for (size_t size : MODEL_SIZES)
+    {
+      std::string fileName = "BenchSuite_grid_" + std::to_string (size) + ".obj";
+      if (!writeGridObj (fileName, size))
+      {
+	fprintf (stderr, "Failed to write %s\n", fileName.c_str ());
+	exit (-1);
+      }
+      suite.run ("NormalsMesh load OBJ", size, [&] ()
+	{
+	  NormalsMesh mesh (&context, nullptr, fileName, 0);
+	  clobberMemory ();
+	});
+      remove (fileName.c_str ());
+    }
+  }
+}
+
+/// \brief Runs the benchmarks.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line arguments.  "--json FILE"
+///   writes every result to FILE ("-" for standard output, which moves the
+///   progress lines to standard error).  "--samples N" keeps N samples of
+///   each benchmark and "--sample-ms MS" makes each last at least MS
+///   milliseconds.  "--filter TEXT" only runs benchmarks whose names
+///   contain TEXT.  "--threads N" runs the parallel geometry functions on N
+///   threads.
+int
+main (int argc, char* argv[])
+{
+  std::string jsonFileName;
+  std::string filter;
+  unsigned int samples = BenchmarkSuite::DEFAULT_SAMPLES;
+  double sampleTime = BenchmarkSuite::DEFAULT_SAMPLE_TIME;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg (argv[i]);
+    if (arg == "--json" && i + 1 < argc)
+      jsonFileName = argv[++i];
+    else if (arg == "--samples" && i + 1 < argc)
+      samples = std::stoul (argv[++i]);
+    else if (arg == "--sample-ms" && i + 1 < argc)
+      sampleTime = std::stod (argv[++i]);
+    else if (arg == "--filter" && i + 1 < argc)
+      filter = argv[++i];
+    else if (arg == "--threads" && i + 1 < argc)
+      JobSystem::resetGlobal (std::stoi (argv[++i]));
+    else
+    {
+      fprintf (stderr, "Usage: %s [--json FILE] [--samples N] [--sample-ms MS]"
+	       " [--filter TEXT] [--threads N]\n", argv[0]);
+      exit (-1);
+    }
+  }
+
+  BenchmarkSuite suite (samples, sampleTime);
+  suite.setFilter (filter);
+  FILE* progress = (jsonFileName == "-") ? stderr : stdout;
+  suite.setProgressStream (progress);
+  fprintf (progress, "%-32s %8s %14s %14s %9s\n", "benchmark", "size",
+	   "median_ns", "min_ns", "stddev%");
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<float> distribution (-1.0f, 1.0f);
+  auto random = [&] () { return distribution (generator); };
+  std::vector<Vector3> vectors3;
+  std::vector<Matrix3> matrices3;
+  std::vector<Vector4> vectors4;
+  std::vector<Matrix4> matrices4;
+  std::vector<Transform> transforms;
+  for (size_t i = 0; i < OPERANDS; ++i)
+  {
+    vectors3.push_back (Vector3 (random (), random (), random ()));
+    // Diagonally dominant, so that every one can be inverted.
+    matrices3.push_back (Matrix3 (4 + random (), random (), random (),
+				  random (), 4 + random (), random (),
+				  random (), random (), 4 + random ()));
+    vectors4.push_back (Vector4 (random (), random (), random (), random ()));
+    matrices4.push_back (Matrix4 (Vector4 (random (), random (), random (), random ()),
+				  Vector4 (random (), random (), random (), random ()),
+				  Vector4 (random (), random (), random (), random ()),
+				  Vector4 (random (), random (), random (), random ())));
+    Transform t;
+    t.rotateLocal (180 * random (), Vector3 (random (), random (), random () + 2));
+    t.setPosition (vectors3.back () * 10);
+    transforms.push_back (t);
+  }
+
+  benchVectors (suite, vectors3);
+  benchMatrices (suite, matrices3, vectors3, matrices4, vectors4);
+  benchTransforms (suite, transforms);
+  benchGeometry (suite);
+  benchModels (suite);
+
+  if (!jsonFileName.empty () && !suite.writeJson (jsonFileName))
+  {
+    fprintf (stderr, "Failed to write %s\n", jsonFileName.c_str ());
+    exit (-1);
+  }
+  return EXIT_SUCCESS;
+}
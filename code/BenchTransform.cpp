@@ -0,0 +1,142 @@
+/// \file BenchTransform.cpp
+/// \brief Compares rotating Transforms through their matrices with rotating
+///   them through quaternions.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// Two things are measured for both kinds of Transform.  Throughput is how
+///   fast many Transforms can be pitched and yawed every frame, both when
+///   every one is drawn (so the matrix is needed every frame) and when few
+///   are.  Drift is how far a single Transform has strayed from a rotation,
+///   and from the angle it should be at, after a million small yaws.  Build
+///   with "make BenchTransform.out" and run with an optional number of
+///   Transforms.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Matrix3.hpp"
+#include "Transform.hpp"
+
+namespace
+{
+  const int TIMED_FRAMES = 200;
+  const int DRIFT_STEPS = 1000000;
+
+  double
+  millisecondsSince (std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>
+      (std::chrono::steady_clock::now () - start).count ();
+  }
+
+  // Milliseconds per frame to rotate every Transform, fetching the 4x4
+  //   matrix of every drawEvery'th one.
+  double
+  timeRotations (std::vector<Transform>& transforms, unsigned int drawEvery)
+  {
+    float matrix[16];
+    float sum = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (int frame = 0; frame < TIMED_FRAMES; ++frame)
+    {
+      for (size_t i = 0; i < transforms.size (); ++i)
+      {
+	transforms[i].yaw (1.0f);
+	transforms[i].pitch (0.5f);
+	if (i % drawEvery == 0)
+	{
+	  transforms[i].getTransform (matrix);
+	  sum += matrix[0];
+	}
+      }
+    }
+    double time = millisecondsSince (start) / TIMED_FRAMES;
+    // Keeps the matrices from being optimized away.
+    if (sum == 12345.0f)
+      printf (" ");
+    return time;
+  }
+
+  // The largest amount by which the basis vectors are not unit length and
+  //   perpendicular.
+  float
+  orthonormalityError (const Matrix3& m)
+  {
+    Vector3 r = m.getRight (), u = m.getUp (), b = m.getBack ();
+    float error = std::max ({ std::fabs (r.dot (r) - 1), std::fabs (u.dot (u) - 1),
+			      std::fabs (b.dot (b) - 1), std::fabs (r.dot (u)),
+			      std::fabs (r.dot (b)), std::fabs (u.dot (b)) });
+    return error;
+  }
+
+  // The largest difference between corresponding elements.
+  float
+  maxDifference (const Matrix3& m1, const Matrix3& m2)
+  {
+    Vector3 d[3] = { m1.getRight () - m2.getRight (), m1.getUp () - m2.getUp (),
+		     m1.getBack () - m2.getBack () };
+    float difference = 0;
+    for (const Vector3& v : d)
+      difference = std::max ({ difference, std::fabs (v.m_x), std::fabs (v.m_y),
+			       std::fabs (v.m_z) });
+    return difference;
+  }
+
+  void
+  printDrift (const char* name, const Transform& t, const Matrix3& expected)
+  {
+    printf ("%-10s  %18.3e  %15.3e\n", name, orthonormalityError (t.getOrientation ()),
+	    maxDifference (t.getOrientation (), expected));
+  }
+}
+
+/// \brief Runs the benchmark.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line arguments.  The first, if
+///   present, is the number of Transforms to rotate.
+int
+main (int argc, char* argv[])
+{
+  unsigned int numTransforms = (argc > 1) ? std::stoi (argv[1]) : 10000;
+
+  std::vector<Transform> matrices (numTransforms);
+  std::vector<Transform> quaternions (numTransforms);
+  for (Transform& t : quaternions)
+    t.decompose ();
+
+  printf ("%u transforms, yaw + pitch per frame, %d frames\n", numTransforms,
+	  TIMED_FRAMES);
+  printf ("drawn       matrix_ms  quaternion_ms  speedup\n");
+  for (unsigned int drawEvery : { 1u, 10u, 100u })
+  {
+    double matrixTime = timeRotations (matrices, drawEvery);
+    double quaternionTime = timeRotations (quaternions, drawEvery);
+    std::string drawn = "1/" + std::to_string (drawEvery);
+    printf ("%-10s  %9.3f  %13.3f  %7.2f\n", drawn.c_str (), matrixTime,
+	    quaternionTime, matrixTime / quaternionTime);
+  }
+
+  // A million 1 degree yaws leave the Transform yawed 1000000 mod 360 = 280
+  //   degrees.
+  Transform matrix;
+  Transform quaternion;
+  quaternion.decompose ();
+  for (int step = 0; step < DRIFT_STEPS; ++step)
+  {
+    matrix.yaw (1.0f);
+    quaternion.yaw (1.0f);
+  }
+  Matrix3 expected;
+  expected.setToRotationY (DRIFT_STEPS % 360);
+  printf ("\n%d yaws of 1 degree\n", DRIFT_STEPS);
+  printf ("path        orthonormal_error  angle_error\n");
+  printDrift ("matrix", matrix, expected);
+  printDrift ("quaternion", quaternion, expected);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+/// \file Benchmark.cpp
+/// \brief Definitions of BenchmarkSuite class member functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cmath>
+
+#include "Benchmark.hpp"
+
+namespace
+{
+  // The most iterations a sample may time, so that an operation the
+  //   compiler removed entirely cannot make calibration run forever.
+  const unsigned long MAX_ITERATIONS = 1ul << 32;
+
+  // Summary statistics of one benchmark's samples.
+  struct Summary
+  {
+    double min;
+    double median;
+    double mean;
+    double stddev;
+  };
+
+  Summary
+  summarize (const std::vector<double>& samples)
+  {
+    std::vector<double> sorted (samples);
+    std::sort (sorted.begin (), sorted.end ());
+    Summary summary = Summary ();
+    if (sorted.empty ())
+      return summary;
+    size_t middle = sorted.size () / 2;
+    summary.min = sorted.front ();
+    summary.median = (sorted.size () % 2 == 1) ? sorted[middle]
+      : (sorted[middle - 1] + sorted[middle]) / 2;
+    for (double sample : sorted)
+      summary.mean += sample;
+    summary.mean /= sorted.size ();
+    for (double sample : sorted)
+      summary.stddev += (sample - summary.mean) * (sample - summary.mean);
+    if (sorted.size () > 1)
+      summary.stddev = std::sqrt (summary.stddev / (sorted.size () - 1));
+    return summary;
+  }
+
+  // Writes a string as a JSON string literal.
+  void
+  writeString (FILE* out, const std::string& text)
+  {
+    fputc ('"', out);
+    for (char c : text)
+    {
+      if (c == '"' || c == '\\')
+	fputc ('\\', out);
+      fputc (c, out);
+    }
+    fputc ('"', out);
+  }
+}
+
+BenchmarkSuite::BenchmarkSuite (unsigned int samples, double sampleTime)
+  : m_samples (std::max (samples, 2u)), m_sampleTime (sampleTime),
+    m_filter (), m_progress (stdout)
+{
+}
+
+void
+BenchmarkSuite::setFilter (const std::string& filter)
+{
+  m_filter = filter;
+}
+
+void
+BenchmarkSuite::setProgressStream (FILE* out)
+{
+  m_progress = out;
+}
+
+const std::vector<BenchmarkSuite::Result>&
+BenchmarkSuite::getResults () const
+{
+  return m_results;
+}
+
+bool
+BenchmarkSuite::writeJson (const std::string& fileName) const
+{
+  bool toStdout = fileName == "-";
+  FILE* out = toStdout ? stdout : fopen (fileName.c_str (), "w");
+  if (out == nullptr)
+    return false;
+  fprintf (out, "{\n  \"unit\": \"ns\",\n  \"samples\": %u,\n"
+	   "  \"warmup_samples\": %u,\n  \"sample_ms\": %.1f,\n"
+	   "  \"benchmarks\": [", m_samples, WARMUP_SAMPLES, m_sampleTime);
+  for (size_t i = 0; i < m_results.size (); ++i)
+  {
+    const Result& result = m_results[i];
+    Summary summary = summarize (result.samples);
+    // One benchmark per line, so that runs can be compared with diff.
+    fprintf (out, "%s\n    {\"name\": ", (i == 0) ? "" : ",");
+    writeString (out, result.name);
+    fprintf (out, ", \"size\": %zu, \"iterations\": %lu, \"min\": %.3f,"
+	     " \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"samples\": [",
+	     result.size, result.iterations, summary.min, summary.median,
+	     summary.mean, summary.stddev);
+    for (size_t s = 0; s < result.samples.size (); ++s)
+      fprintf (out, "%s%.3f", (s == 0) ? "" : ", ", result.samples[s]);
+    fprintf (out, "]}");
+  }
+  fprintf (out, "\n  ]\n}\n");
+  if (toStdout)
+    return fflush (out) == 0;
+  return fclose (out) == 0;
+}
+
+bool
+BenchmarkSuite::matches (const std::string& name) const
+{
+  return m_filter.empty () || name.find (m_filter) != std::string::npos;
+}
+
+void
+BenchmarkSuite::measure (const std::string& name, size_t size,
+			 const std::function<double (unsigned long)>& timeIterations)
+{
+  // Finds how many iterations fill a sample, aiming a little past the
+  //   minimum so that noise does not leave samples just short of it.
+  double sampleNanoseconds = m_sampleTime * 1.0e6;
+  unsigned long iterations = 1;
+  for (double time = timeIterations (iterations);
+       time < sampleNanoseconds && iterations < MAX_ITERATIONS;
+       time = timeIterations (iterations))
+  {
+    double scale = (time <= 0.0) ? 10.0 : 1.2 * sampleNanoseconds / time;
+    scale = std::min (std::max (scale, 2.0), 10.0);
+    iterations = static_cast<unsigned long> (iterations * scale);
+  }
+
+  for (unsigned int i = 0; i < WARMUP_SAMPLES; ++i)
+    timeIterations (iterations);
+  Result result;
+  result.name = name;
+  result.size = size;
+  result.iterations = iterations;
+  for (unsigned int i = 0; i < m_samples; ++i)
+    result.samples.push_back (timeIterations (iterations) / iterations);
+  m_results.push_back (result);
+
+  if (m_progress != nullptr)
+  {
+    Summary summary = summarize (result.samples);
+    fprintf (m_progress, "%-32s %8zu %14.2f %14.2f %8.1f%%\n", name.c_str (), size,
+	     summary.median, summary.min,
+	     (summary.mean > 0.0) ? 100.0 * summary.stddev / summary.mean : 0.0);
+    fflush (m_progress);
+  }
+}
@@ -0,0 +1,135 @@
+/// \file Benchmark.hpp
+/// \brief Declaration of BenchmarkSuite class and the barriers that keep
+///   timed code from being optimized away.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// \brief Makes the compiler believe that a value is read, so the code that
+///   computed it cannot be removed, without generating any instructions.
+/// \param[in] value The value.
+template<typename T>
+inline void
+doNotOptimize (const T& value)
+{
+  asm volatile ("" : : "r,m" (value) : "memory");
+}
+
+/// \brief Makes the compiler believe that all memory is read and written,
+///   so stores before it cannot be removed and loads after it cannot be
+///   hoisted out of a loop.
+inline void
+clobberMemory ()
+{
+  asm volatile ("" : : : "memory");
+}
+
+/// \brief Times small operations repeatedly and keeps statistics of how long
+///   one call takes, to be printed or written as JSON.
+///
+/// Each benchmark is first run with more and more iterations until one
+///   sample takes at least the minimum sample time, which also warms caches
+///   and branch predictors.  A few more samples are then thrown away before
+///   the ones that are kept are taken, each timing that many iterations.
+class BenchmarkSuite
+{
+public:
+
+  /// The number of samples kept of each benchmark by default.
+  static const unsigned int DEFAULT_SAMPLES = 15;
+  /// The number of samples taken and thrown away first.
+  static const unsigned int WARMUP_SAMPLES = 3;
+  /// The shortest time one sample takes by default, in milliseconds.
+  static constexpr double DEFAULT_SAMPLE_TIME = 20.0;
+
+  /// \brief The result of one benchmark.
+  struct Result
+  {
+    std::string name;
+    /// The size of the input, such as a number of triangles, or 0.
+    size_t size;
+    /// The number of calls each sample timed.
+    unsigned long iterations;
+    /// Nanoseconds per call, in the order the samples were taken.
+    std::vector<double> samples;
+  };
+
+  /// \brief Constructs a BenchmarkSuite with no results.
+  /// \param[in] samples The number of samples to keep of each benchmark.
+  /// \param[in] sampleTime The shortest time a sample may take, in
+  ///   milliseconds.
+  BenchmarkSuite (unsigned int samples = DEFAULT_SAMPLES,
+		  double sampleTime = DEFAULT_SAMPLE_TIME);
+
+  /// \brief Restricts which benchmarks are run.
+  /// \param[in] filter Text that the names of benchmarks to run contain, or
+  ///   "" to run all of them.
+  void
+  setFilter (const std::string& filter);
+
+  /// \brief Times an operation, if its name passes the filter.
+  /// \param[in] name What is being timed.
+  /// \param[in] size The size of the input, or 0 if it has none.
+  /// \param[in] operation The operation, which is called many times.  Its
+  ///   results should go through doNotOptimize.
+  /// \post Its Result has been added and printed to the progress stream.
+  template<typename Operation>
+  void
+  run (const std::string& name, size_t size, Operation operation)
+  {
+    if (!matches (name))
+      return;
+    measure (name, size, [&operation] (unsigned long iterations)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      for (unsigned long i = 0; i < iterations; ++i)
+	operation ();
+      clobberMemory ();
+      return std::chrono::duration<double, std::nano>
+	(std::chrono::steady_clock::now () - start).count ();
+    });
+  }
+
+  /// \brief Sets where a line is printed as each benchmark finishes.
+  /// \param[in] out The stream, or nullptr to print nothing.
+  void
+  setProgressStream (FILE* out);
+
+  /// \brief Gets the results of every benchmark run so far.
+  /// \return The results, in the order they were run.
+  const std::vector<Result>&
+  getResults () const;
+
+  /// \brief Writes every result, with all of its samples, as JSON.
+  /// \param[in] fileName The name of the file to create, or "-" for
+  ///   standard output.
+  /// \return Whether or not the file could be written.
+  bool
+  writeJson (const std::string& fileName) const;
+
+private:
+
+  bool
+  matches (const std::string& name) const;
+
+  void
+  measure (const std::string& name, size_t size,
+	   const std::function<double (unsigned long)>& timeIterations);
+
+  unsigned int m_samples;
+  double m_sampleTime;
+  std::string m_filter;
+  FILE* m_progress;
+  std::vector<Result> m_results;
+};
+
+#endif//BENCHMARK_HPP
@@ -0,0 +1,289 @@
+/// \file BufferArena.cpp
+/// \brief Definitions of BufferArena class member functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BufferArena.hpp"
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+  // Allocates a range, or nothing if none is needed.
+  bool
+  allocateRange (FreeListAllocator& allocator, size_t size, size_t& offset)
+  {
+    offset = 0;
+    return size == 0 || allocator.allocate (size, offset);
+  }
+
+  // Doubles a capacity until it has room for more units.
+  size_t
+  grownCapacity (const FreeListAllocator& allocator, size_t needed)
+  {
+    size_t used = allocator.getCapacity () - allocator.getFreeSize ();
+    size_t capacity = std::max<size_t> (allocator.getCapacity (), 1);
+    while (capacity - used < needed)
+      capacity *= 2;
+    return capacity;
+  }
+}
+
+BufferArena::BufferArena (OpenGLContext* context,
+			  const std::vector<VertexAttribute>& attributes,
+			  unsigned int floatsPerVertex, size_t vertexCapacity,
+			  size_t indexCapacity)
+  : m_context (context), m_floatsPerVertex (floatsPerVertex),
+    m_vertices (vertexCapacity), m_indices (indexCapacity), m_compactions (0)
+{
+  m_context->genVertexArrays (1, &m_vao);
+  m_context->genBuffers (1, &m_vbo);
+  m_context->genBuffers (1, &m_ibo);
+  GLsizei stride = m_floatsPerVertex * sizeof(float);
+  // Storage is filled through the copy targets, which are not part of any
+  //   VAO's state.
+  m_context->bindBuffer (GL_COPY_WRITE_BUFFER, m_vbo);
+  m_context->bufferData (GL_COPY_WRITE_BUFFER, vertexCapacity * stride, nullptr,
+			 GL_STATIC_DRAW);
+  m_context->bindBuffer (GL_COPY_WRITE_BUFFER, m_ibo);
+  m_context->bufferData (GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(unsigned int),
+			 nullptr, GL_STATIC_DRAW);
+
+  m_context->bindVertexArray (m_vao);
+  m_context->bindBuffer (GL_ARRAY_BUFFER, m_vbo);
+  for (const VertexAttribute& attribute : attributes)
+  {
+    m_context->enableVertexAttribArray (attribute.index);
+    m_context->vertexAttribPointer (attribute.index, attribute.size, GL_FLOAT,
+				    GL_FALSE, stride,
+				    reinterpret_cast<void*> (attribute.offset * sizeof(float)));
+  }
+  m_context->bindBuffer (GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+  m_context->bindVertexArray (0);
+  reportMemory ();
+}
+
+BufferArena::~BufferArena ()
+{
+  m_context->deleteVertexArrays (1, &m_vao);
+  m_context->deleteBuffers (1, &m_vbo);
+  m_context->deleteBuffers (1, &m_ibo);
+  MemoryTracker::getGlobal ().remove (this);
+}
+
+unsigned int
+BufferArena::allocate (const std::vector<float>& geometry,
+		       const std::vector<unsigned int>& indices)
+{
+  size_t vertexCount = geometry.size () / m_floatsPerVertex;
+  size_t indexCount = indices.size ();
+  size_t vertexOffset, indexOffset;
+  bool placed = allocateRange (m_vertices, vertexCount, vertexOffset);
+  if (placed && !allocateRange (m_indices, indexCount, indexOffset))
+  {
+    if (vertexCount > 0)
+      m_vertices.free (vertexOffset, vertexCount);
+    placed = false;
+  }
+  if (!placed)
+  {
+    // Packing joins the free space into one range at the end, and growing
+    //   makes that range large enough.
+    relocate (grownCapacity (m_vertices, vertexCount),
+	      grownCapacity (m_indices, indexCount));
+    if (!allocateRange (m_vertices, vertexCount, vertexOffset)
+	|| !allocateRange (m_indices, indexCount, indexOffset))
+    {
+      fprintf (stderr, "BufferArena could not fit %zu vertices and %zu"
+	       " indices\n", vertexCount, indexCount);
+      exit (-1);
+    }
+  }
+
+  GLsizei stride = m_floatsPerVertex * sizeof(float);
+  if (vertexCount > 0)
+  {
+    m_context->bindBuffer (GL_COPY_WRITE_BUFFER, m_vbo);
+    m_context->bufferSubData (GL_COPY_WRITE_BUFFER, vertexOffset * stride,
+			      vertexCount * stride, geometry.data ());
+  }
+  if (indexCount > 0)
+  {
+    m_context->bindBuffer (GL_COPY_WRITE_BUFFER, m_ibo);
+    m_context->bufferSubData (GL_COPY_WRITE_BUFFER,
+			      indexOffset * sizeof(unsigned int),
+			      indexCount * sizeof(unsigned int), indices.data ());
+  }
+
+  Slot slot;
+  slot.range.baseVertex = vertexOffset;
+  slot.range.vertexCount = vertexCount;
+  slot.range.firstIndex = indexOffset;
+  slot.range.indexCount = indexCount;
+  slot.used = true;
+  unsigned int id;
+  if (m_freeSlots.empty ())
+  {
+    id = m_slots.size ();
+    m_slots.push_back (slot);
+  }
+  else
+  {
+    id = m_freeSlots.back ();
+    m_freeSlots.pop_back ();
+    m_slots[id] = slot;
+  }
+  reportMemory ();
+  return id;
+}
+
+void
+BufferArena::free (unsigned int id)
+{
+  Slot& slot = m_slots[id];
+  if (!slot.used)
+    return;
+  if (slot.range.vertexCount > 0)
+    m_vertices.free (slot.range.baseVertex, slot.range.vertexCount);
+  if (slot.range.indexCount > 0)
+    m_indices.free (slot.range.firstIndex, slot.range.indexCount);
+  slot.used = false;
+  m_freeSlots.push_back (id);
+  reportMemory ();
+}
+
+const ArenaRange&
+BufferArena::getRange (unsigned int id) const
+{
+  return m_slots[id].range;
+}
+
+void
+BufferArena::compact ()
+{
+  relocate (m_vertices.getCapacity (), m_indices.getCapacity ());
+}
+
+GLuint
+BufferArena::getVertexArray () const
+{
+  return m_vao;
+}
+
+unsigned int
+BufferArena::getFloatsPerVertex () const
+{
+  return m_floatsPerVertex;
+}
+
+double
+BufferArena::getFragmentation () const
+{
+  size_t free = m_vertices.getFreeSize ();
+  if (free == 0)
+    return 0.0;
+  return 1.0 - static_cast<double> (m_vertices.getLargestFree ()) / free;
+}
+
+unsigned long
+BufferArena::getCompactionCount () const
+{
+  return m_compactions;
+}
+
+size_t
+BufferArena::getVertexCapacity () const
+{
+  return m_vertices.getCapacity ();
+}
+
+size_t
+BufferArena::getIndexCapacity () const
+{
+  return m_indices.getCapacity ();
+}
+
+void
+BufferArena::relocate (size_t vertexCapacity, size_t indexCapacity)
+{
+  PROFILE_SCOPE ("BufferArena::relocate");
+  relocateBuffer (m_vbo, m_floatsPerVertex * sizeof(float), vertexCapacity, true);
+  relocateBuffer (m_ibo, sizeof(unsigned int), indexCapacity, false);
+  // The ranges were packed in slot order.
+  size_t vertexOffset = 0;
+  size_t indexOffset = 0;
+  for (Slot& slot : m_slots)
+  {
+    if (!slot.used)
+      continue;
+    slot.range.baseVertex = vertexOffset;
+    slot.range.firstIndex = indexOffset;
+    vertexOffset += slot.range.vertexCount;
+    indexOffset += slot.range.indexCount;
+  }
+  m_vertices.reset (vertexCapacity, vertexOffset);
+  m_indices.reset (indexCapacity, indexOffset);
+  ++m_compactions;
+  reportMemory ();
+}
+
+void
+BufferArena::relocateBuffer (GLuint buffer, size_t unitBytes, size_t capacity,
+			     bool vertices)
+{
+  size_t used = 0;
+  for (const Slot& slot : m_slots)
+    if (slot.used)
+      used += vertices ? slot.range.vertexCount : slot.range.indexCount;
+
+  // A buffer cannot be copied into itself where the ranges overlap, so the
+  //   used ranges are packed into a scratch buffer first.
+  GLuint scratch = 0;
+  if (used > 0)
+  {
+    m_context->genBuffers (1, &scratch);
+    m_context->bindBuffer (GL_COPY_WRITE_BUFFER, scratch);
+    m_context->bufferData (GL_COPY_WRITE_BUFFER, used * unitBytes, nullptr,
+			   GL_STATIC_COPY);
+    m_context->bindBuffer (GL_COPY_READ_BUFFER, buffer);
+    size_t packed = 0;
+    for (const Slot& slot : m_slots)
+    {
+      if (!slot.used)
+	continue;
+      size_t count = vertices ? slot.range.vertexCount : slot.range.indexCount;
+      size_t offset = vertices ? slot.range.baseVertex : slot.range.firstIndex;
+      if (count > 0)
+	m_context->copyBufferSubData (GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				      offset * unitBytes, packed * unitBytes,
+				      count * unitBytes);
+      packed += count;
+    }
+  }
+
+  // New storage keeps the buffer's name, so the VAO still refers to it.
+  m_context->bindBuffer (GL_COPY_WRITE_BUFFER, buffer);
+  m_context->bufferData (GL_COPY_WRITE_BUFFER, capacity * unitBytes, nullptr,
+			 GL_STATIC_DRAW);
+  if (used > 0)
+  {
+    m_context->bindBuffer (GL_COPY_READ_BUFFER, scratch);
+    m_context->copyBufferSubData (GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+				  used * unitBytes);
+    m_context->deleteBuffers (1, &scratch);
+  }
+}
+
+void
+BufferArena::reportMemory () const
+{
+  MemoryUsage usage;
+  usage.cpuBytes = 0;
+  usage.gpuBytes = m_vertices.getFreeSize () * m_floatsPerVertex * sizeof(float)
+    + m_indices.getFreeSize () * sizeof(unsigned int);
+  MemoryTracker::getGlobal ().setUsage (this, "buffer arena free space", usage);
+}
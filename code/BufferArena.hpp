@@ -0,0 +1,172 @@
+/// \file BufferArena.hpp
+/// \brief Declaration of BufferArena class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef BUFFER_ARENA_HPP
+#define BUFFER_ARENA_HPP
+
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "FreeListAllocator.hpp"
+
+/// \brief One float attribute of a vertex layout.
+struct VertexAttribute
+{
+  /// The attribute's location in shaders.
+  GLuint index;
+  /// The number of floats in it.
+  GLint size;
+  /// The number of floats before it in each vertex.
+  unsigned int offset;
+};
+
+/// \brief Where one Mesh's geometry lives in a BufferArena.
+struct ArenaRange
+{
+  /// The first vertex, which indices are relative to.
+  GLint baseVertex;
+  GLsizei vertexCount;
+  /// The first index in the IBO.
+  GLuint firstIndex;
+  GLsizei indexCount;
+};
+
+/// \brief Holds the static geometry of many Meshes that share a vertex
+///   layout in one VBO and one IBO, behind one VAO.
+///
+/// Ranges of the buffers are handed out by FreeListAllocators.  When no free
+///   range is large enough, every range is packed together, and the buffers
+///   grow if that is still not enough room.  Packing copies between buffers
+///   on the GPU, and the VAO keeps referring to the same VBO and IBO, so
+///   Meshes only need to look up their range again, which they do whenever
+///   they draw.  Indices stay relative to each Mesh's first vertex, so they
+///   are drawn with glDrawElementsBaseVertex.
+///
+/// The VBO and IBO are reported to the MemoryTracker: each Mesh counts its
+///   own ranges and the arena counts the rest.
+class BufferArena
+{
+public:
+
+  /// \brief Constructs a BufferArena.
+  /// \param[in] context The object through which to make OpenGL calls.
+  /// \param[in] attributes The layout of each vertex.
+  /// \param[in] floatsPerVertex The number of floats in each vertex.
+  /// \param[in] vertexCapacity The number of vertices the VBO starts with
+  ///   room for.
+  /// \param[in] indexCapacity The number of indices the IBO starts with room
+  ///   for.
+  /// \post The VBO and IBO have been allocated and the VAO set up.
+  BufferArena (OpenGLContext* context,
+	       const std::vector<VertexAttribute>& attributes,
+	       unsigned int floatsPerVertex, size_t vertexCapacity = 65536,
+	       size_t indexCapacity = 196608);
+
+  /// \brief Destructs a BufferArena, deleting its VAO, VBO and IBO.
+  /// \pre No Mesh still draws from it.
+  ~BufferArena ();
+
+  /// Copy constructor deleted because a BufferArena owns OpenGL objects.
+  BufferArena (const BufferArena&) = delete;
+
+  /// Assignment operator deleted because a BufferArena owns OpenGL objects.
+  BufferArena&
+  operator= (const BufferArena&) = delete;
+
+  /// \brief Copies geometry and indices into free ranges of the buffers.
+  /// \param[in] geometry Interleaved vertices in this arena's layout.
+  /// \param[in] indices Indices of the geometry, counted from its first
+  ///   vertex.
+  /// \return The ID of the new range, to pass to getRange and free.
+  unsigned int
+  allocate (const std::vector<float>& geometry,
+	    const std::vector<unsigned int>& indices);
+
+  /// \brief Frees a range, so that its space can be used again.
+  /// \param[in] id The ID allocate returned.
+  void
+  free (unsigned int id);
+
+  /// \brief Gets where a range's geometry and indices are now.
+  /// \param[in] id The ID allocate returned.
+  /// \return The range, which moves when the arena is packed.
+  const ArenaRange&
+  getRange (unsigned int id) const;
+
+  /// \brief Packs every range together at the start of the buffers.
+  /// \post The free space of each buffer is in one piece at its end.
+  void
+  compact ();
+
+  /// \brief Gets the VAO that every range is drawn with.
+  /// \return The VAO's name.
+  GLuint
+  getVertexArray () const;
+
+  /// \brief Gets the number of floats in each vertex.
+  /// \return The floatsPerVertex given to the constructor.
+  unsigned int
+  getFloatsPerVertex () const;
+
+  /// \brief Gets how much of the free space cannot be used by one large
+  ///   allocation.
+  /// \return 0 if the free vertices are in one piece, and closer to 1 the
+  ///   more pieces they are in.
+  double
+  getFragmentation () const;
+
+  /// \brief Gets the number of times the buffers have been packed.
+  /// \return The number of packings, including those for growing.
+  unsigned long
+  getCompactionCount () const;
+
+  /// \brief Gets the number of vertices the VBO has room for.
+  /// \return The VBO's capacity.
+  size_t
+  getVertexCapacity () const;
+
+  /// \brief Gets the number of indices the IBO has room for.
+  /// \return The IBO's capacity.
+  size_t
+  getIndexCapacity () const;
+
+private:
+
+  /// A range and whether it is in use.
+  struct Slot
+  {
+    ArenaRange range;
+    bool used;
+  };
+
+  /// \brief Packs every range together into buffers of new capacities.
+  void
+  relocate (size_t vertexCapacity, size_t indexCapacity);
+
+  /// \brief Copies the used parts of a buffer, packed together, into new
+  ///   storage of a given size.
+  void
+  relocateBuffer (GLuint buffer, size_t unitBytes, size_t capacity,
+		  bool vertices);
+
+  /// \brief Tells the MemoryTracker how much of the buffers is free.
+  void
+  reportMemory () const;
+
+  OpenGLContext* m_context;
+  GLuint m_vao;
+  GLuint m_vbo;
+  GLuint m_ibo;
+  unsigned int m_floatsPerVertex;
+  FreeListAllocator m_vertices;
+  FreeListAllocator m_indices;
+  std::vector<Slot> m_slots;
+  /// Slots that are not used, to be handed out again.
+  std::vector<unsigned int> m_freeSlots;
+  unsigned long m_compactions;
+};
+
+#endif//BUFFER_ARENA_HPP
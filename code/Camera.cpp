@@ -37,7 +37,9 @@
       m_world(Matrix3(Vector3(0, 1.0f, 0), localBackDirection, true), Vector3(eyePosition)),
       m_starting_world(Matrix3(Vector3(0, 1.0f, 0), localBackDirection, true), Vector3(eyePosition)),
       m_update(false),
-      m_viewMatrix(m_world)
+      m_viewMatrix(m_world),
+      m_derivedUpdate(true),
+      m_inverseView(m_world)
     {
       m_viewMatrix.invertRt();
       m_projectionMatrix.setToPerspectiveProjection(verticalFieldOfViewDegrees, aspectRatio, nearClipPlaneDistance, farClipPlaneDistance);
@@ -140,16 +142,38 @@
 
   /// \brief Gets the view matrix, recalculating it only if necessary.
   /// \return A view matrix based on the camera's location and axis vectors.
-  Transform
+  const Transform&
   Camera::getViewMatrix (){
-    if (m_update == false){
-      return m_viewMatrix; 
-    }
-    m_update = false;
-    m_viewMatrix.setOrientation(m_world.getOrientation());
-    m_viewMatrix.setPosition(m_world.getPosition());
-    m_viewMatrix.invertRt();
-    return m_viewMatrix;  
+    update();
+    return m_viewMatrix;
+  };
+
+  /// \brief Gets the inverse of the view matrix, which places the camera in
+  ///   the world, recalculating it only if necessary.
+  /// \return The camera's pose as of the last time the view matrix was
+  ///   recalculated.
+  const Transform&
+  Camera::getInverseViewMatrix (){
+    update();
+    return m_inverseView;
+  };
+
+  /// \brief Gets the projection matrix times the view matrix, recalculating
+  ///   it only if the camera or projection has changed.
+  /// \return The matrix that takes world coordinates to clip coordinates.
+  const Matrix4&
+  Camera::getViewProjectionMatrix (){
+    update();
+    return m_viewProjection;
+  };
+
+  /// \brief Gets the planes of the view frustum, recalculating them only if
+  ///   the camera or projection has changed.
+  /// \return The six normalized planes, in world coordinates.
+  const FrustumPlanes&
+  Camera::getFrustumPlanes (){
+    update();
+    return m_frustumPlanes;
   };
 
   /// \brief Recreates the projection matrix.
@@ -163,6 +187,7 @@
   {
 
     m_projectionMatrix.setToPerspectiveProjection(verticalFovDegrees, aspectRatio, nearZ, farZ);
+    m_derivedUpdate = true;
 
   }; 
 
@@ -171,6 +196,7 @@
 			double nearPlaneZ, double farPlaneZ)
   {
     m_projectionMatrix.setToPerspectiveProjection(left, right, bottom, top, nearPlaneZ, farPlaneZ);
+    m_derivedUpdate = true;
   }
 
   void
@@ -178,12 +204,13 @@
 			double nearPlaneZ, double farPlaneZ)
   {
     m_projectionMatrix.setToOrthographicProjection(left, right, bottom, top, nearPlaneZ, farPlaneZ);
+    m_derivedUpdate = true;
   }
 
   /// \brief Gets the projection matrix.
   /// \return The projection matrix.
-  Matrix4
-  Camera::getProjectionMatrix (){
+  const Matrix4&
+  Camera::getProjectionMatrix () const{
     return m_projectionMatrix;
   };
 
@@ -204,3 +231,20 @@
     //m_camMatrix = m_startingCamMatrix;
   };
 
+  /// \brief Recalculates whichever of the view matrix and the matrices and
+  ///   planes that depend on it are out of date.
+  void
+  Camera::update (){
+    if (m_update){
+      m_update = false;
+      m_inverseView = m_world;
+      m_viewMatrix = m_world;
+      m_viewMatrix.invertRt();
+      m_derivedUpdate = true;
+    }
+    if (m_derivedUpdate){
+      m_derivedUpdate = false;
+      m_viewProjection = m_projectionMatrix * m_viewMatrix.getTransform();
+      extractFrustumPlanes(m_viewProjection, m_frustumPlanes);
+    }
+  };
@@ -12,6 +12,7 @@
 #include "Transform.hpp"
 #include "OpenGLContext.hpp"
 #include "Matrix4.hpp"
+#include "Geometry.hpp"
 
 /// \brief An eye that is viewing the scene.
 class Camera
@@ -80,9 +81,28 @@ public:
 
   /// \brief Gets the view matrix, recalculating it only if necessary.
   /// \return A view matrix based on the camera's location and axis vectors.
-  Transform
+  const Transform&
   getViewMatrix ();
 
+  /// \brief Gets the inverse of the view matrix, which places the camera in
+  ///   the world, recalculating it only if necessary.
+  /// \return The camera's pose as of the last time the view matrix was
+  ///   recalculated.
+  const Transform&
+  getInverseViewMatrix ();
+
+  /// \brief Gets the projection matrix times the view matrix, recalculating
+  ///   it only if the camera or projection has changed.
+  /// \return The matrix that takes world coordinates to clip coordinates.
+  const Matrix4&
+  getViewProjectionMatrix ();
+
+  /// \brief Gets the planes of the view frustum, recalculating them only if
+  ///   the camera or projection has changed.
+  /// \return The six normalized planes, in world coordinates.
+  const FrustumPlanes&
+  getFrustumPlanes ();
+
   /// \brief Recreates the projection matrix.
   /// \param[in] verticalFovDegrees The viewing angle.
   /// \param[in] aspectRatio The width / height.
@@ -102,8 +122,8 @@ public:
 
   /// \brief Gets the projection matrix.
   /// \return The projection matrix.
-  Matrix4
-  getProjectionMatrix ();
+  const Matrix4&
+  getProjectionMatrix () const;
 
   /// \brief Resets the camera to its original pose.
   /// \post The position (eye point) is the same as what had been specified in
@@ -117,6 +137,11 @@ public:
 
 private:
 
+  /// \brief Recalculates whichever of the view matrix and the matrices and
+  ///   planes that depend on it are out of date.
+  void
+  update ();
+
   Transform m_world;
 
   Transform m_starting_world;
@@ -129,6 +154,19 @@ private:
   /// The view matrix.
   Transform m_viewMatrix;
 
+  /// Whether or not the view or projection has changed since
+  ///   m_viewProjection and m_frustumPlanes were calculated.
+  bool m_derivedUpdate;
+
+  /// m_world as of the last time the view matrix was calculated.
+  Transform m_inverseView;
+
+  /// m_projectionMatrix * m_viewMatrix.
+  Matrix4 m_viewProjection;
+
+  /// The planes of m_viewProjection.
+  FrustumPlanes m_frustumPlanes;
+
 };
 
 #endif//CAMERA_HPP
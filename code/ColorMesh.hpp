@@ -3,6 +3,9 @@
 /// \author Aaron Heinbaugh
 /// \version A08
 
+#ifndef COLOR_MESH_HPP
+#define COLOR_MESH_HPP
+
 #include "Mesh.hpp"
 
 class ColorMesh: public Mesh
@@ -18,4 +21,6 @@ class ColorMesh: public Mesh
 
     virtual void
     enableAttributes();
-};
\ No newline at end of file
+};
+
+#endif//COLOR_MESH_HPP
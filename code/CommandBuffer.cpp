@@ -0,0 +1,222 @@
+/// \file CommandBuffer.cpp
+/// \brief Definitions of CommandBuffer class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cstring>
+
+#include "CommandBuffer.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+  // Every record in the arena starts on a multiple of this, so that headers
+  //   can be accessed in place.
+  const size_t ALIGNMENT = 8;
+
+  size_t
+  alignUp (size_t size)
+  {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+}
+
+CommandBuffer::CommandBuffer ()
+  : m_currentPacket (0), m_packetCount (0)
+{
+}
+
+void
+CommandBuffer::clear ()
+{
+  m_arena.clear ();
+  m_currentPacket = 0;
+  m_packetCount = 0;
+}
+
+void
+CommandBuffer::beginPacket (ShaderProgram* program, GLuint vertexArray)
+{
+  m_currentPacket = m_arena.size ();
+  m_arena.resize (m_currentPacket + alignUp (sizeof (PacketHeader)));
+  PacketHeader* packet = currentPacket ();
+  packet->program = program;
+  packet->vertexArray = vertexArray;
+  packet->size = alignUp (sizeof (PacketHeader));
+  packet->uniformCount = 0;
+  packet->arraysMode = GL_TRIANGLES;
+  packet->arraysFirst = 0;
+  packet->arraysCount = 0;
+  packet->elementsMode = GL_TRIANGLES;
+  packet->elementsCount = 0;
+  packet->elementsType = GL_UNSIGNED_INT;
+  packet->elementsOffset = 0;
+  packet->elementsBaseVertex = 0;
+  packet->elementsHaveBaseVertex = false;
+  ++m_packetCount;
+}
+
+void
+CommandBuffer::setUniformMatrix (const std::string& uniform, const Matrix4& value)
+{
+  addUniform (GL_FLOAT_MAT4, uniform, value.data (), 16 * sizeof (float));
+}
+
+void
+CommandBuffer::setUniformVec3 (const std::string& uniform, const Vector3& value)
+{
+  const float values[3] = { value.m_x, value.m_y, value.m_z };
+  addUniform (GL_FLOAT_VEC3, uniform, values, sizeof (values));
+}
+
+void
+CommandBuffer::setUniformFloat (const std::string& uniform, float value)
+{
+  addUniform (GL_FLOAT, uniform, &value, sizeof (value));
+}
+
+void
+CommandBuffer::setUniformInt (const std::string& uniform, int value)
+{
+  addUniform (GL_INT, uniform, &value, sizeof (value));
+}
+
+void
+CommandBuffer::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  PacketHeader* packet = currentPacket ();
+  packet->arraysMode = mode;
+  packet->arraysFirst = first;
+  packet->arraysCount = count;
+}
+
+void
+CommandBuffer::drawElements (GLenum mode, GLsizei count, GLenum type, size_t offset)
+{
+  PacketHeader* packet = currentPacket ();
+  packet->elementsMode = mode;
+  packet->elementsCount = count;
+  packet->elementsType = type;
+  packet->elementsOffset = offset;
+}
+
+void
+CommandBuffer::drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type,
+				       size_t offset, GLint baseVertex)
+{
+  drawElements (mode, count, type, offset);
+  PacketHeader* packet = currentPacket ();
+  packet->elementsBaseVertex = baseVertex;
+  packet->elementsHaveBaseVertex = true;
+}
+
+void
+CommandBuffer::append (const CommandBuffer& other)
+{
+  if (other.m_arena.empty ())
+    return;
+  size_t start = m_arena.size ();
+  m_arena.insert (m_arena.end (), other.m_arena.begin (), other.m_arena.end ());
+  m_currentPacket = start + other.m_currentPacket;
+  m_packetCount += other.m_packetCount;
+}
+
+void
+CommandBuffer::submit (OpenGLContext& context) const
+{
+  PROFILE_SCOPE ("CommandBuffer::submit");
+  size_t offset = 0;
+  while (offset < m_arena.size ())
+  {
+    const PacketHeader* packet
+      = reinterpret_cast<const PacketHeader*> (&m_arena[offset]);
+    ShaderProgram* program = packet->program;
+    context.useProgram (program->getProgramId ());
+
+    size_t uniformOffset = offset + alignUp (sizeof (PacketHeader));
+    for (unsigned int i = 0; i < packet->uniformCount; ++i)
+    {
+      const UniformHeader* uniform
+	= reinterpret_cast<const UniformHeader*> (&m_arena[uniformOffset]);
+      const char* name = reinterpret_cast<const char*> (uniform + 1);
+      size_t valueOffset = alignUp (uniformOffset + sizeof (UniformHeader)
+				    + uniform->nameLength + 1);
+      GLint location = program->getUniformLocation (name);
+      const float* floats = reinterpret_cast<const float*> (&m_arena[valueOffset]);
+      size_t valueSize = 0;
+      switch (uniform->type)
+      {
+      case GL_FLOAT_MAT4:
+	context.uniformMatrix4fv (location, 1, GL_FALSE, floats);
+	valueSize = 16 * sizeof (float);
+	break;
+      case GL_FLOAT_VEC3:
+	context.uniform3fv (location, 1, floats);
+	valueSize = 3 * sizeof (float);
+	break;
+      case GL_FLOAT:
+	context.uniform1f (location, *floats);
+	valueSize = sizeof (float);
+	break;
+      case GL_INT:
+	context.uniform1i (location, *reinterpret_cast<const GLint*> (floats));
+	valueSize = sizeof (GLint);
+	break;
+      }
+      uniformOffset = alignUp (valueOffset + valueSize);
+    }
+
+    context.bindVertexArray (packet->vertexArray);
+    if (packet->arraysCount > 0)
+      context.drawArrays (packet->arraysMode, packet->arraysFirst, packet->arraysCount);
+    if (packet->elementsCount > 0 && packet->elementsHaveBaseVertex)
+      context.drawElementsBaseVertex (packet->elementsMode, packet->elementsCount,
+				      packet->elementsType,
+				      reinterpret_cast<const GLvoid*> (packet->elementsOffset),
+				      packet->elementsBaseVertex);
+    else if (packet->elementsCount > 0)
+      context.drawElements (packet->elementsMode, packet->elementsCount,
+			    packet->elementsType,
+			    reinterpret_cast<const GLvoid*> (packet->elementsOffset));
+    offset += packet->size;
+  }
+}
+
+size_t
+CommandBuffer::getPacketCount () const
+{
+  return m_packetCount;
+}
+
+size_t
+CommandBuffer::getSize () const
+{
+  return m_arena.size ();
+}
+
+void
+CommandBuffer::addUniform (GLenum type, const std::string& uniform,
+			   const void* value, size_t valueSize)
+{
+  size_t start = m_arena.size ();
+  size_t valueOffset = alignUp (start + sizeof (UniformHeader) + uniform.size () + 1);
+  size_t end = alignUp (valueOffset + valueSize);
+  m_arena.resize (end);
+  UniformHeader* header = reinterpret_cast<UniformHeader*> (&m_arena[start]);
+  header->type = type;
+  header->nameLength = uniform.size ();
+  // The name is stored null-terminated so that submit can look it up in
+  //   place.
+  std::memcpy (header + 1, uniform.c_str (), uniform.size () + 1);
+  std::memcpy (&m_arena[valueOffset], value, valueSize);
+  PacketHeader* packet = currentPacket ();
+  packet->size += end - start;
+  ++packet->uniformCount;
+}
+
+CommandBuffer::PacketHeader*
+CommandBuffer::currentPacket ()
+{
+  return reinterpret_cast<PacketHeader*> (&m_arena[m_currentPacket]);
+}
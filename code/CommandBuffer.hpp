@@ -0,0 +1,174 @@
+/// \file CommandBuffer.hpp
+/// \brief Declaration of CommandBuffer class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "ShaderProgram.hpp"
+#include "Matrix4.hpp"
+#include "Vector3.hpp"
+
+/// \brief A list of draw packets that have been recorded without making any
+///   OpenGL calls, so that it can be filled on any thread and submitted
+///   later on the thread that owns the OpenGL context.
+///
+/// Each packet names a ShaderProgram and VAO, the uniform values to set, and
+///   the vertex / index ranges to draw.  Packets are packed one after another
+///   into a single byte arena that is reused from frame to frame, so
+///   recording does not allocate once the arena has grown large enough.
+///   Uniforms are recorded by name and only turned into locations when the
+///   buffer is submitted, since looking up a location is an OpenGL call.
+class CommandBuffer
+{
+public:
+
+  /// \brief Constructs an empty CommandBuffer.
+  CommandBuffer ();
+
+  /// \brief Removes every packet, keeping the memory for reuse.
+  /// \post The buffer contains no packets.
+  void
+  clear ();
+
+  /// \brief Starts recording a new packet.
+  /// \param[in] program The ShaderProgram to draw with.
+  /// \param[in] vertexArray The VAO to draw from.
+  /// \post Uniforms and draws recorded from now on belong to the new packet.
+  void
+  beginPacket (ShaderProgram* program, GLuint vertexArray);
+
+  /// \brief Records the value of a uniform 4x4 matrix of floats.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The matrix to use.
+  /// \pre A packet has been started.
+  void
+  setUniformMatrix (const std::string& uniform, const Matrix4& value);
+
+  /// \brief Records the value of a uniform vector of three floats.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The vector to use.
+  /// \pre A packet has been started.
+  void
+  setUniformVec3 (const std::string& uniform, const Vector3& value);
+
+  /// \brief Records the value of a uniform float.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The float to use.
+  /// \pre A packet has been started.
+  void
+  setUniformFloat (const std::string& uniform, float value);
+
+  /// \brief Records the value of a uniform int.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The int to use.
+  /// \pre A packet has been started.
+  void
+  setUniformInt (const std::string& uniform, int value);
+
+  /// \brief Records a non-indexed draw for the current packet.
+  /// \param[in] mode The kind of primitives to draw.
+  /// \param[in] first The first vertex to draw.
+  /// \param[in] count The number of vertices to draw.
+  /// \pre A packet has been started and has no non-indexed draw yet.
+  void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  /// \brief Records an indexed draw for the current packet.
+  /// \param[in] mode The kind of primitives to draw.
+  /// \param[in] count The number of indices to draw.
+  /// \param[in] type The type of the indices.
+  /// \param[in] offset The byte offset of the first index in the VAO's
+  ///   element buffer.
+  /// \pre A packet has been started and has no indexed draw yet.
+  void
+  drawElements (GLenum mode, GLsizei count, GLenum type, size_t offset);
+
+  /// \brief Records an indexed draw for the current packet whose indices
+  ///   are relative to a base vertex.
+  /// \param[in] mode The kind of primitives to draw.
+  /// \param[in] count The number of indices to draw.
+  /// \param[in] type The type of the indices.
+  /// \param[in] offset The byte offset of the first index in the VAO's
+  ///   element buffer.
+  /// \param[in] baseVertex The number added to every index.
+  /// \pre A packet has been started and has no indexed draw yet.
+  void
+  drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type,
+			  size_t offset, GLint baseVertex);
+
+  /// \brief Copies every packet of another buffer onto the end of this one.
+  /// \param[in] other The buffer to copy from.
+  /// \post This buffer will replay its own packets followed by other's.
+  void
+  append (const CommandBuffer& other);
+
+  /// \brief Replays every packet, in the order they were recorded.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \pre This is called on the thread that owns the OpenGL context.
+  void
+  submit (OpenGLContext& context) const;
+
+  /// \brief Gets the number of packets that have been recorded.
+  /// \return The number of packets.
+  size_t
+  getPacketCount () const;
+
+  /// \brief Gets the number of bytes of the arena in use.
+  /// \return The size of all recorded packets together.
+  size_t
+  getSize () const;
+
+private:
+
+  /// The fixed part at the start of each packet.  Offsets and sizes are
+  ///   relative to the packet, so packets can be copied between buffers.
+  struct PacketHeader
+  {
+    ShaderProgram* program;
+    GLuint vertexArray;
+    /// The number of bytes in the packet, including this header.
+    unsigned int size;
+    unsigned int uniformCount;
+    GLenum arraysMode;
+    GLint arraysFirst;
+    GLsizei arraysCount;
+    GLenum elementsMode;
+    GLsizei elementsCount;
+    GLenum elementsType;
+    size_t elementsOffset;
+    GLint elementsBaseVertex;
+    /// Whether the indexed draw is replayed with glDrawElementsBaseVertex.
+    bool elementsHaveBaseVertex;
+  };
+
+  /// The fixed part at the start of each uniform, followed by the name and
+  ///   then the value.
+  struct UniformHeader
+  {
+    /// GL_FLOAT_MAT4, GL_FLOAT_VEC3, GL_FLOAT or GL_INT.
+    GLenum type;
+    unsigned int nameLength;
+  };
+
+  void
+  addUniform (GLenum type, const std::string& uniform, const void* value,
+	      size_t valueSize);
+
+  PacketHeader*
+  currentPacket ();
+
+  std::vector<unsigned char> m_arena;
+  /// The offset of the packet being recorded.
+  size_t m_currentPacket;
+  size_t m_packetCount;
+};
+
+#endif//COMMAND_BUFFER_HPP
@@ -0,0 +1,203 @@
+/// \file ComponentStore.cpp
+/// \brief Definitions of ComponentStore class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <functional>
+
+#include "ComponentStore.hpp"
+#include "JobSystem.hpp"
+#include "Matrix3.hpp"
+
+namespace
+{
+  // The number of entities given to each job when culling.  Each one is a
+  //   handful of multiplies, so jobs are much bigger than a Scene's.
+  const size_t ENTITIES_PER_JOB = 4096;
+}
+
+ComponentStore::ComponentStore ()
+{
+}
+
+uint32_t
+ComponentStore::addMaterial (const Material& material)
+{
+  m_materials.push_back (material);
+  return m_materials.size () - 1;
+}
+
+size_t
+ComponentStore::add (ShaderProgram* program, GLuint vertexArray,
+		     GLint baseVertex, GLsizei vertexCount, GLuint firstIndex,
+		     GLsizei indexCount, uint32_t materialId,
+		     const Vector3& boundCenter, float boundRadius)
+{
+  m_worlds.push_back (Matrix4 ());
+  m_boundX.push_back (boundCenter.m_x);
+  m_boundY.push_back (boundCenter.m_y);
+  m_boundZ.push_back (boundCenter.m_z);
+  m_boundRadius.push_back (boundRadius);
+  m_worldX.push_back (boundCenter.m_x);
+  m_worldY.push_back (boundCenter.m_y);
+  m_worldZ.push_back (boundCenter.m_z);
+  m_worldRadius.push_back (boundRadius);
+  m_materialIds.push_back (materialId);
+  m_programs.push_back (program);
+  m_vaos.push_back (vertexArray);
+  m_baseVertices.push_back (baseVertex);
+  m_vertexCounts.push_back (vertexCount);
+  m_firstIndices.push_back (firstIndex);
+  m_indexCounts.push_back (indexCount);
+  m_visibleFlags.push_back (1);
+  return m_worlds.size () - 1;
+}
+
+void
+ComponentStore::setWorld (size_t entity, const Transform& world)
+{
+  m_worlds[entity] = world.getTransform ();
+  Matrix3 orientation = world.getOrientation ();
+  Vector3 center = orientation * Vector3 (m_boundX[entity], m_boundY[entity],
+					  m_boundZ[entity])
+    + world.getPosition ();
+  // Scaling can stretch the sphere by as much as the longest basis vector,
+  //   as in Mesh::getBoundingSphere.
+  float scale = std::max (orientation.getRight ().length (),
+			  std::max (orientation.getUp ().length (),
+				    orientation.getBack ().length ()));
+  m_worldX[entity] = center.m_x;
+  m_worldY[entity] = center.m_y;
+  m_worldZ[entity] = center.m_z;
+  m_worldRadius[entity] = m_boundRadius[entity] * scale;
+}
+
+const Matrix4&
+ComponentStore::getWorld (size_t entity) const
+{
+  return m_worlds[entity];
+}
+
+size_t
+ComponentStore::size () const
+{
+  return m_worlds.size ();
+}
+
+void
+ComponentStore::clear ()
+{
+  m_worlds.clear ();
+  m_boundX.clear ();
+  m_boundY.clear ();
+  m_boundZ.clear ();
+  m_boundRadius.clear ();
+  m_worldX.clear ();
+  m_worldY.clear ();
+  m_worldZ.clear ();
+  m_worldRadius.clear ();
+  m_materialIds.clear ();
+  m_programs.clear ();
+  m_vaos.clear ();
+  m_baseVertices.clear ();
+  m_vertexCounts.clear ();
+  m_firstIndices.clear ();
+  m_indexCounts.clear ();
+  m_materials.clear ();
+  m_visibleFlags.clear ();
+  m_visible.clear ();
+}
+
+void
+ComponentStore::cull (const Transform& viewMatrix, const Matrix4& projectionMatrix)
+{
+  FrustumPlanes planes;
+  extractFrustumPlanes (projectionMatrix * viewMatrix.getTransform (), planes);
+  cull (planes);
+}
+
+void
+ComponentStore::cull (const FrustumPlanes& planes)
+{
+  JobSystem::getGlobal ().parallelFor (size (), ENTITIES_PER_JOB,
+				       [&] (size_t begin, size_t end)
+  {
+    // One plane at a time over the whole range, so each pass is a straight
+    //   run through the four bounds arrays.
+    std::fill (m_visibleFlags.begin () + begin, m_visibleFlags.begin () + end, 1);
+    for (int plane = 0; plane < 6; ++plane)
+    {
+      float a = planes[plane][0], b = planes[plane][1];
+      float c = planes[plane][2], d = planes[plane][3];
+      for (size_t i = begin; i < end; ++i)
+	m_visibleFlags[i] &= a * m_worldX[i] + b * m_worldY[i] + c * m_worldZ[i]
+	  + d >= -m_worldRadius[i];
+    }
+  });
+  m_visible.clear ();
+  for (size_t i = 0; i < m_visibleFlags.size (); ++i)
+  {
+    if (m_visibleFlags[i])
+      m_visible.push_back (i);
+  }
+}
+
+void
+ComponentStore::sortVisible ()
+{
+  std::sort (m_visible.begin (), m_visible.end (), [this] (uint32_t a, uint32_t b)
+  {
+    if (m_programs[a] != m_programs[b])
+      return std::less<ShaderProgram*> () (m_programs[a], m_programs[b]);
+    if (m_materialIds[a] != m_materialIds[b])
+      return m_materialIds[a] < m_materialIds[b];
+    if (m_vaos[a] != m_vaos[b])
+      return m_vaos[a] < m_vaos[b];
+    return a < b;
+  });
+}
+
+const std::vector<uint32_t>&
+ComponentStore::getVisible () const
+{
+  return m_visible;
+}
+
+void
+ComponentStore::record (CommandBuffer& commands, const Transform& viewMatrix,
+			const Matrix4& projectionMatrix, const Vector3& eyePosition) const
+{
+  Matrix4 view = viewMatrix.getTransform ();
+  ShaderProgram* program = nullptr;
+  uint32_t materialId = 0;
+  for (uint32_t entity : m_visible)
+  {
+    commands.beginPacket (m_programs[entity], m_vaos[entity]);
+    commands.setUniformMatrix ("uModelView", view * m_worlds[entity]);
+    commands.setUniformMatrix ("uWorld", m_worlds[entity]);
+    // Uniforms stay set in a program, so the per-frame ones and the material
+    //   only need recording when they change.
+    bool newProgram = m_programs[entity] != program;
+    if (newProgram)
+    {
+      program = m_programs[entity];
+      commands.setUniformMatrix ("uProjection", projectionMatrix);
+      commands.setUniformMatrix ("uView", view);
+      commands.setUniformVec3 ("uEyePosition", eyePosition);
+    }
+    if (newProgram || m_materialIds[entity] != materialId)
+    {
+      materialId = m_materialIds[entity];
+      m_materials[materialId].setShader (commands);
+    }
+    // Like Mesh::record, indexed geometry is only drawn through its indices.
+    if (m_indexCounts[entity] == 0)
+      commands.drawArrays (GL_TRIANGLES, m_baseVertices[entity], m_vertexCounts[entity]);
+    else
+      commands.drawElementsBaseVertex (GL_TRIANGLES, m_indexCounts[entity], GL_UNSIGNED_INT,
+				       m_firstIndices[entity] * sizeof(unsigned int),
+				       m_baseVertices[entity]);
+  }
+}
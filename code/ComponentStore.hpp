@@ -0,0 +1,154 @@
+/// \file ComponentStore.hpp
+/// \brief Declaration of ComponentStore class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef COMPONENT_STORE_HPP
+#define COMPONENT_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CommandBuffer.hpp"
+#include "Geometry.hpp"
+#include "Material.hpp"
+#include "Matrix4.hpp"
+#include "OpenGLContext.hpp"
+#include "ShaderProgram.hpp"
+#include "Transform.hpp"
+#include "Vector3.hpp"
+
+/// \brief The parts of many drawable objects that culling, sorting and
+///   drawing need, kept in parallel arrays indexed by entity.
+///
+/// A Scene walks one Mesh object after another, each holding its geometry,
+///   transforms, material and OpenGL handles together, so every pass touches
+///   far more memory than it reads.  Here each pass streams through only the
+///   arrays it needs: culling reads the world bounding spheres, sorting reads
+///   the programs, material IDs and VAOs, and recording reads the world
+///   matrices of what survived.  Materials are stored once and referred to by
+///   ID.  Entities are numbered in the order they are added.
+class ComponentStore
+{
+public:
+
+  /// \brief Constructs an empty ComponentStore.
+  ComponentStore ();
+
+  /// \brief Adds a material that entities can share.
+  /// \param[in] material The material.
+  /// \return The ID to give add.
+  uint32_t
+  addMaterial (const Material& material);
+
+  /// \brief Adds an entity, placed at the origin.
+  /// \param[in] program The ShaderProgram to draw it with.
+  /// \param[in] vertexArray The VAO to draw it from.
+  /// \param[in] baseVertex The first vertex, which indices are relative to
+  ///   or, without indices, which drawing starts from, such as the start of
+  ///   its range of a BufferArena.
+  /// \param[in] vertexCount The number of non-indexed vertices to draw.
+  /// \param[in] firstIndex The first index in the VAO's IBO.
+  /// \param[in] indexCount The number of indices to draw.
+  /// \param[in] materialId The ID of its material, from addMaterial.
+  /// \param[in] boundCenter The center of a sphere around it, in model space.
+  /// \param[in] boundRadius The radius of that sphere.
+  /// \return The entity's index.
+  size_t
+  add (ShaderProgram* program, GLuint vertexArray, GLint baseVertex,
+       GLsizei vertexCount, GLuint firstIndex, GLsizei indexCount,
+       uint32_t materialId, const Vector3& boundCenter, float boundRadius);
+
+  /// \brief Moves an entity.
+  /// \param[in] entity The entity's index.
+  /// \param[in] world Its new world matrix.
+  /// \post The entity's world matrix and world bounding sphere are updated.
+  void
+  setWorld (size_t entity, const Transform& world);
+
+  /// \brief Gets an entity's world matrix.
+  /// \param[in] entity The entity's index.
+  /// \return The matrix last given to setWorld.
+  const Matrix4&
+  getWorld (size_t entity) const;
+
+  /// \brief Gets the number of entities.
+  /// \return The number of entities.
+  size_t
+  size () const;
+
+  /// \brief Removes every entity and material.
+  /// \post The store is empty.
+  void
+  clear ();
+
+  /// \brief Finds which entities can be seen.
+  /// \param[in] viewMatrix The view matrix.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \post getVisible lists, in entity order, those whose bounding spheres
+  ///   are at least partly inside the view frustum.
+  void
+  cull (const Transform& viewMatrix, const Matrix4& projectionMatrix);
+
+  /// \brief Finds which entities can be seen from a view frustum whose
+  ///   planes are already known, such as a Camera's.
+  /// \param[in] planes The planes of the frustum.
+  /// \post getVisible lists, in entity order, those whose bounding spheres
+  ///   are at least partly inside the frustum.
+  void
+  cull (const FrustumPlanes& planes);
+
+  /// \brief Orders the visible entities so that those sharing a program,
+  ///   material and VAO are drawn together.
+  /// \post getVisible is sorted by program, then material, then VAO.
+  void
+  sortVisible ();
+
+  /// \brief Gets the entities that survived the last cull.
+  /// \return Their indices.
+  const std::vector<uint32_t>&
+  getVisible () const;
+
+  /// \brief Records a draw packet for every visible entity.
+  /// \param[in] commands The buffer to record into.
+  /// \param[in] viewMatrix The view matrix.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  /// \post commands ends with one packet per visible entity, in the order
+  ///   of getVisible.  Uniforms that are the same as in the previous packet
+  ///   with the same program are not recorded again, so the packets must be
+  ///   submitted in order.
+  void
+  record (CommandBuffer& commands, const Transform& viewMatrix,
+	  const Matrix4& projectionMatrix, const Vector3& eyePosition) const;
+
+private:
+
+  std::vector<Matrix4> m_worlds;
+  /// Bounding spheres in model space.
+  std::vector<float> m_boundX;
+  std::vector<float> m_boundY;
+  std::vector<float> m_boundZ;
+  std::vector<float> m_boundRadius;
+  /// Bounding spheres in world space, updated by setWorld.
+  std::vector<float> m_worldX;
+  std::vector<float> m_worldY;
+  std::vector<float> m_worldZ;
+  std::vector<float> m_worldRadius;
+  std::vector<uint32_t> m_materialIds;
+  std::vector<ShaderProgram*> m_programs;
+  std::vector<GLuint> m_vaos;
+  std::vector<GLint> m_baseVertices;
+  std::vector<GLsizei> m_vertexCounts;
+  std::vector<GLuint> m_firstIndices;
+  std::vector<GLsizei> m_indexCounts;
+  std::vector<Material> m_materials;
+  /// Whether or not each entity survived the last cull.
+  std::vector<char> m_visibleFlags;
+  std::vector<uint32_t> m_visible;
+};
+
+#endif//COMPONENT_STORE_HPP
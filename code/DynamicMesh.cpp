@@ -0,0 +1,139 @@
+/// \file DynamicMesh.cpp
+/// \brief Definitions of DynamicMesh class member functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "DynamicMesh.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+  // How long one wait for a fence may take before it is tried again, in
+  //   nanoseconds.
+  const GLuint64 FENCE_TIMEOUT = 1000000000;
+}
+
+DynamicMesh::DynamicMesh (OpenGLContext* context, ShaderProgram* shader,
+			  GLsizei capacity, GLenum mode, SyncMethod sync)
+  : ColorMesh (context, shader), m_capacity (capacity), m_mode (mode),
+    m_sync (sync), m_usedVertices (0), m_dirty (false), m_region (0),
+    m_stalls (0)
+{
+  std::fill (m_fences, m_fences + REGIONS, nullptr);
+  m_geometry.resize (static_cast<size_t> (capacity) * getFloatsPerVertex ());
+  m_gpuBytes = REGIONS * m_geometry.size () * sizeof(float);
+  createBuffers ();
+  m_context->bindVertexArray (m_vao);
+  m_context->bindBuffer (GL_ARRAY_BUFFER, m_vbo);
+  m_context->bufferData (GL_ARRAY_BUFFER, m_gpuBytes, nullptr, GL_STREAM_DRAW);
+  enableAttributes ();
+  m_context->bindVertexArray (0);
+  setDrawRange (m_mode, 0, 0);
+  reportMemory ();
+}
+
+DynamicMesh::~DynamicMesh ()
+{
+  for (GLsync fence : m_fences)
+    if (fence != nullptr)
+      m_context->deleteSync (fence);
+}
+
+void
+DynamicMesh::updateGeometry (size_t offset, const std::vector<float>& geometry)
+{
+  unsigned int floatsPerVertex = getFloatsPerVertex ();
+  size_t vertices = geometry.size () / floatsPerVertex;
+  if (offset + vertices > static_cast<size_t> (m_capacity))
+  {
+    fprintf (stderr, "DynamicMesh geometry of %zu vertices is over its"
+	     " capacity of %d\n", offset + vertices, m_capacity);
+    exit (-1);
+  }
+  std::copy (geometry.begin (), geometry.begin () + vertices * floatsPerVertex,
+	     m_geometry.begin () + offset * floatsPerVertex);
+  m_usedVertices = std::max (m_usedVertices,
+			     static_cast<GLsizei> (offset + vertices));
+  m_dirty = true;
+}
+
+void
+DynamicMesh::setVertexCount (GLsizei count)
+{
+  if (count < 0 || count > m_capacity)
+  {
+    fprintf (stderr, "DynamicMesh cannot have %d vertices, with a capacity"
+	     " of %d\n", count, m_capacity);
+    exit (-1);
+  }
+  m_usedVertices = count;
+  m_dirty = true;
+}
+
+GLsizei
+DynamicMesh::getVertexCount () const
+{
+  return m_usedVertices;
+}
+
+GLsizei
+DynamicMesh::getCapacity () const
+{
+  return m_capacity;
+}
+
+void
+DynamicMesh::upload ()
+{
+  if (!m_dirty)
+    return;
+  PROFILE_SCOPE ("DynamicMesh::upload");
+  m_context->bindBuffer (GL_ARRAY_BUFFER, m_vbo);
+  size_t regionBytes = m_geometry.size () * sizeof(float);
+  if (m_sync == FENCES)
+  {
+    // Every draw that read the region being left has been issued, so one
+    //   fence covers them all.
+    m_fences[m_region] = m_context->fenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_region = (m_region + 1) % REGIONS;
+    GLsync fence = m_fences[m_region];
+    if (fence != nullptr)
+    {
+      GLenum result = m_context->clientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+						 FENCE_TIMEOUT);
+      if (result != GL_ALREADY_SIGNALED)
+	++m_stalls;
+      while (result == GL_TIMEOUT_EXPIRED)
+	result = m_context->clientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+					    FENCE_TIMEOUT);
+      m_context->deleteSync (fence);
+      m_fences[m_region] = nullptr;
+    }
+  }
+  else
+  {
+    m_region = (m_region + 1) % REGIONS;
+    // Draws may still read the other regions of the old storage, so the
+    //   driver keeps it until they finish and gives this buffer new storage.
+    if (m_region == 0)
+      m_context->bufferData (GL_ARRAY_BUFFER, REGIONS * regionBytes, nullptr,
+			     GL_STREAM_DRAW);
+  }
+  size_t usedFloats = static_cast<size_t> (m_usedVertices) * getFloatsPerVertex ();
+  if (usedFloats > 0)
+    m_context->bufferSubData (GL_ARRAY_BUFFER, m_region * regionBytes,
+			      usedFloats * sizeof(float), m_geometry.data ());
+  computeBounds (m_geometry.data (), usedFloats);
+  setDrawRange (m_mode, m_region * m_capacity, m_usedVertices);
+  m_dirty = false;
+}
+
+unsigned long
+DynamicMesh::getStallCount () const
+{
+  return m_stalls;
+}
@@ -0,0 +1,119 @@
+/// \file DynamicMesh.hpp
+/// \brief Declaration of DynamicMesh class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef DYNAMIC_MESH_HPP
+#define DYNAMIC_MESH_HPP
+
+#include <vector>
+
+#include "ColorMesh.hpp"
+
+/// \brief A ColorMesh whose geometry is rebuilt on the CPU while running,
+///   such as highlighted squares, trails or debug lines.
+///
+/// The VBO is one buffer split into REGIONS regions of the same size.  Each
+///   upload goes into the region after the one the last frames drew from,
+///   so that the GPU can still be reading those while the CPU writes.
+///   Before a region is written again, either a fence placed after the draws
+///   that read it is waited on, which is almost always already passed with
+///   three regions, or, when orphaning, the whole buffer is reallocated
+///   without data once the ring wraps, so that the driver hands back fresh
+///   storage.  Either way, updating never waits for the GPU to catch up.
+///
+/// The constructor prepares the VAO, so prepareVao, addGeometry and
+///   addIndices must not be used.  The geometry is drawn without indices,
+///   and addTo does not know which region to draw.
+class DynamicMesh : public ColorMesh
+{
+public:
+
+  /// How a region is made safe to write again.
+  enum SyncMethod
+  {
+    /// Wait for a fence placed after the draws that read it.
+    FENCES,
+    /// Reallocate the whole buffer each time the ring wraps.
+    ORPHANING
+  };
+
+  /// The number of regions the VBO is split into.
+  static const unsigned int REGIONS = 3;
+
+  /// \brief Constructs a DynamicMesh with no vertices.
+  /// \param[in] context The object through which to make OpenGL calls.
+  /// \param[in] shader The ShaderProgram to draw with, which takes positions
+  ///   and colors.
+  /// \param[in] capacity The most vertices the geometry may have.
+  /// \param[in] mode The kind of primitives, such as GL_TRIANGLES or
+  ///   GL_LINES.
+  /// \param[in] sync How regions are made safe to write again.
+  /// \post The VBO has room for REGIONS copies of capacity vertices, and the
+  ///   VAO has been set up.
+  DynamicMesh (OpenGLContext* context, ShaderProgram* shader,
+	       GLsizei capacity, GLenum mode = GL_TRIANGLES,
+	       SyncMethod sync = FENCES);
+
+  /// \brief Destructs a DynamicMesh, deleting any fences it is holding.
+  virtual
+  ~DynamicMesh ();
+
+  /// \brief Replaces some vertices of the geometry.
+  /// \param[in] offset The first vertex to replace.
+  /// \param[in] geometry Interleaved positions and colors (X, Y, Z, R, G, B)
+  ///   of whole vertices.  Any past the end of the geometry are added.
+  /// \pre The geometry will have no more than the capacity of vertices.
+  /// \post The vertices have changed in main memory, and will be drawn
+  ///   after the next upload.
+  void
+  updateGeometry (size_t offset, const std::vector<float>& geometry);
+
+  /// \brief Sets how many vertices the geometry has, so that it can shrink.
+  /// \param[in] count The number of vertices, which is no more than the
+  ///   capacity.  Any added by growing have whatever data was there before.
+  void
+  setVertexCount (GLsizei count);
+
+  /// \brief Gets how many vertices the geometry has.
+  /// \return The number of vertices that will be drawn after the next upload.
+  GLsizei
+  getVertexCount () const;
+
+  /// \brief Gets how many vertices the geometry may have.
+  /// \return The capacity given to the constructor.
+  GLsizei
+  getCapacity () const;
+
+  /// \brief Copies the geometry into the next region of the VBO, if it has
+  ///   changed since the last upload.  This should be called once a frame,
+  ///   after updating and before drawing or recording.
+  /// \post draw and record draw the new geometry, and the bounding sphere
+  ///   and box contain it.
+  void
+  upload ();
+
+  /// \brief Gets how many uploads had to wait for a fence that the GPU had
+  ///   not passed yet.
+  /// \return The number of waits, which should stay 0.
+  unsigned long
+  getStallCount () const;
+
+private:
+
+  GLsizei m_capacity;
+  GLenum m_mode;
+  SyncMethod m_sync;
+  /// The number of vertices in m_geometry that are used.
+  GLsizei m_usedVertices;
+  /// Whether or not the geometry has changed since the last upload.
+  bool m_dirty;
+  /// The region draws read from.
+  unsigned int m_region;
+  /// For each region, a fence after the last draws that read it, or nullptr.
+  GLsync m_fences[REGIONS];
+  unsigned long m_stalls;
+};
+
+#endif//DYNAMIC_MESH_HPP
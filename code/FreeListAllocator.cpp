@@ -0,0 +1,111 @@
+/// \file FreeListAllocator.cpp
+/// \brief Definitions of FreeListAllocator class member functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include "FreeListAllocator.hpp"
+
+FreeListAllocator::FreeListAllocator (size_t capacity)
+  : m_capacity (0), m_freeSize (0)
+{
+  reset (capacity);
+}
+
+bool
+FreeListAllocator::allocate (size_t size, size_t& offset)
+{
+  auto fit = m_bySize.lower_bound (size);
+  if (size == 0 || fit == m_bySize.end ())
+    return false;
+  size_t rangeSize = fit->first;
+  offset = fit->second;
+  eraseFree (m_byOffset.find (offset));
+  if (rangeSize > size)
+    insertFree (offset + size, rangeSize - size);
+  return true;
+}
+
+void
+FreeListAllocator::free (size_t offset, size_t size)
+{
+  if (size == 0)
+    return;
+  // Merge with the free range just after, then the one just before.
+  auto next = m_byOffset.find (offset + size);
+  if (next != m_byOffset.end ())
+  {
+    size += next->second;
+    eraseFree (next);
+  }
+  auto previous = m_byOffset.lower_bound (offset);
+  if (previous != m_byOffset.begin ())
+  {
+    --previous;
+    if (previous->first + previous->second == offset)
+    {
+      offset = previous->first;
+      size += previous->second;
+      eraseFree (previous);
+    }
+  }
+  insertFree (offset, size);
+}
+
+void
+FreeListAllocator::reset (size_t capacity, size_t used)
+{
+  m_byOffset.clear ();
+  m_bySize.clear ();
+  m_capacity = capacity;
+  m_freeSize = 0;
+  if (capacity > used)
+    insertFree (used, capacity - used);
+}
+
+size_t
+FreeListAllocator::getCapacity () const
+{
+  return m_capacity;
+}
+
+size_t
+FreeListAllocator::getFreeSize () const
+{
+  return m_freeSize;
+}
+
+size_t
+FreeListAllocator::getLargestFree () const
+{
+  return m_bySize.empty () ? 0 : m_bySize.rbegin ()->first;
+}
+
+const std::map<size_t, size_t>&
+FreeListAllocator::getFreeRanges () const
+{
+  return m_byOffset;
+}
+
+void
+FreeListAllocator::insertFree (size_t offset, size_t size)
+{
+  m_byOffset[offset] = size;
+  m_bySize.emplace (size, offset);
+  m_freeSize += size;
+}
+
+void
+FreeListAllocator::eraseFree (std::map<size_t, size_t>::iterator range)
+{
+  auto sized = m_bySize.equal_range (range->second);
+  for (auto it = sized.first; it != sized.second; ++it)
+  {
+    if (it->second == range->first)
+    {
+      m_bySize.erase (it);
+      break;
+    }
+  }
+  m_freeSize -= range->second;
+  m_byOffset.erase (range);
+}
@@ -0,0 +1,86 @@
+/// \file FreeListAllocator.hpp
+/// \brief Declaration of FreeListAllocator class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef FREE_LIST_ALLOCATOR_HPP
+#define FREE_LIST_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <map>
+
+/// \brief Hands out ranges of a block of some capacity, such as vertices of
+///   a buffer, without touching the block itself.
+///
+/// Free ranges are kept both by offset, so that a freed range can be merged
+///   with its neighbors, and by size, so that an allocation takes the
+///   smallest free range it fits in.  Both are O(log n) in the number of
+///   free ranges.
+class FreeListAllocator
+{
+public:
+
+  /// \brief Constructs a FreeListAllocator with all of its capacity free.
+  /// \param[in] capacity The number of units that may be allocated.
+  FreeListAllocator (size_t capacity = 0);
+
+  /// \brief Allocates a range.
+  /// \param[in] size The number of units, which must be more than 0.
+  /// \param[out] offset The first unit of the range.
+  /// \return Whether or not a free range was large enough.
+  bool
+  allocate (size_t size, size_t& offset);
+
+  /// \brief Frees a range, merging it with any free range next to it.
+  /// \param[in] offset The first unit of the range.
+  /// \param[in] size The number of units in the range.
+  /// \pre The range was allocated and has not been freed since.
+  void
+  free (size_t offset, size_t size);
+
+  /// \brief Forgets every allocation and sets a new capacity.
+  /// \param[in] capacity The number of units that may be allocated.
+  /// \param[in] used The number of units at the start that stay allocated,
+  ///   as after packing every allocation together.
+  void
+  reset (size_t capacity, size_t used = 0);
+
+  /// \brief Gets the number of units that may be allocated.
+  /// \return The capacity.
+  size_t
+  getCapacity () const;
+
+  /// \brief Gets the number of units not allocated.
+  /// \return The sum of the free ranges.
+  size_t
+  getFreeSize () const;
+
+  /// \brief Gets the largest range that could be allocated now.
+  /// \return The size of the largest free range.
+  size_t
+  getLargestFree () const;
+
+  /// \brief Gets every free range.
+  /// \return The size of each free range, by offset.  No two are next to
+  ///   each other, since freeing merges them.
+  const std::map<size_t, size_t>&
+  getFreeRanges () const;
+
+private:
+
+  void
+  insertFree (size_t offset, size_t size);
+
+  void
+  eraseFree (std::map<size_t, size_t>::iterator range);
+
+  size_t m_capacity;
+  size_t m_freeSize;
+  /// The size of each free range, by offset.
+  std::map<size_t, size_t> m_byOffset;
+  /// The offset of each free range, by size.
+  std::multimap<size_t, size_t> m_bySize;
+};
+
+#endif//FREE_LIST_ALLOCATOR_HPP
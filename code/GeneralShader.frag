@@ -4,6 +4,23 @@ precision highp float;
 
 uniform int uNumLights;
 
+// A variant made by ShaderProgram::getVariant may fix how many lights of each
+//   type there are, with uLights holding the directional ones first, then the
+//   point ones, then the spot ones.  The loops then have constant trip counts
+//   and never test a light's type, so the compiler can unroll them.
+#if defined (NUM_DIRECTIONAL) || defined (NUM_POINT) || defined (NUM_SPOT)
+#define SPECIALIZED_LIGHTS
+#ifndef NUM_DIRECTIONAL
+#define NUM_DIRECTIONAL 0
+#endif
+#ifndef NUM_POINT
+#define NUM_POINT 0
+#endif
+#ifndef NUM_SPOT
+#define NUM_SPOT 0
+#endif
+#endif
+
 struct Light
 {
   // 0 if directional, 1 if point, 2 if spot -- other values illegal.
@@ -30,11 +47,28 @@ uniform Light uLights[MAX_LIGHTS];
 
 uniform vec3  uAmbientIntensity; 
 
+// A variant with INDIRECT_DRAW defined holds every material of a
+//   multi-draw in arrays, indexed by the draw's material index.
+#ifdef INDIRECT_DRAW
+const int MAX_MATERIALS = 16;
+flat in uint vMaterial;
+uniform vec3  uAmbientReflections[MAX_MATERIALS];
+uniform vec3  uDiffuseReflections[MAX_MATERIALS];
+uniform vec3  uSpecularReflections[MAX_MATERIALS];
+uniform float uSpecularPowers[MAX_MATERIALS];
+uniform vec3  uEmissiveIntensities[MAX_MATERIALS];
+#define uAmbientReflection uAmbientReflections[vMaterial]
+#define uDiffuseReflection uDiffuseReflections[vMaterial]
+#define uSpecularReflection uSpecularReflections[vMaterial]
+#define uSpecularPower uSpecularPowers[vMaterial]
+#define uEmissiveIntensity uEmissiveIntensities[vMaterial]
+#else
 uniform vec3  uAmbientReflection; 
 uniform vec3  uDiffuseReflection; 
 uniform vec3  uSpecularReflection; 
 uniform float uSpecularPower; 
 uniform vec3  uEmissiveIntensity; 
+#endif
 
 uniform vec3 uEyePosition;
 
@@ -51,6 +85,15 @@ in vec3 vPosition;
 vec3
 calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal);
 
+vec3
+calculateDirectional (Light light, vec3 vertexPosition, vec3 vertexNormal);
+
+vec3
+calculatePoint (Light light, vec3 vertexPosition, vec3 vertexNormal);
+
+vec3
+calculateSpot (Light light, vec3 vertexPosition, vec3 vertexNormal);
+
 
 
 void
@@ -60,10 +103,26 @@ main (void)
     vec3 nColor = uAmbientReflection * uAmbientIntensity + uEmissiveIntensity;
 
 
+#ifdef SPECIALIZED_LIGHTS
+    for (int i = 0; i < NUM_DIRECTIONAL; ++i)
+    {
+        nColor += calculateDirectional (uLights[i], vPosition, vNormal);
+    }
+    for (int i = NUM_DIRECTIONAL; i < NUM_DIRECTIONAL + NUM_POINT; ++i)
+    {
+        nColor += calculatePoint (uLights[i], vPosition, vNormal);
+    }
+    for (int i = NUM_DIRECTIONAL + NUM_POINT;
+         i < NUM_DIRECTIONAL + NUM_POINT + NUM_SPOT; ++i)
+    {
+        nColor += calculateSpot (uLights[i], vPosition, vNormal);
+    }
+#else
     for (int i = 0; i < uNumLights; ++i)
     {
         nColor += calculateLighting (uLights[i], vPosition, vNormal);
     }
+#endif
     
     // Stay in bounds [0, 1]
     nColor = clamp (nColor, 0.0, 1.0);
@@ -153,4 +212,59 @@ calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal)
   }
 
   return diffuseAndSpecular;
-}
\ No newline at end of file
+}
+
+
+
+// The rest computes the same as calculateLighting, one function per type of
+//   light, choosing with arithmetic instead of branches.
+
+vec3
+shade (Light light, vec3 lightVector, vec3 vertexPosition, vec3 vertexNormal)
+{
+  float lambertianCoef = max (dot (lightVector, vertexNormal), 0.0);
+  vec3 diffuseColor = uDiffuseReflection * light.diffuseIntensity * lambertianCoef;
+  vec3 reflectionVector = reflect (-lightVector, vertexNormal);
+  vec3 eyeVector = normalize (uEyePosition - vertexPosition);
+  float specularCoef = max (dot (eyeVector, reflectionVector), 0.0);
+  vec3 specularColor = uSpecularReflection * light.specularIntensity
+    * pow (specularCoef, uSpecularPower);
+  // Nothing reaches a vertex the light is edge-on to or behind.
+  return float (lambertianCoef > 0.0) * (diffuseColor + specularColor);
+}
+
+float
+attenuate (Light light, vec3 vertexPosition)
+{
+  float distance = length (vec4 (vertexPosition, 1) - (uView * vec4 (light.position, 1)));
+  return 1.0 / (light.attenuationCoefficients.x
+      + light.attenuationCoefficients.y * distance
+      + light.attenuationCoefficients.z * distance * distance);
+}
+
+vec3
+calculateDirectional (Light light, vec3 vertexPosition, vec3 vertexNormal)
+{
+  mat3 normaluViewInv = transpose (inverse (mat3 (uView)));
+  vec3 lightVector = normalize (normaluViewInv * -light.direction);
+  return shade (light, lightVector, vertexPosition, vertexNormal);
+}
+
+vec3
+calculatePoint (Light light, vec3 vertexPosition, vec3 vertexNormal)
+{
+  vec3 lightVector = normalize ((mat3 (uView) * light.position) - vertexPosition);
+  return attenuate (light, vertexPosition)
+    * shade (light, lightVector, vertexPosition, vertexNormal);
+}
+
+vec3
+calculateSpot (Light light, vec3 vertexPosition, vec3 vertexNormal)
+{
+  vec3 lightVector = normalize ((mat3 (uView) * light.position) - vertexPosition);
+  mat3 normaluViewInv = transpose (inverse (mat3 (uView)));
+  float cosTheta = max (dot (-lightVector, (normaluViewInv * light.direction)), 0.0);
+  float spotFactor = pow (step (light.cutoffCosAngle, cosTheta) * cosTheta, light.falloff);
+  return spotFactor * attenuate (light, vertexPosition)
+    * shade (light, lightVector, vertexPosition, vertexNormal);
+}
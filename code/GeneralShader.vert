@@ -17,16 +17,32 @@ precision highp float;
 in vec3 aPosition;
 layout(location = 2) in vec3 aNormal;
 
+// A variant made by ShaderProgram::getVariant with INDIRECT_DRAW defined
+//   draws many meshes in one glMultiDrawElementsIndirect.  Each mesh's world
+//   matrix and material index are then per-instance attributes, which each
+//   draw command's base instance selects, instead of uniforms.
+#ifdef INDIRECT_DRAW
+layout(location = 3) in mat4 aWorld;
+layout(location = 7) in uint aMaterial;
+#endif
+
 // Output to the fragment shader.
 
 out vec3 vNormal;
 out vec3 vPosition;
+#ifdef INDIRECT_DRAW
+flat out uint vMaterial;
+#endif
 
 // Transformation matrices, provided by C++ code.
 
 uniform mat4 uView;
 uniform mat4 uProjection;
+#ifdef INDIRECT_DRAW
+#define uWorld aWorld
+#else
 uniform mat4 uWorld;
+#endif
 
 void
 main (void)
@@ -65,6 +81,9 @@ main (void)
  
   vec3 normalWorld = normalize (normaluViewInv * normalize (normalTransform * aNormal));
   vNormal = normalWorld;
+#ifdef INDIRECT_DRAW
+  vMaterial = aMaterial;
+#endif
   
 }
 
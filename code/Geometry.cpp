@@ -6,8 +6,10 @@
 #include <random>
 #include <cassert>
 #include <iostream>
+#include <cmath>
 
 #include "Geometry.hpp"
+#include "JobSystem.hpp"
 
 void
 indexData (const std::vector<float>& geometry, unsigned int floatsPerVertex,
@@ -54,14 +56,17 @@ indexData (const std::vector<float>& geometry, unsigned int floatsPerVertex,
 std::vector<Vector3>
 computeFaceNormals (const std::vector<Triangle>& faces)
 {
-  std::vector<Vector3> faceNormals;
-  for(unsigned int faceIndex = 0; faceIndex < faces.size (); faceIndex++)
+  std::vector<Vector3> faceNormals (faces.size ());
+  JobSystem::getGlobal ().parallelFor (faces.size (), 4096, [&] (size_t begin, size_t end)
   {
-    // We learned this algorithm back in Lecture 04!
-    Vector3 normal = (faces[faceIndex][1] - faces[faceIndex][0]).cross (faces[faceIndex][2] - faces[faceIndex][0]);
-    normal.normalize ();
-    faceNormals.push_back (normal);
-  }
+    for(size_t faceIndex = begin; faceIndex < end; faceIndex++)
+    {
+      // We learned this algorithm back in Lecture 04!
+      Vector3 normal = (faces[faceIndex][1] - faces[faceIndex][0]).cross (faces[faceIndex][2] - faces[faceIndex][0]);
+      normal.normalize ();
+      faceNormals[faceIndex] = normal;
+    }
+  });
   return faceNormals;
 }
 
@@ -70,38 +75,43 @@ computeVertexNormals (const std::vector<Triangle>& faces,
 		      const std::vector<Vector3>& faceNormals)
 {
   assert (faces.size () == faceNormals.size ());
-  std::vector<Vector3> vertexNormals;
-  for (unsigned int faceIndex = 0; faceIndex < faces.size (); faceIndex++)
+  // Each output only reads the inputs, so faces can be split among threads.
+  //   Every vertex looks at every face, so even small meshes are worth it.
+  std::vector<Vector3> vertexNormals (faces.size () * 3);
+  JobSystem::getGlobal ().parallelFor (faces.size (), 16, [&] (size_t begin, size_t end)
   {
-    for (unsigned int vertexIndex = 0; vertexIndex < 3; vertexIndex++)
+    for (size_t faceIndex = begin; faceIndex < end; faceIndex++)
     {
-      // We need to find *every* vertex in any triangle that is at this
-      //   position and average their face normals.
-      Vector3 vertexNormal (0.0f, 0.0f, 0.0f);
-      for (unsigned int otherFaceIndex = 0; otherFaceIndex < faces.size (); otherFaceIndex++)
+      for (unsigned int vertexIndex = 0; vertexIndex < 3; vertexIndex++)
       {
-	for (unsigned int otherVertexIndex = 0; otherVertexIndex < 3; otherVertexIndex++ )
+	// We need to find *every* vertex in any triangle that is at this
+	//   position and average their face normals.
+	Vector3 vertexNormal (0.0f, 0.0f, 0.0f);
+	for (unsigned int otherFaceIndex = 0; otherFaceIndex < faces.size (); otherFaceIndex++)
 	{
-	  if (faces[faceIndex][vertexIndex] == faces[otherFaceIndex][otherVertexIndex])
+	  for (unsigned int otherVertexIndex = 0; otherVertexIndex < 3; otherVertexIndex++ )
 	  {
-	    // Hey, we derived this formula in Lecture 04!
-	    float area = 0.5f * ((faces[otherFaceIndex][1] - faces[otherFaceIndex][0]).cross (faces[otherFaceIndex][2] - faces[otherFaceIndex][0])).length ();
-	    unsigned int oppositeIndexA = (otherVertexIndex + 1) % 3;
-	    unsigned int oppositeIndexB = (otherVertexIndex + 2) % 3;
-	    float angle = (faces[otherFaceIndex][oppositeIndexA] - faces[otherFaceIndex][otherVertexIndex]).angleBetween (faces[otherFaceIndex][oppositeIndexB] - faces[otherFaceIndex][otherVertexIndex]);
-	    // Weighting the average by area makes it so that lots of smaller
-	    //   faces don't overwhelm a few larger faces.
-	    // Weighting the average by angle makes it so that points where
-	    //   two 45 degree angles and points where one 90 degree angle meet
-	    //   get the same treatment.
-	    vertexNormal += faceNormals[otherFaceIndex] * fabs (area) * fabs (angle);
+	    if (faces[faceIndex][vertexIndex] == faces[otherFaceIndex][otherVertexIndex])
+	    {
+	      // Hey, we derived this formula in Lecture 04!
+	      float area = 0.5f * ((faces[otherFaceIndex][1] - faces[otherFaceIndex][0]).cross (faces[otherFaceIndex][2] - faces[otherFaceIndex][0])).length ();
+	      unsigned int oppositeIndexA = (otherVertexIndex + 1) % 3;
+	      unsigned int oppositeIndexB = (otherVertexIndex + 2) % 3;
+	      float angle = (faces[otherFaceIndex][oppositeIndexA] - faces[otherFaceIndex][otherVertexIndex]).angleBetween (faces[otherFaceIndex][oppositeIndexB] - faces[otherFaceIndex][otherVertexIndex]);
+	      // Weighting the average by area makes it so that lots of smaller
+	      //   faces don't overwhelm a few larger faces.
+	      // Weighting the average by angle makes it so that points where
+	      //   two 45 degree angles and points where one 90 degree angle meet
+	      //   get the same treatment.
+	      vertexNormal += faceNormals[otherFaceIndex] * fabs (area) * fabs (angle);
+	    }
 	  }
 	}
+	vertexNormal.normalize ();
+	vertexNormals[faceIndex * 3 + vertexIndex] = vertexNormal;
       }
-      vertexNormal.normalize ();
-      vertexNormals.push_back (vertexNormal);
     }
-  }
+  });
   return vertexNormals;
 }
 
@@ -265,3 +275,25 @@ buildCube ()
   triangles.push_back ((Triangle){Vector3 (0.5f, -0.5f, -0.5f), Vector3 (0.5f, -0.5f, 0.5f), Vector3 (-0.5f, -0.5f, -0.5f)});
   return triangles;
 }
+
+void
+extractFrustumPlanes (const Matrix4& viewProjection, FrustumPlanes planes)
+{
+  const float* clip = viewProjection.data ();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    for (int k = 0; k < 4; ++k)
+    {
+      planes[axis * 2][k] = clip[k * 4 + 3] + clip[k * 4 + axis];
+      planes[axis * 2 + 1][k] = clip[k * 4 + 3] - clip[k * 4 + axis];
+    }
+  }
+  for (int plane = 0; plane < 6; ++plane)
+  {
+    float length = std::sqrt (planes[plane][0] * planes[plane][0]
+			      + planes[plane][1] * planes[plane][1]
+			      + planes[plane][2] * planes[plane][2]);
+    for (int k = 0; k < 4; ++k)
+      planes[plane][k] /= length;
+  }
+}
@@ -3,14 +3,22 @@
 /// \author Chad Hogg
 /// \version A08
 
+#ifndef GEOMETRY_HPP
+#define GEOMETRY_HPP
+
 #include <vector>
 #include <array>
 
 #include "Vector3.hpp"
+#include "Matrix4.hpp"
 
 // A triangle consists of exactly 3 Vector3s (the coordinates of the vertices).
 using Triangle = std::array<Vector3, 3>;
 
+// The six planes of a view frustum, each (a, b, c, d) with the inside where
+//   ax + by + cz + d >= 0.
+using FrustumPlanes = float[6][4];
+
 /// \brief Indexes some geometry.
 /// \param[in] geometry A collection containing floats defining some vertices.
 /// \param[in] floatsPerVertex The number of floats used for each vertex.
@@ -105,3 +113,14 @@ dataWithVertexNormals (const std::vector<Triangle>& faces,
 /// \return A collection of triangles in a unit cube, centered on the origin.
 std::vector<Triangle>
 buildCube ();
+
+/// \brief Extracts the planes of a view frustum, as in Gribb & Hartmann,
+///   "Fast Extraction of Viewing Frustum Planes from the
+///   World-View-Projection Matrix".
+/// \param[in] viewProjection The projection matrix times the view matrix.
+/// \param[out] planes The left, right, bottom, top, near and far planes,
+///   normalized.
+void
+extractFrustumPlanes (const Matrix4& viewProjection, FrustumPlanes planes);
+
+#endif//GEOMETRY_HPP
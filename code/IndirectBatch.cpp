@@ -0,0 +1,224 @@
+/// \file IndirectBatch.cpp
+/// \brief Definitions of IndirectBatch class member functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+
+#include "IndirectBatch.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+  // Where GeneralShader.vert and GeneralShader.frag read per-draw data
+  //   instead of uniforms.
+  const ShaderProgram::Defines INDIRECT_DEFINES = { { "INDIRECT_DRAW", "1" } };
+
+  // Sets the uniforms that every draw of a frame shares.
+  void
+  setFrameUniforms (ShaderProgram& program, const Transform& viewMatrix,
+		    const Matrix4& projectionMatrix, const Vector3& eyePosition)
+  {
+    program.setUniformMatrix ("uProjection", projectionMatrix);
+    program.setUniformMatrix ("uView", viewMatrix.getTransform ());
+    program.setUniformVec3 ("uEyePosition", eyePosition);
+  }
+}
+
+IndirectBatch::IndirectBatch (OpenGLContext* context, BufferArena& arena,
+			      bool multiDraw)
+  : m_context (context), m_arena (arena), m_multiDraw (multiDraw),
+    m_commandBuffer (0), m_drawBuffer (0)
+{
+  if (!m_multiDraw)
+    return;
+  m_context->genBuffers (1, &m_commandBuffer);
+  m_context->genBuffers (1, &m_drawBuffer);
+  // Each draw command's base instance picks its element of the draw data.
+  m_context->bindVertexArray (m_arena.getVertexArray ());
+  m_context->bindBuffer (GL_ARRAY_BUFFER, m_drawBuffer);
+  for (GLuint column = 0; column < 4; ++column)
+  {
+    m_context->enableVertexAttribArray (WORLD_ATTRIBUTE + column);
+    m_context->vertexAttribPointer (WORLD_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE,
+				    sizeof(DrawData),
+				    reinterpret_cast<void*> (offsetof (DrawData, world)
+							     + column * 4 * sizeof(float)));
+    m_context->vertexAttribDivisor (WORLD_ATTRIBUTE + column, 1);
+  }
+  m_context->enableVertexAttribArray (MATERIAL_ATTRIBUTE);
+  m_context->vertexAttribIPointer (MATERIAL_ATTRIBUTE, 1, GL_UNSIGNED_INT,
+				   sizeof(DrawData),
+				   reinterpret_cast<void*> (offsetof (DrawData, material)));
+  m_context->vertexAttribDivisor (MATERIAL_ATTRIBUTE, 1);
+  m_context->bindVertexArray (0);
+}
+
+IndirectBatch::~IndirectBatch ()
+{
+  if (m_multiDraw)
+  {
+    m_context->deleteBuffers (1, &m_commandBuffer);
+    m_context->deleteBuffers (1, &m_drawBuffer);
+  }
+}
+
+bool
+IndirectBatch::supportsMultiDraw (OpenGLContext& context)
+{
+  const GLubyte* version = context.getString (GL_VERSION);
+  int major = 0;
+  int minor = 0;
+  if (version == nullptr
+      || sscanf (reinterpret_cast<const char*> (version), "%d.%d", &major, &minor) != 2)
+    return false;
+  return major > 4 || (major == 4 && minor >= 3);
+}
+
+ShaderProgram*
+IndirectBatch::getMultiDrawVariant (ShaderProgram* program)
+{
+  return program->getVariant (INDIRECT_DEFINES);
+}
+
+void
+IndirectBatch::clear ()
+{
+  m_commands.clear ();
+  m_drawData.clear ();
+  m_runs.clear ();
+}
+
+bool
+IndirectBatch::add (ShaderProgram* program, const ArenaRange& range,
+		    const Transform& world, const Material& material)
+{
+  size_t materialIndex = std::find (m_materials.begin (), m_materials.end (), material)
+    - m_materials.begin ();
+  if (materialIndex == m_materials.size ())
+  {
+    if (m_multiDraw && m_materials.size () == MAX_MATERIALS)
+      return false;
+    m_materials.push_back (material);
+  }
+
+  DrawElementsIndirectCommand command;
+  command.count = range.indexCount;
+  command.instanceCount = 1;
+  command.firstIndex = range.firstIndex;
+  command.baseVertex = range.baseVertex;
+  command.baseInstance = m_commands.size ();
+  m_commands.push_back (command);
+
+  DrawData draw;
+  world.getTransform (draw.world);
+  draw.material = materialIndex;
+  m_drawData.push_back (draw);
+
+  if (m_runs.empty () || m_runs.back ().program != program)
+    m_runs.push_back ({ program, m_commands.size () - 1, 0 });
+  ++m_runs.back ().count;
+  return true;
+}
+
+void
+IndirectBatch::submit (const Transform& viewMatrix, const Matrix4& projectionMatrix,
+		       const Vector3& eyePosition)
+{
+  if (m_commands.empty ())
+    return;
+  PROFILE_SCOPE ("IndirectBatch::submit");
+  if (m_multiDraw)
+  {
+    // Both buffers are respecified every frame, so the driver can give them
+    //   new storage instead of waiting for last frame's draws.
+    m_context->bindBuffer (GL_ARRAY_BUFFER, m_drawBuffer);
+    m_context->bufferData (GL_ARRAY_BUFFER, m_drawData.size () * sizeof(DrawData),
+			   m_drawData.data (), GL_STREAM_DRAW);
+    m_context->bindBuffer (GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    m_context->bufferData (GL_DRAW_INDIRECT_BUFFER,
+			   m_commands.size () * sizeof(DrawElementsIndirectCommand),
+			   m_commands.data (), GL_STREAM_DRAW);
+  }
+  m_context->bindVertexArray (m_arena.getVertexArray ());
+  for (const Run& run : m_runs)
+  {
+    if (m_multiDraw)
+      submitMultiDraw (run, viewMatrix, projectionMatrix, eyePosition);
+    else
+      submitEach (run, viewMatrix, projectionMatrix, eyePosition);
+  }
+}
+
+const BufferArena&
+IndirectBatch::getArena () const
+{
+  return m_arena;
+}
+
+bool
+IndirectBatch::isMultiDraw () const
+{
+  return m_multiDraw;
+}
+
+const std::vector<DrawElementsIndirectCommand>&
+IndirectBatch::getCommands () const
+{
+  return m_commands;
+}
+
+const std::vector<DrawData>&
+IndirectBatch::getDrawData () const
+{
+  return m_drawData;
+}
+
+void
+IndirectBatch::submitMultiDraw (const Run& run, const Transform& viewMatrix,
+				const Matrix4& projectionMatrix,
+				const Vector3& eyePosition)
+{
+  ShaderProgram* program = getMultiDrawVariant (run.program);
+  program->enable ();
+  setFrameUniforms (*program, viewMatrix, projectionMatrix, eyePosition);
+  // The table only grows, so a variant already holds the materials it was
+  //   given before.
+  size_t& uploaded = m_uploadedMaterials[program];
+  for (; uploaded < m_materials.size (); ++uploaded)
+    m_materials[uploaded].setShader (*program, uploaded);
+  m_context->multiDrawElementsIndirect (GL_TRIANGLES, GL_UNSIGNED_INT,
+					reinterpret_cast<const void*> (run.first * sizeof(DrawElementsIndirectCommand)),
+					run.count, 0);
+}
+
+void
+IndirectBatch::submitEach (const Run& run, const Transform& viewMatrix,
+			   const Matrix4& projectionMatrix, const Vector3& eyePosition)
+{
+  run.program->enable ();
+  setFrameUniforms (*run.program, viewMatrix, projectionMatrix, eyePosition);
+  Matrix4 view = viewMatrix.getTransform ();
+  // Other programs may have been given other materials since this one was
+  //   last used, so the first draw always sets its own.
+  size_t material = m_materials.size ();
+  for (size_t draw = run.first; draw < run.first + run.count; ++draw)
+  {
+    const DrawData& data = m_drawData[draw];
+    Matrix4 world;
+    std::copy (data.world, data.world + 16, world.data ());
+    run.program->setUniformMatrix ("uModelView", view * world);
+    run.program->setUniformMatrix ("uWorld", world);
+    if (data.material != material)
+    {
+      material = data.material;
+      m_materials[material].setShader (*run.program);
+    }
+    const DrawElementsIndirectCommand& command = m_commands[draw];
+    m_context->drawElementsBaseVertex (GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+				       reinterpret_cast<void*> (command.firstIndex * sizeof(unsigned int)),
+				       command.baseVertex);
+  }
+}
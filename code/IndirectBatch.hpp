@@ -0,0 +1,178 @@
+/// \file IndirectBatch.hpp
+/// \brief Declaration of IndirectBatch class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef INDIRECT_BATCH_HPP
+#define INDIRECT_BATCH_HPP
+
+#include <map>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "BufferArena.hpp"
+#include "ShaderProgram.hpp"
+#include "Material.hpp"
+#include "Transform.hpp"
+#include "Matrix4.hpp"
+#include "Vector3.hpp"
+
+/// \brief What the INDIRECT_DRAW variant of GeneralShader reads for each
+///   draw of an IndirectBatch, as instanced attributes.
+struct DrawData
+{
+  /// The world matrix, column by column.
+  float world[16];
+  /// The draw's element of the batch's material table.
+  GLuint material;
+};
+
+/// \brief Draws many Meshes of one BufferArena with as few driver calls as
+///   possible.
+///
+/// Each frame, the visible Meshes are added with Mesh::addTo, which builds
+///   a DrawElementsIndirectCommand and a DrawData for each, and submit then
+///   draws them.  Where glMultiDrawElementsIndirect is available (OpenGL
+///   4.3), the commands and draw data are uploaded and every run of draws
+///   that share a ShaderProgram goes out in one call.  The draw data are
+///   instanced attributes of the arena's VAO, and each command's base
+///   instance is its own index, so each draw finds its world matrix and
+///   material.  Otherwise the same commands are drawn one by one with
+///   glDrawElementsBaseVertex, setting uniforms between them.
+///
+/// Materials are kept in a table that lasts between frames, so that each
+///   program only needs each material uploaded once.
+class IndirectBatch
+{
+public:
+
+  /// The number of materials the table holds, which matches MAX_MATERIALS
+  ///   in GeneralShader.frag.
+  static const unsigned int MAX_MATERIALS = 16;
+
+  /// The first of the four attribute locations the world matrix uses.
+  static const GLuint WORLD_ATTRIBUTE = 3;
+
+  /// The attribute location of the material index.
+  static const GLuint MATERIAL_ATTRIBUTE = 7;
+
+  /// \brief Constructs an empty IndirectBatch.
+  /// \param[in] context The object through which to make OpenGL calls.
+  /// \param[inout] arena The arena whose Meshes this draws, which outlives
+  ///   this batch.
+  /// \param[in] multiDraw Whether to use glMultiDrawElementsIndirect, such
+  ///   as supportsMultiDraw tells.
+  /// \post If multiDraw, the command and draw data buffers have been
+  ///   generated and the arena's VAO reads the draw data.
+  IndirectBatch (OpenGLContext* context, BufferArena& arena, bool multiDraw);
+
+  /// \brief Destructs an IndirectBatch, deleting its buffers.
+  ~IndirectBatch ();
+
+  /// Copy constructor deleted because an IndirectBatch owns OpenGL objects.
+  IndirectBatch (const IndirectBatch&) = delete;
+
+  /// Assignment operator deleted because an IndirectBatch owns OpenGL
+  ///   objects.
+  IndirectBatch&
+  operator= (const IndirectBatch&) = delete;
+
+  /// \brief Tells whether a context can draw with
+  ///   glMultiDrawElementsIndirect.
+  /// \param[in] context The context to ask.
+  /// \return Whether or not its GL_VERSION is at least 4.3.
+  static bool
+  supportsMultiDraw (OpenGLContext& context);
+
+  /// \brief Gets the variant of a program that multi-draws use, which reads
+  ///   world matrices and materials per draw instead of from uniforms.
+  /// \param[inout] program A program made from GeneralShader, or a variant
+  ///   of it.
+  /// \return Its variant with INDIRECT_DRAW defined, whose other uniforms,
+  ///   such as lights, must be set like the program's.
+  static ShaderProgram*
+  getMultiDrawVariant (ShaderProgram* program);
+
+  /// \brief Removes every draw, to start a new frame.
+  /// \post There are no draws, but the material table is kept.
+  void
+  clear ();
+
+  /// \brief Adds one draw.
+  /// \param[in] program The ShaderProgram to draw with.
+  /// \param[in] range Where the geometry and indices are in the arena.
+  /// \param[in] world The world matrix.
+  /// \param[in] material The material.
+  /// \return Whether or not the draw was added, which it is not if the
+  ///   material table is full.
+  bool
+  add (ShaderProgram* program, const ArenaRange& range, const Transform& world,
+       const Material& material);
+
+  /// \brief Draws every draw added since the last clear.
+  /// \param[in] viewMatrix The view matrix.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  /// \post The draws have been made, in the order they were added.
+  void
+  submit (const Transform& viewMatrix, const Matrix4& projectionMatrix,
+	  const Vector3& eyePosition);
+
+  /// \brief Gets the arena this batch draws from.
+  /// \return The arena given to the constructor.
+  const BufferArena&
+  getArena () const;
+
+  /// \brief Tells whether submit uses glMultiDrawElementsIndirect.
+  /// \return The multiDraw given to the constructor.
+  bool
+  isMultiDraw () const;
+
+  /// \brief Gets the commands added since the last clear.
+  /// \return One command per draw, in order.
+  const std::vector<DrawElementsIndirectCommand>&
+  getCommands () const;
+
+  /// \brief Gets the draw data added since the last clear.
+  /// \return One element per draw, in order.
+  const std::vector<DrawData>&
+  getDrawData () const;
+
+private:
+
+  /// Draws in a row that share a ShaderProgram.
+  struct Run
+  {
+    ShaderProgram* program;
+    size_t first;
+    size_t count;
+  };
+
+  /// \brief Draws one run with glMultiDrawElementsIndirect.
+  void
+  submitMultiDraw (const Run& run, const Transform& viewMatrix,
+		   const Matrix4& projectionMatrix, const Vector3& eyePosition);
+
+  /// \brief Draws one run with a glDrawElementsBaseVertex per draw.
+  void
+  submitEach (const Run& run, const Transform& viewMatrix,
+	      const Matrix4& projectionMatrix, const Vector3& eyePosition);
+
+  OpenGLContext* m_context;
+  BufferArena& m_arena;
+  bool m_multiDraw;
+  /// The buffers for the commands and for the draw data, or 0 if not
+  ///   m_multiDraw.
+  GLuint m_commandBuffer;
+  GLuint m_drawBuffer;
+  std::vector<DrawElementsIndirectCommand> m_commands;
+  std::vector<DrawData> m_drawData;
+  std::vector<Run> m_runs;
+  std::vector<Material> m_materials;
+  /// How many of m_materials each INDIRECT_DRAW variant has been given.
+  std::map<ShaderProgram*, size_t> m_uploadedMaterials;
+};
+
+#endif//INDIRECT_BATCH_HPP
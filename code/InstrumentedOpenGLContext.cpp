@@ -0,0 +1,563 @@
+/// \file InstrumentedOpenGLContext.cpp
+/// \brief Definitions of InstrumentedOpenGLContext member and associated
+///   global functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cstring>
+
+#include "InstrumentedOpenGLContext.hpp"
+
+namespace
+{
+  // The number of triangles a draw call with "count" vertices produces.
+  unsigned long
+  countTriangles (GLenum mode, GLsizei count)
+  {
+    switch (mode)
+    {
+    case GL_TRIANGLES:
+      return count / 3;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+      return (count > 2) ? count - 2 : 0;
+    default:
+      return 0;
+    }
+  }
+
+  void
+  addCounts (GlCallCounts& sum, const GlCallCounts& counts)
+  {
+    sum.calls += counts.calls;
+    sum.draws += counts.draws;
+    sum.triangles += counts.triangles;
+    sum.bufferBytes += counts.bufferBytes;
+    sum.uniformUploads += counts.uniformUploads;
+    sum.programBinds += counts.programBinds;
+    sum.vertexArrayBinds += counts.vertexArrayBinds;
+    sum.shaderCompiles += counts.shaderCompiles;
+    sum.filteredCalls += counts.filteredCalls;
+  }
+}
+
+InstrumentedOpenGLContext::InstrumentedOpenGLContext (OpenGLContext* context)
+  : m_context (context), m_current (), m_previous (), m_total (), m_frame (0),
+    m_drawIndirectBuffer (0)
+{
+}
+
+InstrumentedOpenGLContext::~InstrumentedOpenGLContext ()
+{
+  delete m_context;
+}
+
+bool
+InstrumentedOpenGLContext::openCsv (const std::string& fileName)
+{
+  m_csv.open (fileName);
+  if (!m_csv)
+    return false;
+  m_csv << "frame,calls,draws,triangles,bufferBytes,uniformUploads,"
+	<< "programBinds,vertexArrayBinds,shaderCompiles,filteredCalls\n";
+  return true;
+}
+
+void
+InstrumentedOpenGLContext::addFilteredCalls (unsigned long count)
+{
+  m_current.filteredCalls += count;
+}
+
+void
+InstrumentedOpenGLContext::endFrame ()
+{
+  if (m_csv.is_open ())
+    m_csv << m_frame << ',' << m_current.calls << ',' << m_current.draws << ','
+	  << m_current.triangles << ',' << m_current.bufferBytes << ','
+	  << m_current.uniformUploads << ',' << m_current.programBinds << ','
+	  << m_current.vertexArrayBinds << ',' << m_current.shaderCompiles << ','
+	  << m_current.filteredCalls << '\n';
+  addCounts (m_total, m_current);
+  m_previous = m_current;
+  m_current = GlCallCounts ();
+  ++m_frame;
+}
+
+const GlCallCounts&
+InstrumentedOpenGLContext::getCurrentCounts () const
+{
+  return m_current;
+}
+
+const GlCallCounts&
+InstrumentedOpenGLContext::getPreviousCounts () const
+{
+  return m_previous;
+}
+
+const GlCallCounts&
+InstrumentedOpenGLContext::getTotalCounts () const
+{
+  return m_total;
+}
+
+unsigned long
+InstrumentedOpenGLContext::getFrameNumber () const
+{
+  return m_frame;
+}
+
+OpenGLContext*
+InstrumentedOpenGLContext::getWrappedContext () const
+{
+  return m_context;
+}
+
+
+void
+InstrumentedOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  ++m_current.calls;
+  m_context->attachShader (program, shader);
+}
+
+void
+InstrumentedOpenGLContext::beginQuery (GLenum target, GLuint id)
+{
+  ++m_current.calls;
+  m_context->beginQuery (target, id);
+}
+
+void
+InstrumentedOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  ++m_current.calls;
+  if (target == GL_DRAW_INDIRECT_BUFFER)
+    m_drawIndirectBuffer = buffer;
+  m_context->bindBuffer (target, buffer);
+}
+
+void
+InstrumentedOpenGLContext::bindVertexArray (GLuint array)
+{
+  ++m_current.calls;
+  ++m_current.vertexArrayBinds;
+  m_context->bindVertexArray (array);
+}
+
+void
+InstrumentedOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  ++m_current.calls;
+  m_current.bufferBytes += size;
+  if (target == GL_DRAW_INDIRECT_BUFFER)
+  {
+    std::vector<GLubyte>& commands = m_indirectCommands[m_drawIndirectBuffer];
+    commands.assign (size, 0);
+    if (data != nullptr)
+      std::memcpy (commands.data (), data, size);
+  }
+  m_context->bufferData (target, size, data, usage);
+}
+
+void
+InstrumentedOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  ++m_current.calls;
+  m_current.bufferBytes += size;
+  if (target == GL_DRAW_INDIRECT_BUFFER)
+  {
+    std::vector<GLubyte>& commands = m_indirectCommands[m_drawIndirectBuffer];
+    if (offset >= 0 && static_cast<size_t> (offset + size) <= commands.size ())
+      std::memcpy (commands.data () + offset, data, size);
+  }
+  m_context->bufferSubData (target, offset, size, data);
+}
+
+void
+InstrumentedOpenGLContext::clear (GLbitfield mask)
+{
+  ++m_current.calls;
+  m_context->clear (mask);
+}
+
+void
+InstrumentedOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  ++m_current.calls;
+  m_context->clearColor (red, green, blue, alpha);
+}
+
+GLenum
+InstrumentedOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  ++m_current.calls;
+  return m_context->clientWaitSync (sync, flags, timeout);
+}
+
+void
+InstrumentedOpenGLContext::compileShader (GLuint shader)
+{
+  ++m_current.calls;
+  ++m_current.shaderCompiles;
+  m_context->compileShader (shader);
+}
+
+void
+InstrumentedOpenGLContext::copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+  ++m_current.calls;
+  m_context->copyBufferSubData (readTarget, writeTarget, readOffset, writeOffset, size);
+}
+
+GLuint
+InstrumentedOpenGLContext::createProgram ()
+{
+  ++m_current.calls;
+  return m_context->createProgram ();
+}
+
+GLuint
+InstrumentedOpenGLContext::createShader (GLenum shaderType)
+{
+  ++m_current.calls;
+  return m_context->createShader (shaderType);
+}
+
+void
+InstrumentedOpenGLContext::cullFace (GLenum mode)
+{
+  ++m_current.calls;
+  m_context->cullFace (mode);
+}
+
+void
+InstrumentedOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  ++m_current.calls;
+  for (GLsizei i = 0; i < n; ++i)
+    m_indirectCommands.erase (buffers[i]);
+  m_context->deleteBuffers (n, buffers);
+}
+
+void
+InstrumentedOpenGLContext::deleteProgram (GLuint program)
+{
+  ++m_current.calls;
+  m_context->deleteProgram (program);
+}
+
+void
+InstrumentedOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  ++m_current.calls;
+  m_context->deleteQueries (n, ids);
+}
+
+void
+InstrumentedOpenGLContext::deleteShader (GLuint shader)
+{
+  ++m_current.calls;
+  m_context->deleteShader (shader);
+}
+
+void
+InstrumentedOpenGLContext::deleteSync (GLsync sync)
+{
+  ++m_current.calls;
+  m_context->deleteSync (sync);
+}
+
+void
+InstrumentedOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  ++m_current.calls;
+  m_context->deleteVertexArrays (n, arrays);
+}
+
+void
+InstrumentedOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  ++m_current.calls;
+  m_context->detachShader (program, shader);
+}
+
+void
+InstrumentedOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  ++m_current.calls;
+  ++m_current.draws;
+  m_current.triangles += countTriangles (mode, count);
+  m_context->drawArrays (mode, first, count);
+}
+
+void
+InstrumentedOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+  ++m_current.calls;
+  ++m_current.draws;
+  m_current.triangles += countTriangles (mode, count);
+  m_context->drawElements (mode, count, type, indices);
+}
+
+void
+InstrumentedOpenGLContext::drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex)
+{
+  ++m_current.calls;
+  ++m_current.draws;
+  m_current.triangles += countTriangles (mode, count);
+  m_context->drawElementsBaseVertex (mode, count, type, indices, basevertex);
+}
+
+void
+InstrumentedOpenGLContext::enable (GLenum cap)
+{
+  ++m_current.calls;
+  m_context->enable (cap);
+}
+
+void
+InstrumentedOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  ++m_current.calls;
+  m_context->enableVertexAttribArray (index);
+}
+
+void
+InstrumentedOpenGLContext::endQuery (GLenum target)
+{
+  ++m_current.calls;
+  m_context->endQuery (target);
+}
+
+GLsync
+InstrumentedOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  ++m_current.calls;
+  return m_context->fenceSync (condition, flags);
+}
+
+void
+InstrumentedOpenGLContext::flush ()
+{
+  ++m_current.calls;
+  m_context->flush ();
+}
+
+void
+InstrumentedOpenGLContext::frontFace (GLenum mode)
+{
+  ++m_current.calls;
+  m_context->frontFace (mode);
+}
+
+void
+InstrumentedOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  ++m_current.calls;
+  m_context->genBuffers (n, buffers);
+}
+
+void
+InstrumentedOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  ++m_current.calls;
+  m_context->genQueries (n, ids);
+}
+
+void
+InstrumentedOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  ++m_current.calls;
+  m_context->genVertexArrays (n, arrays);
+}
+
+GLint
+InstrumentedOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  ++m_current.calls;
+  return m_context->getAttribLocation (program, name);
+}
+
+void
+InstrumentedOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  ++m_current.calls;
+  m_context->getProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
+void
+InstrumentedOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  ++m_current.calls;
+  m_context->getProgramInfoLog (program, maxLength, length, infoLog);
+}
+
+void
+InstrumentedOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  ++m_current.calls;
+  m_context->getProgramiv (program, pname, params);
+}
+
+void
+InstrumentedOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  ++m_current.calls;
+  m_context->getQueryObjectiv (id, pname, params);
+}
+
+void
+InstrumentedOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  ++m_current.calls;
+  m_context->getQueryObjectui64v (id, pname, params);
+}
+
+void
+InstrumentedOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  ++m_current.calls;
+  m_context->getShaderInfoLog (shader, maxLength, length, infoLog);
+}
+
+void
+InstrumentedOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  ++m_current.calls;
+  m_context->getShaderiv (shader, pname, params);
+}
+
+const GLubyte*
+InstrumentedOpenGLContext::getString (GLenum name)
+{
+  ++m_current.calls;
+  return m_context->getString (name);
+}
+
+GLint
+InstrumentedOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  ++m_current.calls;
+  return m_context->getUniformLocation (program, name);
+}
+
+void
+InstrumentedOpenGLContext::linkProgram (GLuint program)
+{
+  ++m_current.calls;
+  m_context->linkProgram (program);
+}
+
+void
+InstrumentedOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  ++m_current.calls;
+  // Commands are read from the copy of the indirect buffer kept here, so
+  //   each one is counted as the draw it stands for.
+  const std::vector<GLubyte>& commands = m_indirectCommands[m_drawIndirectBuffer];
+  size_t offset = reinterpret_cast<size_t> (indirect);
+  size_t step = (stride == 0) ? sizeof (DrawElementsIndirectCommand) : stride;
+  for (GLsizei draw = 0; draw < drawcount; ++draw, offset += step)
+  {
+    if (offset + sizeof (DrawElementsIndirectCommand) > commands.size ())
+      break;
+    DrawElementsIndirectCommand command;
+    std::memcpy (&command, commands.data () + offset, sizeof (command));
+    if (command.instanceCount == 0)
+      continue;
+    ++m_current.draws;
+    m_current.triangles += countTriangles (mode, command.count) * command.instanceCount;
+  }
+  m_context->multiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+InstrumentedOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  ++m_current.calls;
+  m_context->programBinary (program, binaryFormat, binary, length);
+}
+
+void
+InstrumentedOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  ++m_current.calls;
+  m_context->programParameteri (program, pname, value);
+}
+
+void
+InstrumentedOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  ++m_current.calls;
+  m_context->shaderSource (shader, count, string, length);
+}
+
+void
+InstrumentedOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  ++m_current.calls;
+  ++m_current.uniformUploads;
+  m_context->uniform1f (location, v0);
+}
+
+void
+InstrumentedOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  ++m_current.calls;
+  ++m_current.uniformUploads;
+  m_context->uniform1i (location, v0);
+}
+
+void
+InstrumentedOpenGLContext::uniform3fv (GLint location, GLsizei count, const GLfloat* value)
+{
+  ++m_current.calls;
+  ++m_current.uniformUploads;
+  m_context->uniform3fv (location, count, value);
+}
+
+void
+InstrumentedOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  ++m_current.calls;
+  ++m_current.uniformUploads;
+  m_context->uniformMatrix4fv (location, count, transpose, value);
+}
+
+void
+InstrumentedOpenGLContext::useProgram (GLuint program)
+{
+  ++m_current.calls;
+  ++m_current.programBinds;
+  m_context->useProgram (program);
+}
+
+void
+InstrumentedOpenGLContext::vertexAttribDivisor (GLuint index, GLuint divisor)
+{
+  ++m_current.calls;
+  m_context->vertexAttribDivisor (index, divisor);
+}
+
+void
+InstrumentedOpenGLContext::vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer)
+{
+  ++m_current.calls;
+  m_context->vertexAttribIPointer (index, size, type, stride, pointer);
+}
+
+void
+InstrumentedOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  ++m_current.calls;
+  m_context->vertexAttribPointer (index, size, type, normalized, stride, pointer);
+}
+
+void
+InstrumentedOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  ++m_current.calls;
+  m_context->viewport (x, y, width, height);
+}
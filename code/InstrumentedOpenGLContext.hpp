@@ -0,0 +1,305 @@
+/// \file InstrumentedOpenGLContext.hpp
+/// \brief Declaration of InstrumentedOpenGLContext and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef INSTRUMENTED_OPENGL_CONTEXT_HPP
+#define INSTRUMENTED_OPENGL_CONTEXT_HPP
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief The number of OpenGL calls of each interesting kind made during one
+///   frame.
+struct GlCallCounts
+{
+  /// Every call made through the context, of any kind.
+  unsigned long calls;
+  /// glDrawArrays and glDrawElements calls, plus each command of a
+  ///   glMultiDrawElementsIndirect.
+  unsigned long draws;
+  /// Triangles those draw calls submitted.
+  unsigned long triangles;
+  /// Bytes passed to glBufferData and glBufferSubData.
+  unsigned long bufferBytes;
+  /// glUniform* calls.
+  unsigned long uniformUploads;
+  /// glUseProgram calls.
+  unsigned long programBinds;
+  /// glBindVertexArray calls.
+  unsigned long vertexArrayBinds;
+  /// glCompileShader calls.
+  unsigned long shaderCompiles;
+  /// Calls the wrapped context reported it did not pass on to OpenGL.
+  unsigned long filteredCalls;
+};
+
+/// \brief A subclass of OpenGLContext that counts the calls made through it
+///   before passing them on to another OpenGLContext.
+///
+/// Counts accumulate until endFrame is called, at which point they become the
+///   previous frame's counts and are optionally appended to a CSV file.  No
+///   GPU is needed to get meaningful numbers, so these are a cheap way to
+///   notice when a change makes us talk to the driver more than we used to.
+class InstrumentedOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// \brief Constructs an InstrumentedOpenGLContext.
+  /// \param[in] context The context that calls are passed on to.  This
+  ///   object takes ownership of it.
+  /// \post All counts are zero and the frame number is zero.
+  InstrumentedOpenGLContext (OpenGLContext* context);
+
+  /// \brief Destructs an InstrumentedOpenGLContext.
+  /// \post The wrapped context has been deleted and any CSV file closed.
+  virtual
+  ~InstrumentedOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   InstrumentedOpenGLContexts.
+  InstrumentedOpenGLContext (const InstrumentedOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   InstrumentedOpenGLContexts.
+  InstrumentedOpenGLContext&
+  operator= (const InstrumentedOpenGLContext&) = delete;
+
+  /// \brief Starts writing one line per frame to a CSV file.
+  /// \param[in] fileName The name of the file to create.
+  /// \return Whether or not the file could be opened.
+  /// \post If successful, a header line has been written to the file.
+  bool
+  openCsv (const std::string& fileName);
+
+  /// \brief Records calls the wrapped context filtered out during the
+  ///   current frame, since only it can tell which calls were redundant.
+  /// \param[in] count The number of calls filtered.
+  /// \post The current frame's filtered call count includes count.
+  void
+  addFilteredCalls (unsigned long count);
+
+  /// \brief Finishes the current frame.
+  /// \post The current counts have become the previous frame's counts, been
+  ///   written to the CSV file if there is one, and been reset to zero.
+  void
+  endFrame ();
+
+  /// \brief Gets the counts for the frame in progress.
+  /// \return The calls made since the last endFrame.
+  const GlCallCounts&
+  getCurrentCounts () const;
+
+  /// \brief Gets the counts for the most recently finished frame.
+  /// \return The calls made between the last two calls to endFrame.
+  const GlCallCounts&
+  getPreviousCounts () const;
+
+  /// \brief Gets the counts summed over every finished frame.
+  /// \return The calls made before the last endFrame.
+  const GlCallCounts&
+  getTotalCounts () const;
+
+  /// \brief Gets the number of frames that have been finished.
+  /// \return The number of times endFrame has been called.
+  unsigned long
+  getFrameNumber () const;
+
+  /// \brief Gets the context calls are passed on to.
+  /// \return The wrapped context.
+  OpenGLContext*
+  getWrappedContext () const;
+
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  beginQuery (GLenum target, GLuint id);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
+  virtual void
+  drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual void
+  endQuery (GLenum target);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  flush ();
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3fv (GLint location, GLsizei count, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexAttribDivisor (GLuint index, GLuint divisor);
+
+  virtual void
+  vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// The context that does the real work.
+  OpenGLContext* m_context;
+  GlCallCounts m_current;
+  GlCallCounts m_previous;
+  GlCallCounts m_total;
+  unsigned long m_frame;
+  std::ofstream m_csv;
+  GLuint m_drawIndirectBuffer;
+  /// What was uploaded to each buffer bound to GL_DRAW_INDIRECT_BUFFER,
+  ///   since the wrapped context cannot be asked for it.
+  std::map<GLuint, std::vector<GLubyte>> m_indirectCommands;
+};
+
+#endif//INSTRUMENTED_OPENGL_CONTEXT_HPP
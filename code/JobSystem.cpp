@@ -0,0 +1,356 @@
+/// \file JobSystem.cpp
+/// \brief Definitions of JobSystem class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <string>
+
+#include "JobSystem.hpp"
+#include "TraceRecorder.hpp"
+
+/// \brief One unit of work.
+struct Job
+{
+  std::function<void ()> work;
+  JobCounter* counter;
+};
+
+/// \brief A fixed-capacity Chase-Lev work-stealing deque of jobs.
+///
+/// Only the owning thread may push and pop, at the bottom; any thread may
+///   steal from the top.  The memory orderings follow Le et al., "Correct and
+///   Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+class WorkStealingDeque
+{
+public:
+
+  WorkStealingDeque ()
+    : m_top (0), m_bottom (0), m_slots (CAPACITY)
+  {
+  }
+
+  /// Returns false, without pushing, if the deque is full.
+  bool
+  push (Job* job)
+  {
+    long bottom = m_bottom.load (std::memory_order_relaxed);
+    long top = m_top.load (std::memory_order_acquire);
+    if (bottom - top >= static_cast<long> (CAPACITY))
+      return false;
+    m_slots[bottom & (CAPACITY - 1)].store (job, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    m_bottom.store (bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  Job*
+  pop ()
+  {
+    long bottom = m_bottom.load (std::memory_order_relaxed) - 1;
+    m_bottom.store (bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    long top = m_top.load (std::memory_order_relaxed);
+    if (top > bottom)
+    {
+      m_bottom.store (bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Job* job = m_slots[bottom & (CAPACITY - 1)].load (std::memory_order_relaxed);
+    if (top == bottom)
+    {
+      // The last job: race any thieves for it.
+      if (!m_top.compare_exchange_strong (top, top + 1, std::memory_order_seq_cst,
+					  std::memory_order_relaxed))
+	job = nullptr;
+      m_bottom.store (bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  Job*
+  steal ()
+  {
+    long top = m_top.load (std::memory_order_acquire);
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    long bottom = m_bottom.load (std::memory_order_acquire);
+    if (top >= bottom)
+      return nullptr;
+    Job* job = m_slots[top & (CAPACITY - 1)].load (std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong (top, top + 1, std::memory_order_seq_cst,
+					std::memory_order_relaxed))
+      return nullptr;
+    return job;
+  }
+
+private:
+
+  /// Must be a power of two.
+  static const size_t CAPACITY = 4096;
+
+  std::atomic<long> m_top;
+  std::atomic<long> m_bottom;
+  std::vector<std::atomic<Job*>> m_slots;
+};
+
+namespace
+{
+  // Which JobSystem, if any, owns the current thread as a worker.
+  thread_local const JobSystem* t_system = nullptr;
+  thread_local unsigned int t_index = 0;
+
+  // Picks victims to steal from.
+  thread_local unsigned int t_random = 2463534242u;
+
+  unsigned int
+  nextRandom ()
+  {
+    t_random ^= t_random << 13;
+    t_random ^= t_random >> 17;
+    t_random ^= t_random << 5;
+    return t_random;
+  }
+
+  std::unique_ptr<JobSystem>&
+  globalSystem ()
+  {
+    static std::unique_ptr<JobSystem> system;
+    return system;
+  }
+}
+
+JobCounter::JobCounter ()
+  : m_count (0)
+{
+}
+
+bool
+JobCounter::isDone () const
+{
+  return m_count.load (std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem (unsigned int numThreads)
+  : m_owner (std::this_thread::get_id ()), m_pending (0), m_sleepers (0),
+    m_stopping (false)
+{
+  if (numThreads == 0)
+    numThreads = std::max (1u, std::thread::hardware_concurrency ());
+  for (unsigned int i = 0; i < numThreads; ++i)
+    m_deques.push_back (std::unique_ptr<WorkStealingDeque> (new WorkStealingDeque ()));
+  for (unsigned int i = 1; i < numThreads; ++i)
+    m_workers.push_back (std::thread (&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_sleepMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all ();
+  for (std::thread& worker : m_workers)
+    worker.join ();
+}
+
+JobSystem&
+JobSystem::getGlobal ()
+{
+  std::unique_ptr<JobSystem>& system = globalSystem ();
+  if (!system)
+    system.reset (new JobSystem ());
+  return *system;
+}
+
+void
+JobSystem::resetGlobal (unsigned int numThreads)
+{
+  std::unique_ptr<JobSystem>& system = globalSystem ();
+  system.reset ();
+  system.reset (new JobSystem (numThreads));
+}
+
+unsigned int
+JobSystem::getThreadCount () const
+{
+  return m_deques.size ();
+}
+
+void
+JobSystem::run (std::function<void ()> work, JobCounter* counter)
+{
+  if (counter != nullptr)
+    counter->m_count.fetch_add (1, std::memory_order_relaxed);
+  push (new Job { std::move (work), counter });
+}
+
+void
+JobSystem::runAfter (JobCounter& dependency, std::function<void ()> work,
+		     JobCounter* counter)
+{
+  if (counter != nullptr)
+    counter->m_count.fetch_add (1, std::memory_order_relaxed);
+  Job* job = new Job { std::move (work), counter };
+  {
+    // Checked under the lock, so that the job is either seen by whichever
+    //   thread takes the count to zero or queued here.
+    std::lock_guard<std::mutex> lock (dependency.m_mutex);
+    if (!dependency.isDone ())
+    {
+      dependency.m_waiting.push_back (job);
+      return;
+    }
+  }
+  push (job);
+}
+
+void
+JobSystem::wait (JobCounter& counter)
+{
+  unsigned int index = threadIndex ();
+  while (!counter.isDone ())
+  {
+    Job* job = findJob (index);
+    if (job != nullptr)
+      execute (job);
+    else
+      std::this_thread::yield ();
+  }
+  // The thread that finished the last job may still hold the lock; let it
+  //   finish before counter goes away.
+  std::lock_guard<std::mutex> lock (counter.m_mutex);
+}
+
+void
+JobSystem::parallelFor (size_t count, size_t grainSize,
+			const std::function<void (size_t, size_t)>& body)
+{
+  grainSize = std::max<size_t> (grainSize, 1);
+  if (count <= grainSize || m_deques.size () == 1)
+  {
+    if (count > 0)
+      body (0, count);
+    return;
+  }
+  // Never make more ranges than it takes to give each thread a few, since
+  //   each one costs an allocation and a trip through a deque.
+  size_t ranges = std::min ((count + grainSize - 1) / grainSize, m_deques.size () * 4);
+  JobCounter counter;
+  for (size_t range = 1; range < ranges; ++range)
+  {
+    size_t begin = count * range / ranges;
+    size_t end = count * (range + 1) / ranges;
+    run ([&body, begin, end] { body (begin, end); }, &counter);
+  }
+  body (0, count / ranges);
+  wait (counter);
+}
+
+unsigned int
+JobSystem::threadIndex () const
+{
+  if (t_system == this)
+    return t_index;
+  if (std::this_thread::get_id () == m_owner)
+    return 0;
+  return NOT_OURS;
+}
+
+void
+JobSystem::push (Job* job)
+{
+  // Counted before it can be taken, so that m_pending never says there is
+  //   less work than there is.
+  m_pending.fetch_add (1);
+  unsigned int index = threadIndex ();
+  if (index == NOT_OURS)
+  {
+    std::lock_guard<std::mutex> lock (m_injectedMutex);
+    m_injected.push_back (job);
+  }
+  else if (!m_deques[index]->push (job))
+  {
+    // Our deque is full, so there is plenty for everyone else to steal.
+    m_pending.fetch_sub (1);
+    execute (job);
+    return;
+  }
+  if (m_sleepers.load () > 0)
+  {
+    std::lock_guard<std::mutex> lock (m_sleepMutex);
+    m_wake.notify_one ();
+  }
+}
+
+Job*
+JobSystem::findJob (unsigned int index)
+{
+  Job* job = (index == NOT_OURS) ? nullptr : m_deques[index]->pop ();
+  unsigned int numDeques = m_deques.size ();
+  for (unsigned int attempt = 0; job == nullptr && attempt < numDeques; ++attempt)
+  {
+    unsigned int victim = nextRandom () % numDeques;
+    if (victim != index)
+      job = m_deques[victim]->steal ();
+  }
+  if (job == nullptr)
+  {
+    std::lock_guard<std::mutex> lock (m_injectedMutex);
+    if (!m_injected.empty ())
+    {
+      job = m_injected.front ();
+      m_injected.pop_front ();
+    }
+  }
+  if (job != nullptr)
+    m_pending.fetch_sub (1);
+  return job;
+}
+
+void
+JobSystem::execute (Job* job)
+{
+  {
+    TRACE_SCOPE ("job", "job");
+    job->work ();
+  }
+  JobCounter* counter = job->counter;
+  delete job;
+  if (counter == nullptr)
+    return;
+  std::vector<Job*> released;
+  {
+    // Decremented under the lock so that a waiter, which takes the lock
+    //   after seeing zero, cannot destroy the counter while we use it.
+    std::lock_guard<std::mutex> lock (counter->m_mutex);
+    if (counter->m_count.fetch_sub (1, std::memory_order_acq_rel) == 1)
+      released.swap (counter->m_waiting);
+  }
+  for (Job* waiting : released)
+    push (waiting);
+}
+
+void
+JobSystem::workerLoop (unsigned int index)
+{
+  t_system = this;
+  t_index = index;
+  TraceRecorder::getGlobal ().setThreadName ("worker " + std::to_string (index));
+  t_random += index * 0x9E3779B9u;
+  while (true)
+  {
+    Job* job = findJob (index);
+    if (job != nullptr)
+    {
+      execute (job);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock (m_sleepMutex);
+    m_sleepers.fetch_add (1);
+    m_wake.wait (lock, [this] { return m_stopping || m_pending.load () > 0; });
+    m_sleepers.fetch_sub (1);
+    if (m_stopping)
+      return;
+  }
+}
@@ -0,0 +1,183 @@
+/// \file JobSystem.hpp
+/// \brief Declaration of JobSystem class and any associated global functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <deque>
+
+struct Job;
+class WorkStealingDeque;
+
+/// \brief Counts jobs that have not finished yet.
+///
+/// Every job started with a counter increments it, and decrements it when
+///   it finishes.  Other jobs can be made to wait for a counter to reach zero
+///   with JobSystem::runAfter, and threads can wait for it with
+///   JobSystem::wait.
+class JobCounter
+{
+public:
+
+  /// \brief Constructs a counter with no unfinished jobs.
+  JobCounter ();
+
+  /// \brief Copy constructor removed because jobs refer to their counter.
+  JobCounter (const JobCounter&) = delete;
+
+  /// \brief Assignment operator removed because jobs refer to their counter.
+  JobCounter&
+  operator= (const JobCounter&) = delete;
+
+  /// \brief Tests whether all the jobs using this counter have finished.
+  /// \return Whether or not the count is zero.
+  bool
+  isDone () const;
+
+private:
+
+  friend class JobSystem;
+
+  std::atomic<int> m_count;
+  /// Protects m_waiting.
+  std::mutex m_mutex;
+  /// Jobs that were started with runAfter and will be queued at zero.
+  std::vector<Job*> m_waiting;
+};
+
+/// \brief A pool of threads that run small jobs, balancing the load between
+///   them by work stealing.
+///
+/// Each thread owns a Chase-Lev deque.  New jobs go on the bottom of the
+///   deque of the thread that created them, which takes work back off the
+///   bottom, while idle threads steal from the top of other deques.  The
+///   thread that constructs a JobSystem counts as one of its threads: it does
+///   not run jobs on its own, but it helps with queued jobs while it waits on
+///   a JobCounter instead of blocking.  Other threads may also create jobs,
+///   which then go through a shared, locked queue.
+class JobSystem
+{
+public:
+
+  /// \brief Constructs a JobSystem and starts its worker threads.
+  /// \param[in] numThreads The total number of threads that run jobs,
+  ///   including the calling thread.  Zero means one per hardware thread.
+  JobSystem (unsigned int numThreads = 0);
+
+  /// \brief Destructs a JobSystem.
+  /// \pre No jobs are queued or running.
+  /// \post All worker threads have been joined.
+  ~JobSystem ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   JobSystems.
+  JobSystem (const JobSystem&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   JobSystems.
+  JobSystem&
+  operator= (const JobSystem&) = delete;
+
+  /// \brief Gets the JobSystem shared by the whole program, creating it with
+  ///   one thread per hardware thread if necessary.
+  /// \return The shared JobSystem.
+  static JobSystem&
+  getGlobal ();
+
+  /// \brief Replaces the JobSystem shared by the whole program.
+  /// \param[in] numThreads The number of threads the new one should use.
+  /// \pre The current shared JobSystem has no queued or running jobs.
+  /// \post getGlobal returns a JobSystem with numThreads threads, owned by
+  ///   the calling thread.
+  static void
+  resetGlobal (unsigned int numThreads);
+
+  /// \brief Gets the number of threads that run jobs.
+  /// \return The number of worker threads plus one for the owning thread.
+  unsigned int
+  getThreadCount () const;
+
+  /// \brief Queues a job.
+  /// \param[in] work What the job should do.
+  /// \param[inout] counter A counter to increment now and decrement when the
+  ///   job finishes, or nullptr.
+  void
+  run (std::function<void ()> work, JobCounter* counter = nullptr);
+
+  /// \brief Queues a job once every job using another counter has finished.
+  /// \param[inout] dependency The counter that must reach zero first.
+  /// \param[in] work What the job should do.
+  /// \param[inout] counter A counter to increment now and decrement when the
+  ///   job finishes, or nullptr.
+  void
+  runAfter (JobCounter& dependency, std::function<void ()> work,
+	    JobCounter* counter = nullptr);
+
+  /// \brief Waits for every job using a counter to finish, running queued
+  ///   jobs in the meantime.
+  /// \param[inout] counter The counter to wait for.
+  /// \post counter is zero and may be destroyed.
+  void
+  wait (JobCounter& counter);
+
+  /// \brief Calls body on consecutive ranges covering [0, count), in
+  ///   parallel, and waits for them all.
+  /// \param[in] count The number of items.
+  /// \param[in] grainSize The fewest items worth giving one call.  Ranges
+  ///   are at least about this large, and larger when there are more
+  ///   ranges than a few per thread.  Small ranges are cheap to balance but
+  ///   add scheduling overhead.
+  /// \param[in] body A function taking the beginning and end of a range.
+  ///   Calls for different ranges must not interfere with each other.
+  void
+  parallelFor (size_t count, size_t grainSize,
+	       const std::function<void (size_t, size_t)>& body);
+
+private:
+
+  /// A value of threadIndex meaning the thread is not one of ours.
+  static const unsigned int NOT_OURS = ~0u;
+
+  unsigned int
+  threadIndex () const;
+
+  void
+  push (Job* job);
+
+  Job*
+  findJob (unsigned int index);
+
+  void
+  execute (Job* job);
+
+  void
+  workerLoop (unsigned int index);
+
+  std::thread::id m_owner;
+  std::vector<std::unique_ptr<WorkStealingDeque>> m_deques;
+  std::vector<std::thread> m_workers;
+
+  /// Jobs created by threads that have no deque.
+  std::deque<Job*> m_injected;
+  std::mutex m_injectedMutex;
+
+  /// The number of jobs queued but not yet taken, used to decide whether
+  ///   idle workers may sleep.
+  std::atomic<long> m_pending;
+  std::atomic<unsigned int> m_sleepers;
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+  std::atomic<bool> m_stopping;
+};
+
+#endif//JOB_SYSTEM_HPP
@@ -41,6 +41,12 @@
       program->setUniformInt("uLights[" + std::to_string(lightNum) + "].type", 0);
   }
 
+  LightType
+  DirectionalLightSource::getType () const
+  {
+      return DIRECTIONAL;
+  }
+
 
 
 
@@ -79,6 +85,12 @@
 
   }
 
+  LightType
+  PointLightSource::getType () const
+  {
+      return POINT;
+  }
+
 
 
 
@@ -102,4 +114,42 @@
       program->setUniformFloat("uLights[" + std::to_string(lightNum) + "].falloff", m_falloff);
       program->setUniformInt("uLights[" + std::to_string(lightNum) + "].type", 2);
 
-  }
\ No newline at end of file
+  }
+
+  LightType
+  SpotLightSource::getType () const
+  {
+      return SPOT;
+  }
+
+
+
+
+
+  ShaderProgram::Defines
+  getLightDefines (const std::vector<LightSource*>& lights)
+  {
+      int counts[3] = {0, 0, 0};
+      for (const LightSource* light : lights)
+        ++counts[light->getType ()];
+      ShaderProgram::Defines defines;
+      defines["NUM_DIRECTIONAL"] = std::to_string (counts[DIRECTIONAL]);
+      defines["NUM_POINT"] = std::to_string (counts[POINT]);
+      defines["NUM_SPOT"] = std::to_string (counts[SPOT]);
+      return defines;
+  }
+
+  void
+  setLightUniforms (ShaderProgram* program, const std::vector<LightSource*>& lights)
+  {
+      int lightNum = 0;
+      for (LightType type : {DIRECTIONAL, POINT, SPOT})
+      {
+        for (LightSource* light : lights)
+        {
+          if (light->getType () == type)
+            light->setUniforms (program, lightNum++);
+        }
+      }
+      program->setUniformInt ("uNumLights", lightNum);
+  }
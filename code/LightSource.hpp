@@ -6,6 +6,8 @@
 #ifndef LIGHT_SOURCE_HPP
 #define LIGHT_SOURCE_HPP
 
+#include <vector>
+
 #include "Vector3.hpp"
 #include "ShaderProgram.hpp"
 
@@ -20,6 +22,7 @@ public:
   LightSource (const Vector3& diffuseIntensity, const Vector3& specularIntensity);
   virtual ~LightSource ();
   virtual void setUniforms (ShaderProgram* program, int lightNum);
+  virtual LightType getType () const = 0;
 private:
   Vector3 m_diffuseIntensity;
   Vector3 m_specularIntensity;
@@ -30,6 +33,7 @@ public:
   DirectionalLightSource (const Vector3& diffuseIntensity, const Vector3& specularIntensity, const Vector3& direction);
   virtual ~DirectionalLightSource ();
   virtual void setUniforms (ShaderProgram* program, int lightNum);
+  virtual LightType getType () const;
 private:
   Vector3 m_direction;
 };
@@ -49,6 +53,7 @@ public:
   PointLightSource (const Vector3& diffuseIntensity, const Vector3& specularIntensity, const Vector3& position, const Vector3& attenuationCoefficients);
   virtual ~PointLightSource ();
   virtual void setUniforms (ShaderProgram* program, int lightNum);
+  virtual LightType getType () const;
 };
 
 class SpotLightSource : public LocationLightSource {
@@ -56,10 +61,28 @@ public:
   SpotLightSource (const Vector3& diffuseIntensity, const Vector3& specularIntensity, const Vector3& position, const Vector3& attenuationCoefficients, const Vector3& direction, float cutoffCosAngle, float falloff);
   virtual ~SpotLightSource ();
   virtual void setUniforms (ShaderProgram* program, int lightNum);
+  virtual LightType getType () const;
 private:
   Vector3 m_direction;
   float m_cutoffCosAngle;
   float m_falloff;
 };
 
+/// \brief Gets the preprocessor definitions that specialize GeneralShader
+///   for a set of lights, for ShaderProgram::getVariant.
+/// \param[in] lights The lights.
+/// \return NUM_DIRECTIONAL, NUM_POINT and NUM_SPOT, the number of lights of
+///   each type.
+ShaderProgram::Defines
+getLightDefines (const std::vector<LightSource*>& lights);
+
+/// \brief Sets the uniforms of a set of lights, directional lights first,
+///   then point lights, then spot lights, as a variant from getLightDefines
+///   expects.
+/// \param[in] program The program, which must be enabled.
+/// \param[in] lights The lights.
+/// \post uNumLights and uLights are set.
+void
+setLightUniforms (ShaderProgram* program, const std::vector<LightSource*>& lights);
+
 #endif//LIGHT_SOURCE_HPP
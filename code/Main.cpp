@@ -9,11 +9,18 @@
 
 /******************************************************************/
 // System includes
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <vector>
 #include <ctime>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <unistd.h>
 #include "ColorMesh.hpp"
 #include "NormalsMesh.hpp"
@@ -34,22 +41,46 @@
 
 /******************************************************************/
 // Local includes
+#include "Animation.hpp"
 #include "RealOpenGLContext.hpp"
+#include "InstrumentedOpenGLContext.hpp"
+#include "NullOpenGLContext.hpp"
+#include "SoftwareOpenGLContext.hpp"
+#include "CommandBuffer.hpp"
+#include "JobSystem.hpp"
 #include "ShaderProgram.hpp"
 #include "Mesh.hpp"
+#include "DynamicMesh.hpp"
 #include "Scene.hpp"
 #include "MyScene.hpp"
+#include "IndirectBatch.hpp"
 #include "Camera.hpp"
 #include "Vector3.hpp"
 #include "KeyBuffer.hpp"
 #include "MouseBuffer.hpp"
 #include "Matrix4.hpp"
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+#include "TraceRecorder.hpp"
 
 
 
 /******************************************************************/
 // Local types
 
+/// \brief The time, in milliseconds, that each part of every frame took in
+///   a benchmark run.
+struct BenchmarkTimes
+{
+  /// Whole frames, from the start of one to the start of the next.
+  std::vector<double> frame;
+  /// Simulation steps, input and updating world matrices.
+  std::vector<double> update;
+  /// Culling, recording and submitting draw packets.
+  std::vector<double> draw;
+  /// Swapping buffers, which is where waiting for the GPU shows up.
+  std::vector<double> swap;
+};
 
 
 /******************************************************************/
@@ -60,6 +91,87 @@
 /// This should be allocated in ::init and deallocated in ::releaseGlResources.
 OpenGLContext* g_context;
 
+/// \brief The same object as ::g_context when OpenGL calls are being counted,
+///   or nullptr when they are not.
+InstrumentedOpenGLContext* g_glStats = nullptr;
+
+/// \brief The context that actually talks to OpenGL, which may be wrapped by
+///   ::g_glStats, or nullptr when another backend is used.
+RealOpenGLContext* g_realContext = nullptr;
+
+/// \brief Which OpenGLContext draws the Scene: "real" for OpenGL in a
+///   window, "software" for SoftwareOpenGLContext or "null" for
+///   NullOpenGLContext.  The last two need no window or GPU.  Set by
+///   "--backend NAME".
+std::string g_backend = "real";
+
+/// \brief The number of frames to draw before exiting, or 0 to run until
+///   the window is closed.  Set by "--frames N".
+unsigned long g_frameLimit = 0;
+
+/// \brief Whether or not to exit once the whole chess game has played.  Set
+///   by "--full-animation".
+bool g_fullAnimation = false;
+
+/// \brief Whether or not every frame simulates exactly one step, however
+///   long it takes, so that a run draws the same frames on every machine.
+///   Set by "--fixed-step".
+bool g_fixedStep = false;
+
+/// \brief The file that benchmark results are written to as JSON when a run
+///   ends by itself, or "-" for standard output.  Set by
+///   "--benchmark-file FILE".
+const char* g_benchmarkFileName = "-";
+
+/// \brief Whether or not the state cache in ::g_realContext is checked
+///   against OpenGL after every change.  Set by "--check-gl-state".
+bool g_checkGlState = false;
+
+/// \brief The CSV file that per-frame OpenGL call counts are written to, or
+///   nullptr if they should not be counted.  Set by "--gl-stats FILE".
+const char* g_glStatsFileName = nullptr;
+
+/// \brief The directory that linked shader programs are cached in between
+///   runs, or "" if they should always be compiled.  Cleared by
+///   "--no-shader-cache".
+std::string g_shaderCacheDirectory = "shadercache";
+
+/// \brief The number of frames between printouts of where frame time goes,
+///   or 0 to not print them.  Set by "--profile N".
+unsigned long g_profileInterval = 0;
+
+/// \brief The CSV file that the time each profiled scope took in each frame
+///   is written to, or nullptr to not write one.  Set by "--profile-csv FILE".
+const char* g_profileFileName = nullptr;
+
+/// \brief The file that a Chrome trace of startup and every frame is
+///   written to at exit, or nullptr to not trace.  Set by "--trace FILE".
+const char* g_traceFileName = nullptr;
+
+/// \brief Whether or not the memory each asset holds on the CPU and GPU is
+///   printed once the Scene is ready and again at exit.  Set by "--memory".
+bool g_memoryReport = false;
+
+/// \brief How the Meshes in the Scene's arena are drawn: "auto" for
+///   glMultiDrawElementsIndirect where OpenGL 4.3 has it and a loop of
+///   glDrawElementsBaseVertex elsewhere, "on" or "off" to choose one of
+///   those, or "packets" for one recorded packet per Mesh.  "on" lets the
+///   null and software backends, which report OpenGL 3.3, check the
+///   multi-draw command stream.  Set by "--multi-draw MODE".
+std::string g_multiDraw = "auto";
+
+/// \brief Whether or not buffer swaps wait for the display's refresh.
+///   Cleared by "--no-vsync" so that frames can be drawn as fast as possible.
+bool g_vsync = true;
+
+/// \brief The number of seconds of game time that each call to ::updateScene
+///   simulates.  Frames draw the Scene blended between the last two steps.
+const double SIMULATION_STEP = 1.0 / 60;
+
+/// \brief The most simulation steps one frame may run, so that a long stall
+///   does not make the following frames fall further and further behind.
+const int MAX_STEPS_PER_FRAME = 10;
+
 // We use one VAO for each object we draw
 /// \brief A collection of the VAOs for each of the objects we want to draw.
 ///
@@ -67,6 +179,19 @@ OpenGLContext* g_context;
 ///   releaseGlResources.
 Scene* g_scene; 
 
+/// \brief The square under the active Mesh, which is rebuilt every frame.
+///
+/// This should be allocated in ::initScene and deallocated in
+///   ::releaseGlResources.
+DynamicMesh* g_highlight;
+
+/// \brief The draws of the visible Meshes in the Scene's arena, rebuilt
+///   every frame, or nullptr if every Mesh records its own packet.
+///
+/// This should be allocated in ::initScene and deallocated in
+///   ::releaseGlResources.
+IndirectBatch* g_batch = nullptr;
+
 /// \brief The ShaderProgram that transforms and lights the primitives.
 ///
 /// This should be allocated in ::initShaders and deallocated in
@@ -75,6 +200,20 @@ ShaderProgram* g_shaderProgram;
 
 ShaderProgram* g_shaderProgramNorm;
 
+/// \brief The draw packets for the current frame, which are recorded from
+///   the Scene and then submitted to ::g_context.
+CommandBuffer g_commands;
+
+/// \brief The keyframes that play the chess game, bound to the Meshes of
+///   ::g_scene.
+///
+/// This should be allocated in ::initScene and deallocated in
+///   ::releaseGlResources.
+Animation* g_animation;
+
+/// \brief How many seconds of the animation have been played.
+double g_animationTime = 0.0;
+
 /// \brief The Camera that views the Scene.
 ///
 /// This should be allocated in ::initCamera and deallocated in
@@ -91,7 +230,6 @@ double lastX;
 double lastY;
 double fov = 50.0;
 double aspectRatio = 1200.0f / 900;
-int state = 0;
 
 
 
@@ -121,6 +259,13 @@ initGlew ();
 void
 initWindow (GLFWwindow*& window);
 
+/// \brief Sets the OpenGL state that the Scene is drawn with.  Should only
+///   be called by ::init and ::initWindow.
+/// \param[in] width The width of the framebuffer.
+/// \param[in] height The height of the framebuffer.
+void
+initGlState (int width, int height);
+
 /// \brief Re-renders the window.  This should be called whenever the window
 ///   size changes.
 /// \param[in] window The GLFWwindow to reset.
@@ -142,16 +287,52 @@ void
 initCamera ();
 
 /// \brief Moves geometric objects around using game logic.  This should be
-///   called for every frame.
-/// \param[in] time The number of seconds since the previous update.
+///   called for every simulation step.
+/// \param[in] time The number of seconds the step covers, which is always
+///   ::SIMULATION_STEP.
 void
 updateScene (double time);
 
-/// \brief Draws the Scene onto the window.  This should be called for every
+/// \brief Moves ::g_highlight under the active Mesh and pulses its color.
+///   This should be called for every frame, before drawing.
+void
+updateHighlight ();
+
+/// \brief Draws the Scene.  This should be called for every frame.
+void
+drawScene ();
+
+/// \brief Shows what ::drawScene drew.  This should be called for every
 ///   frame.
-/// \param[in] window The GLFWwindow to draw in.
+/// \param[in] window The GLFWwindow to show it in, or nullptr if there is
+///   none.
+void
+swapBuffers (GLFWwindow* window);
+
+/// \brief Gets the time from a clock that only moves forward.
+/// \return The number of seconds since some fixed point.
+double
+getTime ();
+
+/// \brief Tells whether or not the game/render loop should stop.
+/// \param[in] window The GLFWwindow, or nullptr if there is none.
+/// \param[in] frames The number of frames drawn so far.
+/// \return Whether the window was closed or the run has gone on as long as
+///   it was asked to.
+bool
+isFinished (GLFWwindow* window, unsigned long frames);
+
+/// \brief Writes the statistics of a run to ::g_benchmarkFileName as JSON.
+/// \param[in] times The time each part of each frame took.
 void
-drawScene (GLFWwindow* window);
+writeBenchmark (const BenchmarkTimes& times);
+
+/// \brief Reads a count from a command-line argument.
+/// \param[in] text The argument.
+/// \param[out] count The count, if it was one.
+/// \return Whether text is a whole decimal number from 1 to INT_MAX.
+bool
+parseCount (const char* text, int& count);
 
 /// \brief Responds to any user input.  This should be set as a callback.
 /// \param[in] window The GLFWwindow the input came from.
@@ -202,36 +383,192 @@ outputGlfwError (int error, const char* description);
 /******************************************************************/
 
 /// \brief Runs our program.
-/// \param[in] argc The number of command-line arguments, which we ignore.
-/// \param[in] argv The array of command-line-arguments, which we ignore.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line-arguments.  "--gl-stats FILE"
+///   writes the number of OpenGL calls made during each frame to FILE.
+///   "--check-gl-state" validates the OpenGL state cache, which is slow.
+///   "--threads N" runs jobs on N threads instead of one per hardware thread.
+///   "--no-vsync" draws frames without waiting for the display.
+///   "--no-shader-cache" compiles every shader instead of loading cached
+///   program binaries.  "--profile N" prints CPU and GPU time statistics
+///   every N frames, and "--profile-csv FILE" writes each frame's times to
+///   FILE.  "--trace FILE" writes a timeline of startup and every frame to
+///   FILE, for chrome://tracing or Perfetto.  "--memory" prints how much
+///   memory each model holds after loading and at exit.  "--backend NAME"
+///   draws with the "real", "software" or "null" context.  "--frames N"
+///   exits after N frames and "--full-animation" once the chess game is
+///   over; either makes a benchmark run, which writes frame, update, draw
+///   and swap time statistics as JSON to standard output or
+///   "--benchmark-file FILE".  "--fixed-step" simulates one step per frame,
+///   however long frames take.  Without a window, a run must be limited by
+///   one of these.  "--multi-draw auto|on|off|packets" chooses how the
+///   Meshes that share buffers are drawn; "on" needs the real or null
+///   backend.
 int
 main (int argc, char* argv[])
 {
-  GLFWwindow* window;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg (argv[i]);
+    int count;
+    if (arg == "--gl-stats" && i + 1 < argc)
+      g_glStatsFileName = argv[++i];
+    else if (arg == "--check-gl-state")
+      g_checkGlState = true;
+    else if (arg == "--threads" && i + 1 < argc && parseCount (argv[i + 1], count))
+    {
+      JobSystem::resetGlobal (count);
+      ++i;
+    }
+    else if (arg == "--no-vsync")
+      g_vsync = false;
+    else if (arg == "--no-shader-cache")
+      g_shaderCacheDirectory = "";
+    else if (arg == "--profile" && i + 1 < argc && parseCount (argv[i + 1], count))
+    {
+      g_profileInterval = count;
+      ++i;
+    }
+    else if (arg == "--profile-csv" && i + 1 < argc)
+      g_profileFileName = argv[++i];
+    else if (arg == "--trace" && i + 1 < argc)
+      g_traceFileName = argv[++i];
+    else if (arg == "--memory")
+      g_memoryReport = true;
+    else if (arg == "--backend" && i + 1 < argc)
+      g_backend = argv[++i];
+    else if (arg == "--frames" && i + 1 < argc && parseCount (argv[i + 1], count))
+    {
+      g_frameLimit = count;
+      ++i;
+    }
+    else if (arg == "--full-animation")
+      g_fullAnimation = true;
+    else if (arg == "--fixed-step")
+      g_fixedStep = true;
+    else if (arg == "--benchmark-file" && i + 1 < argc)
+      g_benchmarkFileName = argv[++i];
+    else if (arg == "--multi-draw" && i + 1 < argc)
+      g_multiDraw = argv[++i];
+    else
+    {
+      fprintf (stderr, "Usage: %s [--gl-stats FILE] [--check-gl-state] [--threads N]"
+	       " [--no-vsync] [--no-shader-cache] [--profile N] [--profile-csv FILE]"
+	       " [--trace FILE] [--memory] [--backend real|software|null] [--frames N]"
+	       " [--full-animation] [--fixed-step] [--benchmark-file FILE]"
+	       " [--multi-draw auto|on|off|packets]\n",
+	       argv[0]);
+      exit (-1);
+    }
+  }
+  bool benchmark = g_frameLimit != 0 || g_fullAnimation;
+  if (g_backend != "real" && !benchmark)
+  {
+    fprintf (stderr, "The %s backend has no window to close, so it needs"
+	     " --frames or --full-animation\n", g_backend.c_str ());
+    exit (-1);
+  }
+  if (g_multiDraw != "auto" && g_multiDraw != "on" && g_multiDraw != "off"
+      && g_multiDraw != "packets")
+  {
+    fprintf (stderr, "Unknown --multi-draw mode %s\n", g_multiDraw.c_str ());
+    exit (-1);
+  }
+  // The software context does not emulate the per-draw attributes and
+  //   uniform arrays that multi-draw needs, so it would draw a wrong image.
+  if (g_multiDraw == "on" && g_backend == "software")
+  {
+    fprintf (stderr, "The software backend cannot draw with --multi-draw on\n");
+    exit (-1);
+  }
+
+  TraceRecorder::getGlobal ().setThreadName ("main");
+  if (g_traceFileName != nullptr)
+    TraceRecorder::getGlobal ().start ();
+
+  GLFWwindow* window = nullptr;
   init (window);
+  if (g_memoryReport)
+    MemoryTracker::getGlobal ().print (stderr);
 
   // Game/render loop
-  double previousTime = glfwGetTime ();
-  while (!glfwWindowShouldClose (window))
-  {
-    double currentTime = glfwGetTime ();
+  BenchmarkTimes times;
+  unsigned long frames = 0;
+  double previousTime = getTime ();
+  // Game time that has passed but not been simulated yet.
+  double unsimulatedTime = 0.0;
+  while (!isFinished (window, frames))
+  {
+    TRACE_SCOPE ("frame", "frame");
+    double currentTime = getTime ();
     // Compute frame times, which we can use later for frame rate computation,
     //   animation, and physics.
-    double deltaTime = currentTime - previousTime;
+    double deltaTime = g_fixedStep ? SIMULATION_STEP : currentTime - previousTime;
+    if (benchmark && frames > 0)
+      times.frame.push_back ((currentTime - previousTime) * 1000.0);
     previousTime = currentTime;
-    updateScene (deltaTime);
-    drawScene (window);
+    // Simulate in steps of a fixed size, however long frames take, so that
+    //   the animation runs at the same speed at any frame rate.
+    unsimulatedTime += std::min (deltaTime, MAX_STEPS_PER_FRAME * SIMULATION_STEP);
+    while (unsimulatedTime >= SIMULATION_STEP)
+    {
+      g_scene->savePreviousWorlds ();
+      processKeys ();
+      updateScene (SIMULATION_STEP);
+      unsimulatedTime -= SIMULATION_STEP;
+    }
+    // Bring attached Meshes along with whatever moved them in the last step.
+    g_scene->updateWorlds ();
+    // Draw the part of the way from the previous step to the current one
+    //   that the leftover time covers.
+    g_scene->setInterpolation (unsimulatedTime / SIMULATION_STEP);
+    double drawTime = getTime ();
+    drawScene ();
+    double swapTime = getTime ();
+    swapBuffers (window);
+    if (benchmark)
+    {
+      times.update.push_back ((drawTime - currentTime) * 1000.0);
+      times.draw.push_back ((swapTime - drawTime) * 1000.0);
+      times.swap.push_back ((getTime () - swapTime) * 1000.0);
+    }
+    if (g_glStats != nullptr)
+    {
+      if (g_realContext != nullptr)
+	g_glStats->addFilteredCalls (g_realContext->getFilteredCallCount ());
+      g_glStats->endFrame ();
+    }
+    if (g_realContext != nullptr)
+      g_realContext->resetFilteredCallCount ();
+    Profiler::getGlobal ().endFrame ();
+    ++frames;
     // Process events in the event queue, which results in callbacks
     //   being invoked.
-    glfwPollEvents ();
-    processKeys();
+    if (window != nullptr)
+      glfwPollEvents ();
   }
+  // The last frame ends when the loop does.
+  if (benchmark && frames > 0)
+    times.frame.push_back ((getTime () - previousTime) * 1000.0);
 
+  if (g_memoryReport)
+    MemoryTracker::getGlobal ().print (stderr);
   releaseGlResources ();
-  // Destroying the window destroys the OpenGL context
-  glfwDestroyWindow (window);
-  glfwTerminate ();
+  if (window != nullptr)
+  {
+    // Destroying the window destroys the OpenGL context
+    glfwDestroyWindow (window);
+    glfwTerminate ();
+  }
 
+  if (benchmark)
+    writeBenchmark (times);
+  if (g_traceFileName != nullptr)
+  {
+    TraceRecorder::getGlobal ().stop ();
+    if (!TraceRecorder::getGlobal ().writeJson (g_traceFileName))
+      fprintf (stderr, "Failed to write %s\n", g_traceFileName);
+  }
   return EXIT_SUCCESS;
 }
 
@@ -240,6 +577,7 @@ main (int argc, char* argv[])
 void
 init (GLFWwindow*& window)
 {
+  TRACE_SCOPE ("init", "init");
   KeyBuffer* kb = new KeyBuffer;
   g_keyBuffer = kb;
   MouseBuffer* mb = new MouseBuffer;
@@ -247,11 +585,54 @@ init (GLFWwindow*& window)
   firstMouse = true;
   lastX = 400;
   lastY = 300;
-  g_context = new RealOpenGLContext ();
-  // Always initialize GLFW before GLEW
-  initGlfw ();
-  initWindow (window);
-  initGlew ();
+  if (g_backend == "real")
+  {
+    g_realContext = new RealOpenGLContext (g_checkGlState);
+    g_context = g_realContext;
+  }
+  else if (g_backend == "software")
+    g_context = new SoftwareOpenGLContext ();
+  else if (g_backend == "null")
+    g_context = new NullOpenGLContext ();
+  else
+  {
+    fprintf (stderr, "Unknown backend %s -- exiting\n", g_backend.c_str ());
+    exit (-1);
+  }
+  if (g_glStatsFileName != nullptr)
+  {
+    g_glStats = new InstrumentedOpenGLContext (g_context);
+    if (!g_glStats->openCsv (g_glStatsFileName))
+    {
+      fprintf (stderr, "Failed to open %s\n", g_glStatsFileName);
+      exit (-1);
+    }
+    g_context = g_glStats;
+  }
+  if (g_profileInterval != 0 || g_profileFileName != nullptr)
+  {
+    Profiler& profiler = Profiler::getGlobal ();
+    profiler.setEnabled (true);
+    profiler.setPrintInterval (g_profileInterval);
+    profiler.setContext (g_context);
+    if (g_profileFileName != nullptr && !profiler.openCsv (g_profileFileName))
+    {
+      fprintf (stderr, "Failed to open %s\n", g_profileFileName);
+      exit (-1);
+    }
+  }
+  if (g_realContext != nullptr)
+  {
+    // Always initialize GLFW before GLEW
+    initGlfw ();
+    initWindow (window);
+    initGlew ();
+  }
+  else
+  {
+    window = nullptr;
+    initGlState (800, 600);
+  }
   initShaders ();
   initCamera ();
   initScene ();
@@ -262,6 +643,7 @@ init (GLFWwindow*& window)
 void
 initGlfw ()
 {
+  TRACE_SCOPE ("initGlfw", "init");
   glfwSetErrorCallback (outputGlfwError);
   if (!glfwInit ())
   {
@@ -275,6 +657,7 @@ initGlfw ()
 void
 initWindow (GLFWwindow*& window)
 {
+  TRACE_SCOPE ("initWindow", "init");
   glfwWindowHint (GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint (GLFW_CONTEXT_VERSION_MINOR, 3);
 #ifdef __APPLE__
@@ -292,14 +675,25 @@ initWindow (GLFWwindow*& window)
   glfwSetWindowPos (window, 200, 100);
 
   glfwMakeContextCurrent (window);
-  // Swap buffers after 1 frame
-  glfwSwapInterval (1);
+  // Swap buffers after 1 frame, unless we are drawing as fast as possible
+  glfwSwapInterval (g_vsync ? 1 : 0);
   glfwSetKeyCallback (window, recordKeys /*processKeys*/);
   glfwSetMouseButtonCallback(window, recordMouse);
   glfwSetCursorPosCallback(window, recordMousePosition);
   glfwSetFramebufferSizeCallback (window, resetViewport);
   glfwSetCursorEnterCallback(window, cursor_enter_callback);
   glfwSetScrollCallback(window, scroll_callback);
+  // Set initial viewport size
+  int width, height;
+  glfwGetFramebufferSize (window, &width, &height);
+  initGlState (width, height);
+}
+
+/******************************************************************/
+
+void
+initGlState (int width, int height)
+{
   // Specify background color
   g_context->clearColor (0.0f, 0.0f, 0.0f, 1.0f);
   // Enable depth testing so occluded surfaces aren't drawn
@@ -311,9 +705,6 @@ initWindow (GLFWwindow*& window)
   // The next two setting are default, but we'll be explicit.
   g_context->frontFace (GL_CCW);
   g_context->cullFace (GL_BACK);
-  // Set initial viewport size
-  int width, height;
-  glfwGetFramebufferSize (window, &width, &height);
   g_context->viewport (0, 0, width, height);
 }
 
@@ -322,6 +713,7 @@ initWindow (GLFWwindow*& window)
 void
 initGlew ()
 {
+  TRACE_SCOPE ("initGlew", "init");
   GLenum status = glewInit ();
   if (status != GLEW_OK)
   {
@@ -353,9 +745,19 @@ resetViewport (GLFWwindow* window, int width, int height)
 void
 initScene ()
 {
+  TRACE_SCOPE ("initScene", "init");
   
-  Scene* tri = new MyScene(g_context, g_shaderProgram, g_shaderProgramNorm);
+  bool multiDraw = (g_multiDraw == "auto")
+    ? IndirectBatch::supportsMultiDraw (*g_context) : g_multiDraw == "on";
+  MyScene* tri = new MyScene(g_context, g_shaderProgram, g_shaderProgramNorm,
+                             multiDraw);
   g_scene = tri;
+  if (g_multiDraw != "packets")
+    g_batch = new IndirectBatch (g_context, tri->getArena (), multiDraw);
+  g_animation = new Animation ("chess.anim");
+  g_animation->bind (*g_scene);
+  // Two triangles, with room to spare for more highlights later.
+  g_highlight = new DynamicMesh (g_context, g_shaderProgram, 64);
 
 }
 
@@ -366,8 +768,10 @@ initScene ()
 void
 initShaders ()
 {
+  TRACE_SCOPE ("initShaders", "init");
   // Create shader programs, which consist of linked shaders.
   // No need to use the program until we draw or set uniform variables.
+  ShaderProgram::setBinaryCacheDirectory (g_shaderCacheDirectory);
   g_shaderProgram = new ShaderProgram (g_context);
   g_shaderProgram->createVertexShader ("Vec3.vert");
   g_shaderProgram->createFragmentShader ("Vec3.frag");
@@ -398,6 +802,7 @@ initShaders ()
 void
 initCamera ()
 { 
+  TRACE_SCOPE ("initCamera", "init");
   float verticalFov = 38.0f;  //orginal 50
   // Near plane
   float nearZ = 0.01f; //.01
@@ -421,1208 +826,161 @@ initCamera ()
   
   //optimal setting for white
   //g_camera = new Camera (Vector3 (3.5, 8, -5), Vector3(0, 1, -1.0f), nearZ, farZ, aspectRatio, verticalFov);
-int t = 0;
-bool hold = false;
 bool pausebutton = false;
 
-void whiteCamera()
-{
-
-  g_shaderProgramNorm->setUniformVec3 ("uEyePosition", Vector3(3.5, 8, -5));
-  g_camera->resetPose();
-  hold = true;
-}
-
-void blackCamera()
-{
-
-  g_shaderProgramNorm->setUniformVec3 ("uEyePosition", Vector3(3.5, 8, 12.0));
-  g_camera->setPosition(Vector3 (3.5, 8, 12));
-  g_camera->pitch(45);
-  g_camera->yaw(180);
-  g_camera->pitch(-45);
-  hold = true;
-}
-
-
-
 void
 updateScene (double time)
 {
+  PROFILE_SCOPE ("updateScene");
   g_shaderProgramNorm->enable();  
-  //0.03 speeed good for laptop
-  //.15 lab comps
-  float speed = .15;
-  
-   if(pausebutton == true)
+  if(pausebutton == true)
   {
     return;
   }
-  
-  if(hold == true){
-    ++t;
-    //150 lab comps
-    //500 good pause for laptop
-    if(t == 500){
-      ++state;
-      t = 0;
-      hold = false;
-    }
-    return;
-  }
-
- 
-  
-  
-  if (state == 0)
-  {
-    //whiteCamera();
-    g_scene->setActiveMesh("pawn4");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 3){
-      ++state;
-    }
-  }
-  if (state == 1)
-  {
-    g_scene->setActiveMesh("bpawn4");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 4){
-      ++state; 
-    }
-  }
-  if (state == 2)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 3)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 2)
-      ++state;
-  }
-    if (state == 4)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 2)
-      ++state;
-  }
-    if (state == 5)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-    if (state == 6)
-  {
-    g_scene->setActiveMesh("bpawn5");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5){
-      ++state;
-    }
-  }
-  if (state == 7)
-  {
-    g_scene->setActiveMesh("pawn5");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 3)
-      ++state;
-  }
-  if (state == 8)
-  {
-    g_scene->setActiveMesh("bbishop2");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 1)
-      ++state;
-  }
-  if (state == 9)
-  {
-    g_scene->setActiveMesh("bpawn4");
-    g_scene->getActiveMesh()->moveLocal(10, Vector3(5,0,0));
-    ++state;
-  }
-      if (state == 10)
-    {
-    //whiteCamera();
-    g_scene->setActiveMesh("pawn5");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 3)
-      ++state;
-  }
-  if (state == 11)
-  {
-    g_scene->setActiveMesh("knight"); 
-    g_scene->getActiveMesh()->moveLocal(3, Vector3(-5,0,0));
-      ++state;
-  }
-    if (state == 12)
-  {
-    g_scene->setActiveMesh("bbishop2");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 2)
-      ++state;
-  }
-      if (state == 13)
-  {
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveBack(speed * .4);
-    g_scene->getActiveMesh()->moveRight(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 3)
-      ++state;
-  }
-      if (state == 14)
-  {
-    g_scene->setActiveMesh("bbishop2");
-    g_scene->getActiveMesh()->moveLocal(12, Vector3(5,0,0));
-
-      ++state;
-  }
-        if (state == 15)
-  {
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveBack(speed * .4);
-    g_scene->getActiveMesh()->moveRight(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 2)
-      ++state;
-  }
-  
-  if(state == 16)
-  {
-      g_scene->setActiveMesh("pawn5");
-    g_scene->getActiveMesh()->moveLocal(8, Vector3(-5,0,0));
-    ++state;
-  }
-  if(state == 17)
-  {
-    g_scene->setActiveMesh("bpawn5");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 3)
-      ++state;
-  }
-    if(state == 18)
-  {
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 5)
-      ++state;
-  }
-  if (state == 19)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 20)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5)
-      ++state;
-  }
-    if (state == 21)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 2)
-      ++state;
-  }
-    if (state == 22)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-      if (state == 23)
-  {
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveRight(speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-        if (state == 24)
-  {
-    g_scene->setActiveMesh("bqueen");
-    g_scene->getActiveMesh()->moveRight(-speed * .4);
-    g_scene->getActiveMesh()->moveBack(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 6)
-      ++state;
-  }
-if (state == 25)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 26)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 2)
-      ++state;
-  }
-    if (state == 27)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 5)
-      ++state;
-  }
-    if (state == 28)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-      if (state == 29)
-  {
-    g_scene->setActiveMesh("bpawn6");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5)
-      ++state;
-  }
-        if (state == 30)
-  {
-    g_scene->setActiveMesh("bishop2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 1)
-      ++state;
-  }
-          if (state == 31)
-  {
-    g_scene->setActiveMesh("bpawn7");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 4)
-      ++state;
-  }
-  if (state == 32)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 33)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 4)
-      ++state;
-  }
-    if (state == 34)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-              if (state == 35)
-  {
-    g_scene->setActiveMesh("bpawn7");
-    g_scene->getActiveMesh()->moveLocal(8, Vector3(5,0,0));
-      ++state;
-  }
-    
-    if (state == 36)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-      if (state == 37)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveLocal(8, Vector3(-5,0,0));
-      ++state;
-  }
-      if (state == 38)
-  {
-    g_scene->setActiveMesh("bpawn6");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-          if (state == 39)
-  {
-    g_scene->setActiveMesh("bpawn6");
-        g_scene->getActiveMesh()->moveLocal(4, Vector3(5,0,0));
-      ++state;
-  }  
-      
-      if(state == 40)
-  {
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-  if (state == 41)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 42)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 6)
-      ++state;
-  }
-    if (state == 43)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 4)
-      ++state;
-  }
-    if (state == 44)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-      if (state == 45)
-  {
-    g_scene->setActiveMesh("rook2");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 4)
-      ++state;
-  }
-  if (state == 46)
-  {
-    g_scene->setActiveMesh("king");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 47)
-  {
-    g_scene->setActiveMesh("king");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 5)
-      ++state;
-  }
-    if (state == 48)
-  {
-    g_scene->setActiveMesh("king");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-      if (state == 49)
-  {
-    g_scene->setActiveMesh("brook1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 4)
-      ++state;
-  }  
-        if (state == 50)
-  {
-    g_scene->setActiveMesh("rook2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 5)
-      ++state;
-  }
-      if (state == 51)
-  {
-    g_scene->setActiveMesh("bknight2");
-      g_scene->getActiveMesh()->moveLocal(4, Vector3(-5,0,0));
-      ++state;
-  }    
-          if (state == 52)
-  {
-    g_scene->setActiveMesh("rook2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 6){
-      ++state;  
-       g_scene->getActiveMesh()->moveLocal(10, Vector3(-5,0,0));
-    }
-  }
-            if (state == 53)
-  {
-    g_scene->setActiveMesh("brook1");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 6)
-      ++state;  
-  }
-              if (state == 54)
-  {
-    g_scene->setActiveMesh("rook");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 4)
-      ++state;  
-  }
-                if (state == 55)
-  {
-    g_scene->setActiveMesh("bqueen");
-    g_scene->getActiveMesh()->moveBack(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5)
-      ++state;  
-  }
-                  if (state == 56)
-  {
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 5)
-      ++state;  
-  }
-              if (state == 57)
-  {
-    g_scene->setActiveMesh("brook1");
-     g_scene->getActiveMesh()->moveLocal(10, Vector3(5,0,0));
-      ++state;  
-  }
-                  if (state == 58)
-  {
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 6)
-      ++state;  
-  }
-   if (state == 59)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 60)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 6)
-      ++state;
-  }
-    if (state == 61)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 4)
-      ++state;
-  }
-                      if (state == 62)
-  {
-    g_scene->setActiveMesh("bishop");
-      g_scene->getActiveMesh()->moveLocal(12, Vector3(-5,0,0));
+  // Every moving piece is driven by the keyframes in chess.anim.
+  g_animationTime += time;
+  g_animation->apply (g_animationTime);
+}
 
-      ++state;  
-  }
-    
-    if (state == 63)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-      if (state == 64)
-  {
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveBack(speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 7)
-      ++state;
-  }
-  if (state == 65)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 66)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 7)
-      ++state;
-  }
-    if (state == 67)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-                      if (state == 68)
-  {
-    g_scene->setActiveMesh("queen");
-      g_scene->getActiveMesh()->moveLocal(12, Vector3(-5,0,0));
+/******************************************************************/
 
-      ++state;  
-  }
-    
-    if (state == 69)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      ++state;
-  }
-                if (state == 70)
-  {
-    g_scene->setActiveMesh("rook");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 7)
-      ++state;  
-  }
-                  if (state == 71)
+void
+updateHighlight ()
+{
+  Mesh* active = g_scene->getActiveMesh ();
+  if (active == nullptr)
   {
-    g_scene->setActiveMesh("bking");
-    g_scene->getActiveMesh()->pitch(1);
-    if(g_scene->getActiveMesh()->getWorld().getUp().m_y <= 0)
-      ++state;  
+    g_highlight->setVertexCount (0);
+    return;
   }
+  // Pieces stand in the middle of squares one unit wide.
+  Vector3 position = active->getRenderWorld ().getPosition ();
+  float x = std::round (position.m_x);
+  float z = std::round (position.m_z);
+  const float HALF = 0.5f;
+  const float Y = 0.02f;
+  float glow = 0.6f + 0.4f * static_cast<float> (std::sin (g_animationTime * 4.0));
+  std::vector<float> square {
+    x - HALF, Y, z - HALF, glow, glow, 0,
+    x - HALF, Y, z + HALF, glow, glow, 0,
+    x + HALF, Y, z + HALF, glow, glow, 0,
+    x - HALF, Y, z - HALF, glow, glow, 0,
+    x + HALF, Y, z + HALF, glow, glow, 0,
+    x + HALF, Y, z - HALF, glow, glow, 0
+  };
+  g_highlight->updateGeometry (0, square);
+  g_highlight->setVertexCount (6);
+}
 
+/******************************************************************/
 
-/*
-Camera swapining and added lights. 
-All point lights are intended to be spot lights but my spot lights do not work
-Also my lighting only works from one direction.
-The lights illuminate the endpoint of each move and turn red if its a capture.
-Point lights above king turn red when in check and go away otherwise.
-*/
-
-/*
- if (state == 0)
-  {
-    //whiteCamera();
-    g_scene->setActiveMesh("pawn4");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(3,2,3));
-
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 3){
-      blackCamera();
-    }
-  }
-  if (state == 1)
-  {
-    g_scene->setActiveMesh("bpawn4");
-    g_scene->getActiveMesh()->moveBack(-speed);
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(3,2,4));
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 4){
-       whiteCamera();
-    }
-  }
-  if (state == 2)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveUp(speed);
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(2,2,2));
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 3)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 2)
-      ++state;
-  }
-    if (state == 4)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 2)
-      ++state;
-  }
-    if (state == 5)
-  {
-    g_scene->setActiveMesh("knight");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0){
-      blackCamera();}
-  }
-  
-    if (state == 6)
-  {
-    g_scene->setActiveMesh("bpawn5");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,5));
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5){
-      whiteCamera();
-    }
-  }
-  if (state == 7)
-  {
-    g_scene->setActiveMesh("pawn5");
-    g_scene->getActiveMesh()->moveBack(speed);
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,3));
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 3){
-      blackCamera();
-    }
-  }
-  if (state == 8)
-  {
-    g_scene->setActiveMesh("bbishop2");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(1,2,3));
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 1){
-      whiteCamera();}
-  }
-  if (state == 9)
-  {
-  g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.0,0.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.0,0.0));  
-   g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(3,2,4));
-  g_scene->setActiveMesh("bpawn4");
-    g_scene->getActiveMesh()->moveLocal(10, Vector3(5,0,0));
-    ++state;
-  }
-      if (state == 10)
-    {
-    //whiteCamera();
-    g_scene->setActiveMesh("pawn5");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 3){
-      blackCamera();}
-  }
-  if (state == 11)
-  {
-      g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.0,0.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.0,0.0));  
-   g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(2,2,2));
-    g_scene->setActiveMesh("knight"); 
-    g_scene->getActiveMesh()->moveLocal(3, Vector3(-5,0,0));
-      ++state;
-  }
-    if (state == 12)
-  {
-    g_scene->setActiveMesh("bbishop2");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 2){
-      whiteCamera();}
-  }
-      if (state == 13)
-  {
-          g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.0,0.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.0,0.0));  
-   g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(2,2,2));
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveBack(speed * .4);
-    g_scene->getActiveMesh()->moveRight(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 3){
-      state++;}
-  }
-      if (state == 14)
-  {
-    g_scene->setActiveMesh("bbishop2");
-    g_scene->getActiveMesh()->moveLocal(12, Vector3(5,0,0));
-
-      ++state;
-  }
-        if (state == 15)
-  {
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveBack(speed * .4);
-    g_scene->getActiveMesh()->moveRight(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 2){
-      blackCamera();}
-  }
-  
-  if(state == 16)
-  {
-          g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.0,0.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.0,0.0));  
-   g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(3,2,4));
-    g_scene->setActiveMesh("pawn5");
-    g_scene->getActiveMesh()->moveLocal(8, Vector3(-5,0,0));
-    ++state;
-  }
-  if(state == 17)
-  {
-    g_scene->setActiveMesh("bpawn5");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 3){
-      whiteCamera();}
-  }
-    if(state == 18)
-  {
-       g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.9,0.9));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.9,0.9));
-       g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(5,2,3));
-
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 5)
-      blackCamera();
-  }
-  if (state == 19)
-  {
-       g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(2,2,5));
+void
+drawScene ()
+{
+  PROFILE_SCOPE ("drawScene");
+  PROFILE_GPU_SCOPE ("drawScene");
+  g_context->clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  const Transform& modelView = g_camera->getViewMatrix();
+  const Matrix4& projectionMatrix = g_camera->getProjectionMatrix();
+  Vector3 eyePosition = g_camera->getInverseViewMatrix ().getPosition ();
+  g_commands.clear ();
+  updateHighlight ();
+  g_highlight->upload ();
+  g_scene->cull (g_camera->getFrustumPlanes ());
+  if (g_batch != nullptr)
+  {
+    g_batch->clear ();
+    g_scene->recordIndirect (*g_batch, g_commands, modelView, projectionMatrix,
+			     eyePosition);
+    g_batch->submit (modelView, projectionMatrix, eyePosition);
+  }
+  else
+    g_scene->recordParallel (g_commands, modelView, projectionMatrix, eyePosition);
+  g_commands.submit (*g_context);
+  g_highlight->draw (modelView, projectionMatrix, eyePosition);
+  g_context->flush ();
+}
 
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 20)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5)
-      ++state;
-  }
-    if (state == 21)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 2)
-      ++state;
-  }
-    if (state == 22)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      whiteCamera();
-  }
-      if (state == 23)
-  {
-       g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(6,2,2));
+/******************************************************************/
 
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveRight(speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      blackCamera();
-  }
-        if (state == 24)
-  {
-     g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(3,2,6));
-    g_scene->setActiveMesh("bqueen");
-    g_scene->getActiveMesh()->moveRight(-speed * .4);
-    g_scene->getActiveMesh()->moveBack(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 6)
-      whiteCamera();
-  }
-if (state == 25)
-  {
-     g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(5,2,2));
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 26)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 2)
-      ++state;
-  }
-    if (state == 27)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 5)
-      ++state;
-  }
-    if (state == 28)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      blackCamera();
-  }
-      if (state == 29)
-  {
-     g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(5,2,5));
-    g_scene->setActiveMesh("bpawn6");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5)
-      whiteCamera();
-  }
-        if (state == 30)
-  {
-     g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(1,2,4));
-    g_scene->setActiveMesh("bishop2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 1)
-      blackCamera();
-  }
-          if (state == 31)
-  {
-     g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(6,2,4));
-    g_scene->setActiveMesh("bpawn7");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 4)
-      whiteCamera();
-  }
-  if (state == 32)
-  {
-   g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.0,0.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.0,0.0));
-    g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(6,2,4));
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 33)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 4)
-      ++state;
-  }
-    if (state == 34)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-              if (state == 35)
-  {
-    g_scene->setActiveMesh("bpawn7");
-    g_scene->getActiveMesh()->moveLocal(8, Vector3(5,0,0));
-      ++state;
-  }
-    
-    if (state == 36)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      blackCamera();
-  }
-      if (state == 37)
-  {
-    g_scene->setActiveMesh("knight2");
-    g_scene->getActiveMesh()->moveLocal(8, Vector3(-5,0,0));
-      ++state;
-  }
-      if (state == 38)
-  {
-    g_scene->setActiveMesh("bpawn6");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      whiteCamera();
-  }
-          if (state == 39)
-  {
-    g_scene->setActiveMesh("bpawn6");
-        g_scene->getActiveMesh()->moveLocal(4, Vector3(5,0,0));
-      ++state;
-  }  
-      
-      if(state == 40)
-  {
-  g_shaderProgramNorm->setUniformVec3("uLights[3].position", Vector3(3,2,7));
-      g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      blackCamera();
-  }
-  if (state == 41)
-  {
-       g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.9,0.9));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.9,0.9));
-    g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,6));
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 42)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 6)
-      ++state;
-  }
-    if (state == 43)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 4)
-      ++state;
-  }
-    if (state == 44)
-  {
-    g_scene->setActiveMesh("bknight2");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0){
-      g_shaderProgramNorm->setUniformVec3("uLights[3].position", Vector3(3,10000,7));
+void
+swapBuffers (GLFWwindow* window)
+{
+  PROFILE_SCOPE ("swap");
+  if (window != nullptr)
+    glfwSwapBuffers (window);
+}
 
-      whiteCamera();}
-  }
-      if (state == 45)
-  {
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,0));
+/******************************************************************/
 
-    g_scene->setActiveMesh("rook2");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 4)
-      ++state;
-  }
-  if (state == 46)
-  {
-    g_scene->setActiveMesh("king");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 47)
-  {
-    g_scene->setActiveMesh("king");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 5)
-      ++state;
-  }
-    if (state == 48)
-  {
-    g_scene->setActiveMesh("king");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      blackCamera();
-  }
-      if (state == 49)
-  {
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,7));
-
-    g_scene->setActiveMesh("brook1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x <= 4)
-      whiteCamera();
-  }  
-        if (state == 50)
-  {
-    g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,.0,.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,.0,.0));
-        g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,6));
-
-    g_scene->setActiveMesh("rook2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 5)
-      ++state;
-  }
-      if (state == 51)
-  {
-    g_scene->setActiveMesh("bknight2");
-      g_scene->getActiveMesh()->moveLocal(4, Vector3(-5,0,0));
-      ++state;
-  }    
-          if (state == 52)
-  {
-    g_scene->setActiveMesh("rook2");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 6){
-      blackCamera();  
-    }
-  }
-  if (state == 53)
-  {
-    g_scene->getActiveMesh()->moveLocal(10, Vector3(-5,0,0));
-    ++state;
-  }
-    if (state == 54)
-  {
-    g_scene->setActiveMesh("brook1");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 6)
-      whiteCamera();  
-  }
-              if (state == 55)
-  {
-    g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.9,0.9));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.9,0.9));
-            g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,0));
-
-    g_scene->setActiveMesh("rook");
-    g_scene->getActiveMesh()->moveRight(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 4)
-      blackCamera();  
-  }
-                if (state == 56)
-  {
-            g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(3,2,5));
+double
+getTime ()
+{
+  return std::chrono::duration<double>
+    (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+}
 
-    g_scene->setActiveMesh("bqueen");
-    g_scene->getActiveMesh()->moveBack(-speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z <= 5)
-      whiteCamera();  
-  }
-                  if (state == 57)
-  {
-  g_shaderProgramNorm->setUniformVec3("uLights[3].position", Vector3(3,2,7));
-        g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,.0,.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,.0,.0));
-            g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,6));
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 5)
-      ++state;  
-  }
-              if (state == 58)
-  {
-    g_scene->setActiveMesh("brook1");
-     g_scene->getActiveMesh()->moveLocal(10, Vector3(5,0,0));
-      ++state;  
-  }
-                  if (state == 59)
-  {
-    g_scene->setActiveMesh("bishop");
-    g_scene->getActiveMesh()->moveBack(speed);
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 6)
-      blackCamera();  
-  }
-   if (state == 60)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 61)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 6)
-      ++state;
-  }
-    if (state == 62)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 4){
-      ++state;
-      g_shaderProgramNorm->setUniformVec3("uLights[3].position", Vector3(3,10000,7));
-  }}
-                      if (state == 63)
-  {
-    g_scene->setActiveMesh("bishop");
-      g_scene->getActiveMesh()->moveLocal(12, Vector3(-5,0,0));
+/******************************************************************/
 
-      ++state;  
-  }
-    
-    if (state == 64)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      whiteCamera();
-  }
-      if (state == 65)
-  {
-        //check update king
-          g_shaderProgramNorm->setUniformVec3("uLights[3].position", Vector3(3,2,7));
-
-        g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.9,0.9));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.9,0.9));
-            g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(6,2,7));
-    g_scene->setActiveMesh("queen");
-    g_scene->getActiveMesh()->moveBack(speed * .4);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 7)
-      blackCamera();
-  }
-  if (state == 66)
-  {
-    g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,.0,.0));
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,.0,.0));
-            g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(6,2,7));
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y >= 1)
-      ++state;
-  }
-  if (state == 67)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveBack(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 7)
-      ++state;
-  }
-    if (state == 68)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveRight(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_x >= 6)
-      ++state;
-  }
-                      if (state == 69)
-  {
-    g_scene->setActiveMesh("queen");
-      g_scene->getActiveMesh()->moveLocal(12, Vector3(-5,0,0));
+bool
+parseCount (const char* text, int& count)
+{
+  char* end;
+  errno = 0;
+  long value = std::strtol (text, &end, 10);
+  if (end == text || *end != '\0' || errno == ERANGE || value < 1
+      || value > INT_MAX)
+    return false;
+  count = value;
+  return true;
+}
 
-      ++state;  
-  }
-    
-    if (state == 70)
-  {
-    g_scene->setActiveMesh("bknight1");
-    g_scene->getActiveMesh()->moveUp(-speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_y <= 0)
-      whiteCamera();
-  }
-                if (state == 71)
-  {
-    g_shaderProgramNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.9,0.9,0.9));
-  
+/******************************************************************/
 
-  g_shaderProgramNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.9,0.9,0.9));
-            g_shaderProgramNorm->setUniformVec3("uLights[2].position", Vector3(4,2,7));
-    g_scene->setActiveMesh("rook");
-    g_scene->getActiveMesh()->moveBack(speed);
-    if(g_scene->getActiveMesh()->getWorld().getPosition().m_z >= 7)
-      ++state;  
-  }
-                  if (state == 72)
-  {
-    g_scene->setActiveMesh("bking");
-    g_scene->getActiveMesh()->pitch(1);
-    if(g_scene->getActiveMesh()->getWorld().getUp().m_y <= 0)
-      ++state;  
-  }
-*/
+bool
+isFinished (GLFWwindow* window, unsigned long frames)
+{
+  if (g_frameLimit != 0 && frames >= g_frameLimit)
+    return true;
+  if (g_fullAnimation && g_animationTime >= g_animation->getDuration ())
+    return true;
+  return window != nullptr && glfwWindowShouldClose (window);
 }
 
 /******************************************************************/
 
 void
-drawScene (GLFWwindow* window)
+writeBenchmark (const BenchmarkTimes& times)
 {
-
-  g_context->clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  Transform modelView = g_camera->getViewMatrix();
-  Matrix4 projectionMatrix = g_camera->getProjectionMatrix();
-  g_scene->draw(modelView, projectionMatrix);
-  glfwSwapBuffers (window);
-  
+  bool toStdout = std::string (g_benchmarkFileName) == "-";
+  FILE* out = toStdout ? stdout : fopen (g_benchmarkFileName, "w");
+  if (out == nullptr)
+  {
+    fprintf (stderr, "Failed to open %s\n", g_benchmarkFileName);
+    exit (-1);
+  }
+  fprintf (out, "{\n  \"backend\": \"%s\",\n  \"frames\": %zu,\n"
+	   "  \"fixed_step\": %s,\n  \"vsync\": %s,\n  \"threads\": %u,\n"
+	   "  \"animation_seconds\": %.3f",
+	   g_backend.c_str (), times.frame.size (), g_fixedStep ? "true" : "false",
+	   (g_vsync && g_realContext != nullptr) ? "true" : "false",
+	   JobSystem::getGlobal ().getThreadCount (), g_animationTime);
+  const std::pair<const char*, const std::vector<double>*> parts[] =
+    { { "frame_ms", &times.frame }, { "update_ms", &times.update },
+      { "draw_ms", &times.draw }, { "swap_ms", &times.swap } };
+  for (const auto& part : parts)
+  {
+    ScopeStats stats = computeTimeStats (*part.second);
+    fprintf (out, ",\n  \"%s\": {\"min\": %.4f, \"avg\": %.4f, \"p50\": %.4f,"
+	     " \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+	     part.first, stats.min, stats.average, stats.p50, stats.p95,
+	     stats.p99, stats.max);
+  }
+  fprintf (out, "\n}\n");
+  if (toStdout)
+    fflush (out);
+  else if (fclose (out) != 0)
+    fprintf (stderr, "Failed to write %s\n", g_benchmarkFileName);
 }
 
 
@@ -1651,7 +1009,7 @@ recordMouse (GLFWwindow* window, int button, int action, int mods)
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
 
-  std::cout << xoffset << "  :  " << yoffset << std::endl;
+  std::cerr << xoffset << "  :  " << yoffset << std::endl;
   if (yoffset == 1 && fov < 120)
   {
     ++fov;
@@ -1672,12 +1030,12 @@ cursor_enter_callback(GLFWwindow* window, int entered)
     if (entered)
     {
         // The cursor entered the content area of the window
-         printf("cursor entered \n");
+         fprintf(stderr, "cursor entered \n");
     }
     else
     {
         // The cursor left the content area of the window
-        printf("cursor left \n");
+        fprintf(stderr, "cursor left \n");
     }
 }
 
@@ -1825,6 +1183,7 @@ recordKeys (GLFWwindow* window, int key, int scanCode, int action,
 void
 processKeys ()
 {
+  PROFILE_SCOPE ("processKeys");
   const float MOVEMENT_DELTA = 0.05f;
   if (g_keyBuffer->isKeyDown(GLFW_KEY_W))
     g_camera->moveBack(-MOVEMENT_DELTA);
@@ -1840,34 +1199,38 @@ processKeys ()
     g_camera->moveUp(MOVEMENT_DELTA);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_R))
     g_camera->resetPose();
+  // One handle lookup for every key that moves the active mesh.
+  Mesh* active = g_scene->getActiveMesh();
+  if (active == nullptr)
+    return;
   if (g_keyBuffer->isKeyDown(GLFW_KEY_J))
-    g_scene->getActiveMesh()->yaw(0.25);
+    active->yaw(0.25);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_L))
-    g_scene->getActiveMesh()->yaw(-0.25);
+    active->yaw(-0.25);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_I))
-    g_scene->getActiveMesh()->pitch(0.25);
+    active->pitch(0.25);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_K))
-    g_scene->getActiveMesh()->pitch(-0.25);
+    active->pitch(-0.25);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_N))
-    g_scene->getActiveMesh()->roll(0.25);
+    active->roll(0.25);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_M))
-    g_scene->getActiveMesh()->roll(-0.25);
+    active->roll(-0.25);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_1))
-    g_scene->getActiveMesh()->moveRight(0.05);
+    active->moveRight(0.05);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_2))
-    g_scene->getActiveMesh()->moveRight(-0.05);
+    active->moveRight(-0.05);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_3))
-    g_scene->getActiveMesh()->moveUp(0.05);
+    active->moveUp(0.05);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_4))
-    g_scene->getActiveMesh()->moveUp(-0.05);
+    active->moveUp(-0.05);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_5))
-    g_scene->getActiveMesh()->moveBack(0.05);
+    active->moveBack(0.05);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_6))
-    g_scene->getActiveMesh()->moveBack(-0.05);
+    active->moveBack(-0.05);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_7))
-    g_scene->getActiveMesh()->scaleLocal(1.01);
+    active->scaleLocal(1.01);
   if (g_keyBuffer->isKeyDown(GLFW_KEY_8))
-    g_scene->getActiveMesh()->scaleLocal(0.99);
+    active->scaleLocal(0.99);
 }
 /******************************************************************/
 
@@ -1876,9 +1239,16 @@ releaseGlResources ()
 {
   // Delete OpenGL resources, particularly important if program will
   //   continue running
+  delete g_animation;
+  delete g_highlight;
+  delete g_batch;
   delete g_scene;
   delete g_camera;
   delete g_shaderProgram;
+  Profiler& profiler = Profiler::getGlobal ();
+  if (profiler.isEnabled ())
+    profiler.print (stderr);
+  profiler.releaseGlResources ();
   delete g_context;
 }
 
@@ -55,4 +55,33 @@ Material::setShader(ShaderProgram& program)
   program.setUniformFloat ("uSpecularPower", uSpecularPower);
 }
 
+void
+Material::setShader(CommandBuffer& commands) const
+{
+  commands.setUniformVec3 ("uAmbientReflection", uAmbientReflection);
+  commands.setUniformVec3 ("uEmissiveIntensity", uEmissiveIntensity);
+  commands.setUniformVec3 ("uDiffuseReflection", uDiffuseReflection);
+  commands.setUniformVec3 ("uSpecularReflection", uSpecularReflection);
+  commands.setUniformFloat ("uSpecularPower", uSpecularPower);
+}
 
+void
+Material::setShader(ShaderProgram& program, unsigned int index) const
+{
+  std::string element = "[" + std::to_string (index) + "]";
+  program.setUniformVec3 ("uAmbientReflections" + element, uAmbientReflection);
+  program.setUniformVec3 ("uEmissiveIntensities" + element, uEmissiveIntensity);
+  program.setUniformVec3 ("uDiffuseReflections" + element, uDiffuseReflection);
+  program.setUniformVec3 ("uSpecularReflections" + element, uSpecularReflection);
+  program.setUniformFloat ("uSpecularPowers" + element, uSpecularPower);
+}
+
+bool
+Material::operator==(const Material& other) const
+{
+  return uAmbientReflection == other.uAmbientReflection
+    && uDiffuseReflection == other.uDiffuseReflection
+    && uSpecularReflection == other.uSpecularReflection
+    && uSpecularPower == other.uSpecularPower
+    && uEmissiveIntensity == other.uEmissiveIntensity;
+}
@@ -5,6 +5,7 @@
 #include <GLFW/glfw3.h>
 #include "Vector3.hpp"
 #include "ShaderProgram.hpp"
+#include "CommandBuffer.hpp"
 #include <assimp/Importer.hpp>      
 #include <assimp/scene.h>           
 #include <assimp/postprocess.h>
@@ -32,6 +33,26 @@ public:
     void
     setShader(ShaderProgram& program);
 
+    /// \brief Records the same uniforms setShader would set.
+    /// \param[inout] commands The buffer to record into.
+    /// \pre A packet has been started in commands.
+    void
+    setShader(CommandBuffer& commands) const;
+
+    /// \brief Sets this material as one element of the material arrays that
+    ///   a shader variant with INDIRECT_DRAW defined reads.
+    /// \param[inout] program The program to set uniforms of.
+    /// \param[in] index The element, which is below the shader's
+    ///   MAX_MATERIALS.
+    void
+    setShader(ShaderProgram& program, unsigned int index) const;
+
+    /// \brief Tests whether two materials reflect light the same way.
+    /// \param[in] other The other material.
+    /// \return Whether or not every uniform they set is equal.
+    bool
+    operator==(const Material& other) const;
+
 };
 
 #endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <limits>
 #include "Vector3.hpp"
 #include "Matrix3.hpp"
+#include "Simd.hpp"
 
   /// \brief Initializes a new matrix to the identity matrix.
   /// \post rx, uy, and bz are 1.0f while all other elements are 0.0f.
@@ -379,11 +380,13 @@
   /// \return The result of the multiplication.
   Vector3
   Matrix3::transform (const Vector3& v) const {
-    return Vector3(
-      m_right.m_x * v.m_x + m_up.m_x * v.m_y + m_back.m_x * v.m_z,
-      m_right.m_y * v.m_x + m_up.m_y * v.m_y + m_back.m_y * v.m_z,
-      m_right.m_z * v.m_x + m_up.m_z * v.m_y + m_back.m_z * v.m_z
-    );
+    Vector3 result;
+    Simd::storeColumn3 (&result.m_x,
+                        Simd::transform3 (Simd::loadColumn3 (&m_right.m_x),
+                                          Simd::loadColumn3 (&m_up.m_x),
+                                          Simd::loadColumn3 (&m_back.m_x),
+                                          Simd::loadColumn3 (&v.m_x)));
+    return result;
   }
 
   /// \brief Adds another matrix to this.
@@ -446,24 +449,17 @@
   /// \post This matrix contains the product of itself with m.
   Matrix3&
   Matrix3::operator*= (const Matrix3& m){
-    float rx = m_right.m_x * m.m_right.m_x + m_up.m_x * m.m_right.m_y + m_back.m_x * m.m_right.m_z;
-    float ry = m_right.m_y * m.m_right.m_x + m_up.m_y * m.m_right.m_y + m_back.m_y * m.m_right.m_z;
-    float rz = m_right.m_z * m.m_right.m_x + m_up.m_z * m.m_right.m_y + m_back.m_z * m.m_right.m_z;
-    float ux = m_right.m_x * m.m_up.m_x + m_up.m_x * m.m_up.m_y + m_back.m_x * m.m_up.m_z;
-    float uy = m_right.m_y * m.m_up.m_x + m_up.m_y * m.m_up.m_y + m_back.m_y * m.m_up.m_z;
-    float uz = m_right.m_z * m.m_up.m_x + m_up.m_z * m.m_up.m_y + m_back.m_z * m.m_up.m_z;
-    float bx = m_right.m_x * m.m_back.m_x + m_up.m_x * m.m_back.m_y + m_back.m_x * m.m_back.m_z;
-    float by = m_right.m_y * m.m_back.m_x + m_up.m_y * m.m_back.m_y + m_back.m_y * m.m_back.m_z;
-    float bz = m_right.m_z * m.m_back.m_x + m_up.m_z * m.m_back.m_y + m_back.m_z * m.m_back.m_z;
-    m_right.m_x = rx;
-    m_right.m_y = ry;
-    m_right.m_z = rz;
-    m_up.m_x = ux;
-    m_up.m_y = uy;
-    m_up.m_z = uz;
-    m_back.m_x = bx;
-    m_back.m_y = by;
-    m_back.m_z = bz;
+    // The columns are packed (data () promises 9 contiguous floats), so they
+    //   are loaded three at a time rather than as aligned registers.
+    Simd::Float4 right = Simd::loadColumn3 (&m_right.m_x);
+    Simd::Float4 up = Simd::loadColumn3 (&m_up.m_x);
+    Simd::Float4 back = Simd::loadColumn3 (&m_back.m_x);
+    Simd::Float4 newRight = Simd::transform3 (right, up, back, Simd::loadColumn3 (&m.m_right.m_x));
+    Simd::Float4 newUp = Simd::transform3 (right, up, back, Simd::loadColumn3 (&m.m_up.m_x));
+    Simd::Float4 newBack = Simd::transform3 (right, up, back, Simd::loadColumn3 (&m.m_back.m_x));
+    Simd::storeColumn3 (&m_right.m_x, newRight);
+    Simd::storeColumn3 (&m_up.m_x, newUp);
+    Simd::storeColumn3 (&m_back.m_x, newBack);
     return *this;
   }
 
@@ -532,10 +528,7 @@ operator* (const Matrix3& m1, const Matrix3& m2){
 /// \return A new vector that is m * v.
 Vector3
 operator* (const Matrix3& m, const Vector3& v){
-  Matrix3 temp = m;
-  Matrix3 temp2 (v, Vector3(0,0,0), Vector3(0,0,0));
-  temp *= temp2;
-  return temp.getRight();
+  return m.transform(v);
 }
 
 /// \brief Inserts a matrix into an output stream.
@@ -4,6 +4,7 @@
 /// \version A07
 
 #include "Matrix4.hpp"
+#include "Simd.hpp"
 #include <math.h>
 #include <iomanip>
 
@@ -102,6 +103,14 @@
       m_translation.m_w = 0;
   }
     
+  /// \brief Gets a pointer to the first element.
+  /// \return A pointer to rx, which is 16-byte aligned.
+  float*
+  Matrix4::data ()
+  {
+      return &m_right.m_x;
+  }
+
   /// \brief Gets a const pointer to the first element.
   /// \return A pointer to rx.
   const float*
@@ -283,4 +292,40 @@ operator== (const Matrix4& m1, const Matrix4& m2)
           (fabs(*(m1.data() + 14) - *(m2.data() + 14)) < precision) &&
           (fabs(*(m1.data() + 15) - *(m2.data() + 15)) < precision) 
          );
-}
\ No newline at end of file
+}
+
+/// \brief Multiplies a matrix by another matrix.
+/// \param[in] m1 A matrix.
+/// \param[in] m2 Another matrix.
+/// \return A new matrix that is m1 * m2.
+Matrix4
+operator* (const Matrix4& m1, const Matrix4& m2)
+{
+  const float* a = m1.data ();
+  const float* b = m2.data ();
+  Simd::Float4 c0 = Simd::load (a);
+  Simd::Float4 c1 = Simd::load (a + 4);
+  Simd::Float4 c2 = Simd::load (a + 8);
+  Simd::Float4 c3 = Simd::load (a + 12);
+  Matrix4 result;
+  float* out = result.data ();
+  for (int column = 0; column < 16; column += 4)
+    Simd::store (out + column, Simd::transform4 (c0, c1, c2, c3, Simd::load (b + column)));
+  return result;
+}
+
+/// \brief Multiplies a matrix by a vector.
+/// \param[in] m A matrix.
+/// \param[in] v A vector.
+/// \return A new vector that is m * v.
+Vector4
+operator* (const Matrix4& m, const Vector4& v)
+{
+  const float* a = m.data ();
+  Vector4 result;
+  Simd::storeUnaligned (&result.m_x,
+			Simd::transform4 (Simd::load (a), Simd::load (a + 4),
+					  Simd::load (a + 8), Simd::load (a + 12),
+					  Simd::loadUnaligned (&v.m_x)));
+  return result;
+}
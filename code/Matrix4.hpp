@@ -23,7 +23,9 @@
 /// Operations are consistent with column vectors (v' = M * v).
 /// If the last row contains [ 0 0 0 1 ] the transform is affine; otherwise it
 ///    is projective.
-class Matrix4
+/// The matrix is 16-byte aligned, so each column can be loaded into one SIMD
+///    register.
+class alignas (16) Matrix4
 {
 public:
   /// \brief Initializes to the identity matrix.
@@ -69,6 +71,11 @@ public:
   void
   setToZero ();
     
+  /// \brief Gets a pointer to the first element.
+  /// \return A pointer to rx, which is 16-byte aligned.
+  float*
+  data ();
+
   /// \brief Gets a const pointer to the first element.
   /// \return A pointer to rx.
   const float*
@@ -147,4 +154,18 @@ operator<< (std::ostream& out, const Matrix4& m);
 bool
 operator== (const Matrix4& m1, const Matrix4& m2);
 
+/// \brief Multiplies a matrix by another matrix.
+/// \param[in] m1 A matrix.
+/// \param[in] m2 Another matrix.
+/// \return A new matrix that is m1 * m2.
+Matrix4
+operator* (const Matrix4& m1, const Matrix4& m2);
+
+/// \brief Multiplies a matrix by a vector.
+/// \param[in] m A matrix.
+/// \param[in] v A vector.
+/// \return A new vector that is m * v.
+Vector4
+operator* (const Matrix4& m, const Vector4& v);
+
 #endif//MATRIX4_HPP
@@ -0,0 +1,115 @@
+/// \file MemoryTracker.cpp
+/// \brief Definitions of MemoryTracker class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <set>
+
+#include "MemoryTracker.hpp"
+
+MemoryTracker::MemoryTracker ()
+{
+}
+
+MemoryTracker&
+MemoryTracker::getGlobal ()
+{
+  static MemoryTracker tracker;
+  return tracker;
+}
+
+void
+MemoryTracker::setUsage (const void* owner, const std::string& asset,
+			 MemoryUsage usage)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  Entry& entry = m_entries[owner];
+  entry.asset = asset;
+  entry.usage = usage;
+}
+
+void
+MemoryTracker::remove (const void* owner)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_entries.erase (owner);
+}
+
+MemoryUsage
+MemoryTracker::getUsage (const void* owner) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  auto found = m_entries.find (owner);
+  return (found == m_entries.end ()) ? MemoryUsage () : found->second.usage;
+}
+
+MemoryUsage
+MemoryTracker::getAssetUsage (const std::string& asset) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  MemoryUsage total = MemoryUsage ();
+  for (const auto& entry : m_entries)
+  {
+    if (entry.second.asset == asset)
+    {
+      total.cpuBytes += entry.second.usage.cpuBytes;
+      total.gpuBytes += entry.second.usage.gpuBytes;
+    }
+  }
+  return total;
+}
+
+MemoryUsage
+MemoryTracker::getTotal () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  MemoryUsage total = MemoryUsage ();
+  for (const auto& entry : m_entries)
+  {
+    total.cpuBytes += entry.second.usage.cpuBytes;
+    total.gpuBytes += entry.second.usage.gpuBytes;
+  }
+  return total;
+}
+
+std::vector<std::string>
+MemoryTracker::getAssets () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  std::set<std::string> assets;
+  for (const auto& entry : m_entries)
+    assets.insert (entry.second.asset);
+  return std::vector<std::string> (assets.begin (), assets.end ());
+}
+
+size_t
+MemoryTracker::getOwnerCount () const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_entries.size ();
+}
+
+void
+MemoryTracker::print (FILE* out) const
+{
+  fprintf (out, "%-32s %8s %12s %12s\n", "asset", "owners", "cpu_bytes",
+	   "gpu_bytes");
+  for (const std::string& asset : getAssets ())
+  {
+    size_t owners = 0;
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      for (const auto& entry : m_entries)
+	if (entry.second.asset == asset)
+	  ++owners;
+    }
+    MemoryUsage usage = getAssetUsage (asset);
+    fprintf (out, "%-32s %8zu %12zu %12zu\n", asset.empty () ? "(built in code)"
+	     : asset.c_str (), owners, usage.cpuBytes, usage.gpuBytes);
+  }
+  MemoryUsage total = getTotal ();
+  fprintf (out, "%-32s %8zu %12zu %12zu\n", "total", getOwnerCount (),
+	   total.cpuBytes, total.gpuBytes);
+  fflush (out);
+}
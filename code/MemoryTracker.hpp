@@ -0,0 +1,107 @@
+/// \file MemoryTracker.hpp
+/// \brief Declaration of MemoryTracker class and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef MEMORY_TRACKER_HPP
+#define MEMORY_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \brief Bytes of memory held in main memory and in OpenGL buffers.
+struct MemoryUsage
+{
+  size_t cpuBytes;
+  size_t gpuBytes;
+};
+
+/// \brief Keeps count of how much memory each owner, such as a Mesh, holds
+///   on the CPU and the GPU, and which asset it came from, so that totals
+///   per owner, per asset and overall can be asked for while running.
+///
+/// Owners report their whole usage whenever it changes, rather than each
+///   allocation, so a report is never out of step with what the owner
+///   holds.  Any thread may report or ask.
+class MemoryTracker
+{
+public:
+
+  /// Copy constructor deleted because there is only one MemoryTracker.
+  MemoryTracker (const MemoryTracker&) = delete;
+
+  /// Assignment operator deleted because there is only one MemoryTracker.
+  MemoryTracker&
+  operator= (const MemoryTracker&) = delete;
+
+  /// \brief Gets the MemoryTracker.
+  /// \return The only MemoryTracker.
+  static MemoryTracker&
+  getGlobal ();
+
+  /// \brief Records how much memory an owner holds now.
+  /// \param[in] owner The owner, which is only used as a key.
+  /// \param[in] asset The asset the memory belongs to, such as a model's
+  ///   file name, or "" if it was built in code.
+  /// \param[in] usage The bytes it holds.
+  void
+  setUsage (const void* owner, const std::string& asset, MemoryUsage usage);
+
+  /// \brief Forgets an owner, as when it is destroyed.
+  /// \param[in] owner The owner.
+  void
+  remove (const void* owner);
+
+  /// \brief Gets how much memory an owner holds.
+  /// \param[in] owner The owner.
+  /// \return Its last report, or zeros if it has none.
+  MemoryUsage
+  getUsage (const void* owner) const;
+
+  /// \brief Gets how much memory every owner of an asset holds together.
+  /// \param[in] asset The asset.
+  /// \return The sum of their reports.
+  MemoryUsage
+  getAssetUsage (const std::string& asset) const;
+
+  /// \brief Gets how much memory is held in all.
+  /// \return The sum of every owner's report.
+  MemoryUsage
+  getTotal () const;
+
+  /// \brief Gets the assets that memory is held for.
+  /// \return Their names, sorted, with "" for memory built in code.
+  std::vector<std::string>
+  getAssets () const;
+
+  /// \brief Gets the number of owners being tracked.
+  /// \return The number of owners that have reported and not been removed.
+  size_t
+  getOwnerCount () const;
+
+  /// \brief Prints a table of each asset's usage and the total.
+  /// \param[in] out The stream to print to.
+  void
+  print (FILE* out) const;
+
+private:
+
+  /// One owner's usage.
+  struct Entry
+  {
+    std::string asset;
+    MemoryUsage usage;
+  };
+
+  MemoryTracker ();
+
+  mutable std::mutex m_mutex;
+  std::map<const void*, Entry> m_entries;
+};
+
+#endif//MEMORY_TRACKER_HPP
@@ -5,6 +5,7 @@
 
 #include "Mesh.hpp"
 #include <vector>
+#include <algorithm>
 
 #include "OpenGLContext.hpp"
 #include "ShaderProgram.hpp"
@@ -13,22 +14,43 @@
 #include "Transform.hpp"
 #include "Matrix4.hpp"
 #include "Geometry.hpp"
+#include "Profiler.hpp"
+#include "MemoryTracker.hpp"
+#include "BufferArena.hpp"
+#include "IndirectBatch.hpp"
 
 
 Mesh::Mesh (OpenGLContext* context, ShaderProgram* shader){
   m_context = context;
-  m_context->genVertexArrays (1, &m_vao);
-  m_context->genBuffers (1, &m_vbo);
-  m_context->genBuffers (1, &m_ibo);
-  m_indices = new std::vector<unsigned int>;
-  shape = new std::vector<float>;
+  m_vao = 0;
+  m_vbo = 0;
+  m_ibo = 0;
+  m_vertexCount = 0;
+  m_indexCount = 0;
+  m_drawMode = GL_TRIANGLES;
+  m_firstVertex = 0;
+  m_arena = nullptr;
+  m_arenaRange = 0;
+  m_keepCpuCopy = false;
+  m_gpuBytes = 0;
   m_shaderProgram = shader;
+  m_boundRadius = 0;
+  m_interpolation = 1;
+  m_hasParent = false;
+  m_worldDirty = true;
+  reportMemory ();
 };
 
 Mesh::~Mesh (){
-  m_context->deleteVertexArrays (1, &m_vao);
-  m_context->deleteBuffers (1, &m_vbo );
-  m_context->deleteBuffers (1, &m_ibo );
+  if (m_vao != 0)
+  {
+    m_context->deleteVertexArrays (1, &m_vao);
+    m_context->deleteBuffers (1, &m_vbo );
+    m_context->deleteBuffers (1, &m_ibo );
+  }
+  if (m_arena != nullptr)
+    m_arena->free (m_arenaRange);
+  MemoryTracker::getGlobal ().remove (this);
 };
 
 void
@@ -39,33 +61,222 @@ Mesh::setMaterial(Material material)
 
 void
 Mesh::addGeometry (const std::vector<float>& geometry){
-  shape->insert(shape->end(), geometry.begin(), geometry.end());
+  m_geometry.insert(m_geometry.end(), geometry.begin(), geometry.end());
+  m_vertexCount = m_geometry.size() / 6;
+  reportMemory ();
 };
 
+void
+Mesh::createBuffers ()
+{
+  m_context->genVertexArrays (1, &m_vao);
+  m_context->genBuffers (1, &m_vbo);
+  m_context->genBuffers (1, &m_ibo);
+}
+
 void
 Mesh::prepareVao(){
 
     // Set up triangle geometry
+  createBuffers ();
   m_context->bindVertexArray (m_vao);
   m_context->bindBuffer (GL_ARRAY_BUFFER, m_vbo);
-  m_context->bufferData (GL_ARRAY_BUFFER, shape->size () * sizeof(float),
-			 shape->data (), GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices->size() * sizeof(unsigned int),
-       m_indices->data(), GL_STATIC_DRAW);
+  m_context->bufferData (GL_ARRAY_BUFFER, m_geometry.size () * sizeof(float),
+			 m_geometry.data (), GL_STATIC_DRAW);
+  m_context->bindBuffer (GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+  m_context->bufferData (GL_ELEMENT_ARRAY_BUFFER, m_indices.size () * sizeof(unsigned int),
+			 m_indices.data (), GL_STATIC_DRAW);
+  m_gpuBytes = m_geometry.size () * sizeof(float)
+    + m_indices.size () * sizeof(unsigned int);
   enableAttributes();
   m_context->bindVertexArray (0);
-
+  finishPreparing ();
 };
 
-void 
-Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
+void
+Mesh::prepareVao (BufferArena& arena)
+{
+  m_arena = &arena;
+  m_arenaRange = arena.allocate (m_geometry, m_indices);
+  const ArenaRange& range = arena.getRange (m_arenaRange);
+  m_gpuBytes = range.vertexCount * arena.getFloatsPerVertex () * sizeof(float)
+    + range.indexCount * sizeof(unsigned int);
+  finishPreparing ();
+}
+
+void
+Mesh::finishPreparing ()
+{
+  computeBounds (m_geometry.data (), m_geometry.size ());
+
+  // Everything drawing needs is now in the buffers and the bounds.
+  if (!m_keepCpuCopy)
+  {
+    std::vector<float> ().swap (m_geometry);
+    std::vector<unsigned int> ().swap (m_indices);
+  }
+  reportMemory ();
+}
+
+void
+Mesh::setDrawRange (GLenum mode, GLint first, GLsizei count)
+{
+  m_drawMode = mode;
+  m_firstVertex = first;
+  m_vertexCount = count;
+}
+
+void
+Mesh::computeBounds (const float* geometry, size_t size)
+{
+  // Bound the geometry with a sphere around its axis-aligned box, for culling.
+  unsigned int floatsPerVertex = getFloatsPerVertex ();
+  if (size < floatsPerVertex)
+    return;
+  Vector3 low (geometry[0], geometry[1], geometry[2]);
+  Vector3 high = low;
+  for (size_t i = 0; i + 2 < size; i += floatsPerVertex)
+  {
+    Vector3 position (geometry[i], geometry[i + 1], geometry[i + 2]);
+    low.m_x = std::min (low.m_x, position.m_x);
+    low.m_y = std::min (low.m_y, position.m_y);
+    low.m_z = std::min (low.m_z, position.m_z);
+    high.m_x = std::max (high.m_x, position.m_x);
+    high.m_y = std::max (high.m_y, position.m_y);
+    high.m_z = std::max (high.m_z, position.m_z);
+  }
+  m_boundLow = low;
+  m_boundHigh = high;
+  m_boundCenter = (low + high) / 2;
+  m_boundRadius = 0;
+  for (size_t i = 0; i + 2 < size; i += floatsPerVertex)
+  {
+    Vector3 position (geometry[i], geometry[i + 1], geometry[i + 2]);
+    m_boundRadius = std::max (m_boundRadius, (position - m_boundCenter).length ());
+  }
+}
+
+void
+Mesh::setKeepCpuCopy (bool keep)
+{
+  m_keepCpuCopy = keep;
+}
+
+bool
+Mesh::getKeepCpuCopy () const
+{
+  return m_keepCpuCopy;
+}
+
+const std::vector<float>&
+Mesh::getGeometry () const
+{
+  return m_geometry;
+}
+
+const std::vector<unsigned int>&
+Mesh::getIndices () const
+{
+  return m_indices;
+}
+
+void
+Mesh::setAssetName (const std::string& name)
+{
+  m_assetName = name;
+  reportMemory ();
+}
+
+MemoryUsage
+Mesh::getMemoryUsage () const
+{
+  MemoryUsage usage;
+  usage.cpuBytes = m_geometry.capacity () * sizeof(float)
+    + m_indices.capacity () * sizeof(unsigned int);
+  usage.gpuBytes = m_gpuBytes;
+  return usage;
+}
+
+void
+Mesh::reportMemory () const
+{
+  MemoryTracker::getGlobal ().setUsage (this, m_assetName, getMemoryUsage ());
+}
+
+void
+Mesh::getBoundingSphere (Vector3& center, float& radius) const
+{
+  Transform world = getRenderWorld ();
+  Matrix3 orientation = world.getOrientation ();
+  center = orientation * m_boundCenter + world.getPosition ();
+  // Scaling can stretch the sphere by as much as the longest basis vector.
+  float scale = std::max (orientation.getRight ().length (),
+			  std::max (orientation.getUp ().length (),
+				    orientation.getBack ().length ()));
+  radius = m_boundRadius * scale;
+}
+
+void
+Mesh::getBoundingBox (Vector3& low, Vector3& high) const
+{
+  float corners[8 * 3];
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    corners[corner * 3] = (corner & 1) ? m_boundHigh.m_x : m_boundLow.m_x;
+    corners[corner * 3 + 1] = (corner & 2) ? m_boundHigh.m_y : m_boundLow.m_y;
+    corners[corner * 3 + 2] = (corner & 4) ? m_boundHigh.m_z : m_boundLow.m_z;
+  }
+  getRenderWorld ().transformPoints (corners, corners, 8);
+  low = high = Vector3 (corners[0], corners[1], corners[2]);
+  for (int corner = 1; corner < 8; ++corner)
+  {
+    low.m_x = std::min (low.m_x, corners[corner * 3]);
+    low.m_y = std::min (low.m_y, corners[corner * 3 + 1]);
+    low.m_z = std::min (low.m_z, corners[corner * 3 + 2]);
+    high.m_x = std::max (high.m_x, corners[corner * 3]);
+    high.m_y = std::max (high.m_y, corners[corner * 3 + 1]);
+    high.m_z = std::max (high.m_z, corners[corner * 3 + 2]);
+  }
+}
 
+size_t
+Mesh::addTo (ComponentStore& store, uint32_t materialId) const
+{
+  size_t entity;
+  if (m_arena != nullptr)
+  {
+    const ArenaRange& range = m_arena->getRange (m_arenaRange);
+    entity = store.add (m_shaderProgram, m_arena->getVertexArray (),
+			range.baseVertex, m_vertexCount, range.firstIndex,
+			m_indexCount, materialId, m_boundCenter, m_boundRadius);
+  }
+  else
+    entity = store.add (m_shaderProgram, m_vao,
+			(m_indexCount == 0) ? m_firstVertex : 0, m_vertexCount, 0,
+			m_indexCount, materialId, m_boundCenter, m_boundRadius);
+  store.setWorld (entity, getRenderWorld ());
+  return entity;
+}
+
+bool
+Mesh::addTo (IndirectBatch& batch) const
+{
+  if (m_arena != &batch.getArena () || m_indexCount == 0)
+    return false;
+  return batch.add (m_shaderProgram, m_arena->getRange (m_arenaRange),
+		    getRenderWorld (), m_material);
+}
+
+void 
+Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix,
+           const Vector3& eyePosition){
+  PROFILE_SCOPE("Mesh::draw");
+  Transform world = getRenderWorld ();
   m_shaderProgram->enable ();
-  m_shaderProgram->setUniformMatrix ("uModelView", (viewMatrix * m_world).getTransform());
+  m_shaderProgram->setUniformMatrix ("uModelView", (viewMatrix * world).getTransform());
   m_shaderProgram->setUniformMatrix ("uProjection", projectionMatrix);
   m_shaderProgram->setUniformMatrix ("uView", viewMatrix.getTransform());
-  m_shaderProgram->setUniformMatrix ("uWorld", m_world.getTransform());
+  m_shaderProgram->setUniformMatrix ("uWorld", world.getTransform());
   /*
   m_shaderProgram->setUniformVec3 ("uAmbientReflection", Vector3(1,1,1));
   m_shaderProgram->setUniformVec3 ("uEmissiveIntensity", Vector3(0.0,0.0,0.0));
@@ -74,20 +285,64 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   m_shaderProgram->setUniformFloat ("uSpecularPower", 0.5);
   */
   m_material.setShader(*m_shaderProgram);
+  m_shaderProgram->setUniformVec3 ("uEyePosition", eyePosition);
 
-  //m_shaderProgram->setUniformVec3 ("uEyePosition", Vector3(3.5,0,3.5));
-    m_shaderProgram->setUniformVec3 ("uEyePosition", Vector3(3.5, 8, -5));
-
+  if (m_arena != nullptr)
+  {
+    const ArenaRange& range = m_arena->getRange (m_arenaRange);
+    m_context->bindVertexArray (m_arena->getVertexArray ());
+    if (m_indexCount == 0)
+      m_context->drawArrays (m_drawMode, range.baseVertex, m_vertexCount);
+    else
+      m_context->drawElementsBaseVertex (GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT,
+					 reinterpret_cast<void*> (range.firstIndex * sizeof(unsigned int)),
+					 range.baseVertex);
+    return;
+  }
   m_context->bindVertexArray (m_vao);
-  m_context->drawArrays (GL_TRIANGLES, 0, shape->size()/6);
-  glDrawElements (GL_TRIANGLES, m_indices->size(), GL_UNSIGNED_INT,
-      reinterpret_cast<void*> (0));
+  // Indexed geometry shares vertices between triangles, so it is only
+  //   drawn through its indices, as an IndirectBatch draws it.
+  if (m_indexCount == 0)
+    m_context->drawArrays (m_drawMode, m_firstVertex, m_vertexCount);
+  else
+    m_context->drawElements (GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT,
+			     reinterpret_cast<void*> (0));
   //enableAttributes();
-  m_context->bindVertexArray (0);
-  m_shaderProgram->disable ();
+  // The VAO and program are left bound, so that the next Mesh does not have
+  //   to rebind them if it shares them; the context filters those calls.
 
 };
 
+void
+Mesh::record (CommandBuffer& commands, const Transform& viewMatrix,
+	      const Matrix4& projectionMatrix, const Vector3& eyePosition) const
+{
+  Transform world = getRenderWorld ();
+  commands.beginPacket (m_shaderProgram,
+			(m_arena != nullptr) ? m_arena->getVertexArray () : m_vao);
+  commands.setUniformMatrix ("uModelView", (viewMatrix * world).getTransform());
+  commands.setUniformMatrix ("uProjection", projectionMatrix);
+  commands.setUniformMatrix ("uView", viewMatrix.getTransform());
+  commands.setUniformMatrix ("uWorld", world.getTransform());
+  m_material.setShader (commands);
+  commands.setUniformVec3 ("uEyePosition", eyePosition);
+  if (m_arena != nullptr)
+  {
+    const ArenaRange& range = m_arena->getRange (m_arenaRange);
+    if (m_indexCount == 0)
+      commands.drawArrays (m_drawMode, range.baseVertex, m_vertexCount);
+    else
+      commands.drawElementsBaseVertex (GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT,
+				       range.firstIndex * sizeof(unsigned int),
+				       range.baseVertex);
+    return;
+  }
+  if (m_indexCount == 0)
+    commands.drawArrays (m_drawMode, m_firstVertex, m_vertexCount);
+  else
+    commands.drawElements (GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0);
+}
+
   /// \brief Adds additional triangles to this Mesh.
   /// \param[in] indices A collection of indices into the vertex buffer for 1
   ///   or more triangles.  There must be 3 indices per triangle.
@@ -97,7 +352,9 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::addIndices (const std::vector<unsigned int>& indices)
   {
-    m_indices->insert(m_indices->end(), indices.begin(), indices.end());
+    m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+    m_indexCount = m_indices.size();
+    reportMemory ();
   }
 
   /// \brief Gets the mesh's world matrix.
@@ -107,12 +364,88 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
     return m_world;
   }
 
+  /// \brief Sets the mesh's world matrix.
+  /// \param[in] world The new world matrix.
+  /// \post The mesh has been moved, rotated and scaled to match world.
+  void
+  Mesh::setWorld (const Transform& world){
+    m_world = world;
+    m_worldDirty = true;
+  }
+
+  /// \brief Remembers the current world matrix as the state before the next
+  ///   simulation step.
+  /// \post getRenderWorld blends from the current world matrix.
+  void
+  Mesh::savePreviousWorld (){
+    m_previousWorld = m_world;
+    m_previousParentWorld = m_parentWorld;
+  }
+
+  /// \brief Sets how far between the previous and current world matrices the
+  ///   mesh should be drawn.
+  /// \param[in] amount 0 for the previous world matrix, 1 for the current.
+  void
+  Mesh::setInterpolation (float amount){
+    m_interpolation = amount;
+  }
+
+  /// \brief Gets the world matrix that draw, record and getBoundingSphere
+  ///   use.
+  /// \return The world matrix blended between the previous and current
+  ///   ones, or just the current one if no blending has been asked for.
+  Transform
+  Mesh::getRenderWorld () const{
+    if (!m_hasParent){
+      if (m_interpolation >= 1)
+        return m_world;
+      return interpolate(m_previousWorld, m_world, m_interpolation);
+    }
+    if (m_interpolation >= 1)
+      return m_fullWorld;
+    return interpolate(m_previousParentWorld * m_previousWorld, m_fullWorld, m_interpolation);
+  }
+
+  /// \brief Gets the world matrix relative to the world rather than to the
+  ///   parent.
+  /// \return The parent's full world matrix times this mesh's, as of the
+  ///   last updateWorld.
+  const Transform&
+  Mesh::getFullWorld () const{
+    return m_hasParent ? m_fullWorld : m_world;
+  }
+
+  /// \brief Tests whether the world matrix has changed since the last
+  ///   updateWorld.
+  /// \return Whether or not the mesh has been moved, rotated, etc.
+  bool
+  Mesh::isWorldDirty () const{
+    return m_worldDirty;
+  }
+
+  /// \brief Recomputes the full world matrix from the parent's.
+  /// \param[in] parentWorld The parent's full world matrix, or nullptr if the
+  ///   mesh has no parent.
+  /// \post getFullWorld is up to date and the mesh is not dirty.
+  void
+  Mesh::updateWorld (const Transform* parentWorld){
+    m_hasParent = parentWorld != nullptr;
+    if (m_hasParent){
+      m_parentWorld = *parentWorld;
+      m_fullWorld = m_parentWorld * m_world;
+    }
+    else
+      m_parentWorld.reset();
+    m_worldDirty = false;
+  }
+
   /// \brief Moves the mesh right (locally).
   /// \param[in] distance The distance to move the mesh.
   /// \post The mesh has been moved.
   void
   Mesh::moveRight (float distance){
     m_world.moveRight(distance);
+    m_worldDirty = true;
   }
 
   /// \brief Moves the mesh up (locally).
@@ -121,6 +454,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::moveUp (float distance){
     m_world.moveUp(distance);
+    m_worldDirty = true;
   }
 
   /// \brief Moves the mesh back (locally).
@@ -129,6 +463,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::moveBack (float distance){
     m_world.moveBack(distance);
+    m_worldDirty = true;
   }
 
   /// \brief Moves the mesh in some local direction.
@@ -138,6 +473,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::moveLocal (float distance, const Vector3& localDirection){
     m_world.moveLocal(distance, localDirection);
+    m_worldDirty = true;
   }
 
   /// \brief Moves the mesh in some world direction.
@@ -147,6 +483,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::moveWorld (float distance, const Vector3& worldDirection){
     m_world.moveWorld(distance, worldDirection);
+    m_worldDirty = true;
   }
 
   /// \brief Rotates the mesh around its own local right axis.
@@ -155,6 +492,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::pitch (float angleDegrees){
     m_world.pitch(angleDegrees);
+    m_worldDirty = true;
   }
 
   /// \brief Rotates the mesh around its own local up axis.
@@ -163,6 +501,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::yaw (float angleDegrees){
     m_world.yaw(angleDegrees);
+    m_worldDirty = true;
   }
 
   /// \brief Rotates the mesh around its own local back axis.
@@ -171,6 +510,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::roll (float angleDegrees){
     m_world.roll(angleDegrees);
+    m_worldDirty = true;
   }
 
   /// \brief Rotates the mesh around some local direction.
@@ -180,6 +520,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::rotateLocal (float angleDegrees, const Vector3& axis){
     m_world.rotateLocal(angleDegrees, axis);
+    m_worldDirty = true;
   }
 
   /// \brief Aligns the mesh with the world Y axis.
@@ -189,6 +530,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::alignWithWorldY (){
     m_world.alignWithWorldY();
+    m_worldDirty = true;
   }
 
   /// \brief Scales the mesh (locally).
@@ -197,6 +539,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::scaleLocal (float scale){
     m_world.scaleLocal(scale);
+    m_worldDirty = true;
   }
 
   /// \brief Scales the mesh (locally).
@@ -207,6 +550,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::scaleLocal (float scaleX, float scaleY, float scaleZ){
     m_world.scaleLocal(scaleX, scaleY, scaleZ);
+    m_worldDirty = true;
   }
     
   /// \brief Scales the mesh (worldly).
@@ -215,6 +559,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::scaleWorld (float scale){
     m_world.scaleWorld(scale);
+    m_worldDirty = true;
   }
 
   /// \brief Scales the mesh (worldly).
@@ -225,6 +570,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::scaleWorld (float scaleX, float scaleY, float scaleZ){
     m_world.scaleWorld(scaleX, scaleY, scaleZ);
+    m_worldDirty = true;
   }
 
   /// \brief Shears the mesh's local X by its local Y and local Z.
@@ -234,6 +580,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::shearLocalXByYz (float shearY, float shearZ){
     m_world.shearLocalXByYz(shearY, shearZ);
+    m_worldDirty = true;
   }
 
   /// \brief Shears the mesh's local Y by its local X and local Z.
@@ -243,6 +590,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::shearLocalYByXz (float shearX, float shearZ){
     m_world.shearLocalYByXz(shearX, shearZ);
+    m_worldDirty = true;
   }
 
   /// \brief Shears the mesh's local Z by its local X and local Y.
@@ -252,6 +600,7 @@ Mesh::draw(const Transform& viewMatrix, const Matrix4& projectionMatrix){
   void
   Mesh::shearLocalZByXy (float shearX, float shearY){
     m_world.shearLocalZByXy(shearX, shearY);
+    m_worldDirty = true;
   }
 
   /// \brief Gets the number of floats used to represent each vertex.
@@ -6,15 +6,29 @@
 #ifndef MESH_HPP
 #define MESH_HPP
 
+#include <string>
 #include <vector>
 #include "Transform.hpp"
 #include "OpenGLContext.hpp"
 #include "ShaderProgram.hpp"
 #include "Matrix4.hpp"
+#include "Vector3.hpp"
 #include "Material.hpp"
+#include "CommandBuffer.hpp"
+#include "ComponentStore.hpp"
+#include "MemoryTracker.hpp"
+
+class BufferArena;
+class IndirectBatch;
 
 /// \brief An object that exists in the world, which consists of one or more
 ///   3-D triangles.
+///
+/// Geometry and indices are gathered in main memory and uploaded by
+///   prepareVao, after which only the OpenGL buffers are needed to draw.  The
+///   CPU copies are then freed, unless setKeepCpuCopy asked for them to be
+///   kept for picking, collision or anything else that reads vertices.  What
+///   each Mesh holds is reported to the global MemoryTracker.
 class Mesh
 {
 public:
@@ -44,12 +58,14 @@ public:
   /// \brief Constructs an empty Mesh with no triangles.
   /// \param context A pointer to an object through which the Mesh will be able
   ///   to make OpenGL calls.
-  /// \post A unique VAO and VBO have been generated for this Mesh and stored
-  ///   for later use.
+  /// \post No OpenGL objects have been generated yet; prepareVao does that,
+  ///   unless the Mesh is put in a BufferArena.
   Mesh (OpenGLContext* context, ShaderProgram* shader);
 
   /// \brief Destructs this Mesh.
-  /// \post The VAO and VBO associated with this Mesh have been deleted.
+  /// \post The VAO and VBO associated with this Mesh have been deleted, or
+  ///   its range of a BufferArena freed, and it is no longer counted by the
+  ///   MemoryTracker.
   virtual
   ~Mesh ();
 
@@ -81,26 +97,176 @@ public:
   /// \post The first two vertex attributes have been enabled, with
   ///   interleaved 3-part positions and 3-part colors.
   /// \post This Mesh's geometry has been copied to its VBO.
+  /// \post Unless the Mesh keeps its CPU copy, its geometry and indices
+  ///   have been freed from main memory.
   void
   prepareVao ();
 
+  /// \brief Copies this Mesh's geometry and indices into a range of a
+  ///   BufferArena, instead of buffers of its own, and draws from there.
+  /// \param[inout] arena The arena, whose layout matches this Mesh's and
+  ///   which outlives it.
+  /// \pre This Mesh has not yet been prepared.
+  /// \post This Mesh draws with the arena's VAO and glDrawElementsBaseVertex.
+  /// \post Unless the Mesh keeps its CPU copy, its geometry and indices
+  ///   have been freed from main memory.
+  void
+  prepareVao (BufferArena& arena);
+
+  /// \brief Chooses whether this Mesh keeps its geometry and indices in main
+  ///   memory after prepareVao uploads them.  By default it does not.
+  /// \param[in] keep Whether or not to keep them.
+  /// \pre This Mesh has not yet been prepared.
+  void
+  setKeepCpuCopy (bool keep);
+
+  /// \brief Tells whether this Mesh keeps its CPU copy after preparing.
+  /// \return Whether or not setKeepCpuCopy asked it to.
+  bool
+  getKeepCpuCopy () const;
+
+  /// \brief Gets the geometry added to this Mesh.
+  /// \return The interleaved vertex data, which is empty once the Mesh has
+  ///   been prepared unless it keeps its CPU copy.
+  const std::vector<float>&
+  getGeometry () const;
+
+  /// \brief Gets the indices added to this Mesh.
+  /// \return The indices, which are empty once the Mesh has been prepared
+  ///   unless it keeps its CPU copy.
+  const std::vector<unsigned int>&
+  getIndices () const;
+
+  /// \brief Names the asset that this Mesh was made from, which its memory
+  ///   is counted under.
+  /// \param[in] name The asset's name, such as a model's file name.
+  void
+  setAssetName (const std::string& name);
+
+  /// \brief Gets how much memory this Mesh holds.
+  /// \return The bytes of its CPU copy and of its OpenGL buffers.
+  MemoryUsage
+  getMemoryUsage () const;
+
   /// \brief Draws this Mesh in OpenGL.
   /// \param[in] shaderProgram A pointer to the ShaderProgram that should
   ///   be used.
   /// \param[in] viewMatrix The view matrix that should be used by itself as
   ///   the model-view matrix (there is not yet any model part).
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
   /// \pre This Mesh has been prepared.
   /// \post While the ShaderProgram was enabled, the viewMatrix has been set as
-  ///   the "uModelView" uniform matrix and the geometry has been drawn.
+  ///   the "uModelView" uniform matrix and the geometry has been drawn,
+  ///   through its indices if it has any, or else as its draw range.
+  void
+  draw (const Transform& viewMatrix, const Matrix4& projectionMatrix,
+	const Vector3& eyePosition);
+
+  /// \brief Records the packet that draw would submit, without making any
+  ///   OpenGL calls.
+  /// \param[inout] commands The buffer to record into.
+  /// \param[in] viewMatrix The view matrix.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  /// \pre This Mesh has been prepared.
+  /// \post A packet that draws this Mesh has been added to commands.
   void
-  draw (const Transform& viewMatrix, const Matrix4& projectionMatrix);
+  record (CommandBuffer& commands, const Transform& viewMatrix,
+	  const Matrix4& projectionMatrix, const Vector3& eyePosition) const;
   
   
+  /// \brief Gets a sphere that contains this Mesh, in world coordinates.
+  /// \param[out] center The center of the sphere.
+  /// \param[out] radius The radius of the sphere.
+  /// \pre This Mesh has been prepared.
+  void
+  getBoundingSphere (Vector3& center, float& radius) const;
+
+  /// \brief Gets an axis-aligned box that contains this Mesh, in world
+  ///   coordinates.
+  /// \param[out] low The corner with the smallest coordinates.
+  /// \param[out] high The corner with the largest coordinates.
+  /// \pre This Mesh has been prepared.
+  void
+  getBoundingBox (Vector3& low, Vector3& high) const;
+
+  /// \brief Copies what drawing this Mesh needs into a ComponentStore.
+  /// \param[inout] store The store to add an entity to.
+  /// \param[in] materialId The ID in store of this Mesh's material.
+  /// \pre This Mesh has been prepared.  If it is in a BufferArena, the
+  ///   entity keeps its range where it is now, so it must be added again
+  ///   after the arena packs its ranges.
+  /// \return The new entity, placed where this Mesh is drawn.
+  size_t
+  addTo (ComponentStore& store, uint32_t materialId) const;
+
+  /// \brief Adds a draw of this Mesh to an IndirectBatch, if it can be
+  ///   drawn from there.
+  /// \param[inout] batch The batch to add to.
+  /// \pre This Mesh has been prepared.
+  /// \return Whether or not the draw was added, which it is only if this
+  ///   Mesh has indices in the batch's arena and the batch had room for its
+  ///   material.  Its indices are all that the batch draws.
+  bool
+  addTo (IndirectBatch& batch) const;
+
   /// \brief Gets the mesh's world matrix.
-  /// \return The world matrix.
+  /// \return The world matrix, which is relative to the parent if the Scene
+  ///   has given the mesh one.
   Transform
   getWorld () const;
 
+  /// \brief Sets the mesh's world matrix.  If the Scene has given the mesh
+  ///   a parent, this is relative to the parent.
+  /// \param[in] world The new world matrix.
+  /// \post The mesh has been moved, rotated and scaled to match world.
+  void
+  setWorld (const Transform& world);
+
+  /// \brief Remembers the current world matrix as the state before the next
+  ///   simulation step.
+  /// \post getRenderWorld blends from the current world matrix.
+  void
+  savePreviousWorld ();
+
+  /// \brief Sets how far between the previous and current world matrices the
+  ///   mesh should be drawn.
+  /// \param[in] amount 0 for the previous world matrix, 1 for the current.
+  void
+  setInterpolation (float amount);
+
+  /// \brief Gets the world matrix that draw, record and getBoundingSphere
+  ///   use.
+  /// \return The world matrix blended between the previous and current
+  ///   ones, or just the current one if no blending has been asked for.
+  Transform
+  getRenderWorld () const;
+
+  /// \brief Gets the world matrix relative to the world rather than to the
+  ///   parent.
+  /// \return The parent's full world matrix times this mesh's, as of the
+  ///   last updateWorld, or just this mesh's if it has no parent.
+  const Transform&
+  getFullWorld () const;
+
+  /// \brief Tests whether the world matrix has changed since the last
+  ///   updateWorld.
+  /// \return Whether or not the mesh has been moved, rotated, etc.
+  bool
+  isWorldDirty () const;
+
+  /// \brief Recomputes the full world matrix from the parent's.  The Scene
+  ///   calls this, parents first, for meshes that are dirty or whose parents
+  ///   are.
+  /// \param[in] parentWorld The parent's full world matrix, or nullptr if the
+  ///   mesh has no parent.
+  /// \post getFullWorld is up to date and the mesh is not dirty.
+  void
+  updateWorld (const Transform* parentWorld);
+
   /// \brief Moves the mesh right (locally).
   /// \param[in] distance The distance to move the mesh.
   /// \post The mesh has been moved.
@@ -226,21 +392,89 @@ protected:
   virtual void
   enableAttributes();
 
+  /// \brief Sets which vertices draw and record draw, which they only do if
+  ///   this Mesh has no indices.
+  /// \param[in] mode The kind of primitives, such as GL_TRIANGLES or
+  ///   GL_LINES.
+  /// \param[in] first The first vertex in the VBO.
+  /// \param[in] count The number of vertices.
+  void
+  setDrawRange (GLenum mode, GLint first, GLsizei count);
+
+  /// \brief Finds the bounding sphere and box of some geometry.
+  /// \param[in] geometry Interleaved vertex data, with the position first
+  ///   in each vertex.
+  /// \param[in] size The number of floats in geometry.
+  /// \post getBoundingSphere and getBoundingBox contain the geometry.
+  void
+  computeBounds (const float* geometry, size_t size);
+
+  /// Tells the MemoryTracker what this Mesh holds now.
+  void
+  reportMemory () const;
+
+  /// \brief Generates this Mesh's own VAO, VBO and IBO.
+  void
+  createBuffers ();
+
   OpenGLContext* m_context;
+  GLuint m_vao;
+  GLuint m_vbo;
+  /// Vertex data, until it is uploaded and freed.
+  std::vector<float> m_geometry;
+  /// The bytes uploaded to the VBO and IBO.
+  size_t m_gpuBytes;
 
 private:
 
   /// A pointer to the object through which this Mesh will make OpenGL calls.
   // TODO: Add the other data members you think you will need here.
-  GLuint m_vao;
-  GLuint m_vbo;
   GLuint m_ibo;
-  std::vector<float>* shape;
+  /// Indices, until they are uploaded and freed.
+  std::vector<unsigned int> m_indices;
+  /// The primitives and first vertex drawn without indices.
+  GLenum m_drawMode;
+  GLint m_firstVertex;
+  /// The arena this Mesh was prepared in, or nullptr if it has its own
+  ///   buffers, and the ID of its range there.
+  BufferArena* m_arena;
+  unsigned int m_arenaRange;
+  /// The number of vertices drawn without and with indices, which outlive
+  ///   the CPU copy.
+  GLsizei m_vertexCount;
+  GLsizei m_indexCount;
+  /// Whether or not prepareVao keeps the CPU copy.
+  bool m_keepCpuCopy;
+  /// The asset that memory is counted under.
+  std::string m_assetName;
+  /// The world matrix, relative to the parent if there is one.
   Transform m_world;
-  std::vector<unsigned int>* m_indices;
+  /// The world matrix before the latest simulation step.
+  Transform m_previousWorld;
+  /// Whether or not the Scene has given this mesh a parent.
+  bool m_hasParent;
+  /// Whether or not m_world has changed since the last updateWorld.
+  bool m_worldDirty;
+  /// The parent's full world matrix, now and before the latest step.
+  Transform m_parentWorld;
+  Transform m_previousParentWorld;
+  /// m_parentWorld * m_world.
+  Transform m_fullWorld;
+  /// How far from m_previousWorld to m_world to draw the mesh.
+  float m_interpolation;
   ShaderProgram* m_shaderProgram;
   Material m_material;
-
+  /// The center of a sphere containing the geometry, in model coordinates.
+  Vector3 m_boundCenter;
+  /// The radius of that sphere.
+  float m_boundRadius;
+  /// The corners of the geometry's axis-aligned box, in model coordinates.
+  Vector3 m_boundLow;
+  Vector3 m_boundHigh;
+
+  /// Finds the bounds and frees the CPU copy once the geometry is uploaded.
+  void
+  finishPreparing ();
 };
 
 #endif//MESH_HPP
@@ -22,8 +22,13 @@
 #include <array>
 #include "Material.hpp"
 #include "LightSource.hpp"
+#include "IndirectBatch.hpp"
 
-MyScene::MyScene (OpenGLContext* context, ShaderProgram* shader, ShaderProgram* shaderNorm){
+MyScene::MyScene (OpenGLContext* context, ShaderProgram* shader, ShaderProgram* shaderNorm,
+                  bool multiDraw){
+  // Every NormalsMesh has positions in attribute 0 and normals in 2.
+  std::vector<VertexAttribute> normalsLayout { { 0, 3, 0 }, { 2, 3, 3 } };
+  m_arena = new BufferArena(context, normalsLayout, 6);
   
   std::vector<float> triVertices {
     5.0f, 5.0f, 0.0f,   // 3-d coordinates of first vertex (X, Y, Z)
@@ -327,98 +332,34 @@ std::vector<float> chesboard {
     0.8f, 0.1f, 0.6f,
 };
   
-  shaderNorm->enable();
-  shaderNorm->setUniformInt("uNumLights", 4);
-  shaderNorm->setUniformVec3("uAmbientIntensity", Vector3(0.1,0.1,0.1));
-  //LightSource a1 = LightSource(Vector3(0.6,0.6,0.6), Vector3(0.6,0.6,0.6));
-  //DirectionalLightSource sun (Vector3(0.5, 0.5, 0.5), Vector3(0.5,0.5,0.5), Vector3(0,-1,0));
-  //SpotLightSource spotlight (Vector3())
-  //sun.setUniforms(shaderNorm, 0);
-
-//Lights
-  
-///// Light 0 /////
-
-  //type  0 if directional, 1 if point, 2 if spot
-  shaderNorm->setUniformInt("uLights[0].type", 0);  
-  
-  // All lights have these parameters
-  shaderNorm->setUniformVec3("uLights[0].diffuseIntensity", Vector3(0.5,0.5,0.5));
-  shaderNorm->setUniformVec3("uLights[0].specularIntensity", Vector3(0.5,0.5,0.5));
-
-  // Point and spot light parameters.
-  //shaderNorm->setUniformVec3("uLights[0].position", Vector3(1,2,1));
-  //shaderNorm->setUniformVec3("uLights[0].attenuationCoefficients", Vector3(0.1,0.1,0.1));
-
-  // Directional and spot light parameter.
-  shaderNorm->setUniformVec3("uLights[0].direction", Vector3(0,-1,0));
-
-  // Spot light parameters.
-  //shaderNorm->setUniformFloat("uLights[0].cutoffCosAngle", 45);
-  //shaderNorm->setUniformFloat("uLights[0].falloff", 0.5);
-
-//////Light 1////////
-
-  //type  0 if directional, 1 if point, 2 if spot
-  shaderNorm->setUniformInt("uLights[1].type", 0);  
-  
-  // All lights have these parameters.
-  shaderNorm->setUniformVec3("uLights[1].diffuseIntensity", Vector3(0.3,0.3,0.3));
-  shaderNorm->setUniformVec3("uLights[1].specularIntensity", Vector3(0.3,0.3,0.3));
-
-  // Point and spot light parameters.
-  //shaderNorm->setUniformVec3("uLights[1].position", Vector3(6,2,6));
-  //shaderNorm->setUniformVec3("uLights[1].attenuationCoefficients", Vector3(0.1,0.1,0.1));
-
-  // Directional and spot light parameter.
-  shaderNorm->setUniformVec3("uLights[1].direction", Vector3(-1,0,0));
-
-  // Spot light parameters.
-  //shaderNorm->setUniformFloat("uLights[1].cutoffCosAngle", XXXX);
-  //shaderNorm->setUniformFloat("uLights[1].falloff", XXXX);
+  //Lights
+  DirectionalLightSource light0 (Vector3(0.5,0.5,0.5), Vector3(0.5,0.5,0.5), Vector3(0,-1,0));
+  DirectionalLightSource light1 (Vector3(0.3,0.3,0.3), Vector3(0.3,0.3,0.3), Vector3(-1,0,0));
 /*
 Note: this is intended to be a spot light to illuminate where each move ends
 but my spot lights are not functional
 light type should be 2 but again not functional
 */
-//Light 2
-  //type  0 if directional, 1 if point, 2 if spot
-  shaderNorm->setUniformInt("uLights[2].type", 1);  
-  
-  // All lights have these parameters.
-  shaderNorm->setUniformVec3("uLights[2].diffuseIntensity", Vector3(0.7,.7,0.7));
-  shaderNorm->setUniformVec3("uLights[2].specularIntensity", Vector3(0.7,.7,.7));
-
-  // Point and spot light parameters.
-  shaderNorm->setUniformVec3("uLights[2].position", Vector3(4,2,4));
-  shaderNorm->setUniformVec3("uLights[2].attenuationCoefficients", Vector3(0.1,0.1,0.1));
-
-  // Directional and spot light parameter.
-  shaderNorm->setUniformVec3("uLights[2].direction", Vector3(0,1,0));
-
-  // Spot light parameters.
-  shaderNorm->setUniformFloat("uLights[2].cutoffCosAngle", 10);
-  shaderNorm->setUniformFloat("uLights[2].falloff", 100);
-
-//blue point light to illuminate if a king is in check
-//Light 3
-  //type  0 if directional, 1 if point, 2 if spot
-  shaderNorm->setUniformInt("uLights[3].type", 1);  
-  
-  // All lights have these parameters.
-  shaderNorm->setUniformVec3("uLights[3].diffuseIntensity", Vector3(0,0,1));
-  shaderNorm->setUniformVec3("uLights[3].specularIntensity", Vector3(0,0,1));
-
-  // Point and spot light parameters.
-  shaderNorm->setUniformVec3("uLights[3].position", Vector3(3,100,7));
-  shaderNorm->setUniformVec3("uLights[3].attenuationCoefficients", Vector3(0.1,0.1,0.1));
-
-  // Directional and spot light parameter.
-  //shaderNorm->setUniformVec3("uLights[3].direction", Vector3(0,-1,0));
-
-  // Spot light parameters.
-  //shaderNorm->setUniformFloat("uLights[3].cutoffCosAngle", XXXX);
-  //shaderNorm->setUniformFloat("uLights[3].falloff", XXXX);
+  PointLightSource light2 (Vector3(0.7,.7,0.7), Vector3(0.7,.7,.7), Vector3(4,2,4), Vector3(0.1,0.1,0.1));
+  //blue point light to illuminate if a king is in check
+  PointLightSource light3 (Vector3(0,0,1), Vector3(0,0,1), Vector3(3,100,7), Vector3(0.1,0.1,0.1));
+  std::vector<LightSource*> lights {&light0, &light1, &light2, &light3};
+
+  // Every lit mesh uses the variant of the shader made for exactly these
+  //   lights, whose uniforms are separate from the general program's.
+  shaderNorm = shaderNorm->getVariant(getLightDefines(lights));
+  shaderNorm->enable();
+  setLightUniforms(shaderNorm, lights);
+  shaderNorm->setUniformVec3("uAmbientIntensity", Vector3(0.1,0.1,0.1));
+  // A multi-drawing IndirectBatch draws them with a variant of that variant,
+  //   which needs the same lights.  Nothing else uses it, so it is only
+  //   compiled when it will be.
+  if (multiDraw){
+    ShaderProgram* shaderIndirect = IndirectBatch::getMultiDrawVariant(shaderNorm);
+    shaderIndirect->enable();
+    setLightUniforms(shaderIndirect, lights);
+    shaderIndirect->setUniformVec3("uAmbientIntensity", Vector3(0.1,0.1,0.1));
+  }
 /*
 //Light 4
   //type  0 if directional, 1 if point, 2 if spot
@@ -540,7 +481,7 @@ light type should be 2 but again not functional
   square->setMaterial(*blackplastic);
   square->moveBack(-0.5);
   square->moveRight(-0.5);
-  square->prepareVao();
+  square->prepareVao(*m_arena);
   square->scaleLocal(8);
   add("square", square);
 
@@ -647,7 +588,7 @@ light type should be 2 but again not functional
   NormalsMesh* checkers = new NormalsMesh(context, shaderNorm, "models/checkers.obj", 0);
   checkers->setMaterial(*whiteplastic);
   checkers->moveUp(0.002);
-  checkers->prepareVao();
+  checkers->prepareVao(*m_arena);
   add("checkers", checkers);
 
 
@@ -655,14 +596,14 @@ light type should be 2 but again not functional
   rook->setMaterial(*bronze);
   //rook2->moveBack(1);
   rook->scaleLocal(0.1);
-  rook->prepareVao();
+  rook->prepareVao(*m_arena);
   add("rook", rook);
 
    NormalsMesh* rook2 = new NormalsMesh(context, shaderNorm, "models/rook2.obj", 0);
   rook2->setMaterial(*bronze);
   rook2->moveRight(7);
   rook2->scaleLocal(0.1);
-  rook2->prepareVao();
+  rook2->prepareVao(*m_arena);
   add("rook2", rook2);
 
   NormalsMesh* brook1 = new NormalsMesh(context, shaderNorm, "models/rook2.obj", 0);
@@ -670,21 +611,21 @@ light type should be 2 but again not functional
   brook1->moveRight(7);
   brook1->moveBack(7);
   brook1->scaleLocal(0.1);
-  brook1->prepareVao();
+  brook1->prepareVao(*m_arena);
   add("brook1", brook1);
 
   NormalsMesh* brook2 = new NormalsMesh(context, shaderNorm, "models/rook2.obj", 0);
   brook2->setMaterial(*emerald);
   brook2->moveBack(7);
   brook2->scaleLocal(0.1);
-  brook2->prepareVao();
+  brook2->prepareVao(*m_arena);
   add("brook2", brook2);
 
   NormalsMesh* queen = new NormalsMesh(context, shaderNorm, "models/queen.obj", 0);
   queen->setMaterial(*bronze);
   queen->moveRight(4);
   queen->scaleLocal(0.25);
-  queen->prepareVao();
+  queen->prepareVao(*m_arena);
   add("queen", queen);
 
   NormalsMesh* bqueen = new NormalsMesh(context, shaderNorm, "models/queen.obj", 0);
@@ -692,14 +633,14 @@ light type should be 2 but again not functional
   bqueen->moveRight(4);
   bqueen->moveBack(7);
   bqueen->scaleLocal(0.25);
-  bqueen->prepareVao();
+  bqueen->prepareVao(*m_arena);
   add("bqueen", bqueen);
 
   NormalsMesh* pawn = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
   pawn->setMaterial(*bronze);
   pawn->moveBack(1);
   pawn->scaleLocal(0.1);
-  pawn->prepareVao();
+  pawn->prepareVao(*m_arena);
   add("pawn", pawn);
 
   NormalsMesh* pawn2 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -707,7 +648,7 @@ light type should be 2 but again not functional
   pawn2->moveBack(1);
   pawn2->moveRight(1);
   pawn2->scaleLocal(0.1);
-  pawn2->prepareVao();
+  pawn2->prepareVao(*m_arena);
   add("pawn2", pawn2);
 
     NormalsMesh* pawn3 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -715,7 +656,7 @@ light type should be 2 but again not functional
   pawn3->moveBack(1);
   pawn3->moveRight(2);
   pawn3->scaleLocal(0.1);
-  pawn3->prepareVao();
+  pawn3->prepareVao(*m_arena);
   add("pawn3", pawn3);
 
     NormalsMesh* pawn4 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -723,7 +664,7 @@ light type should be 2 but again not functional
   pawn4->moveBack(1);
   pawn4->moveRight(3);
   pawn4->scaleLocal(0.1);
-  pawn4->prepareVao();
+  pawn4->prepareVao(*m_arena);
   add("pawn4", pawn4);
 
     NormalsMesh* pawn5 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -731,7 +672,7 @@ light type should be 2 but again not functional
   pawn5->moveBack(1);
   pawn5->moveRight(4);
   pawn5->scaleLocal(0.1);
-  pawn5->prepareVao();
+  pawn5->prepareVao(*m_arena);
   add("pawn5", pawn5);
 
     NormalsMesh* pawn6 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -739,7 +680,7 @@ light type should be 2 but again not functional
   pawn6->moveBack(1);
   pawn6->moveRight(5);
   pawn6->scaleLocal(0.1);
-  pawn6->prepareVao();
+  pawn6->prepareVao(*m_arena);
   add("pawn6", pawn6);
 
     NormalsMesh* pawn7 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -747,7 +688,7 @@ light type should be 2 but again not functional
   pawn7->moveBack(1);
   pawn7->moveRight(6);
   pawn7->scaleLocal(0.1);
-  pawn7->prepareVao();
+  pawn7->prepareVao(*m_arena);
   add("pawn7", pawn7);
 
     NormalsMesh* pawn8 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -755,14 +696,14 @@ light type should be 2 but again not functional
   pawn8->moveBack(1);
   pawn8->moveRight(7);
   pawn8->scaleLocal(0.1);
-  pawn8->prepareVao();
+  pawn8->prepareVao(*m_arena);
   add("pawn8", pawn8);
 
   NormalsMesh* bpawn = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
   bpawn->setMaterial(*emerald);
   bpawn->moveBack(6);
   bpawn->scaleLocal(0.1);
-  bpawn->prepareVao();
+  bpawn->prepareVao(*m_arena);
   add("bpawn", bpawn);
 
   NormalsMesh* bpawn2 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -770,7 +711,7 @@ light type should be 2 but again not functional
   bpawn2->moveBack(6);
   bpawn2->moveRight(1);
   bpawn2->scaleLocal(0.1);
-  bpawn2->prepareVao();
+  bpawn2->prepareVao(*m_arena);
   add("bpawn2", bpawn2);
 
     NormalsMesh* bpawn3 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -778,7 +719,7 @@ light type should be 2 but again not functional
   bpawn3->moveBack(6);
   bpawn3->moveRight(2);
   bpawn3->scaleLocal(0.1);
-  bpawn3->prepareVao();
+  bpawn3->prepareVao(*m_arena);
   add("bpawn3", bpawn3);
 
     NormalsMesh* bpawn4 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -786,7 +727,7 @@ light type should be 2 but again not functional
   bpawn4->moveBack(6);
   bpawn4->moveRight(3);
   bpawn4->scaleLocal(0.1);
-  bpawn4->prepareVao();
+  bpawn4->prepareVao(*m_arena);
   add("bpawn4", bpawn4);
 
     NormalsMesh* bpawn5 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -794,7 +735,7 @@ light type should be 2 but again not functional
   bpawn5->moveBack(6);
   bpawn5->moveRight(4);
   bpawn5->scaleLocal(0.1);
-  bpawn5->prepareVao();
+  bpawn5->prepareVao(*m_arena);
   add("bpawn5", bpawn5);
 
     NormalsMesh* bpawn6 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -802,7 +743,7 @@ light type should be 2 but again not functional
   bpawn6->moveBack(6);
   bpawn6->moveRight(5);
   bpawn6->scaleLocal(0.1);
-  bpawn6->prepareVao();
+  bpawn6->prepareVao(*m_arena);
   add("bpawn6", bpawn6);
 
     NormalsMesh* bpawn7 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -810,7 +751,7 @@ light type should be 2 but again not functional
   bpawn7->moveBack(6);
   bpawn7->moveRight(6);
   bpawn7->scaleLocal(0.1);
-  bpawn7->prepareVao();
+  bpawn7->prepareVao(*m_arena);
   add("bpawn7", bpawn7);
 
     NormalsMesh* bpawn8 = new NormalsMesh(context, shaderNorm, "models/pawn.obj", 0);
@@ -818,21 +759,21 @@ light type should be 2 but again not functional
   bpawn8->moveBack(6);
   bpawn8->moveRight(7);
   bpawn8->scaleLocal(0.1);
-  bpawn8->prepareVao();
+  bpawn8->prepareVao(*m_arena);
   add("bpawn8", bpawn8);
 
   NormalsMesh* bishop = new NormalsMesh(context, shaderNorm, "models/bishop.obj", 0);
   bishop->setMaterial(*bronze);
   bishop->moveRight(2);
   bishop->scaleLocal(0.1);
-  bishop->prepareVao();
+  bishop->prepareVao(*m_arena);
   add("bishop", bishop);
 
   NormalsMesh* bishop2 = new NormalsMesh(context, shaderNorm, "models/bishop.obj", 0);
   bishop2->setMaterial(*bronze);
   bishop2->moveRight(5);
   bishop2->scaleLocal(0.1);
-  bishop2->prepareVao();
+  bishop2->prepareVao(*m_arena);
   add("bishop2", bishop2);
 
   NormalsMesh* bbishop2 = new NormalsMesh(context, shaderNorm, "models/bishop.obj", 0);
@@ -840,7 +781,7 @@ light type should be 2 but again not functional
   bbishop2->moveRight(5);
   bbishop2->moveBack(7);
   bbishop2->scaleLocal(0.1);
-  bbishop2->prepareVao();
+  bbishop2->prepareVao(*m_arena);
   add("bbishop2", bbishop2);
 
   NormalsMesh* bbishop = new NormalsMesh(context, shaderNorm, "models/bishop.obj", 0);
@@ -848,14 +789,14 @@ light type should be 2 but again not functional
   bbishop->moveRight(2);
   bbishop->moveBack(7);
   bbishop->scaleLocal(0.1);
-  bbishop->prepareVao();
+  bbishop->prepareVao(*m_arena);
   add("bbishop", bbishop);
 
   NormalsMesh* king = new NormalsMesh(context, shaderNorm, "models/king.obj", 0);
   king->setMaterial(*bronze);
   king->moveRight(3);
   king->scaleLocal(0.1);
-  king->prepareVao();
+  king->prepareVao(*m_arena);
   add("king", king);
 
   NormalsMesh* bking = new NormalsMesh(context, shaderNorm, "models/king.obj", 0);
@@ -863,21 +804,21 @@ light type should be 2 but again not functional
   bking->moveRight(3);
   bking->moveBack(7);
   bking->scaleLocal(0.1);
-  bking->prepareVao();
+  bking->prepareVao(*m_arena);
   add("bking", bking);
 
   NormalsMesh* knight = new NormalsMesh(context, shaderNorm, "models/knight.obj", 0);
   knight->setMaterial(*bronze);
   knight->moveRight(1);
   knight->scaleLocal(.2);
-  knight->prepareVao();
+  knight->prepareVao(*m_arena);
   add("knight", knight);
 
   NormalsMesh* knight2 = new NormalsMesh(context, shaderNorm, "models/knight.obj", 0);
   knight2->setMaterial(*bronze);
   knight2->moveRight(6);
   knight2->scaleLocal(.2);
-  knight2->prepareVao();
+  knight2->prepareVao(*m_arena);
   add("knight2", knight2);
 
   NormalsMesh* bknight2 = new NormalsMesh(context, shaderNorm, "models/knight.obj", 0);
@@ -886,7 +827,7 @@ light type should be 2 but again not functional
   bknight2->moveBack(7);
   bknight2->scaleLocal(.2);
   bknight2->rotateLocal(180, Vector3(0,1,0));
-  bknight2->prepareVao();
+  bknight2->prepareVao(*m_arena);
   add("bknight2", bknight2);
 
    NormalsMesh* bknight1 = new NormalsMesh(context, shaderNorm, "models/knight.obj", 0);
@@ -895,7 +836,7 @@ light type should be 2 but again not functional
   bknight1->moveBack(7);
   bknight1->scaleLocal(.2);
   bknight1->rotateLocal(180, Vector3(0,1,0));
-  bknight1->prepareVao();
+  bknight1->prepareVao(*m_arena);
   add("bknight1", bknight1);
 
 
@@ -925,4 +866,14 @@ light type should be 2 but again not functional
   bear2->prepareVao();
   add("bear2", bear2);
 */
-};
\ No newline at end of file
+};
+
+MyScene::~MyScene (){
+  clear();
+  delete m_arena;
+};
+
+BufferArena&
+MyScene::getArena (){
+  return *m_arena;
+};
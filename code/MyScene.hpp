@@ -4,16 +4,39 @@
 /// \version A02
 
 #include "Scene.hpp"
+#include "BufferArena.hpp"
 
 class MyScene: public Scene
 {
     public:
     
-    MyScene (OpenGLContext* context, ShaderProgram* shader, ShaderProgram* shaderNorm);
+    /// \brief Constructs the scene.
+    /// \param[in] context The object through which to make OpenGL calls.
+    /// \param[in] shader The program ColorMeshes are drawn with.
+    /// \param[in] shaderNorm The program every NormalsMesh is drawn with a
+    ///   variant of.
+    /// \param[in] multiDraw Whether an IndirectBatch will multi-draw the
+    ///   arena, so the variant it draws with needs the lights too.
+    MyScene (OpenGLContext* context, ShaderProgram* shader, ShaderProgram* shaderNorm,
+             bool multiDraw);
+
+    /// \brief Destructs a MyScene, freeing its Meshes before the arena they
+    ///   are drawn from.
+    ~MyScene ();
 
     MyScene (const MyScene&) = delete;
  
     void
     operator= (const MyScene&) = delete;
 
+    /// \brief Gets the arena that every NormalsMesh is drawn from.
+    /// \return The arena, which lives as long as this MyScene.
+    BufferArena&
+    getArena ();
+
+    private:
+
+    /// The shared buffers of every NormalsMesh.
+    BufferArena* m_arena;
+
 };
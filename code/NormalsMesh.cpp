@@ -9,6 +9,8 @@
 #include <assimp/scene.h>          
 #include <assimp/postprocess.h>
 #include "Material.hpp"
+#include "JobSystem.hpp"
+#include "TraceRecorder.hpp"
 
 NormalsMesh::NormalsMesh (OpenGLContext* context, ShaderProgram* shader)
   : Mesh::Mesh(context, shader)
@@ -17,6 +19,8 @@ NormalsMesh::NormalsMesh (OpenGLContext* context, ShaderProgram* shader)
 NormalsMesh::NormalsMesh (OpenGLContext* context, ShaderProgram* shader, std::string filename, unsigned int meshNum)
   : NormalsMesh(context, shader)
 {
+  TRACE_SCOPE_DETAIL ("import model", "init", filename.c_str ());
+  setAssetName (filename);
   Assimp::Importer importer;
   unsigned int flags =
     aiProcess_Triangulate              // convert all shapes to triangles
@@ -49,26 +53,34 @@ NormalsMesh::NormalsMesh (OpenGLContext* context, ShaderProgram* shader, std::st
         setMaterial(defaultmat);
       }
 
-      std::vector<float> vertexData;
-      std::vector<unsigned int> indexes;
-      for (unsigned vertexNum = 0; vertexNum < mesh->mNumVertices; ++vertexNum)
+      // Every vertex and face is copied independently, so large models are
+      //   split among threads.  Faces are triangles thanks to
+      //   aiProcess_Triangulate.
+      std::vector<float> vertexData (mesh->mNumVertices * 6);
+      std::vector<unsigned int> indexes (mesh->mNumFaces * 3);
+      JobSystem& jobs = JobSystem::getGlobal ();
+      jobs.parallelFor (mesh->mNumVertices, 8192, [&] (size_t begin, size_t end)
       {
-      	vertexData.push_back (mesh->mVertices[vertexNum].x);
-      	vertexData.push_back (mesh->mVertices[vertexNum].y);
-      	vertexData.push_back (mesh->mVertices[vertexNum].z);
-      	vertexData.push_back (mesh->mNormals[vertexNum].x);
-      	vertexData.push_back (mesh->mNormals[vertexNum].y);
-      	vertexData.push_back (mesh->mNormals[vertexNum].z);
-      }
-      for (unsigned int faceNum = 0; faceNum < mesh->mNumFaces; ++faceNum)
+	for (size_t vertexNum = begin; vertexNum < end; ++vertexNum)
+	{
+	  float* vertex = &vertexData[vertexNum * 6];
+	  vertex[0] = mesh->mVertices[vertexNum].x;
+	  vertex[1] = mesh->mVertices[vertexNum].y;
+	  vertex[2] = mesh->mVertices[vertexNum].z;
+	  vertex[3] = mesh->mNormals[vertexNum].x;
+	  vertex[4] = mesh->mNormals[vertexNum].y;
+	  vertex[5] = mesh->mNormals[vertexNum].z;
+	}
+      });
+      jobs.parallelFor (mesh->mNumFaces, 8192, [&] (size_t begin, size_t end)
       {
-	      const aiFace& face = mesh->mFaces[faceNum];
-	      for (unsigned int indexNum = 0; indexNum < 3; ++indexNum)
-	      {
-	        unsigned int vertexNum = face.mIndices[indexNum];
-	        indexes.push_back (vertexNum);
-	      }
-      }
+	for (size_t faceNum = begin; faceNum < end; ++faceNum)
+	{
+	  const aiFace& face = mesh->mFaces[faceNum];
+	  for (unsigned int indexNum = 0; indexNum < 3; ++indexNum)
+	    indexes[faceNum * 3 + indexNum] = face.mIndices[indexNum];
+	}
+      });
 
       addGeometry (vertexData);
       addIndices (indexes);
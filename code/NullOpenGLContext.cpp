@@ -0,0 +1,341 @@
+/// \file NullOpenGLContext.cpp
+/// \brief Definitions of NullOpenGLContext member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cstdint>
+
+#include "NullOpenGLContext.hpp"
+
+NullOpenGLContext::NullOpenGLContext ()
+  : m_lastName (0)
+{
+}
+
+NullOpenGLContext::~NullOpenGLContext ()
+{
+}
+
+void
+NullOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+}
+
+void
+NullOpenGLContext::beginQuery (GLenum target, GLuint id)
+{
+}
+
+void
+NullOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+}
+
+void
+NullOpenGLContext::bindVertexArray (GLuint array)
+{
+}
+
+void
+NullOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+}
+
+void
+NullOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+}
+
+void
+NullOpenGLContext::clear (GLbitfield mask)
+{
+}
+
+void
+NullOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+}
+
+GLenum
+NullOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return GL_ALREADY_SIGNALED;
+}
+
+void
+NullOpenGLContext::compileShader (GLuint shader)
+{
+}
+
+void
+NullOpenGLContext::copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+}
+
+GLuint
+NullOpenGLContext::createProgram ()
+{
+  return ++m_lastName;
+}
+
+GLuint
+NullOpenGLContext::createShader (GLenum shaderType)
+{
+  return ++m_lastName;
+}
+
+void
+NullOpenGLContext::cullFace (GLenum mode)
+{
+}
+
+void
+NullOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+}
+
+void
+NullOpenGLContext::deleteProgram (GLuint program)
+{
+}
+
+void
+NullOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+}
+
+void
+NullOpenGLContext::deleteShader (GLuint shader)
+{
+}
+
+void
+NullOpenGLContext::deleteSync (GLsync sync)
+{
+}
+
+void
+NullOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+}
+
+void
+NullOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+}
+
+void
+NullOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+}
+
+void
+NullOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+}
+
+void
+NullOpenGLContext::drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex)
+{
+}
+
+void
+NullOpenGLContext::enable (GLenum cap)
+{
+}
+
+void
+NullOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+}
+
+void
+NullOpenGLContext::endQuery (GLenum target)
+{
+}
+
+GLsync
+NullOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return reinterpret_cast<GLsync> (static_cast<uintptr_t> (++m_lastName));
+}
+
+void
+NullOpenGLContext::flush ()
+{
+}
+
+void
+NullOpenGLContext::frontFace (GLenum mode)
+{
+}
+
+void
+NullOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    buffers[i] = ++m_lastName;
+}
+
+void
+NullOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    ids[i] = ++m_lastName;
+}
+
+void
+NullOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    arrays[i] = ++m_lastName;
+}
+
+GLint
+NullOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  return 0;
+}
+
+void
+NullOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  if (length != nullptr)
+    *length = 0;
+  *binaryFormat = 0;
+}
+
+void
+NullOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (length != nullptr)
+    *length = 0;
+  if (maxLength > 0)
+    infoLog[0] = '\0';
+}
+
+void
+NullOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  *params = (pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+
+void
+NullOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  *params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void
+NullOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  *params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void
+NullOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (length != nullptr)
+    *length = 0;
+  if (maxLength > 0)
+    infoLog[0] = '\0';
+}
+
+void
+NullOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+const GLubyte*
+NullOpenGLContext::getString (GLenum name)
+{
+  switch (name)
+  {
+  case GL_VENDOR:
+    return reinterpret_cast<const GLubyte*> ("CSCI 375");
+  case GL_RENDERER:
+    return reinterpret_cast<const GLubyte*> ("NullOpenGLContext");
+  case GL_VERSION:
+    return reinterpret_cast<const GLubyte*> ("3.3 (null)");
+  default:
+    return reinterpret_cast<const GLubyte*> ("");
+  }
+}
+
+GLint
+NullOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  return 0;
+}
+
+void
+NullOpenGLContext::linkProgram (GLuint program)
+{
+}
+
+void
+NullOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+}
+
+void
+NullOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+}
+
+void
+NullOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+}
+
+void
+NullOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+}
+
+void
+NullOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+}
+
+void
+NullOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+}
+
+void
+NullOpenGLContext::uniform3fv (GLint location, GLsizei count, const GLfloat* value)
+{
+}
+
+void
+NullOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+}
+
+void
+NullOpenGLContext::useProgram (GLuint program)
+{
+}
+
+void
+NullOpenGLContext::vertexAttribDivisor (GLuint index, GLuint divisor)
+{
+}
+
+void
+NullOpenGLContext::vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer)
+{
+}
+
+void
+NullOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+}
+
+void
+NullOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+}
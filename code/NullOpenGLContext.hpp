@@ -0,0 +1,218 @@
+/// \file NullOpenGLContext.hpp
+/// \brief Declaration of NullOpenGLContext and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef NULL_OPENGL_CONTEXT_HPP
+#define NULL_OPENGL_CONTEXT_HPP
+
+#include "OpenGLContext.hpp"
+
+/// \brief A subclass of OpenGLContext that does nothing with the calls made
+///   through it.
+///
+/// Objects get unique names, shaders always compile and programs always
+///   link, and queries finish instantly having timed nothing.  Nothing is
+///   drawn, so a frame made through this context costs only what the rest of
+///   the program does to prepare it, which makes it a baseline for the
+///   other contexts.
+class NullOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// \brief Constructs a NullOpenGLContext.
+  /// \post No names have been given out.
+  NullOpenGLContext ();
+
+  /// \brief Destructs a NullOpenGLContext.
+  virtual
+  ~NullOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   NullOpenGLContexts.
+  NullOpenGLContext (const NullOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   NullOpenGLContexts.
+  NullOpenGLContext&
+  operator= (const NullOpenGLContext&) = delete;
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  beginQuery (GLenum target, GLuint id);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
+  virtual void
+  drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual void
+  endQuery (GLenum target);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  flush ();
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3fv (GLint location, GLsizei count, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexAttribDivisor (GLuint index, GLuint divisor);
+
+  virtual void
+  vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// The last name given to an object of any kind.
+  GLuint m_lastName;
+};
+
+#endif//NULL_OPENGL_CONTEXT_HPP
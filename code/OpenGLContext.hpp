@@ -11,6 +11,21 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+/// \brief One draw of glMultiDrawElementsIndirect, laid out as OpenGL reads
+///   it from the GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand
+{
+  /// The number of indices.
+  GLuint count;
+  GLuint instanceCount;
+  /// The first index in the element buffer.
+  GLuint firstIndex;
+  /// What is added to each index.
+  GLint baseVertex;
+  /// The first instance, which instanced attributes are fetched from.
+  GLuint baseInstance;
+};
+
 /// \brief A class that works as a proxy between clients and the OpenGL
 ///   library.
 ///
@@ -32,6 +47,10 @@ public:
   virtual void
   attachShader (GLuint program, GLuint shader) = 0;
 
+  /// See documentation of glBeginQuery.
+  virtual void
+  beginQuery (GLenum target, GLuint id) = 0;
+
   /// See documentation of glBindBuffer.
   virtual void
   bindBuffer (GLenum target, GLuint buffer) = 0;
@@ -44,6 +63,10 @@ public:
   virtual void
   bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) = 0;
 
+  /// See documentation of glBufferSubData.
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) = 0;
+
   /// See documentation of glClear.
   virtual void
   clear (GLbitfield mask) = 0;
@@ -52,10 +75,18 @@ public:
   virtual void
   clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) = 0;
 
+  /// See documentation of glClientWaitSync.
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout) = 0;
+
   /// See documentation of glCompileShader.
   virtual void
   compileShader (GLuint shader) = 0;
 
+  /// See documentation of glCopyBufferSubData.
+  virtual void
+  copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) = 0;
+
   /// See documentation of glCreateProgram.
   virtual GLuint
   createProgram () = 0;
@@ -76,10 +107,18 @@ public:
   virtual void
   deleteProgram (GLuint program) = 0;
 
+  /// See documentation of glDeleteQueries.
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids) = 0;
+
   /// See documentation of glDeleteShader.
   virtual void
   deleteShader (GLuint shader) = 0;
 
+  /// See documentation of glDeleteSync.
+  virtual void
+  deleteSync (GLsync sync) = 0;
+
   /// See documentation of glDeleteVertexArrays.
   virtual void
   deleteVertexArrays (GLsizei n, const GLuint* arrays) = 0;
@@ -92,6 +131,14 @@ public:
   virtual void
   drawArrays (GLenum mode, GLint first, GLsizei count) = 0;
 
+  /// See documentation of glDrawElements.
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) = 0;
+
+  /// See documentation of glDrawElementsBaseVertex.
+  virtual void
+  drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex) = 0;
+
   /// See documentation of glEnable.
   virtual void
   enable (GLenum cap) = 0;
@@ -100,6 +147,18 @@ public:
   virtual void
   enableVertexAttribArray (GLuint index) = 0;
 
+  /// See documentation of glEndQuery.
+  virtual void
+  endQuery (GLenum target) = 0;
+
+  /// See documentation of glFenceSync.
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags) = 0;
+
+  /// See documentation of glFlush.
+  virtual void
+  flush () = 0;
+
   /// See documentation of glFrontFace.
   virtual void
   frontFace (GLenum mode) = 0;
@@ -108,6 +167,10 @@ public:
   virtual void
   genBuffers (GLsizei n, GLuint* buffers) = 0;
 
+  /// See documentation of glGenQueries.
+  virtual void
+  genQueries (GLsizei n, GLuint* ids) = 0;
+
   /// See documentation of glGenVertexArrays.
   virtual void
   genVertexArrays (GLsizei n, GLuint* arrays) = 0;
@@ -116,6 +179,10 @@ public:
   virtual GLint
   getAttribLocation (GLuint program, const GLchar* name) = 0;
 
+  /// See documentation of glGetProgramBinary.
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) = 0;
+
   /// See documentation of glGetProgramInfoLog.
   virtual void
   getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog) = 0;
@@ -124,6 +191,14 @@ public:
   virtual void
   getProgramiv (GLuint program, GLenum pname, GLint* params) = 0;
 
+  /// See documentation of glGetQueryObjectiv.
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params) = 0;
+
+  /// See documentation of glGetQueryObjectui64v.
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params) = 0;
+
   /// See documentation of glGetShaderInfoLog.
   virtual void
   getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog) = 0;
@@ -144,10 +219,34 @@ public:
   virtual void
   linkProgram (GLuint program) = 0;
 
+  /// See documentation of glMultiDrawElementsIndirect.
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) = 0;
+
+  /// See documentation of glProgramBinary.
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) = 0;
+
+  /// See documentation of glProgramParameteri.
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value) = 0;
+
   /// See documentation of glShaderSource.
   virtual void
   shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length) = 0;
 
+  /// See documentation of glUniform1f.
+  virtual void
+  uniform1f (GLint location, GLfloat v0) = 0;
+
+  /// See documentation of glUniform1i.
+  virtual void
+  uniform1i (GLint location, GLint v0) = 0;
+
+  /// See documentation of glUniform3fv.
+  virtual void
+  uniform3fv (GLint location, GLsizei count, const GLfloat* value) = 0;
+
   /// See documentation of glUniformMatrix4fv.
   virtual void
   uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) = 0;
@@ -156,6 +255,14 @@ public:
   virtual void
   useProgram (GLuint program) = 0;
 
+  /// See documentation of glVertexAttribDivisor.
+  virtual void
+  vertexAttribDivisor (GLuint index, GLuint divisor) = 0;
+
+  /// See documentation of glVertexAttribIPointer.
+  virtual void
+  vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) = 0;
+
   /// See documentation of glVertexAttribPointer.
   virtual void
   vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer) = 0;
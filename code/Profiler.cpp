@@ -0,0 +1,317 @@
+/// \file Profiler.cpp
+/// \brief Definitions of Profiler class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cmath>
+
+#include "Profiler.hpp"
+#include "TraceRecorder.hpp"
+
+namespace
+{
+  // The nearest-rank percentile of sorted values.
+  double
+  percentile (const std::vector<double>& sorted, double fraction)
+  {
+    size_t rank = static_cast<size_t> (std::ceil (fraction * sorted.size ()));
+    return sorted[std::max<size_t> (rank, 1) - 1];
+  }
+}
+
+ScopeStats
+computeTimeStats (const std::vector<double>& times)
+{
+  ScopeStats stats = ScopeStats ();
+  if (times.empty ())
+    return stats;
+  std::vector<double> sorted (times);
+  std::sort (sorted.begin (), sorted.end ());
+  stats.frames = sorted.size ();
+  double sum = 0.0;
+  for (double time : sorted)
+    sum += time;
+  stats.min = sorted.front ();
+  stats.average = sum / stats.frames;
+  stats.p50 = percentile (sorted, 0.50);
+  stats.p95 = percentile (sorted, 0.95);
+  stats.p99 = percentile (sorted, 0.99);
+  stats.max = sorted.back ();
+  stats.callsPerFrame = 1.0;
+  return stats;
+}
+
+Profiler::Scope::Scope ()
+  : frameTime (0.0), frameCalls (0), next (0), queries (), pending (),
+    queryFrames ()
+{
+}
+
+Profiler::Profiler (size_t window)
+  : m_window (window), m_enabled (false), m_context (nullptr),
+    m_printInterval (0), m_frame (0), m_openGpuScope (nullptr)
+{
+}
+
+Profiler::~Profiler ()
+{
+}
+
+Profiler&
+Profiler::getGlobal ()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+void
+Profiler::setEnabled (bool enabled)
+{
+  m_enabled.store (enabled, std::memory_order_relaxed);
+}
+
+bool
+Profiler::isEnabled () const
+{
+  return m_enabled.load (std::memory_order_relaxed);
+}
+
+void
+Profiler::setContext (OpenGLContext* context)
+{
+  releaseGlResources ();
+  m_context = context;
+}
+
+void
+Profiler::setPrintInterval (unsigned long frames)
+{
+  m_printInterval = frames;
+}
+
+bool
+Profiler::openCsv (const std::string& fileName)
+{
+  m_csv.open (fileName);
+  if (!m_csv)
+    return false;
+  m_csv << "frame,kind,scope,milliseconds,calls\n";
+  return true;
+}
+
+void
+Profiler::addCpuTime (const char* scope, double milliseconds)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  Scope& times = m_cpuScopes[scope];
+  times.frameTime += milliseconds;
+  ++times.frameCalls;
+}
+
+void
+Profiler::beginGpuScope (const char* scope)
+{
+  if (m_context == nullptr)
+    return;
+  Scope& times = m_gpuScopes[scope];
+  if (times.queries[0] == 0)
+    m_context->genQueries (QUERY_RING_SIZE, times.queries);
+  // If this slot's last query has still not finished, its result is lost
+  //   rather than waited for.
+  unsigned int slot = m_frame % QUERY_RING_SIZE;
+  m_context->beginQuery (GL_TIME_ELAPSED, times.queries[slot]);
+  times.pending[slot] = true;
+  times.queryFrames[slot] = m_frame;
+  m_openGpuScope = &times;
+}
+
+void
+Profiler::endGpuScope ()
+{
+  if (m_openGpuScope == nullptr)
+    return;
+  m_context->endQuery (GL_TIME_ELAPSED);
+  m_openGpuScope = nullptr;
+}
+
+void
+Profiler::endFrame ()
+{
+  if (!isEnabled ())
+    return;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    for (auto& entry : m_cpuScopes)
+    {
+      Scope& times = entry.second;
+      if (m_csv.is_open () && times.frameCalls > 0)
+	m_csv << m_frame << ",cpu," << entry.first << ',' << times.frameTime
+	      << ',' << times.frameCalls << '\n';
+      addFrame (times, times.frameTime, times.frameCalls);
+      times.frameTime = 0.0;
+      times.frameCalls = 0;
+    }
+  }
+  collectGpuResults ();
+  ++m_frame;
+  if (m_printInterval != 0 && m_frame % m_printInterval == 0)
+    print (stderr);
+}
+
+std::vector<std::string>
+Profiler::getScopeNames (bool gpu) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  std::vector<std::string> names;
+  for (const auto& entry : gpu ? m_gpuScopes : m_cpuScopes)
+    names.push_back (entry.first);
+  return names;
+}
+
+ScopeStats
+Profiler::getCpuStats (const std::string& scope) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  auto found = m_cpuScopes.find (scope);
+  return (found == m_cpuScopes.end ()) ? ScopeStats () : computeStats (found->second);
+}
+
+ScopeStats
+Profiler::getGpuStats (const std::string& scope) const
+{
+  auto found = m_gpuScopes.find (scope);
+  return (found == m_gpuScopes.end ()) ? ScopeStats () : computeStats (found->second);
+}
+
+void
+Profiler::print (FILE* out) const
+{
+  fprintf (out, "Profile at frame %lu, in milliseconds per frame\n", m_frame);
+  fprintf (out, "%-4s %-24s %8s %8s %8s %8s %8s %8s\n", "kind", "scope", "avg",
+	   "p50", "p95", "p99", "max", "calls");
+  for (bool gpu : { false, true })
+  {
+    for (const std::string& name : getScopeNames (gpu))
+    {
+      ScopeStats stats = gpu ? getGpuStats (name) : getCpuStats (name);
+      fprintf (out, "%-4s %-24s %8.3f %8.3f %8.3f %8.3f %8.3f %8.1f\n",
+	       gpu ? "gpu" : "cpu", name.c_str (), stats.average, stats.p50,
+	       stats.p95, stats.p99, stats.max, stats.callsPerFrame);
+    }
+  }
+  fflush (out);
+}
+
+unsigned long
+Profiler::getFrameNumber () const
+{
+  return m_frame;
+}
+
+void
+Profiler::releaseGlResources ()
+{
+  for (auto& entry : m_gpuScopes)
+  {
+    Scope& times = entry.second;
+    if (times.queries[0] != 0)
+      m_context->deleteQueries (QUERY_RING_SIZE, times.queries);
+    std::fill (times.queries, times.queries + QUERY_RING_SIZE, 0);
+    std::fill (times.pending, times.pending + QUERY_RING_SIZE, false);
+  }
+  m_openGpuScope = nullptr;
+}
+
+void
+Profiler::addFrame (Scope& scope, double time, unsigned long calls)
+{
+  if (scope.times.size () < m_window)
+  {
+    scope.times.push_back (time);
+    scope.calls.push_back (calls);
+  }
+  else
+  {
+    scope.times[scope.next] = time;
+    scope.calls[scope.next] = calls;
+  }
+  scope.next = (scope.next + 1) % m_window;
+}
+
+void
+Profiler::collectGpuResults ()
+{
+  for (auto& entry : m_gpuScopes)
+  {
+    Scope& times = entry.second;
+    // Oldest first, so the statistics stay in frame order.
+    for (unsigned int i = 1; i <= QUERY_RING_SIZE; ++i)
+    {
+      unsigned int slot = (m_frame + i) % QUERY_RING_SIZE;
+      if (!times.pending[slot])
+	continue;
+      GLint available = GL_FALSE;
+      m_context->getQueryObjectiv (times.queries[slot], GL_QUERY_RESULT_AVAILABLE,
+				   &available);
+      if (!available)
+	continue;
+      GLuint64 nanoseconds = 0;
+      m_context->getQueryObjectui64v (times.queries[slot], GL_QUERY_RESULT,
+				      &nanoseconds);
+      times.pending[slot] = false;
+      double milliseconds = nanoseconds / 1.0e6;
+      if (m_csv.is_open ())
+	m_csv << times.queryFrames[slot] << ",gpu," << entry.first << ','
+	      << milliseconds << ",1\n";
+      addFrame (times, milliseconds, 1);
+    }
+  }
+}
+
+ScopeStats
+Profiler::computeStats (const Scope& scope) const
+{
+  ScopeStats stats = computeTimeStats (scope.times);
+  if (stats.frames == 0)
+    return stats;
+  unsigned long calls = 0;
+  for (unsigned long frameCalls : scope.calls)
+    calls += frameCalls;
+  stats.callsPerFrame = static_cast<double> (calls) / stats.frames;
+  return stats;
+}
+
+ScopedCpuTimer::ScopedCpuTimer (const char* scope)
+  : m_scope (scope), m_enabled (Profiler::getGlobal ().isEnabled ()),
+    m_tracing (TraceRecorder::getGlobal ().isRecording ())
+{
+  if (m_enabled || m_tracing)
+    m_start = std::chrono::steady_clock::now ();
+}
+
+ScopedCpuTimer::~ScopedCpuTimer ()
+{
+  if (!m_enabled && !m_tracing)
+    return;
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+  if (m_enabled)
+    Profiler::getGlobal ().addCpuTime (m_scope, std::chrono::duration<double, std::milli>
+				       (end - m_start).count ());
+  if (m_tracing)
+    TraceRecorder::getGlobal ().record (m_scope, "profile", nullptr, m_start, end);
+}
+
+ScopedGpuTimer::ScopedGpuTimer (const char* scope)
+  : m_enabled (Profiler::getGlobal ().isEnabled ())
+{
+  if (m_enabled)
+    Profiler::getGlobal ().beginGpuScope (scope);
+}
+
+ScopedGpuTimer::~ScopedGpuTimer ()
+{
+  if (m_enabled)
+    Profiler::getGlobal ().endGpuScope ();
+}
@@ -0,0 +1,293 @@
+/// \file Profiler.hpp
+/// \brief Declaration of Profiler class, the scoped timers that feed it, and
+///   the macros that place them.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief Rolling statistics of the time one scope took per frame, in
+///   milliseconds.
+struct ScopeStats
+{
+  /// The number of frames the statistics cover.
+  size_t frames;
+  double min;
+  double average;
+  double p50;
+  double p95;
+  double p99;
+  double max;
+  /// The average number of times the scope was entered per frame.
+  double callsPerFrame;
+};
+
+/// \brief Computes statistics of a list of times, such as those of a whole
+///   benchmark run.
+/// \param[in] times The times, in milliseconds, in any order.
+/// \return Their statistics, with callsPerFrame 1, or all zeros if there are
+///   no times.
+ScopeStats
+computeTimeStats (const std::vector<double>& times);
+
+/// \brief Collects how long named scopes of each frame take, on the CPU and
+///   on the GPU, and keeps statistics over the last few hundred frames.
+///
+/// CPU time is reported by ScopedCpuTimer objects, usually placed with
+///   PROFILE_SCOPE, and summed per frame, so a scope entered once per Mesh
+///   counts the whole frame's worth.  GPU time is measured by GL_TIME_ELAPSED
+///   queries placed with PROFILE_GPU_SCOPE.  Each GPU scope has a ring of
+///   queries, one per frame in flight, and results are only read once OpenGL
+///   says they are available, so profiling never waits for the GPU; a result
+///   still missing when its query comes around again is dropped.
+///
+/// Nothing is recorded until setEnabled is called, so the timers cost one
+///   load each when profiling is off, and defining NO_PROFILING removes them
+///   entirely.
+class Profiler
+{
+public:
+
+  /// The number of frames statistics are kept over by default.
+  static const size_t DEFAULT_WINDOW = 240;
+  /// The number of frames a GPU query may take to finish before its result
+  ///   is given up on.
+  static const unsigned int QUERY_RING_SIZE = 4;
+
+  /// \brief Constructs a disabled Profiler with no scopes.
+  /// \param[in] window The number of frames to keep statistics over.
+  Profiler (size_t window = DEFAULT_WINDOW);
+
+  /// \brief Destructs a Profiler.
+  /// \pre releaseGlResources has been called if GPU scopes were used.
+  ~Profiler ();
+
+  /// Copy constructor deleted because you should not be copying Profilers.
+  Profiler (const Profiler&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   Profilers.
+  Profiler&
+  operator= (const Profiler&) = delete;
+
+  /// \brief Gets the Profiler that the PROFILE_ macros report to.
+  /// \return The global Profiler, which is created disabled.
+  static Profiler&
+  getGlobal ();
+
+  /// \brief Turns recording on or off.
+  /// \param[in] enabled Whether or not scopes should be recorded.
+  void
+  setEnabled (bool enabled);
+
+  /// \brief Tells whether or not scopes are being recorded.
+  /// \return Whether or not the Profiler is enabled.
+  bool
+  isEnabled () const;
+
+  /// \brief Sets the context that GPU scopes make queries through.
+  /// \param[in] context The context, or nullptr to not time the GPU.
+  void
+  setContext (OpenGLContext* context);
+
+  /// \brief Prints statistics to standard error every so often.
+  /// \param[in] frames The number of frames between printouts, or 0 to never
+  ///   print them.
+  void
+  setPrintInterval (unsigned long frames);
+
+  /// \brief Starts writing every scope's time in every frame to a CSV file.
+  /// \param[in] fileName The name of the file to create.
+  /// \return Whether or not the file could be opened.
+  /// \post If successful, a header line has been written to the file.  GPU
+  ///   lines are written when their results arrive, a few frames late.
+  bool
+  openCsv (const std::string& fileName);
+
+  /// \brief Adds CPU time to a scope in the current frame.  May be called
+  ///   from any thread.
+  /// \param[in] scope The name of the scope.
+  /// \param[in] milliseconds The time taken.
+  void
+  addCpuTime (const char* scope, double milliseconds);
+
+  /// \brief Starts timing a scope on the GPU.
+  /// \param[in] scope The name of the scope.
+  /// \pre No other GPU scope is open, since OpenGL cannot nest
+  ///   GL_TIME_ELAPSED queries, and this scope has not been timed yet this
+  ///   frame.  Only the thread that owns the context may call this.
+  void
+  beginGpuScope (const char* scope);
+
+  /// \brief Stops timing the GPU scope that is open.
+  void
+  endGpuScope ();
+
+  /// \brief Finishes the current frame.
+  /// \post Each scope's total for the frame has joined its statistics and
+  ///   any GPU results that have arrived have been collected.  The CSV file
+  ///   and periodic printout are up to date.
+  void
+  endFrame ();
+
+  /// \brief Gets the names of every scope of one kind seen so far.
+  /// \param[in] gpu Whether to list the GPU scopes rather than the CPU ones.
+  /// \return Their names, sorted.
+  std::vector<std::string>
+  getScopeNames (bool gpu) const;
+
+  /// \brief Gets statistics about a CPU scope.
+  /// \param[in] scope The name of the scope.
+  /// \return Its statistics over the last frames, or all zeros if it has
+  ///   never been seen.
+  ScopeStats
+  getCpuStats (const std::string& scope) const;
+
+  /// \brief Gets statistics about a GPU scope.
+  /// \param[in] scope The name of the scope.
+  /// \return Its statistics over the frames whose results have arrived, or
+  ///   all zeros if it has never been seen.
+  ScopeStats
+  getGpuStats (const std::string& scope) const;
+
+  /// \brief Prints a table of every scope's statistics.
+  /// \param[in] out The stream to print to.
+  void
+  print (FILE* out) const;
+
+  /// \brief Gets the number of frames that have been finished.
+  /// \return The number of times endFrame has been called while enabled.
+  unsigned long
+  getFrameNumber () const;
+
+  /// \brief Deletes the queries GPU scopes have made.
+  /// \post GPU scopes have no queries, and will make new ones if used again.
+  void
+  releaseGlResources ();
+
+private:
+
+  /// One scope's times.
+  struct Scope
+  {
+    Scope ();
+
+    /// Time and calls so far in the current frame.
+    double frameTime;
+    unsigned long frameCalls;
+    /// Totals of the last m_window frames, used as a ring.
+    std::vector<double> times;
+    std::vector<unsigned long> calls;
+    size_t next;
+
+    /// GPU scopes only: a query for each frame in flight, whether it is
+    ///   waiting for a result, and the frame it timed.
+    GLuint queries[QUERY_RING_SIZE];
+    bool pending[QUERY_RING_SIZE];
+    unsigned long queryFrames[QUERY_RING_SIZE];
+  };
+
+  void
+  addFrame (Scope& scope, double time, unsigned long calls);
+
+  void
+  collectGpuResults ();
+
+  ScopeStats
+  computeStats (const Scope& scope) const;
+
+  size_t m_window;
+  std::atomic<bool> m_enabled;
+  OpenGLContext* m_context;
+  unsigned long m_printInterval;
+  unsigned long m_frame;
+  /// Protects m_cpuScopes, which any thread may add to.
+  mutable std::mutex m_mutex;
+  std::map<std::string, Scope> m_cpuScopes;
+  std::map<std::string, Scope> m_gpuScopes;
+  /// The GPU scope that is open, or nullptr.
+  Scope* m_openGpuScope;
+  std::ofstream m_csv;
+};
+
+/// \brief Adds the time between its construction and destruction to a scope
+///   in the global Profiler, and records it as an event if the TraceRecorder
+///   is recording.
+class ScopedCpuTimer
+{
+public:
+
+  /// \brief Starts timing, if the global Profiler is enabled or the
+  ///   TraceRecorder is recording.
+  /// \param[in] scope The name of the scope, which must outlive the timer.
+  ScopedCpuTimer (const char* scope);
+
+  /// \brief Stops timing and reports the time.
+  ~ScopedCpuTimer ();
+
+  ScopedCpuTimer (const ScopedCpuTimer&) = delete;
+
+  ScopedCpuTimer&
+  operator= (const ScopedCpuTimer&) = delete;
+
+private:
+
+  const char* m_scope;
+  bool m_enabled;
+  bool m_tracing;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/// \brief Times the OpenGL commands made between its construction and
+///   destruction as a GPU scope in the global Profiler.
+class ScopedGpuTimer
+{
+public:
+
+  /// \brief Begins the scope, if the global Profiler is enabled.
+  /// \param[in] scope The name of the scope.
+  ScopedGpuTimer (const char* scope);
+
+  /// \brief Ends the scope.
+  ~ScopedGpuTimer ();
+
+  ScopedGpuTimer (const ScopedGpuTimer&) = delete;
+
+  ScopedGpuTimer&
+  operator= (const ScopedGpuTimer&) = delete;
+
+private:
+
+  bool m_enabled;
+};
+
+#define PROFILE_CONCATENATE_(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_ (a, b)
+
+#ifdef NO_PROFILING
+#define PROFILE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name)
+#else
+/// \brief Times the rest of the enclosing block as a CPU scope.
+#define PROFILE_SCOPE(name)						\
+  ScopedCpuTimer PROFILE_CONCATENATE (profileScope, __LINE__) (name)
+/// \brief Times the OpenGL commands in the rest of the enclosing block as a
+///   GPU scope.
+#define PROFILE_GPU_SCOPE(name)						\
+  ScopedGpuTimer PROFILE_CONCATENATE (profileGpuScope, __LINE__) (name)
+#endif
+
+#endif//PROFILER_HPP
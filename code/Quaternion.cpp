@@ -0,0 +1,180 @@
+/// \file Quaternion.cpp
+/// \brief Definitions of Quaternion class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cmath>
+#include <iomanip>
+
+#include "Quaternion.hpp"
+
+Quaternion::Quaternion ()
+  : m_w (1), m_x (0), m_y (0), m_z (0)
+{
+}
+
+Quaternion::Quaternion (float w, float x, float y, float z)
+  : m_w (w), m_x (x), m_y (y), m_z (z)
+{
+}
+
+Quaternion::Quaternion (float angleDegrees, const Vector3& axis)
+{
+  Vector3 unitAxis = axis;
+  unitAxis.normalize ();
+  float halfAngle = angleDegrees * M_PI / 360;
+  float sine = std::sin (halfAngle);
+  m_w = std::cos (halfAngle);
+  m_x = unitAxis.m_x * sine;
+  m_y = unitAxis.m_y * sine;
+  m_z = unitAxis.m_z * sine;
+}
+
+void
+Quaternion::setFromMatrix (const Matrix3& rotation)
+{
+  Vector3 r = rotation.getRight ();
+  Vector3 u = rotation.getUp ();
+  Vector3 b = rotation.getBack ();
+  // Divide by the largest of the four candidates, so that no square root
+  //   is taken of a number near zero.
+  float trace = r.m_x + u.m_y + b.m_z;
+  if (trace > 0)
+  {
+    float s = std::sqrt (trace + 1) * 2;
+    m_w = s / 4;
+    m_x = (u.m_z - b.m_y) / s;
+    m_y = (b.m_x - r.m_z) / s;
+    m_z = (r.m_y - u.m_x) / s;
+  }
+  else if (r.m_x > u.m_y && r.m_x > b.m_z)
+  {
+    float s = std::sqrt (1 + r.m_x - u.m_y - b.m_z) * 2;
+    m_w = (u.m_z - b.m_y) / s;
+    m_x = s / 4;
+    m_y = (u.m_x + r.m_y) / s;
+    m_z = (b.m_x + r.m_z) / s;
+  }
+  else if (u.m_y > b.m_z)
+  {
+    float s = std::sqrt (1 + u.m_y - r.m_x - b.m_z) * 2;
+    m_w = (b.m_x - r.m_z) / s;
+    m_x = (u.m_x + r.m_y) / s;
+    m_y = s / 4;
+    m_z = (b.m_y + u.m_z) / s;
+  }
+  else
+  {
+    float s = std::sqrt (1 + b.m_z - r.m_x - u.m_y) * 2;
+    m_w = (r.m_y - u.m_x) / s;
+    m_x = (b.m_x + r.m_z) / s;
+    m_y = (b.m_y + u.m_z) / s;
+    m_z = s / 4;
+  }
+  normalize ();
+}
+
+Matrix3
+Quaternion::getMatrix () const
+{
+  float xx = m_x * m_x, yy = m_y * m_y, zz = m_z * m_z;
+  float xy = m_x * m_y, xz = m_x * m_z, yz = m_y * m_z;
+  float wx = m_w * m_x, wy = m_w * m_y, wz = m_w * m_z;
+  return Matrix3 (1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy),
+		  2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx),
+		  2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy));
+}
+
+Vector3
+Quaternion::rotate (const Vector3& v) const
+{
+  // v + 2w(q x v) + 2q x (q x v), with q the vector part.
+  Vector3 q (m_x, m_y, m_z);
+  Vector3 t = 2 * q.cross (v);
+  return v + m_w * t + q.cross (t);
+}
+
+float
+Quaternion::dot (const Quaternion& q) const
+{
+  return m_w * q.m_w + m_x * q.m_x + m_y * q.m_y + m_z * q.m_z;
+}
+
+float
+Quaternion::length () const
+{
+  return std::sqrt (dot (*this));
+}
+
+void
+Quaternion::normalize ()
+{
+  float inverseLength = 1 / length ();
+  m_w *= inverseLength;
+  m_x *= inverseLength;
+  m_y *= inverseLength;
+  m_z *= inverseLength;
+}
+
+Quaternion
+Quaternion::conjugate () const
+{
+  return Quaternion (m_w, -m_x, -m_y, -m_z);
+}
+
+Quaternion&
+Quaternion::operator*= (const Quaternion& q)
+{
+  *this = *this * q;
+  return *this;
+}
+
+Quaternion
+operator* (const Quaternion& q1, const Quaternion& q2)
+{
+  return Quaternion (q1.m_w * q2.m_w - q1.m_x * q2.m_x - q1.m_y * q2.m_y - q1.m_z * q2.m_z,
+		     q1.m_w * q2.m_x + q1.m_x * q2.m_w + q1.m_y * q2.m_z - q1.m_z * q2.m_y,
+		     q1.m_w * q2.m_y - q1.m_x * q2.m_z + q1.m_y * q2.m_w + q1.m_z * q2.m_x,
+		     q1.m_w * q2.m_z + q1.m_x * q2.m_y - q1.m_y * q2.m_x + q1.m_z * q2.m_w);
+}
+
+Quaternion
+slerp (const Quaternion& from, const Quaternion& to, float amount)
+{
+  float cosine = from.dot (to);
+  // q and -q are the same rotation; go the short way around.
+  float sign = 1;
+  if (cosine < 0)
+  {
+    cosine = -cosine;
+    sign = -1;
+  }
+  float fromWeight = 1 - amount;
+  float toWeight = amount;
+  // Nearly equal rotations would divide by nearly zero, but blend fine
+  //   linearly.
+  if (cosine < 0.9995f)
+  {
+    float angle = std::acos (cosine);
+    float sine = std::sin (angle);
+    fromWeight = std::sin ((1 - amount) * angle) / sine;
+    toWeight = std::sin (amount * angle) / sine;
+  }
+  toWeight *= sign;
+  Quaternion result (fromWeight * from.m_w + toWeight * to.m_w,
+		     fromWeight * from.m_x + toWeight * to.m_x,
+		     fromWeight * from.m_y + toWeight * to.m_y,
+		     fromWeight * from.m_z + toWeight * to.m_z);
+  result.normalize ();
+  return result;
+}
+
+std::ostream&
+operator<< (std::ostream& out, const Quaternion& q)
+{
+  out << std::setprecision (2) << std::fixed << std::setw (10) << q.m_w
+      << std::setw (10) << q.m_x << std::setw (10) << q.m_y
+      << std::setw (10) << q.m_z;
+  return out;
+}
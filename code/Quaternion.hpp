@@ -0,0 +1,129 @@
+/// \file Quaternion.hpp
+/// \brief Declaration of Quaternion class and any associated global functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef QUATERNION_HPP
+#define QUATERNION_HPP
+
+#include <iostream>
+
+#include "Matrix3.hpp"
+#include "Vector3.hpp"
+
+/// \brief A quaternion w + xi + yj + zk, used to represent rotations.
+/// Unit quaternions represent rotations compactly, compose with fewer
+///   operations than 3x3 matrices, and can be renormalized cheaply so that
+///   rounding error never turns them into something other than a rotation.
+/// Like Vector3, the coefficients are public because any combination of
+///   them is a legal quaternion.
+class Quaternion
+{
+public:
+
+  /// \brief Initializes a new quaternion to the identity rotation.
+  /// \post The quaternion is 1 + 0i + 0j + 0k.
+  Quaternion ();
+
+  /// \brief Initializes a new quaternion with custom coefficients.
+  /// \param[in] w The real part.
+  /// \param[in] x The coefficient of i.
+  /// \param[in] y The coefficient of j.
+  /// \param[in] z The coefficient of k.
+  /// \post The coefficients are equal to the parameters.
+  Quaternion (float w, float x, float y, float z);
+
+  /// \brief Initializes a new quaternion to a rotation around an axis.
+  /// \param[in] angleDegrees How much to rotate, counterclockwise when
+  ///   looking down the axis.
+  /// \param[in] axis The vector to rotate around, which need not be unit
+  ///   length.
+  /// \post The quaternion is a unit quaternion for that rotation.
+  Quaternion (float angleDegrees, const Vector3& axis);
+
+  /// \brief Sets this to the rotation a rotation matrix represents.
+  /// \param[in] rotation A matrix whose columns are perpendicular unit
+  ///   vectors and whose determinant is 1.
+  /// \post This is a unit quaternion for the same rotation.
+  void
+  setFromMatrix (const Matrix3& rotation);
+
+  /// \brief Computes the rotation matrix this represents.
+  /// \pre This is a unit quaternion.
+  /// \return A matrix whose columns are the rotated right, up, and back
+  ///   vectors.
+  Matrix3
+  getMatrix () const;
+
+  /// \brief Rotates a vector.
+  /// \param[in] v The vector to rotate.
+  /// \pre This is a unit quaternion.
+  /// \return v rotated by this.
+  Vector3
+  rotate (const Vector3& v) const;
+
+  /// \brief Computes the dot product of this and another quaternion.
+  /// \param[in] q The other quaternion.
+  /// \return The sum of the products of corresponding coefficients.
+  float
+  dot (const Quaternion& q) const;
+
+  /// \brief Computes the length of this quaternion.
+  /// \return The square root of the dot product of this with itself.
+  float
+  length () const;
+
+  /// \brief Scales this quaternion to unit length.
+  /// \pre This is not the zero quaternion.
+  /// \post The length is 1.
+  void
+  normalize ();
+
+  /// \brief Computes the conjugate, which is the inverse rotation of a unit
+  ///   quaternion.
+  /// \return w - xi - yj - zk.
+  Quaternion
+  conjugate () const;
+
+  /// \brief Combines this with another rotation, in the order this * q.
+  /// \param[in] q The rotation to apply before this one.
+  /// \return This quaternion, which is now the product.
+  Quaternion&
+  operator*= (const Quaternion& q);
+
+  /// The real part.
+  float m_w;
+  /// The coefficient of i.
+  float m_x;
+  /// The coefficient of j.
+  float m_y;
+  /// The coefficient of k.
+  float m_z;
+};
+
+/// \brief Multiplies two quaternions, which combines their rotations.
+/// \param[in] q1 The rotation to apply second.
+/// \param[in] q2 The rotation to apply first.
+/// \return q1 * q2.
+Quaternion
+operator* (const Quaternion& q1, const Quaternion& q2);
+
+/// \brief Blends two rotations, turning at a constant speed along the
+///   shortest arc between them.
+/// \param[in] from The rotation when amount is 0.
+/// \param[in] to The rotation when amount is 1.
+/// \param[in] amount How far to go from "from" towards "to".
+/// \pre from and to are unit quaternions.
+/// \return A unit quaternion between from and to.
+Quaternion
+slerp (const Quaternion& from, const Quaternion& to, float amount);
+
+/// \brief Prints a quaternion as "w x y z", with a field width of 10 and 2
+///   digits of precision.
+/// \param[inout] out An output stream.
+/// \param[in] q A quaternion.
+/// \return The output stream.
+std::ostream&
+operator<< (std::ostream& out, const Quaternion& q);
+
+#endif//QUATERNION_HPP
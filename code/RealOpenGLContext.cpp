@@ -4,9 +4,17 @@
 /// \author Chad Hogg
 /// \version A02
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
 #include "RealOpenGLContext.hpp"
 
-RealOpenGLContext::RealOpenGLContext ()
+// The shadow state starts out matching OpenGL's defaults.
+RealOpenGLContext::RealOpenGLContext (bool validateState)
+  : m_validateState (validateState), m_filteredCalls (0), m_program (0),
+    m_vertexArray (0), m_arrayBuffer (0), m_elementBuffer (0),
+    m_elementBufferKnown (true), m_cullFace (GL_BACK), m_frontFace (GL_CCW)
 {
 }
 
@@ -14,6 +22,59 @@ RealOpenGLContext::~RealOpenGLContext ()
 {
 }
 
+unsigned long
+RealOpenGLContext::getFilteredCallCount () const
+{
+  return m_filteredCalls;
+}
+
+void
+RealOpenGLContext::resetFilteredCallCount ()
+{
+  m_filteredCalls = 0;
+}
+
+void
+RealOpenGLContext::validateState () const
+{
+  GLint actual;
+  const struct { GLenum pname; GLint expected; const char* name; } checks[] = {
+    { GL_CURRENT_PROGRAM, static_cast<GLint> (m_program), "GL_CURRENT_PROGRAM" },
+    { GL_VERTEX_ARRAY_BINDING, static_cast<GLint> (m_vertexArray), "GL_VERTEX_ARRAY_BINDING" },
+    { GL_ARRAY_BUFFER_BINDING, static_cast<GLint> (m_arrayBuffer), "GL_ARRAY_BUFFER_BINDING" },
+    { GL_CULL_FACE_MODE, static_cast<GLint> (m_cullFace), "GL_CULL_FACE_MODE" },
+    { GL_FRONT_FACE, static_cast<GLint> (m_frontFace), "GL_FRONT_FACE" }
+  };
+  for (const auto& check : checks)
+  {
+    glGetIntegerv (check.pname, &actual);
+    if (actual != check.expected)
+    {
+      fprintf (stderr, "GL state cache is stale: %s is %d, expected %d\n",
+	       check.name, actual, check.expected);
+      exit (-1);
+    }
+  }
+  if (m_elementBufferKnown)
+  {
+    glGetIntegerv (GL_ELEMENT_ARRAY_BUFFER_BINDING, &actual);
+    if (actual != static_cast<GLint> (m_elementBuffer))
+    {
+      fprintf (stderr, "GL state cache is stale: GL_ELEMENT_ARRAY_BUFFER_BINDING is %d, expected %u\n",
+	       actual, m_elementBuffer);
+      exit (-1);
+    }
+  }
+  for (GLenum cap : m_enabled)
+  {
+    if (!glIsEnabled (cap))
+    {
+      fprintf (stderr, "GL state cache is stale: capability 0x%x is disabled\n", cap);
+      exit (-1);
+    }
+  }
+}
+
 
 void
 RealOpenGLContext::attachShader (GLuint program, GLuint shader)
@@ -21,16 +82,50 @@ RealOpenGLContext::attachShader (GLuint program, GLuint shader)
   glAttachShader (program, shader);
 }
 
+void
+RealOpenGLContext::beginQuery (GLenum target, GLuint id)
+{
+  glBeginQuery (target, id);
+}
+
 void
 RealOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
 {
+  bool redundant = false;
+  if (target == GL_ARRAY_BUFFER)
+  {
+    redundant = (buffer == m_arrayBuffer);
+    m_arrayBuffer = buffer;
+  }
+  else if (target == GL_ELEMENT_ARRAY_BUFFER)
+  {
+    redundant = m_elementBufferKnown && buffer == m_elementBuffer;
+    m_elementBuffer = buffer;
+    m_elementBufferKnown = true;
+  }
+  if (redundant)
+  {
+    ++m_filteredCalls;
+    return;
+  }
   glBindBuffer (target, buffer);
+  if (m_validateState)
+    validateState ();
 }
 
 void
 RealOpenGLContext::bindVertexArray (GLuint array)
 {
+  if (array == m_vertexArray)
+  {
+    ++m_filteredCalls;
+    return;
+  }
+  m_vertexArray = array;
+  m_elementBufferKnown = false;
   glBindVertexArray (array);
+  if (m_validateState)
+    validateState ();
 }
 
 void
@@ -39,6 +134,12 @@ RealOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* dat
   glBufferData (target, size, data, usage);
 }
 
+void
+RealOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  glBufferSubData (target, offset, size, data);
+}
+
 void
 RealOpenGLContext::clear (GLbitfield mask)
 {
@@ -51,12 +152,24 @@ RealOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat
   glClearColor (red, green, blue, alpha);
 }
 
+GLenum
+RealOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return glClientWaitSync (sync, flags, timeout);
+}
+
 void
 RealOpenGLContext::compileShader (GLuint shader)
 {
   glCompileShader (shader);
 }
 
+void
+RealOpenGLContext::copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+  glCopyBufferSubData (readTarget, writeTarget, readOffset, writeOffset, size);
+}
+
 GLuint
 RealOpenGLContext::createProgram ()
 {
@@ -72,12 +185,28 @@ RealOpenGLContext::createShader (GLenum shaderType)
 void
 RealOpenGLContext::cullFace (GLenum mode)
 {
+  if (mode == m_cullFace)
+  {
+    ++m_filteredCalls;
+    return;
+  }
+  m_cullFace = mode;
   glCullFace (mode);
+  if (m_validateState)
+    validateState ();
 }
 
 void
 RealOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
 {
+  // Deleting a bound buffer unbinds it.
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    if (buffers[i] == m_arrayBuffer)
+      m_arrayBuffer = 0;
+    if (buffers[i] == m_elementBuffer)
+      m_elementBufferKnown = false;
+  }
   glDeleteBuffers (n, buffers);
 }
 
@@ -87,15 +216,36 @@ RealOpenGLContext::deleteProgram (GLuint program)
   glDeleteProgram (program);
 }
 
+void
+RealOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  glDeleteQueries (n, ids);
+}
+
 void
 RealOpenGLContext::deleteShader (GLuint shader)
 {
   glDeleteShader (shader);
 }
 
+void
+RealOpenGLContext::deleteSync (GLsync sync)
+{
+  glDeleteSync (sync);
+}
+
 void
 RealOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
 {
+  // Deleting the bound VAO binds the default one.
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    if (arrays[i] == m_vertexArray)
+    {
+      m_vertexArray = 0;
+      m_elementBufferKnown = false;
+    }
+  }
   glDeleteVertexArrays (n, arrays);
 }
 
@@ -111,10 +261,30 @@ RealOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
   glDrawArrays (mode, first, count);
 }
 
+void
+RealOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+  glDrawElements (mode, count, type, indices);
+}
+
+void
+RealOpenGLContext::drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex)
+{
+  glDrawElementsBaseVertex (mode, count, type, indices, basevertex);
+}
+
 void
 RealOpenGLContext::enable (GLenum cap)
 {
+  if (std::find (m_enabled.begin (), m_enabled.end (), cap) != m_enabled.end ())
+  {
+    ++m_filteredCalls;
+    return;
+  }
+  m_enabled.push_back (cap);
   glEnable (cap);
+  if (m_validateState)
+    validateState ();
 }
 
 void
@@ -123,10 +293,36 @@ RealOpenGLContext::enableVertexAttribArray (GLuint index)
   glEnableVertexAttribArray (index);
 }
 
+void
+RealOpenGLContext::endQuery (GLenum target)
+{
+  glEndQuery (target);
+}
+
+GLsync
+RealOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return glFenceSync (condition, flags);
+}
+
+void
+RealOpenGLContext::flush ()
+{
+  glFlush ();
+}
+
 void
 RealOpenGLContext::frontFace (GLenum mode)
 {
+  if (mode == m_frontFace)
+  {
+    ++m_filteredCalls;
+    return;
+  }
+  m_frontFace = mode;
   glFrontFace (mode);
+  if (m_validateState)
+    validateState ();
 }
 
 void
@@ -135,6 +331,12 @@ RealOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
   glGenBuffers (n, buffers);
 }
 
+void
+RealOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  glGenQueries (n, ids);
+}
+
 void
 RealOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
 {
@@ -147,6 +349,12 @@ RealOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
   return glGetAttribLocation (program, name);
 }
 
+void
+RealOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  glGetProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
 void
 RealOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
 {
@@ -159,6 +367,18 @@ RealOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
   glGetProgramiv (program, pname, params);
 }
 
+void
+RealOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  glGetQueryObjectiv (id, pname, params);
+}
+
+void
+RealOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  glGetQueryObjectui64v (id, pname, params);
+}
+
 void
 RealOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
 {
@@ -189,12 +409,48 @@ RealOpenGLContext::linkProgram (GLuint program)
   glLinkProgram (program);
 }
 
+void
+RealOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  glMultiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+RealOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  glProgramBinary (program, binaryFormat, binary, length);
+}
+
+void
+RealOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  glProgramParameteri (program, pname, value);
+}
+
 void
 RealOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
 {
   glShaderSource (shader, count, string, length);
 }
 
+void
+RealOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  glUniform1f (location, v0);
+}
+
+void
+RealOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  glUniform1i (location, v0);
+}
+
+void
+RealOpenGLContext::uniform3fv (GLint location, GLsizei count, const GLfloat* value)
+{
+  glUniform3fv (location, count, value);
+}
+
 void
 RealOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
@@ -204,7 +460,27 @@ RealOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean tr
 void
 RealOpenGLContext::useProgram (GLuint program)
 {
+  if (program == m_program)
+  {
+    ++m_filteredCalls;
+    return;
+  }
+  m_program = program;
   glUseProgram (program);
+  if (m_validateState)
+    validateState ();
+}
+
+void
+RealOpenGLContext::vertexAttribDivisor (GLuint index, GLuint divisor)
+{
+  glVertexAttribDivisor (index, divisor);
+}
+
+void
+RealOpenGLContext::vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer)
+{
+  glVertexAttribIPointer (index, size, type, stride, pointer);
 }
 
 void
@@ -7,6 +7,8 @@
 #ifndef REAL_OPENGL_CONTEXT_HPP
 #define REAL_OPENGL_CONTEXT_HPP
 
+#include <vector>
+
 #include "OpenGLContext.hpp"
 
 /// \brief A subclass of OpenGLContext that simply passes calls directly to
@@ -15,12 +17,20 @@
 /// For normal applications, this is the only subclass of OpenGLContext that
 ///   will be needed.  All OpenGL calls should be made through an instance of
 ///   this class.
+///
+/// A shadow copy of the bound program, VAO, buffers, enabled capabilities,
+///   cull face and front face is kept so that calls which would not change
+///   anything are never passed on to the driver.  This only works if no one
+///   else changes that state behind this object's back.
 class RealOpenGLContext : public OpenGLContext
 {
 public:
 
-  /// Constructs a RealOpenGLContext.
-  RealOpenGLContext ();
+  /// \brief Constructs a RealOpenGLContext.
+  /// \param[in] validateState Whether or not to check the shadow state
+  ///   against glGet* after every state change, which is slow but catches
+  ///   calls made behind this object's back.
+  RealOpenGLContext (bool validateState = false);
 
   /// Destructs a RealOpenGLContext.
   virtual
@@ -35,10 +45,24 @@ public:
   RealOpenGLContext&
   operator= (const RealOpenGLContext&) = delete;
 
+  /// \brief Gets the number of calls that were not passed on to OpenGL
+  ///   because they would not have changed anything.
+  /// \return The number of calls filtered since the last reset.
+  unsigned long
+  getFilteredCallCount () const;
+
+  /// \brief Resets the count of filtered calls, such as at the end of a
+  ///   frame.
+  /// \post getFilteredCallCount returns 0.
+  void
+  resetFilteredCallCount ();
 
   virtual void
   attachShader (GLuint program, GLuint shader);
   
+  virtual void
+  beginQuery (GLenum target, GLuint id);
+
   virtual void
   bindBuffer (GLenum target, GLuint buffer);
 
@@ -48,15 +72,24 @@ public:
   virtual void
   bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
 
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
   virtual void
   clear (GLbitfield mask);
 
   virtual void
   clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
 
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
   virtual void
   compileShader (GLuint shader);
 
+  virtual void
+  copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+
   virtual GLuint
   createProgram ();
 
@@ -72,9 +105,15 @@ public:
   virtual void
   deleteProgram (GLuint program);
 
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
   virtual void
   deleteShader (GLuint shader);
 
+  virtual void
+  deleteSync (GLsync sync);
+
   virtual void
   deleteVertexArrays (GLsizei n, const GLuint* arrays);
 
@@ -84,30 +123,57 @@ public:
   virtual void
   drawArrays (GLenum mode, GLint first, GLsizei count);
 
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
+  virtual void
+  drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex);
+
   virtual void
   enable (GLenum cap);
 
   virtual void
   enableVertexAttribArray (GLuint index);
 
+  virtual void
+  endQuery (GLenum target);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  flush ();
+
   virtual void
   frontFace (GLenum mode);
 
   virtual void
   genBuffers (GLsizei n, GLuint* buffers);
 
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
   virtual void
   genVertexArrays (GLsizei n, GLuint* arrays);
 
   virtual GLint
   getAttribLocation (GLuint program, const GLchar* name);
 
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
   virtual void
   getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
 
   virtual void
   getProgramiv (GLuint program, GLenum pname, GLint* params);
 
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
   virtual void
   getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
   
@@ -123,20 +189,68 @@ public:
   virtual void
   linkProgram (GLuint program);
 
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
   virtual void
   shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
 
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3fv (GLint location, GLsizei count, const GLfloat* value);
+
   virtual void
   uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
 
   virtual void
   useProgram (GLuint program);
   
+  virtual void
+  vertexAttribDivisor (GLuint index, GLuint divisor);
+
+  virtual void
+  vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+
   virtual void
   vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
 
   virtual void
   viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// \brief Compares the shadow state to what OpenGL reports.
+  /// \post If they differ, an error has been printed and the program has
+  ///   exited.
+  void
+  validateState () const;
+
+  /// Whether or not validateState runs after each state change.
+  bool m_validateState;
+  unsigned long m_filteredCalls;
+
+  GLuint m_program;
+  GLuint m_vertexArray;
+  GLuint m_arrayBuffer;
+  /// The element buffer is part of the VAO, so it is forgotten whenever the
+  ///   bound VAO changes.
+  GLuint m_elementBuffer;
+  bool m_elementBufferKnown;
+  /// The capabilities that have been enabled.  Nothing ever disables them.
+  std::vector<GLenum> m_enabled;
+  GLenum m_cullFace;
+  GLenum m_frontFace;
 };
 
 #endif//REAL_OPENGL_CONTEXT_HPP
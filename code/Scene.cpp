@@ -14,61 +14,376 @@
 #include "Transform.hpp"
 #include <iterator>
 #include <list>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include "Matrix4.hpp"
+#include "JobSystem.hpp"
+#include "Geometry.hpp"
+#include "Profiler.hpp"
 
+namespace
+{
+  // The number of Meshes given to each job when work is split among threads.
+  const size_t MESHES_PER_JOB = 64;
 
-Scene::Scene () {
-    std::map<std::string, Mesh*> m_scene;
-    std::array<LightSource, 8>* uLights;
+  // The parent index of a Mesh in the scene graph that has no parent.
+  const size_t NO_PARENT = ~size_t(0);
+
+  // The end of the list of free slots.
+  const uint32_t NO_SLOT = ~uint32_t(0);
+}
+
+
+Scene::Scene ()
+    : m_freeSlot(NO_SLOT), m_graphStale(true){
 };
 
 Scene::~Scene (){
-    for(auto it = m_scene.begin(); it != m_scene.end(); ++it){
-        it->second->~Mesh();
+    for(Mesh* mesh : m_meshes){
+        delete mesh;
     }
 };
 
-void
+MeshHandle
 Scene::add (const std::string& meshName, Mesh* mesh){
-    m_scene.insert(std::make_pair(meshName, mesh));
-    if (m_scene.size() == 1)
-        active = meshName;
+    if(m_names.count(meshName)){
+        fprintf(stderr, "The scene already has a mesh named %s; exiting\n", meshName.c_str());
+        exit(-1);
+    }
+    MeshHandle handle = add(mesh);
+    m_slots[handle.index].name = meshName;
+    m_names[meshName] = handle;
+    return handle;
+};
+
+MeshHandle
+Scene::add (Mesh* mesh){
+    uint32_t index = m_freeSlot;
+    if(index == NO_SLOT){
+        index = m_slots.size();
+        m_slots.push_back(Slot{0, 0, MeshHandle(), std::string()});
+    }
+    else
+        m_freeSlot = m_slots[index].dense;
+    Slot& slot = m_slots[index];
+    slot.dense = m_meshes.size();
+    slot.parent = MeshHandle();
+    m_meshes.push_back(mesh);
+    m_meshSlots.push_back(index);
+    m_visible.push_back(1);
+    m_graphStale = true;
+    MeshHandle handle(index, slot.generation);
+    if(m_meshes.size() == 1)
+        m_active = handle;
+    return handle;
 };
 
 void
 Scene::remove (const std::string& meshName){
-    if (active == meshName)
-        this->activateNextMesh();
-    delete m_scene.find(meshName)->second;
-    m_scene.erase(meshName);
+    remove(requireMesh(meshName));
+};
+
+void
+Scene::remove (MeshHandle mesh){
+    if(!isValid(mesh)){
+        fprintf(stderr, "Cannot remove a mesh that is not in the scene; exiting\n");
+        exit(-1);
+    }
+    if(m_active == mesh)
+        activateNextMesh();
+    // Anything attached to the Mesh is left where its parent put it.
+    for(size_t i = 0; i < m_meshes.size(); ++i){
+        Slot& child = m_slots[m_meshSlots[i]];
+        if(child.parent == mesh){
+            m_meshes[i]->setWorld(m_meshes[i]->getFullWorld());
+            child.parent = MeshHandle();
+        }
+    }
+    Slot& slot = m_slots[mesh.index];
+    delete m_meshes[slot.dense];
+    // The last Mesh takes its place, so the others do not move.
+    size_t last = m_meshes.size() - 1;
+    m_meshes[slot.dense] = m_meshes[last];
+    m_meshSlots[slot.dense] = m_meshSlots[last];
+    m_visible[slot.dense] = m_visible[last];
+    m_slots[m_meshSlots[slot.dense]].dense = slot.dense;
+    m_meshes.pop_back();
+    m_meshSlots.pop_back();
+    m_visible.pop_back();
+    if(!slot.name.empty())
+        m_names.erase(slot.name);
+    slot.name.clear();
+    ++slot.generation;
+    slot.dense = m_freeSlot;
+    m_freeSlot = mesh.index;
+    if(m_meshes.empty())
+        m_active = MeshHandle();
+    m_graphStale = true;
 };
 
 void
 Scene::clear (){
-    for(auto it = m_scene.begin(); it != m_scene.end(); ++it){
-        delete it->second;
+    for(size_t i = 0; i < m_meshes.size(); ++i){
+        delete m_meshes[i];
+        Slot& slot = m_slots[m_meshSlots[i]];
+        slot.name.clear();
+        ++slot.generation;
+        slot.dense = m_freeSlot;
+        m_freeSlot = m_meshSlots[i];
+    }
+    m_meshes.clear();
+    m_meshSlots.clear();
+    m_visible.clear();
+    m_names.clear();
+    m_active = MeshHandle();
+    m_graphStale = true;
+};
+
+bool
+Scene::isValid (MeshHandle mesh) const{
+    // Freeing a slot changes its generation, so stale handles never match.
+    return mesh.index < m_slots.size() && m_slots[mesh.index].generation == mesh.generation;
+};
+
+MeshHandle
+Scene::findMesh (const std::string& meshName) const{
+    auto it = m_names.find(meshName);
+    if(it == m_names.end())
+        return MeshHandle();
+    return it->second;
+};
+
+size_t
+Scene::getMeshCount () const{
+    return m_meshes.size();
+};
+
+void
+Scene::draw (const Transform& viewMatrix, const Matrix4& projectionMatrix,
+	     const Vector3& eyePosition){
+    PROFILE_SCOPE("Scene::draw");
+    for(Mesh* mesh : m_meshes){
+        mesh->draw(viewMatrix, projectionMatrix, eyePosition);
+    }
+};
+
+void
+Scene::record (CommandBuffer& commands, const Transform& viewMatrix,
+	       const Matrix4& projectionMatrix, const Vector3& eyePosition,
+	       size_t part, size_t parts) const{
+    size_t first = m_meshes.size() * part / parts;
+    size_t last = m_meshes.size() * (part + 1) / parts;
+    for(size_t i = first; i < last; ++i){
+        if(m_visible[i])
+            m_meshes[i]->record(commands, viewMatrix, projectionMatrix, eyePosition);
+    }
+};
+
+void
+Scene::recordParallel (CommandBuffer& commands, const Transform& viewMatrix,
+		       const Matrix4& projectionMatrix, const Vector3& eyePosition){
+    PROFILE_SCOPE("Scene::recordParallel");
+    size_t parts = (m_meshes.size() + MESHES_PER_JOB - 1) / MESHES_PER_JOB;
+    if(parts <= 1){
+        record(commands, viewMatrix, projectionMatrix, eyePosition);
+        return;
+    }
+    if(m_partBuffers.size() < parts)
+        m_partBuffers.resize(parts);
+    JobSystem::getGlobal().parallelFor(parts, 1, [&] (size_t begin, size_t end){
+        for(size_t part = begin; part < end; ++part){
+            m_partBuffers[part].clear();
+            record(m_partBuffers[part], viewMatrix, projectionMatrix, eyePosition,
+                   part, parts);
+        }
+    });
+    for(size_t part = 0; part < parts; ++part)
+        commands.append(m_partBuffers[part]);
+};
+
+void
+Scene::recordIndirect (IndirectBatch& batch, CommandBuffer& commands,
+		       const Transform& viewMatrix, const Matrix4& projectionMatrix,
+		       const Vector3& eyePosition) const{
+    PROFILE_SCOPE("Scene::recordIndirect");
+    for(size_t i = 0; i < m_meshes.size(); ++i){
+        if(m_visible[i] && !m_meshes[i]->addTo(batch))
+            m_meshes[i]->record(commands, viewMatrix, projectionMatrix, eyePosition);
+    }
+};
+
+void
+Scene::cull (const Transform& viewMatrix, const Matrix4& projectionMatrix){
+    FrustumPlanes planes;
+    extractFrustumPlanes(projectionMatrix * viewMatrix.getTransform(), planes);
+    cull(planes);
+};
+
+void
+Scene::cull (const FrustumPlanes& planes){
+    PROFILE_SCOPE("Scene::cull");
+    JobSystem::getGlobal().parallelFor(m_meshes.size(), MESHES_PER_JOB, [&] (size_t begin, size_t end){
+        for(size_t i = begin; i < end; ++i){
+            Vector3 center;
+            float radius;
+            m_meshes[i]->getBoundingSphere(center, radius);
+            bool visible = true;
+            for(int plane = 0; plane < 6 && visible; ++plane){
+                visible = planes[plane][0] * center.m_x + planes[plane][1] * center.m_y
+                    + planes[plane][2] * center.m_z + planes[plane][3] >= -radius;
+            }
+            m_visible[i] = visible;
+        }
+    });
+};
+
+size_t
+Scene::getVisibleCount () const{
+    size_t count = 0;
+    for(char visible : m_visible)
+        count += visible;
+    return count;
+};
+
+void
+Scene::updateMeshes (const std::function<void (Mesh&)>& update){
+    JobSystem::getGlobal().parallelFor(m_meshes.size(), MESHES_PER_JOB, [&] (size_t begin, size_t end){
+        for(size_t i = begin; i < end; ++i)
+            update(*m_meshes[i]);
+    });
+};
+
+void
+Scene::setParent (const std::string& childName, const std::string& parentName){
+    if(!hasMesh(childName) || !hasMesh(parentName)){
+        fprintf(stderr, "Cannot attach %s to %s, which are not both in the scene; exiting\n",
+                childName.c_str(), parentName.c_str());
+        exit(-1);
+    }
+    setParent(findMesh(childName), findMesh(parentName));
+};
+
+void
+Scene::setParent (MeshHandle child, MeshHandle parent){
+    if(!isValid(child) || !isValid(parent)){
+        fprintf(stderr, "Cannot attach meshes that are not both in the scene; exiting\n");
+        exit(-1);
+    }
+    for(MeshHandle ancestor = parent; isValid(ancestor); ancestor = m_slots[ancestor.index].parent){
+        if(ancestor == child){
+            fprintf(stderr, "Attaching %s to %s would make a cycle; exiting\n",
+                    m_slots[child.index].name.c_str(), m_slots[parent.index].name.c_str());
+            exit(-1);
+        }
+    }
+    m_slots[child.index].parent = parent;
+    m_graphStale = true;
+};
+
+void
+Scene::clearParent (const std::string& childName){
+    clearParent(findMesh(childName));
+};
+
+void
+Scene::clearParent (MeshHandle child){
+    if(isValid(child))
+        m_slots[child.index].parent = MeshHandle();
+    m_graphStale = true;
+};
+
+void
+Scene::updateWorlds (){
+    bool all = m_graphStale;
+    if(m_graphStale)
+        rebuildGraph();
+    for(size_t i = 0; i < m_graph.size(); ++i){
+        size_t parent = m_graphParents[i];
+        bool update = all || m_graph[i]->isWorldDirty()
+            || (parent != NO_PARENT && m_graphUpdated[parent]);
+        m_graphUpdated[i] = update;
+        if(update)
+            m_graph[i]->updateWorld(parent == NO_PARENT ? nullptr : &m_graph[parent]->getFullWorld());
+    }
+};
+
+void
+Scene::savePreviousWorlds (){
+    updateWorlds();
+    updateMeshes([] (Mesh& mesh){ mesh.savePreviousWorld(); });
+};
+
+void
+Scene::setInterpolation (float amount){
+    updateMeshes([amount] (Mesh& mesh){ mesh.setInterpolation(amount); });
+};
+
+MeshHandle
+Scene::handleAt (size_t dense) const{
+    uint32_t index = m_meshSlots[dense];
+    return MeshHandle(index, m_slots[index].generation);
+};
+
+MeshHandle
+Scene::requireMesh (const std::string& meshName) const{
+    MeshHandle handle = findMesh(meshName);
+    if(!isValid(handle)){
+        fprintf(stderr, "The scene has no mesh named %s; exiting\n", meshName.c_str());
+        exit(-1);
     }
-    m_scene.clear();
+    return handle;
 };
 
 void
-Scene::draw (const Transform& viewMatrix, const Matrix4& projectionMatrix){
-    for(auto it = m_scene.begin(); it != m_scene.end(); ++it){
-        it->second->draw(viewMatrix, projectionMatrix);
+Scene::rebuildGraph (){
+    std::vector<std::vector<size_t>> children(m_meshes.size());
+    for(size_t i = 0; i < m_meshes.size(); ++i){
+        MeshHandle parent = m_slots[m_meshSlots[i]].parent;
+        if(isValid(parent))
+            children[m_slots[parent.index].dense].push_back(i);
     }
+    // Roots first, then breadth first, so that every parent comes before its
+    //   children.
+    std::vector<size_t> dense;
+    m_graph.clear();
+    m_graphParents.clear();
+    for(size_t i = 0; i < m_meshes.size(); ++i){
+        if(!isValid(m_slots[m_meshSlots[i]].parent)){
+            dense.push_back(i);
+            m_graph.push_back(m_meshes[i]);
+            m_graphParents.push_back(NO_PARENT);
+        }
+    }
+    for(size_t i = 0; i < dense.size(); ++i){
+        for(size_t child : children[dense[i]]){
+            dense.push_back(child);
+            m_graph.push_back(m_meshes[child]);
+            m_graphParents.push_back(i);
+        }
+    }
+    m_graphUpdated.assign(m_graph.size(), 0);
+    m_graphStale = false;
 };
 
 bool
 Scene::hasMesh (const std::string& meshName){
-    return m_scene.count(meshName);
+    return isValid(findMesh(meshName));
 };
 
 Mesh*
 Scene::getMesh (const std::string& meshName){
-    auto it = m_scene.find(meshName);
-    if(it != m_scene.end()){
-        return it->second;
+    MeshHandle handle = findMesh(meshName);
+    return isValid(handle) ? getMesh(handle) : nullptr;
+};
+
+Mesh*
+Scene::getMesh (MeshHandle mesh) const{
+    if(!isValid(mesh)){
+        fprintf(stderr, "A mesh handle is no longer valid; exiting\n");
+        exit(-1);
     }
+    return m_meshes[m_slots[mesh.index].dense];
 };
 
   /// \brief Sets the active mesh to the mesh named "meshName".
@@ -78,54 +393,53 @@ Scene::getMesh (const std::string& meshName){
   /// \post The mesh with that name becomes the active mesh.
   void
   Scene::setActiveMesh (const std::string& meshName){
-      active = meshName;
+      m_active = requireMesh(meshName);
+  };
+
+  /// \brief Sets the active mesh.
+  /// \param[in] mesh A handle to the mesh that should be active.
+  /// \pre The handle is valid.
+  /// \post The mesh becomes the active mesh.
+  void
+  Scene::setActiveMesh (MeshHandle mesh){
+      m_active = mesh;
   };
 
   /// \brief Gets the active mesh.
-  /// \pre The scene has at least one mesh.
-  /// \return The active mesh.
+  /// \return The active mesh, or nullptr if there is none, such as when
+  ///   the scene is empty.
   Mesh*
   Scene::getActiveMesh (){
-    auto it = m_scene.find(active);
-    if(it != m_scene.end()){
-        return it->second;
-    }
+    return isValid(m_active) ? getMesh(m_active) : nullptr;
+  }
+
+  /// \brief Gets the handle of the active mesh.
+  /// \return The handle, which is invalid if the scene is empty.
+  MeshHandle
+  Scene::getActiveMeshHandle () const{
+    return m_active;
   }
+
   /// \brief Switches active meshes in the forward direction.
   /// \pre The scene has at least one mesh.
-  /// \post The next mesh becomes active.  If the last mesh was active, the
-  ///   first mesh becomes active.
-  
+  /// \post The next mesh, in the order they are drawn, becomes active.  If
+  ///   the last mesh was active, the first mesh becomes active.
   void
   Scene::activateNextMesh (){
-    if (m_scene.size() < 2) 
-        active = m_scene.begin()->first;
-    auto it = m_scene.find(active);
-    ++it;
-    if(it == m_scene.end())
-        active = m_scene.begin()->first;
-    else
-        active = it->first;
+    if (m_meshes.empty())
+        return;
+    size_t dense = isValid(m_active) ? m_slots[m_active.index].dense + 1 : 0;
+    m_active = handleAt(dense % m_meshes.size());
   }
 
   /// \brief Switches active meshes in the backward direction.
   /// \pre The scene has at least one mesh.
-  /// \post The previous mesh becomes active.  If the first mesh was active,
-  ///   the last mesh becomes active.
+  /// \post The previous mesh, in the order they are drawn, becomes active.
+  ///   If the first mesh was active, the last mesh becomes active.
   void
   Scene::activatePreviousMesh (){
-    if (m_scene.size() < 2) 
-        active = m_scene.begin()->first;
-    auto it = m_scene.find(active);
-    if(it == m_scene.begin()){
-        it = m_scene.end();
-        --it;
-        active = it->first; 
-    }
-    else
-    {
-        --it;
-        active = it->first;
-    }    
-
-  }
\ No newline at end of file
+    if (m_meshes.empty())
+        return;
+    size_t dense = isValid(m_active) ? m_slots[m_active.index].dense : 0;
+    m_active = handleAt((dense + m_meshes.size() - 1) % m_meshes.size());
+  }
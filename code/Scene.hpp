@@ -6,8 +6,11 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <cstdint>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <functional>
+#include <vector>
 #include "Mesh.hpp"
 #include "ShaderProgram.hpp"
 #include <utility>
@@ -15,9 +18,55 @@
 #include <iterator>
 #include <list>
 #include "Matrix4.hpp"
+#include "Vector3.hpp"
 #include "LightSource.hpp"
+#include "CommandBuffer.hpp"
+#include "Geometry.hpp"
+
+/// \brief Refers to a Mesh in a Scene.
+/// A handle stays valid for as long as its Mesh is in the Scene, and is
+///   recognized as stale afterwards, even if another Mesh has taken its
+///   place.  Looking one up is an array index and a comparison.
+struct MeshHandle
+{
+  /// \brief Initializes a handle that does not refer to any Mesh.
+  MeshHandle ()
+    : index (~0u), generation (0)
+  {
+  }
+
+  /// \brief Initializes a handle to a slot.
+  /// \param[in] slotIndex The slot the Mesh is in.
+  /// \param[in] slotGeneration Which use of the slot the handle is for.
+  MeshHandle (uint32_t slotIndex, uint32_t slotGeneration)
+    : index (slotIndex), generation (slotGeneration)
+  {
+  }
+
+  /// The slot the Mesh is in.
+  uint32_t index;
+  /// Which use of the slot this handle is for.
+  uint32_t generation;
+};
+
+/// \brief Tests whether two handles refer to the same Mesh.
+inline bool
+operator== (const MeshHandle& h1, const MeshHandle& h2)
+{
+  return h1.index == h2.index && h1.generation == h2.generation;
+}
+
+/// \brief Tests whether two handles refer to different Meshes.
+inline bool
+operator!= (const MeshHandle& h1, const MeshHandle& h2)
+{
+  return !(h1 == h2);
+}
 
 /// \brief A collection of all the objects that exist in the world.
+/// Meshes are kept contiguously, so that drawing and parallel work walk an
+///   array, and are referred to by MeshHandles.  Names are optional, and
+///   finding a Mesh by name is meant for setting up, not for every frame.
 class Scene
 {
 public:
@@ -46,9 +95,18 @@ public:
   ///   and be responsible for de-allocating it.
   /// \pre The Scene does not contain any Mesh associated with meshName.
   /// \post The Scene contains the mesh, associated with the meshName.
-  void
+  /// \return A handle to the Mesh.
+  MeshHandle
   add (const std::string& meshName, Mesh* mesh);
 
+  /// \brief Adds a new Mesh to this Scene without a name.
+  /// \param[in] mesh A pointer to the Mesh that should be added, which the
+  ///   Scene will now own.
+  /// \post The Scene contains the mesh.
+  /// \return A handle to the Mesh, which is the only way to refer to it.
+  MeshHandle
+  add (Mesh* mesh);
+
   /// \brief Removes a Mesh from this Scene.
   /// \param[in] meshName The name of the Mesh that should be removed.
   /// \pre This Scene contains a Mesh associated with meshName.
@@ -57,19 +115,180 @@ public:
   void
   remove (const std::string& meshName);
 
+  /// \brief Removes a Mesh from this Scene.
+  /// \param[in] mesh A handle to the Mesh that should be removed.
+  /// \pre The handle is valid.
+  /// \post The handle, and any copies of it, are no longer valid.
+  /// \post The Mesh has been freed.
+  void
+  remove (MeshHandle mesh);
+
   /// \brief Removes all Meshes from this Scene.
   /// \post This Scene is empty.
   /// \post All Meshes that had been part of this Scene have been freed.
   void
   clear ();
 
+  /// \brief Tests whether a handle still refers to a Mesh in this Scene.
+  /// \param[in] mesh A handle.
+  /// \return Whether or not the Mesh it referred to is still here.
+  bool
+  isValid (MeshHandle mesh) const;
+
+  /// \brief Finds the handle of a named Mesh.  This is a hash lookup, so
+  ///   handles should be looked up once and kept.
+  /// \param[in] meshName The name of the Mesh.
+  /// \return A handle to the Mesh, or an invalid handle if there is none.
+  MeshHandle
+  findMesh (const std::string& meshName) const;
+
+  /// \brief Gets the number of Meshes in this Scene.
+  /// \return The number of Meshes.
+  size_t
+  getMeshCount () const;
+
   /// \brief Draws all of the elements in this Scene.
   /// \param[in] shaderProgram The ShaderProgram that should be used for
   ///   drawing.
   /// \param[in] viewMatrix The view matrix that should be used when drawing
   ///   the Scene.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  void
+  draw (const Transform& viewMatrix, const Matrix4& projectionMatrix,
+	const Vector3& eyePosition);
+
+  /// \brief Records draw packets for some of the elements in this Scene
+  ///   without making any OpenGL calls, so that this can run on any thread.
+  /// \param[inout] commands The buffer to record into.
+  /// \param[in] viewMatrix The view matrix that should be used when drawing
+  ///   the Scene.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  /// \param[in] part Which of the parts the Meshes are split into to record.
+  /// \param[in] parts The number of parts the Meshes are split into.  Each
+  ///   part is a contiguous run, so submitting the buffers for parts 0, 1, ...
+  ///   in order draws the Meshes in the same order as draw.
+  /// \pre part < parts, and the Scene is not modified until this returns.
+  /// \post A packet for each Mesh in the part has been added to commands.
+  void
+  record (CommandBuffer& commands, const Transform& viewMatrix,
+	  const Matrix4& projectionMatrix, const Vector3& eyePosition,
+	  size_t part = 0, size_t parts = 1) const;
+
+  /// \brief Records draw packets for all of the visible elements in this
+  ///   Scene, splitting the work among the threads of the global JobSystem.
+  /// \param[inout] commands The buffer to record into.
+  /// \param[in] viewMatrix The view matrix that should be used when drawing
+  ///   the Scene.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  /// \post commands contains the same packets, in the same order, as record
+  ///   would have produced.
+  void
+  recordParallel (CommandBuffer& commands, const Transform& viewMatrix,
+		  const Matrix4& projectionMatrix, const Vector3& eyePosition);
+
+  /// \brief Adds the visible Meshes that an IndirectBatch can draw to it,
+  ///   and records draw packets for the rest.
+  /// \param[inout] batch The batch to add to.
+  /// \param[inout] commands The buffer to record into.
+  /// \param[in] viewMatrix The view matrix that should be used when drawing
+  ///   the Scene.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \param[in] eyePosition Where the camera is in the world, which is the
+  ///   position of the inverse of viewMatrix.
+  /// \post Each visible Mesh is either in batch or has a packet in
+  ///   commands.
+  void
+  recordIndirect (IndirectBatch& batch, CommandBuffer& commands,
+		  const Transform& viewMatrix, const Matrix4& projectionMatrix,
+		  const Vector3& eyePosition) const;
+
+  /// \brief Decides which Meshes are at least partly inside the view
+  ///   frustum, in parallel.  Those that are not will be skipped by record.
+  /// \param[in] viewMatrix The view matrix.
+  /// \param[in] projectionMatrix The projection matrix.
+  /// \post Only Meshes whose bounding spheres touch the frustum are visible.
+  void
+  cull (const Transform& viewMatrix, const Matrix4& projectionMatrix);
+
+  /// \brief Decides which Meshes are at least partly inside a view frustum
+  ///   whose planes are already known, such as a Camera's.
+  /// \param[in] planes The planes of the frustum.
+  /// \post Only Meshes whose bounding spheres touch the frustum are visible.
+  void
+  cull (const FrustumPlanes& planes);
+
+  /// \brief Gets the number of Meshes that survived the last cull.
+  /// \return The number of visible Meshes.
+  size_t
+  getVisibleCount () const;
+
+  /// \brief Applies a function to every Mesh, in parallel.
+  /// \param[in] update A function that moves, rotates, etc. one Mesh.  It
+  ///   will be called from several threads at once, each with a different
+  ///   Mesh.
+  /// \post update has been called once for each Mesh.
+  void
+  updateMeshes (const std::function<void (Mesh&)>& update);
+
+  /// \brief Remembers every Mesh's world matrix before a simulation step.
+  /// \post The full world matrices are up to date, and each Mesh's previous
+  ///   world matrix is its current one.
+  void
+  savePreviousWorlds ();
+
+  /// \brief Sets how far between the previous and current simulation steps
+  ///   every Mesh should be drawn.
+  /// \param[in] amount 0 for the previous step, 1 for the current one.
+  void
+  setInterpolation (float amount);
+
+  /// \brief Attaches a Mesh to another, so that it moves with it.
+  /// \param[in] childName The name of the Mesh to attach.
+  /// \param[in] parentName The name of the Mesh to attach it to.
+  /// \pre Both Meshes are in this Scene, and parentName is not childName or
+  ///   attached (through any number of Meshes) to it.
+  /// \post The child's world matrix is relative to the parent's.  It is not
+  ///   changed, so the child jumps to the same place relative to the parent
+  ///   as it had relative to the world.
+  void
+  setParent (const std::string& childName, const std::string& parentName);
+
+  /// \brief Attaches a Mesh to another, so that it moves with it.
+  /// \param[in] child A handle to the Mesh to attach.
+  /// \param[in] parent A handle to the Mesh to attach it to.
+  /// \pre Both handles are valid, and parent is not child or attached to it.
+  /// \post The child's world matrix is relative to the parent's.
+  void
+  setParent (MeshHandle child, MeshHandle parent);
+
+  /// \brief Detaches a Mesh from its parent.
+  /// \param[in] childName The name of the Mesh to detach.
+  /// \pre The Mesh is in this Scene.
+  /// \post The Mesh's world matrix is relative to the world again.
   void
-  draw (const Transform& viewMatrix, const Matrix4& projectionMatrix);
+  clearParent (const std::string& childName);
+
+  /// \brief Detaches a Mesh from its parent.
+  /// \param[in] child A handle to the Mesh to detach.
+  /// \pre The handle is valid.
+  /// \post The Mesh's world matrix is relative to the world again.
+  void
+  clearParent (MeshHandle child);
+
+  /// \brief Recomputes the full world matrices of the Meshes that have
+  ///   moved since the last call, and of everything attached to them.
+  /// The Meshes are kept in an array with every parent before its children,
+  ///   so this is one pass over it: a Mesh is updated if it is dirty or its
+  ///   parent was just updated.
+  /// \post Every Mesh's getFullWorld is up to date.
+  void
+  updateWorlds ();
 
   /// \brief Tests whether or not this Scene contains a Mesh associated with a
   ///   name.
@@ -88,6 +307,14 @@ public:
   Mesh*
   getMesh (const std::string& meshName);
 
+  /// \brief Gets the Mesh a handle refers to.
+  /// \param[in] mesh A handle to the Mesh.
+  /// \return A pointer to the Mesh, which should not be kept longer than
+  ///   the handle is valid.
+  /// \pre The handle is valid.
+  Mesh*
+  getMesh (MeshHandle mesh) const;
+
   /// \brief Sets the active mesh to the mesh named "meshName".
   /// The active mesh is the one affected by transforms.
   /// \param[in] meshName The name of the mesh that should be active.
@@ -96,29 +323,95 @@ public:
   void
   setActiveMesh (const std::string& meshName);
 
+  /// \brief Sets the active mesh.
+  /// \param[in] mesh A handle to the mesh that should be active.
+  /// \pre The handle is valid.
+  /// \post The mesh becomes the active mesh.
+  void
+  setActiveMesh (MeshHandle mesh);
+
   /// \brief Gets the active mesh.
-  /// \pre The scene has at least one mesh.
-  /// \return The active mesh.
+  /// \return The active mesh, or nullptr if there is none, such as when
+  ///   the scene is empty.
   Mesh*
   getActiveMesh ();
 
+  /// \brief Gets the handle of the active mesh.
+  /// \return The handle, which is invalid if the scene is empty.
+  MeshHandle
+  getActiveMeshHandle () const;
+
   /// \brief Switches active meshes in the forward direction.
   /// \pre The scene has at least one mesh.
-  /// \post The next mesh becomes active.  If the last mesh was active, the
-  ///   first mesh becomes active.
+  /// \post The next mesh, in the order they are drawn, becomes active.  If
+  ///   the last mesh was active, the first mesh becomes active.
   void
   activateNextMesh ();
 
   /// \brief Switches active meshes in the backward direction.
   /// \pre The scene has at least one mesh.
-  /// \post The previous mesh becomes active.  If the first mesh was active,
-  ///   the last mesh becomes active.
+  /// \post The previous mesh, in the order they are drawn, becomes active.
+  ///   If the first mesh was active, the last mesh becomes active.
   void
   activatePreviousMesh ();
 
 private:
-  std::map<std::string, Mesh*> m_scene;
-  std::string active;
+  /// Where a handle's Mesh is.
+  struct Slot
+  {
+    /// The index of the Mesh in m_meshes, or, if the slot is free, the
+    ///   index of the next free slot.
+    uint32_t dense;
+    /// Incremented whenever the slot is freed, so that old handles to it
+    ///   stop matching.
+    uint32_t generation;
+    /// The Mesh this one is attached to, if any.
+    MeshHandle parent;
+    /// The Mesh's name, or empty if it has none.
+    std::string name;
+  };
+
+  /// \brief Makes the handle of the Mesh at an index in m_meshes.
+  /// \param[in] dense The index.
+  /// \return A handle to that Mesh.
+  MeshHandle
+  handleAt (size_t dense) const;
+
+  /// \brief Finds the handle of a named Mesh, exiting if there is none.
+  /// \param[in] meshName The name of the Mesh.
+  /// \return A valid handle to it.
+  MeshHandle
+  requireMesh (const std::string& meshName) const;
+
+  /// \brief Brings m_graph up to date after Meshes are added or removed or
+  ///   their parents change.
+  /// \post Every Mesh is in m_graph after its parent, and all are dirty.
+  void
+  rebuildGraph ();
+
+  std::vector<Slot> m_slots;
+  /// The first free slot, or NO_SLOT if every slot is in use.
+  uint32_t m_freeSlot;
+  /// Every Mesh, contiguously, in the order they are drawn.
+  std::vector<Mesh*> m_meshes;
+  /// The slot of each Mesh in m_meshes.
+  std::vector<uint32_t> m_meshSlots;
+  /// Whether or not each Mesh in m_meshes survived the last cull.
+  std::vector<char> m_visible;
+  /// The handle of each named Mesh.
+  std::unordered_map<std::string, MeshHandle> m_names;
+  /// One buffer per range of Meshes for recordParallel, kept so their
+  ///   memory is reused.
+  std::vector<CommandBuffer> m_partBuffers;
+  /// Every Mesh, with each parent before its children.
+  std::vector<Mesh*> m_graph;
+  /// The index in m_graph of each Mesh's parent, or NO_PARENT.
+  std::vector<size_t> m_graphParents;
+  /// Whether or not each Mesh in m_graph was updated by the current pass.
+  std::vector<char> m_graphUpdated;
+  /// Whether or not m_graph needs rebuilding.
+  bool m_graphStale;
+  MeshHandle m_active;
   std::array<LightSource, 8>* uLights;
 };
 
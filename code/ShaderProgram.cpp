@@ -7,17 +7,71 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cctype>
 #include <cstdio>
 #include <memory>
+#include <vector>
+
+#include <sys/stat.h>
 
 #include <glm/gtc/type_ptr.hpp>
 
 #include "ShaderProgram.hpp"
+#include "TraceRecorder.hpp"
 #include "Matrix4.hpp"
 #include "Vector3.hpp"
 
+namespace
+{
+  // Where program binaries are cached, or "" if they are not.
+  std::string&
+  binaryCacheDirectory ()
+  {
+    static std::string directory;
+    return directory;
+  }
+
+  // Definitions as " NAME=VALUE" each, for messages.
+  std::string
+  describeDefines (const ShaderProgram::Defines& defines)
+  {
+    std::string text;
+    for (const auto& define : defines)
+      text += " " + define.first + "=" + define.second;
+    return text;
+  }
+
+  // Definitions as ".NAME-VALUE" each, with anything but letters, digits,
+  //   '_' and '-' replaced, so that they can end a file name.
+  std::string
+  getFileSuffix (const ShaderProgram::Defines& defines)
+  {
+    std::string suffix;
+    for (const auto& define : defines)
+      suffix += "." + define.first + "-" + define.second;
+    for (char& c : suffix)
+      if (!isalnum (static_cast<unsigned char> (c)) && c != '_' && c != '-'
+	  && c != '.')
+	c = '_';
+    return suffix;
+  }
+
+  // 64-bit FNV-1a, which is plenty to tell shader sources apart.
+  unsigned long long
+  hashString (const std::string& text, unsigned long long hash = 14695981039346656037ull)
+  {
+    for (unsigned char c : text)
+    {
+      hash ^= c;
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+}
+
 ShaderProgram::ShaderProgram (OpenGLContext* context)
-  : m_context (context), m_programId (m_context->createProgram ()), m_vertexShaderId (0), m_fragmentShaderId (0)
+  : m_context (context), m_programId (m_context->createProgram ()), m_vertexShaderId (0), m_fragmentShaderId (0),
+    m_fromBinaryCache (false)
 {
 }
 
@@ -39,7 +93,24 @@ ShaderProgram::getAttributeLocation (const std::string& attributeName) const
 GLint
 ShaderProgram::getUniformLocation (const std::string& uniformName) const
 {
-  return m_context->getUniformLocation (m_programId, uniformName.c_str ());
+  return getUniformLocation (uniformName.c_str ());
+}
+
+GLint
+ShaderProgram::getUniformLocation (const char* uniformName) const
+{
+  auto it = m_uniformLocations.find (uniformName);
+  if (it != m_uniformLocations.end ())
+    return it->second;
+  GLint location = m_context->getUniformLocation (m_programId, uniformName);
+  m_uniformLocations.emplace (uniformName, location);
+  return location;
+}
+
+GLuint
+ShaderProgram::getProgramId () const
+{
+  return m_programId;
 }
 
 void
@@ -53,52 +124,50 @@ void
 ShaderProgram::setUniformVec3 (const std::string& uniform, const Vector3& value)
 {
   GLint location = getUniformLocation (uniform);
-  glUniform3fv(location, 1, &value.m_x);
+  m_context->uniform3fv (location, 1, &value.m_x);
 }
 
 void
 ShaderProgram::setUniformInt (const std::string& uniform, const int& value)
 {
   GLint location = getUniformLocation (uniform);
-  glUniform1i (location, value);
+  m_context->uniform1i (location, value);
 }
 
 void
 ShaderProgram::setUniformFloat (const std::string& uniform, const float& value)
 {
   GLint location = getUniformLocation (uniform);
-  glUniform1f (location, value);
+  m_context->uniform1f (location, value);
 }
 
 void
 ShaderProgram::createVertexShader (const std::string& vertexShaderFilename)
 {
-  m_vertexShaderId = m_context->createShader (GL_VERTEX_SHADER);
-  if (m_vertexShaderId == 0)
-  {
-    fprintf (stderr, "Failed to create vertex shader object; exiting\n");
-    exit (-1);
-  }
-  compileShader (vertexShaderFilename, m_vertexShaderId);
+  m_vertexShaderFilename = vertexShaderFilename;
+  m_vertexShaderSource = readShaderSource (vertexShaderFilename);
 }
 
 void
 ShaderProgram::createFragmentShader (const std::string& fragmentShaderFilename)
 {
-  m_fragmentShaderId = m_context->createShader (GL_FRAGMENT_SHADER);
-  if (m_fragmentShaderId == 0)
-  {
-    fprintf (stderr, "Failed to create fragment shader object; exiting\n");
-    exit (-1);
-  }
-  compileShader (fragmentShaderFilename, m_fragmentShaderId);
+  m_fragmentShaderFilename = fragmentShaderFilename;
+  m_fragmentShaderSource = readShaderSource (fragmentShaderFilename);
 }
 
-void
-ShaderProgram::compileShader (const std::string& shaderFilename,
-			      GLuint shaderId)
+GLuint
+ShaderProgram::compileShader (GLenum shaderType, const std::string& shaderFilename,
+			      const std::string& sourceCode)
 {
-  std::string sourceCode = readShaderSource (shaderFilename);
+  std::string description = shaderFilename + describeDefines (m_defines);
+  TRACE_SCOPE_DETAIL ("compile shader", "init", description.c_str ());
+  GLuint shaderId = m_context->createShader (shaderType);
+  if (shaderId == 0)
+  {
+    fprintf (stderr, "Failed to create %s shader object; exiting\n",
+	     shaderType == GL_VERTEX_SHADER ? "vertex" : "fragment");
+    exit (-1);
+  }
   const GLchar* sourceCodePtr = sourceCode.c_str ();
   // One array of char*. Do not need to specify length if null-terminated.
   m_context->shaderSource (shaderId, 1, &sourceCodePtr, nullptr);
@@ -107,32 +176,164 @@ ShaderProgram::compileShader (const std::string& shaderFilename,
   m_context->getShaderiv (shaderId, GL_COMPILE_STATUS, &isCompiled);
   if (isCompiled == GL_FALSE)
   {
-    std::string logFile = shaderFilename + ".log";
+    std::string logFile = shaderFilename + getFileSuffix (m_defines) + ".log";
     writeInfoLog (shaderId, true, logFile);
-    fprintf (stderr, "Compilation error for %s -- see log; exiting\n",
-	     shaderFilename.c_str ());
+    fprintf (stderr, "Compilation error for %s -- see %s; exiting\n",
+	     description.c_str (), logFile.c_str ());
     exit (-1);
   }
   m_context->attachShader (m_programId, shaderId);
+  return shaderId;
 }
 
 void
-ShaderProgram::link () const
+ShaderProgram::link ()
 {
-  fprintf (stdout, "Linking shader program %d\n", m_programId);
+  std::string description = m_fragmentShaderFilename + describeDefines (m_defines);
+  TRACE_SCOPE_DETAIL ("link program", "init", description.c_str ());
+  m_uniformLocations.clear ();
+  std::string cacheFile = getBinaryCacheFile ();
+  m_fromBinaryCache = !cacheFile.empty () && loadBinary (cacheFile);
+  if (m_fromBinaryCache)
+  {
+    fprintf (stderr, "Loaded shader program %d from %s\n", m_programId,
+	     cacheFile.c_str ());
+    return;
+  }
+  m_vertexShaderId = compileShader (GL_VERTEX_SHADER, m_vertexShaderFilename,
+				    m_vertexShaderSource);
+  m_fragmentShaderId = compileShader (GL_FRAGMENT_SHADER, m_fragmentShaderFilename,
+				      m_fragmentShaderSource);
+  fprintf (stderr, "Linking shader program %d\n", m_programId);
+  if (!cacheFile.empty ())
+    m_context->programParameteri (m_programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   m_context->linkProgram (m_programId);
   GLint isLinked;
   m_context->getProgramiv (m_programId, GL_LINK_STATUS, &isLinked);
   if (isLinked == GL_FALSE)
   {
-    writeInfoLog (0, false, "Link.log");
-    fprintf (stderr, "Link error -- see log\n");
+    std::string logFile = "Link" + getFileSuffix (m_defines) + ".log";
+    writeInfoLog (0, false, logFile);
+    fprintf (stderr, "Link error for %s -- see %s\n", description.c_str (),
+	     logFile.c_str ());
     exit (-1);
   }
   // After linking, the shader objects no longer need to be attached.
   // A shader won't be deleted until it is detached.
   m_context->detachShader (m_programId, m_vertexShaderId);
   m_context->detachShader (m_programId, m_fragmentShaderId);
+  if (!cacheFile.empty ())
+    saveBinary (cacheFile);
+}
+
+ShaderProgram*
+ShaderProgram::getVariant (const Defines& defines)
+{
+  if (defines.empty ())
+    return this;
+  std::unique_ptr<ShaderProgram>& variant = m_variants[defines];
+  if (!variant)
+  {
+    variant.reset (new ShaderProgram (m_context));
+    variant->m_defines = defines;
+    variant->m_vertexShaderFilename = m_vertexShaderFilename;
+    variant->m_vertexShaderSource = addDefines (m_vertexShaderSource, defines);
+    variant->m_fragmentShaderFilename = m_fragmentShaderFilename;
+    variant->m_fragmentShaderSource = addDefines (m_fragmentShaderSource, defines);
+    variant->link ();
+  }
+  return variant.get ();
+}
+
+bool
+ShaderProgram::isFromBinaryCache () const
+{
+  return m_fromBinaryCache;
+}
+
+void
+ShaderProgram::setBinaryCacheDirectory (const std::string& directory)
+{
+  if (!directory.empty ())
+    mkdir (directory.c_str (), 0755);
+  binaryCacheDirectory () = directory;
+}
+
+std::string
+ShaderProgram::addDefines (const std::string& sourceCode, const Defines& defines)
+{
+  // GLSL only allows comments and whitespace before "#version".
+  size_t versionEnd = 0;
+  int firstLine = 1;
+  size_t version = sourceCode.find ("#version");
+  if (version != std::string::npos)
+  {
+    versionEnd = sourceCode.find ('\n', version);
+    versionEnd = (versionEnd == std::string::npos) ? sourceCode.size () : versionEnd + 1;
+    for (size_t i = 0; i < versionEnd; ++i)
+      firstLine += sourceCode[i] == '\n';
+  }
+  std::string added;
+  for (const auto& define : defines)
+    added += "#define " + define.first + " " + define.second + "\n";
+  added += "#line " + std::to_string (firstLine) + "\n";
+  return sourceCode.substr (0, versionEnd) + added + sourceCode.substr (versionEnd);
+}
+
+std::string
+ShaderProgram::getBinaryCacheFile () const
+{
+  const std::string& directory = binaryCacheDirectory ();
+  if (directory.empty ())
+    return "";
+  // A binary only works with the driver that made it, so the driver is part
+  //   of the key along with both sources.
+  unsigned long long hash = hashString (m_vertexShaderSource);
+  hash = hashString (std::string (1, '\0') + m_fragmentShaderSource, hash);
+  for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+  {
+    const GLubyte* value = m_context->getString (name);
+    std::string text = value ? reinterpret_cast<const char*> (value) : "";
+    hash = hashString (std::string (1, '\0') + text, hash);
+  }
+  char fileName[32];
+  snprintf (fileName, sizeof (fileName), "%016llx.bin", hash);
+  return directory + "/" + fileName;
+}
+
+bool
+ShaderProgram::loadBinary (const std::string& cacheFile)
+{
+  std::ifstream inFile (cacheFile, std::ios::binary);
+  GLenum format;
+  if (!inFile.read (reinterpret_cast<char*> (&format), sizeof (format)))
+    return false;
+  std::vector<char> binary { std::istreambuf_iterator<char> (inFile),
+			     std::istreambuf_iterator<char> () };
+  m_context->programBinary (m_programId, format, binary.data (), binary.size ());
+  // Drivers reject binaries from other versions of themselves, in which
+  //   case the program is simply compiled again.
+  GLint isLinked;
+  m_context->getProgramiv (m_programId, GL_LINK_STATUS, &isLinked);
+  return isLinked == GL_TRUE;
+}
+
+void
+ShaderProgram::saveBinary (const std::string& cacheFile) const
+{
+  GLint length = 0;
+  m_context->getProgramiv (m_programId, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+  std::vector<char> binary (length);
+  GLenum format;
+  GLsizei written = 0;
+  m_context->getProgramBinary (m_programId, length, &written, &format, binary.data ());
+  std::ofstream outFile (cacheFile, std::ios::binary);
+  if (!outFile || written <= 0)
+    return;
+  outFile.write (reinterpret_cast<const char*> (&format), sizeof (format));
+  outFile.write (binary.data (), written);
 }
 
 void
@@ -7,6 +7,8 @@
 #ifndef SHADER_PROGRAM_HPP
 #define SHADER_PROGRAM_HPP
 
+#include <map>
+#include <memory>
 #include <string>
 
 #include <glm/mat4x4.hpp>
@@ -20,6 +22,9 @@ class ShaderProgram
 {
 public:
 
+  /// Preprocessor definitions that specialize a program, from name to value.
+  typedef std::map<std::string, std::string> Defines;
+
   /// \brief Constructs a new ShaderProgram with no attached shaders.
   /// \param[in] context A pointer to an object through which the
   ///   ShaderProgram can make OpenGL calls.
@@ -54,6 +59,19 @@ public:
   GLint
   getUniformLocation (const std::string& uniformName) const;
 
+  /// \brief Gets the OpenGL location of the uniform with a certain name.
+  /// \param[in] uniformName The null-terminated name of the requested
+  ///   uniform.
+  /// \return The location of that uniform.  Locations are remembered, so
+  ///   only the first request for each name makes an OpenGL call.
+  GLint
+  getUniformLocation (const char* uniformName) const;
+
+  /// \brief Gets the OpenGL identifier of this ShaderProgram.
+  /// \return The name OpenGL gave this program.
+  GLuint
+  getProgramId () const;
+
   /// \brief Sets the value of a uniform 4x4 matrix of floats.
   /// \param[in] uniform The name of the uniform.
   /// \param[in] value The matrix to use.
@@ -71,25 +89,54 @@ public:
   void
   setUniformInt (const std::string& uniform, const int& value);
 
-  /// \brief Creates and attaches a vertex shader.
+  /// \brief Reads the source of a vertex shader, which link will compile
+  ///   unless it finds the program in the binary cache.
   /// \param[in] vertexShaderFilename The name of a file that contains the
   ///   vertex shader's source code.
   /// \pre No vertex shader was previously created.
   void
   createVertexShader (const std::string& vertexShaderFilename);
 
-  /// \brief Creates and attaches a fragment shader.
+  /// \brief Reads the source of a fragment shader, which link will compile
+  ///   unless it finds the program in the binary cache.
   /// \param[in] fragmentShaderFilename The name of a file that contains the
   ///   fragment shader's source code.
   /// \pre No fragment shader was previously created.
   void
   createFragmentShader (const std::string& fragmentShaderFilename);
 
-  /// \brief Links the attached shaders into this ShaderProgram.
+  /// \brief Links the shaders into this ShaderProgram.
+  /// If the binary cache is enabled and holds a binary for the same sources,
+  ///   driver vendor, renderer and version, and the driver accepts it, that
+  ///   binary is loaded instead.  Otherwise the shaders are compiled and
+  ///   linked, and the result is saved to the cache.
   /// \pre A vertex and fragment shader had been created.
   /// \pre This ShaderProgram had not already been linked.
   void
-  link () const;
+  link ();
+
+  /// \brief Gets a version of this program compiled with some preprocessor
+  ///   definitions, compiling and linking it the first time it is asked for.
+  /// \param[in] defines The definitions, which are inserted after the
+  ///   "#version" line of both shaders.
+  /// \pre This ShaderProgram has been linked.
+  /// \return This program if defines is empty, or else the variant, which
+  ///   this program owns.  Variants have their own uniform values.
+  ShaderProgram*
+  getVariant (const Defines& defines);
+
+  /// \brief Tells whether or not link loaded this program from the binary
+  ///   cache.
+  /// \return True if it did, or false if the shaders were compiled.
+  bool
+  isFromBinaryCache () const;
+
+  /// \brief Chooses where program binaries are cached between runs.
+  /// \param[in] directory The directory to keep them in, which is created if
+  ///   necessary, or "" to turn the cache off.  It starts off.
+  /// \post Programs linked from now on use the cache in that directory.
+  static void
+  setBinaryCacheDirectory (const std::string& directory);
 
   /// \brief Makes this ShaderProgram the one that will be used by future
   ///   OpenGL calls.
@@ -103,12 +150,42 @@ public:
 
 private:
 
-  /// \brief Compiles a shader.
-  /// \param[in] shaderFilename The name of a file that contains the shader's
-  ///   source code.
-  /// \param[in] shaderId The OpenGL identifier associated with the shader.
+  /// \brief Creates, compiles and attaches a shader.
+  /// \param[in] shaderType GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
+  /// \param[in] shaderFilename The name of the file the source came from.
+  /// \param[in] sourceCode The shader's source code.
+  /// \return The OpenGL identifier of the new shader.
+  GLuint
+  compileShader (GLenum shaderType, const std::string& shaderFilename,
+		 const std::string& sourceCode);
+
+  /// \brief Adds preprocessor definitions to shader source.
+  /// \param[in] sourceCode The source, which may start with "#version".
+  /// \param[in] defines The definitions to add.
+  /// \return The source with the definitions after any "#version" line, and
+  ///   line numbers in logs still matching the file.
+  static std::string
+  addDefines (const std::string& sourceCode, const Defines& defines);
+
+  /// \brief Finds the file this program's binary is cached in.
+  /// \return A name made from a hash of the sources and the driver's vendor,
+  ///   renderer and version, or "" if the cache is off.
+  std::string
+  getBinaryCacheFile () const;
+
+  /// \brief Tries to load this program from the binary cache.
+  /// \param[in] cacheFile The file to load from.
+  /// \return True if the file existed and the driver accepted it.
+  bool
+  loadBinary (const std::string& cacheFile);
+
+  /// \brief Saves this program's binary to the cache.
+  /// \param[in] cacheFile The file to save to.
+  /// \pre This program has been linked.
+  /// \post The file has been written, unless the driver could not give a
+  ///   binary or the file could not be created.
   void
-  compileShader (const std::string& shaderFilename, GLuint shaderId);
+  saveBinary (const std::string& cacheFile) const;
 
   /// \brief Reads the source code for a shader from a file.
   /// \param[in] filename The name of a file that contains the shader's source
@@ -140,6 +217,21 @@ private:
   GLuint m_vertexShaderId;
   /// The OpenGL identifier given to the fragment shader.
   GLuint m_fragmentShaderId;
+  std::string m_vertexShaderFilename;
+  std::string m_vertexShaderSource;
+  std::string m_fragmentShaderFilename;
+  std::string m_fragmentShaderSource;
+  /// The definitions a variant was compiled with, which are empty for a
+  ///   program that is not one.  They are added to the names of its log
+  ///   files and to its messages.
+  Defines m_defines;
+  /// Whether or not link loaded this program from the binary cache.
+  bool m_fromBinaryCache;
+  /// Variants that have been compiled, by their definitions.
+  std::map<Defines, std::unique_ptr<ShaderProgram>> m_variants;
+  /// Uniform locations that have already been looked up.  Emptied on link,
+  ///   since linking may move uniforms.
+  mutable std::map<std::string, GLint, std::less<>> m_uniformLocations;
 };
 
 #endif//SHADER_PROGRAM_HPP
@@ -0,0 +1,247 @@
+/// \file Simd.hpp
+/// \brief Four-wide float operations for the matrix and transform math.
+/// \author Aaron Heinbaugh
+/// \version A10
+///
+/// Float4 holds four floats in one SSE or NEON register, depending on what
+///   the compiler targets, and every operation here is an inline wrapper
+///   around one or two intrinsics.  Defining MATH_NO_SIMD, or compiling for
+///   a target with neither, falls back to plain arrays of four floats with
+///   the same results.  Matrix columns are three or four floats; loadColumn3
+///   and storeColumn3 move three of them without touching a fourth.
+
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#if !defined (MATH_NO_SIMD) && (defined (__SSE__) || defined (_M_X64))
+#define SIMD_SSE
+#include <xmmintrin.h>
+#elif !defined (MATH_NO_SIMD) && defined (__ARM_NEON)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Simd
+{
+#if defined (SIMD_SSE)
+  typedef __m128 Float4;
+#elif defined (SIMD_NEON)
+  typedef float32x4_t Float4;
+#else
+  struct Float4
+  {
+    float v[4];
+  };
+#endif
+
+  /// \brief Loads four floats from 16-byte aligned memory.
+  inline Float4
+  load (const float* p)
+  {
+#if defined (SIMD_SSE)
+    return _mm_load_ps (p);
+#elif defined (SIMD_NEON)
+    return vld1q_f32 (p);
+#else
+    return Float4 { { p[0], p[1], p[2], p[3] } };
+#endif
+  }
+
+  /// \brief Loads four floats from memory with any alignment.
+  inline Float4
+  loadUnaligned (const float* p)
+  {
+#if defined (SIMD_SSE)
+    return _mm_loadu_ps (p);
+#else
+    return load (p);
+#endif
+  }
+
+  /// \brief Loads three floats, such as a Vector3 or a Matrix3 column, with
+  ///   the fourth lane zero.
+  inline Float4
+  loadColumn3 (const float* p)
+  {
+#if defined (SIMD_SSE)
+    __m128 xy = _mm_loadl_pi (_mm_setzero_ps (), reinterpret_cast<const __m64*> (p));
+    return _mm_movelh_ps (xy, _mm_load_ss (p + 2));
+#elif defined (SIMD_NEON)
+    return vcombine_f32 (vld1_f32 (p), vld1_lane_f32 (p + 2, vdup_n_f32 (0), 0));
+#else
+    return Float4 { { p[0], p[1], p[2], 0 } };
+#endif
+  }
+
+  /// \brief Stores four floats to 16-byte aligned memory.
+  inline void
+  store (float* p, Float4 a)
+  {
+#if defined (SIMD_SSE)
+    _mm_store_ps (p, a);
+#elif defined (SIMD_NEON)
+    vst1q_f32 (p, a);
+#else
+    for (int i = 0; i < 4; ++i)
+      p[i] = a.v[i];
+#endif
+  }
+
+  /// \brief Stores four floats to memory with any alignment.
+  inline void
+  storeUnaligned (float* p, Float4 a)
+  {
+#if defined (SIMD_SSE)
+    _mm_storeu_ps (p, a);
+#else
+    store (p, a);
+#endif
+  }
+
+  /// \brief Stores the first three lanes, leaving p[3] alone.
+  inline void
+  storeColumn3 (float* p, Float4 a)
+  {
+#if defined (SIMD_SSE)
+    _mm_storel_pi (reinterpret_cast<__m64*> (p), a);
+    _mm_store_ss (p + 2, _mm_movehl_ps (a, a));
+#elif defined (SIMD_NEON)
+    vst1_f32 (p, vget_low_f32 (a));
+    vst1q_lane_f32 (p + 2, a, 2);
+#else
+    for (int i = 0; i < 3; ++i)
+      p[i] = a.v[i];
+#endif
+  }
+
+  /// \brief Makes a Float4 from four lanes.
+  inline Float4
+  set (float x, float y, float z, float w)
+  {
+#if defined (SIMD_SSE)
+    return _mm_setr_ps (x, y, z, w);
+#elif defined (SIMD_NEON)
+    const float lanes[4] = { x, y, z, w };
+    return vld1q_f32 (lanes);
+#else
+    return Float4 { { x, y, z, w } };
+#endif
+  }
+
+  /// \brief Copies one value into every lane.
+  inline Float4
+  splat (float a)
+  {
+#if defined (SIMD_SSE)
+    return _mm_set1_ps (a);
+#elif defined (SIMD_NEON)
+    return vdupq_n_f32 (a);
+#else
+    return Float4 { { a, a, a, a } };
+#endif
+  }
+
+  /// \brief Copies lane "lane" of a into every lane.
+  template<int lane>
+  inline Float4
+  broadcast (Float4 a)
+  {
+#if defined (SIMD_SSE)
+    return _mm_shuffle_ps (a, a, _MM_SHUFFLE (lane, lane, lane, lane));
+#elif defined (SIMD_NEON)
+    return vdupq_n_f32 (vgetq_lane_f32 (a, lane));
+#else
+    return splat (a.v[lane]);
+#endif
+  }
+
+  /// \brief Adds lane by lane.
+  inline Float4
+  add (Float4 a, Float4 b)
+  {
+#if defined (SIMD_SSE)
+    return _mm_add_ps (a, b);
+#elif defined (SIMD_NEON)
+    return vaddq_f32 (a, b);
+#else
+    return Float4 { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+#endif
+  }
+
+  /// \brief Subtracts lane by lane.
+  inline Float4
+  subtract (Float4 a, Float4 b)
+  {
+#if defined (SIMD_SSE)
+    return _mm_sub_ps (a, b);
+#elif defined (SIMD_NEON)
+    return vsubq_f32 (a, b);
+#else
+    return Float4 { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+#endif
+  }
+
+  /// \brief Multiplies lane by lane.
+  inline Float4
+  multiply (Float4 a, Float4 b)
+  {
+#if defined (SIMD_SSE)
+    return _mm_mul_ps (a, b);
+#elif defined (SIMD_NEON)
+    return vmulq_f32 (a, b);
+#else
+    return Float4 { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+#endif
+  }
+
+  /// \brief Computes a * b + c lane by lane.
+  inline Float4
+  multiplyAdd (Float4 a, Float4 b, Float4 c)
+  {
+#if defined (SIMD_NEON)
+    return vmlaq_f32 (c, a, b);
+#else
+    return add (multiply (a, b), c);
+#endif
+  }
+
+  /// \brief Multiplies a matrix with columns c0, c1, and c2 by the first
+  ///   three lanes of v.
+  /// \return c0 * v.x + c1 * v.y + c2 * v.z.
+  inline Float4
+  transform3 (Float4 c0, Float4 c1, Float4 c2, Float4 v)
+  {
+    Float4 result = multiply (c0, broadcast<0> (v));
+    result = multiplyAdd (c1, broadcast<1> (v), result);
+    return multiplyAdd (c2, broadcast<2> (v), result);
+  }
+
+  /// \brief Multiplies a matrix with columns c0 through c3 by v.
+  /// \return c0 * v.x + c1 * v.y + c2 * v.z + c3 * v.w.
+  inline Float4
+  transform4 (Float4 c0, Float4 c1, Float4 c2, Float4 c3, Float4 v)
+  {
+    return multiplyAdd (c3, broadcast<3> (v), transform3 (c0, c1, c2, v));
+  }
+
+  /// \brief Transposes the 3x3 matrix in the first three lanes of c0, c1,
+  ///   and c2, in place.  The fourth lanes are not kept.
+  inline void
+  transpose3 (Float4& c0, Float4& c1, Float4& c2)
+  {
+#if defined (SIMD_SSE)
+    Float4 c3 = _mm_setzero_ps ();
+    _MM_TRANSPOSE4_PS (c0, c1, c2, c3);
+#else
+    float m[12];
+    storeUnaligned (m, c0);
+    storeUnaligned (m + 4, c1);
+    storeUnaligned (m + 8, c2);
+    c0 = set (m[0], m[4], m[8], 0);
+    c1 = set (m[1], m[5], m[9], 0);
+    c2 = set (m[2], m[6], m[10], 0);
+#endif
+  }
+}
+
+#endif//SIMD_HPP
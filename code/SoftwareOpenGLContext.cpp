@@ -0,0 +1,1235 @@
+/// \file SoftwareOpenGLContext.cpp
+/// \brief Definitions of SoftwareOpenGLContext member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+
+#include "SoftwareOpenGLContext.hpp"
+#include "Matrix3.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+  // Every uniform that either of our shader programs declares gets a fixed
+  //   location, so draw calls can read them without looking up names.
+  enum UniformSlot
+  {
+    MODEL_VIEW, PROJECTION, VIEW, WORLD, AMBIENT_INTENSITY,
+    AMBIENT_REFLECTION, DIFFUSE_REFLECTION, SPECULAR_REFLECTION,
+    SPECULAR_POWER, EMISSIVE_INTENSITY, EYE_POSITION, NUM_LIGHTS,
+    FIRST_LIGHT
+  };
+
+  enum LightField
+  {
+    LIGHT_TYPE, LIGHT_DIFFUSE, LIGHT_SPECULAR, LIGHT_POSITION,
+    LIGHT_ATTENUATION, LIGHT_DIRECTION, LIGHT_CUTOFF, LIGHT_FALLOFF,
+    FIELDS_PER_LIGHT
+  };
+
+  const int LIGHTS_IN_SHADER = 8;
+
+  // The only binary format getProgramBinary produces or programBinary
+  //   accepts.  A binary is just whether or not the program is lit.
+  const GLenum SOFTWARE_BINARY_FORMAT = 0x5357;
+  const int NUM_UNIFORMS = FIRST_LIGHT + LIGHTS_IN_SHADER * FIELDS_PER_LIGHT;
+
+  const std::map<std::string, GLint>&
+  uniformLocations ()
+  {
+    static std::map<std::string, GLint> locations;
+    if (locations.empty ())
+    {
+      const char* names[] = { "uModelView", "uProjection", "uView", "uWorld",
+	"uAmbientIntensity", "uAmbientReflection", "uDiffuseReflection",
+	"uSpecularReflection", "uSpecularPower", "uEmissiveIntensity",
+	"uEyePosition", "uNumLights" };
+      for (GLint slot = 0; slot < FIRST_LIGHT; ++slot)
+	locations[names[slot]] = slot;
+      const char* fields[] = { "type", "diffuseIntensity",
+	"specularIntensity", "position", "attenuationCoefficients",
+	"direction", "cutoffCosAngle", "falloff" };
+      for (int light = 0; light < LIGHTS_IN_SHADER; ++light)
+	for (int field = 0; field < FIELDS_PER_LIGHT; ++field)
+	  locations["uLights[" + std::to_string (light) + "]." + fields[field]]
+	    = FIRST_LIGHT + light * FIELDS_PER_LIGHT + field;
+    }
+    return locations;
+  }
+
+  // Small column-major helpers, kept here so the per-vertex loops do not
+  //   have to build Matrix3 / Vector3 temporaries.
+
+  void
+  multiply4 (const float* a, const float* b, float* out)
+  {
+    for (int col = 0; col < 4; ++col)
+      for (int row = 0; row < 4; ++row)
+	out[col * 4 + row] = a[row] * b[col * 4] + a[4 + row] * b[col * 4 + 1]
+	  + a[8 + row] * b[col * 4 + 2] + a[12 + row] * b[col * 4 + 3];
+  }
+
+  void
+  transform4 (const float* m, float x, float y, float z, float w, float* out)
+  {
+    for (int row = 0; row < 4; ++row)
+      out[row] = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row] * w;
+  }
+
+  void
+  transform3 (const float* m, const float* v, float* out)
+  {
+    float x = v[0], y = v[1], z = v[2];
+    for (int row = 0; row < 3; ++row)
+      out[row] = m[row] * x + m[3 + row] * y + m[6 + row] * z;
+  }
+
+  float
+  dot3 (const float* a, const float* b)
+  {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
+
+  void
+  normalize3 (float* v)
+  {
+    float length = std::sqrt (dot3 (v, v));
+    if (length > 0.0f)
+    {
+      v[0] /= length;
+      v[1] /= length;
+      v[2] /= length;
+    }
+  }
+
+  // The upper-left 3x3 of a 4x4 matrix, inverted and transposed, as
+  //   "transpose (inverse (mat3 (m)))" does in GeneralShader.vert.
+  void
+  normalMatrix (const float* m, float* out)
+  {
+    Matrix3 normal (m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]);
+    normal.invert ();
+    normal.transpose ();
+    std::copy (normal.data (), normal.data () + 9, out);
+  }
+
+  void
+  upperLeft3 (const float* m, float* out)
+  {
+    const float values[9] = { m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10] };
+    std::copy (values, values + 9, out);
+  }
+}
+
+SoftwareOpenGLContext::SoftwareOpenGLContext (unsigned int numThreads)
+  : m_buffers (1), m_vertexArrays (1), m_shaders (1), m_programs (1),
+    m_queries (1), m_arrayBuffer (0), m_copyReadBuffer (0),
+    m_copyWriteBuffer (0), m_drawIndirectBuffer (0), m_vertexArray (0),
+    m_program (0), m_activeQuery (0), m_lastSync (0),
+    m_depthTest (false), m_cullFace (false), m_cullMode (GL_BACK),
+    m_frontFace (GL_CCW), m_clearColor ({ { 0.0f, 0.0f, 0.0f, 0.0f } }),
+    m_viewportX (0), m_viewportY (0), m_viewportWidth (800),
+    m_viewportHeight (600), m_width (0), m_height (0), m_tilesX (0),
+    m_tilesY (0), m_generation (0), m_busyWorkers (0), m_stopping (false),
+    m_nextTile (0)
+{
+  m_vertexArrays[0] = VertexArray ();
+  resizeFramebuffer (800, 600);
+  if (numThreads == 0)
+    numThreads = std::max (1u, std::thread::hardware_concurrency ());
+  for (unsigned int i = 1; i < numThreads; ++i)
+    m_workers.push_back (std::thread (&SoftwareOpenGLContext::workerLoop, this));
+}
+
+SoftwareOpenGLContext::~SoftwareOpenGLContext ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_poolMutex);
+    m_stopping = true;
+  }
+  m_poolWake.notify_all ();
+  for (std::thread& worker : m_workers)
+    worker.join ();
+}
+
+GLsizei
+SoftwareOpenGLContext::getWidth () const
+{
+  return m_width;
+}
+
+GLsizei
+SoftwareOpenGLContext::getHeight () const
+{
+  return m_height;
+}
+
+const std::vector<GLubyte>&
+SoftwareOpenGLContext::getColorBuffer () const
+{
+  return m_color;
+}
+
+unsigned int
+SoftwareOpenGLContext::getThreadCount () const
+{
+  return m_workers.size () + 1;
+}
+
+void
+SoftwareOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  m_programs[program].shaders.push_back (shader);
+}
+
+void
+SoftwareOpenGLContext::beginQuery (GLenum target, GLuint id)
+{
+  if (target == GL_TIME_ELAPSED && id != 0 && id < m_queries.size ())
+  {
+    m_activeQuery = id;
+    m_queries[id].begin = std::chrono::steady_clock::now ();
+  }
+}
+
+void
+SoftwareOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  if (target == GL_ARRAY_BUFFER)
+    m_arrayBuffer = buffer;
+  else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    m_vertexArrays[m_vertexArray].elementBuffer = buffer;
+  else if (target == GL_COPY_READ_BUFFER)
+    m_copyReadBuffer = buffer;
+  else if (target == GL_COPY_WRITE_BUFFER)
+    m_copyWriteBuffer = buffer;
+  else if (target == GL_DRAW_INDIRECT_BUFFER)
+    m_drawIndirectBuffer = buffer;
+}
+
+void
+SoftwareOpenGLContext::bindVertexArray (GLuint array)
+{
+  m_vertexArray = array;
+}
+
+void
+SoftwareOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  std::vector<GLubyte>& store = m_buffers[getBoundBuffer (target)];
+  store.resize (size);
+  if (data != nullptr && size > 0)
+    std::memcpy (store.data (), data, size);
+}
+
+void
+SoftwareOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  std::vector<GLubyte>& store = m_buffers[getBoundBuffer (target)];
+  if (offset < 0 || size <= 0 || static_cast<size_t> (offset + size) > store.size ())
+    return;
+  std::memcpy (store.data () + offset, data, size);
+}
+
+void
+SoftwareOpenGLContext::clear (GLbitfield mask)
+{
+  // Anything drawn before the clear still has to land, in case only one of
+  //   the buffers is being cleared.
+  rasterizeBins ();
+  if (mask & GL_COLOR_BUFFER_BIT)
+  {
+    GLubyte rgba[4];
+    for (int c = 0; c < 4; ++c)
+      rgba[c] = static_cast<GLubyte> (std::min (std::max (m_clearColor[c], 0.0f), 1.0f) * 255.0f + 0.5f);
+    for (size_t pixel = 0; pixel < m_color.size (); pixel += 4)
+      std::copy (rgba, rgba + 4, &m_color[pixel]);
+  }
+  if (mask & GL_DEPTH_BUFFER_BIT)
+    std::fill (m_depth.begin (), m_depth.end (), 1.0f);
+}
+
+void
+SoftwareOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  m_clearColor = { { red, green, blue, alpha } };
+}
+
+GLenum
+SoftwareOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  // Draws read their vertices when they are issued, so the buffers they
+  //   used are free again as soon as a fence is placed after them.
+  return GL_ALREADY_SIGNALED;
+}
+
+void
+SoftwareOpenGLContext::compileShader (GLuint shader)
+{
+}
+
+void
+SoftwareOpenGLContext::copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+  const std::vector<GLubyte>& source = m_buffers[getBoundBuffer (readTarget)];
+  std::vector<GLubyte>& destination = m_buffers[getBoundBuffer (writeTarget)];
+  if (readOffset < 0 || writeOffset < 0 || size <= 0
+      || static_cast<size_t> (readOffset + size) > source.size ()
+      || static_cast<size_t> (writeOffset + size) > destination.size ())
+    return;
+  std::memmove (destination.data () + writeOffset, source.data () + readOffset, size);
+}
+
+GLuint
+SoftwareOpenGLContext::createProgram ()
+{
+  Program program;
+  program.linked = false;
+  program.lit = false;
+  program.uniforms.resize (NUM_UNIFORMS);
+  for (UniformValue& value : program.uniforms)
+  {
+    value.f.fill (0.0f);
+    value.i = 0;
+  }
+  m_programs.push_back (program);
+  return m_programs.size () - 1;
+}
+
+GLuint
+SoftwareOpenGLContext::createShader (GLenum shaderType)
+{
+  m_shaders.push_back (Shader ());
+  return m_shaders.size () - 1;
+}
+
+void
+SoftwareOpenGLContext::cullFace (GLenum mode)
+{
+  m_cullMode = mode;
+}
+
+void
+SoftwareOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    if (buffers[i] != 0 && buffers[i] < m_buffers.size ())
+      std::vector<GLubyte> ().swap (m_buffers[buffers[i]]);
+}
+
+void
+SoftwareOpenGLContext::deleteProgram (GLuint program)
+{
+  if (program != 0 && program < m_programs.size ())
+    m_programs[program].shaders.clear ();
+}
+
+void
+SoftwareOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    if (ids[i] != 0 && ids[i] < m_queries.size ())
+      m_queries[ids[i]] = Query ();
+}
+
+void
+SoftwareOpenGLContext::deleteShader (GLuint shader)
+{
+  if (shader != 0 && shader < m_shaders.size ())
+    m_shaders[shader].source.clear ();
+}
+
+void
+SoftwareOpenGLContext::deleteSync (GLsync sync)
+{
+}
+
+void
+SoftwareOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    if (arrays[i] != 0 && arrays[i] < m_vertexArrays.size ())
+      m_vertexArrays[arrays[i]] = VertexArray ();
+}
+
+void
+SoftwareOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  std::vector<GLuint>& shaders = m_programs[program].shaders;
+  shaders.erase (std::remove (shaders.begin (), shaders.end (), shader), shaders.end ());
+}
+
+void
+SoftwareOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  if (mode != GL_TRIANGLES || count <= 0)
+    return;
+  std::vector<GLuint> indices (count);
+  for (GLsizei i = 0; i < count; ++i)
+    indices[i] = first + i;
+  drawIndexed (count, indices.data ());
+}
+
+void
+SoftwareOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+  if (mode != GL_TRIANGLES || type != GL_UNSIGNED_INT || count <= 0)
+    return;
+  GLuint elementBuffer = m_vertexArrays[m_vertexArray].elementBuffer;
+  if (elementBuffer == 0)
+  {
+    if (indices == nullptr)
+      return;
+    drawIndexed (count, static_cast<const GLuint*> (indices));
+    return;
+  }
+  const std::vector<GLubyte>& store = m_buffers[elementBuffer];
+  size_t offset = reinterpret_cast<size_t> (indices);
+  if (offset + count * sizeof (GLuint) > store.size ())
+    return;
+  drawIndexed (count, reinterpret_cast<const GLuint*> (store.data () + offset));
+}
+
+void
+SoftwareOpenGLContext::drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex)
+{
+  if (mode != GL_TRIANGLES || type != GL_UNSIGNED_INT || count <= 0)
+    return;
+  GLuint elementBuffer = m_vertexArrays[m_vertexArray].elementBuffer;
+  const GLuint* source = static_cast<const GLuint*> (indices);
+  if (elementBuffer != 0)
+  {
+    const std::vector<GLubyte>& store = m_buffers[elementBuffer];
+    size_t offset = reinterpret_cast<size_t> (indices);
+    if (offset + count * sizeof (GLuint) > store.size ())
+      return;
+    source = reinterpret_cast<const GLuint*> (store.data () + offset);
+  }
+  else if (source == nullptr)
+    return;
+  std::vector<GLuint> based (source, source + count);
+  for (GLuint& index : based)
+    index += basevertex;
+  drawIndexed (count, based.data ());
+}
+
+void
+SoftwareOpenGLContext::enable (GLenum cap)
+{
+  if (cap == GL_DEPTH_TEST)
+    m_depthTest = true;
+  else if (cap == GL_CULL_FACE)
+    m_cullFace = true;
+}
+
+void
+SoftwareOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  if (index < MAX_ATTRIBS)
+    m_vertexArrays[m_vertexArray].attribs[index].enabled = true;
+}
+
+void
+SoftwareOpenGLContext::endQuery (GLenum target)
+{
+  if (target != GL_TIME_ELAPSED || m_activeQuery == 0)
+    return;
+  // Triangles are only binned until a flush, so finish them to charge their
+  //   rasterization to the query, as a GPU would.
+  rasterizeBins ();
+  Query& query = m_queries[m_activeQuery];
+  query.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now () - query.begin).count ();
+  m_activeQuery = 0;
+}
+
+GLsync
+SoftwareOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return reinterpret_cast<GLsync> (++m_lastSync);
+}
+
+void
+SoftwareOpenGLContext::flush ()
+{
+  rasterizeBins ();
+}
+
+void
+SoftwareOpenGLContext::frontFace (GLenum mode)
+{
+  m_frontFace = mode;
+}
+
+void
+SoftwareOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    buffers[i] = m_buffers.size ();
+    m_buffers.push_back (std::vector<GLubyte> ());
+  }
+}
+
+void
+SoftwareOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    ids[i] = m_queries.size ();
+    m_queries.push_back (Query ());
+  }
+}
+
+void
+SoftwareOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    arrays[i] = m_vertexArrays.size ();
+    m_vertexArrays.push_back (VertexArray ());
+  }
+}
+
+GLint
+SoftwareOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  std::string attribute (name);
+  if (attribute == "aPosition")
+    return 0;
+  if (attribute == "aColor")
+    return 1;
+  if (attribute == "aNormal")
+    return 2;
+  return -1;
+}
+
+void
+SoftwareOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  const Program& linked = m_programs[program];
+  GLsizei size = (linked.linked && bufSize >= 1) ? 1 : 0;
+  if (size == 1)
+    *static_cast<char*> (binary) = linked.lit;
+  if (length != nullptr)
+    *length = size;
+  *binaryFormat = SOFTWARE_BINARY_FORMAT;
+}
+
+void
+SoftwareOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (length != nullptr)
+    *length = 0;
+  if (maxLength > 0)
+    infoLog[0] = '\0';
+}
+
+void
+SoftwareOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  const Program& linked = m_programs[program];
+  if (pname == GL_LINK_STATUS)
+    *params = linked.linked ? GL_TRUE : GL_FALSE;
+  else if (pname == GL_PROGRAM_BINARY_LENGTH)
+    *params = linked.linked ? 1 : 0;
+  else
+    *params = 0;
+}
+
+void
+SoftwareOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  // Queries end synchronously, so results are always available.
+  if (pname == GL_QUERY_RESULT_AVAILABLE)
+    *params = GL_TRUE;
+  else if (pname == GL_QUERY_RESULT)
+    *params = static_cast<GLint> (std::min<GLuint64> (m_queries[id].elapsed, 0x7fffffff));
+}
+
+void
+SoftwareOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  if (pname == GL_QUERY_RESULT_AVAILABLE)
+    *params = GL_TRUE;
+  else if (pname == GL_QUERY_RESULT)
+    *params = m_queries[id].elapsed;
+}
+
+void
+SoftwareOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (length != nullptr)
+    *length = 0;
+  if (maxLength > 0)
+    infoLog[0] = '\0';
+}
+
+void
+SoftwareOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+const GLubyte*
+SoftwareOpenGLContext::getString (GLenum name)
+{
+  switch (name)
+  {
+  case GL_VENDOR:
+    return reinterpret_cast<const GLubyte*> ("CSCI 375");
+  case GL_RENDERER:
+    return reinterpret_cast<const GLubyte*> ("SoftwareOpenGLContext");
+  case GL_VERSION:
+    return reinterpret_cast<const GLubyte*> ("3.3 (software)");
+  default:
+    return reinterpret_cast<const GLubyte*> ("");
+  }
+}
+
+GLint
+SoftwareOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  const std::map<std::string, GLint>& locations = uniformLocations ();
+  auto it = locations.find (name);
+  return (it == locations.end ()) ? -1 : it->second;
+}
+
+void
+SoftwareOpenGLContext::linkProgram (GLuint program)
+{
+  Program& linked = m_programs[program];
+  linked.linked = true;
+  linked.lit = false;
+  for (GLuint shader : linked.shaders)
+    if (m_shaders[shader].source.find ("uLights") != std::string::npos)
+      linked.lit = true;
+}
+
+void
+SoftwareOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  // Instanced attributes are not emulated, so each command is drawn with
+  //   the program's current uniforms.
+  const std::vector<GLubyte>& store = m_buffers[m_drawIndirectBuffer];
+  size_t offset = reinterpret_cast<size_t> (indirect);
+  size_t step = (stride == 0) ? sizeof (DrawElementsIndirectCommand) : stride;
+  for (GLsizei draw = 0; draw < drawcount; ++draw, offset += step)
+  {
+    if (m_drawIndirectBuffer == 0
+	|| offset + sizeof (DrawElementsIndirectCommand) > store.size ())
+      return;
+    DrawElementsIndirectCommand command;
+    std::memcpy (&command, store.data () + offset, sizeof (command));
+    if (command.instanceCount > 0)
+      drawElementsBaseVertex (mode, command.count, type,
+			      reinterpret_cast<const GLvoid*> (command.firstIndex * sizeof (GLuint)),
+			      command.baseVertex);
+  }
+}
+
+void
+SoftwareOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  // Like a driver, reject anything this context did not produce.
+  Program& linked = m_programs[program];
+  linked.linked = binaryFormat == SOFTWARE_BINARY_FORMAT && length == 1;
+  linked.lit = linked.linked && *static_cast<const char*> (binary);
+}
+
+void
+SoftwareOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+}
+
+void
+SoftwareOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  std::string& source = m_shaders[shader].source;
+  source.clear ();
+  for (GLsizei i = 0; i < count; ++i)
+  {
+    if (length == nullptr || length[i] < 0)
+      source += string[i];
+    else
+      source.append (string[i], length[i]);
+  }
+}
+
+void
+SoftwareOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  Program* program = currentProgram ();
+  if (program == nullptr || location < 0 || location >= NUM_UNIFORMS)
+    return;
+  program->uniforms[location].f[0] = v0;
+  program->uniforms[location].i = static_cast<GLint> (v0);
+}
+
+void
+SoftwareOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  Program* program = currentProgram ();
+  if (program == nullptr || location < 0 || location >= NUM_UNIFORMS)
+    return;
+  program->uniforms[location].f[0] = static_cast<float> (v0);
+  program->uniforms[location].i = v0;
+}
+
+void
+SoftwareOpenGLContext::uniform3fv (GLint location, GLsizei count, const GLfloat* value)
+{
+  Program* program = currentProgram ();
+  // Every uniform this context knows is a single value, not an array.
+  if (program == nullptr || location < 0 || location >= NUM_UNIFORMS || count != 1)
+    return;
+  std::copy (value, value + 3, program->uniforms[location].f.begin ());
+}
+
+void
+SoftwareOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  Program* program = currentProgram ();
+  if (program == nullptr || location < 0 || location >= NUM_UNIFORMS || count != 1)
+    return;
+  std::array<float, 16>& m = program->uniforms[location].f;
+  for (int col = 0; col < 4; ++col)
+    for (int row = 0; row < 4; ++row)
+      m[col * 4 + row] = transpose ? value[row * 4 + col] : value[col * 4 + row];
+}
+
+void
+SoftwareOpenGLContext::useProgram (GLuint program)
+{
+  m_program = program;
+}
+
+void
+SoftwareOpenGLContext::vertexAttribDivisor (GLuint index, GLuint divisor)
+{
+  // Only per-vertex attributes are read by the shaders emulated here.
+}
+
+void
+SoftwareOpenGLContext::vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer)
+{
+  // Integer attributes are not read by the shaders emulated here.
+}
+
+void
+SoftwareOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  if (index >= MAX_ATTRIBS || type != GL_FLOAT)
+    return;
+  VertexAttrib& attrib = m_vertexArrays[m_vertexArray].attribs[index];
+  attrib.buffer = m_arrayBuffer;
+  attrib.size = size;
+  attrib.stride = (stride == 0) ? size * sizeof (float) : stride;
+  attrib.offset = reinterpret_cast<size_t> (pointer);
+}
+
+void
+SoftwareOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  m_viewportX = x;
+  m_viewportY = y;
+  m_viewportWidth = width;
+  m_viewportHeight = height;
+  if (x + width != m_width || y + height != m_height)
+    resizeFramebuffer (x + width, y + height);
+}
+
+SoftwareOpenGLContext::Program*
+SoftwareOpenGLContext::currentProgram ()
+{
+  if (m_program == 0 || m_program >= m_programs.size ())
+    return nullptr;
+  return &m_programs[m_program];
+}
+
+GLuint
+SoftwareOpenGLContext::getBoundBuffer (GLenum target) const
+{
+  switch (target)
+  {
+  case GL_ARRAY_BUFFER:
+    return m_arrayBuffer;
+  case GL_COPY_READ_BUFFER:
+    return m_copyReadBuffer;
+  case GL_COPY_WRITE_BUFFER:
+    return m_copyWriteBuffer;
+  case GL_DRAW_INDIRECT_BUFFER:
+    return m_drawIndirectBuffer;
+  default:
+    return m_vertexArrays[m_vertexArray].elementBuffer;
+  }
+}
+
+void
+SoftwareOpenGLContext::drawIndexed (GLsizei count, const GLuint* indices)
+{
+  Program* program = currentProgram ();
+  if (program == nullptr)
+    return;
+  // Indices come from client buffers, so any past the last vertex are
+  //   skipped along with their triangles rather than trusted.
+  GLuint vertexCount = countVertices ();
+  GLuint minIndex = vertexCount;
+  GLuint maxIndex = 0;
+  for (GLsizei i = 0; i < count; ++i)
+  {
+    if (indices[i] < vertexCount)
+    {
+      minIndex = std::min (minIndex, indices[i]);
+      maxIndex = std::max (maxIndex, indices[i]);
+    }
+  }
+  if (minIndex > maxIndex)
+    return;
+  shadeVertices (*program, minIndex, maxIndex);
+  captureDrawState (*program);
+  for (GLsizei i = 0; i + 2 < count; i += 3)
+  {
+    if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount
+	|| indices[i + 2] >= vertexCount)
+      continue;
+    setupTriangle (m_clipVertices[indices[i]], m_clipVertices[indices[i + 1]],
+		   m_clipVertices[indices[i + 2]]);
+  }
+}
+
+GLuint
+SoftwareOpenGLContext::countVertices () const
+{
+  const VertexAttrib& position = m_vertexArrays[m_vertexArray].attribs[0];
+  if (!position.enabled || position.buffer >= m_buffers.size ())
+    return 0;
+  size_t bytes = m_buffers[position.buffer].size ();
+  size_t vertexBytes = position.size * sizeof (float);
+  if (position.offset + vertexBytes > bytes)
+    return 0;
+  size_t count = (bytes - position.offset - vertexBytes) / position.stride + 1;
+  return static_cast<GLuint> (std::min<size_t> (count, std::numeric_limits<GLuint>::max ()));
+}
+
+void
+SoftwareOpenGLContext::shadeVertices (const Program& program, GLuint minIndex,
+				      GLuint maxIndex)
+{
+  const VertexArray& vao = m_vertexArrays[m_vertexArray];
+  const std::vector<UniformValue>& u = program.uniforms;
+
+  // Returns a pointer to the floats of one attribute of one vertex, or null
+  //   if that attribute is disabled or the buffer is too short.
+  auto fetch = [this, &vao] (GLuint attribute, GLuint vertex) -> const float*
+    {
+      const VertexAttrib& attrib = vao.attribs[attribute];
+      if (!attrib.enabled || attrib.buffer >= m_buffers.size ())
+	return nullptr;
+      const std::vector<GLubyte>& store = m_buffers[attrib.buffer];
+      size_t start = attrib.offset + static_cast<size_t> (vertex) * attrib.stride;
+      if (start + attrib.size * sizeof (float) > store.size ())
+	return nullptr;
+      return reinterpret_cast<const float*> (store.data () + start);
+    };
+
+  float modelView[16], modelViewProjection[16];
+  float worldNormal[9], viewNormal[9];
+  if (program.lit)
+  {
+    multiply4 (u[VIEW].f.data (), u[WORLD].f.data (), modelView);
+    normalMatrix (u[WORLD].f.data (), worldNormal);
+    normalMatrix (u[VIEW].f.data (), viewNormal);
+  }
+  else
+    std::copy (u[MODEL_VIEW].f.begin (), u[MODEL_VIEW].f.end (), modelView);
+  multiply4 (u[PROJECTION].f.data (), modelView, modelViewProjection);
+
+  const float zero[3] = { 0.0f, 0.0f, 0.0f };
+  m_clipVertices.resize (maxIndex + 1);
+  for (GLuint vertex = minIndex; vertex <= maxIndex; ++vertex)
+  {
+    ClipVertex& out = m_clipVertices[vertex];
+    const float* position = fetch (0, vertex);
+    if (position == nullptr)
+      position = zero;
+    transform4 (modelViewProjection, position[0], position[1], position[2], 1.0f, out.position);
+    if (program.lit)
+    {
+      // GeneralShader.vert: eye-space position and normal.
+      float eye[4];
+      transform4 (modelView, position[0], position[1], position[2], 1.0f, eye);
+      const float* normal = fetch (2, vertex);
+      float n[3];
+      transform3 (worldNormal, normal == nullptr ? zero : normal, n);
+      normalize3 (n);
+      transform3 (viewNormal, n, out.varyings + 3);
+      normalize3 (out.varyings + 3);
+      std::copy (eye, eye + 3, out.varyings);
+    }
+    else
+    {
+      // Vec3.vert: pass the color along unchanged.
+      const float* color = fetch (1, vertex);
+      std::copy (color == nullptr ? zero : color, (color == nullptr ? zero : color) + 3, out.varyings);
+      std::fill (out.varyings + 3, out.varyings + NUM_VARYINGS, 0.0f);
+    }
+  }
+}
+
+void
+SoftwareOpenGLContext::captureDrawState (const Program& program)
+{
+  const std::vector<UniformValue>& u = program.uniforms;
+  DrawState draw;
+  draw.lit = program.lit;
+  for (int c = 0; c < 3; ++c)
+  {
+    draw.ambient[c] = u[AMBIENT_REFLECTION].f[c] * u[AMBIENT_INTENSITY].f[c];
+    draw.emissive[c] = u[EMISSIVE_INTENSITY].f[c];
+    draw.diffuseReflection[c] = u[DIFFUSE_REFLECTION].f[c];
+    draw.specularReflection[c] = u[SPECULAR_REFLECTION].f[c];
+    draw.eye[c] = u[EYE_POSITION].f[c];
+  }
+  draw.specularPower = u[SPECULAR_POWER].f[0];
+  draw.numLights = std::min (std::max (u[NUM_LIGHTS].i, 0), static_cast<GLint> (MAX_LIGHTS));
+
+  const float* view = u[VIEW].f.data ();
+  float viewRotation[9], viewNormal[9];
+  upperLeft3 (view, viewRotation);
+  normalMatrix (view, viewNormal);
+  for (int light = 0; light < draw.numLights; ++light)
+  {
+    const UniformValue* field = &u[FIRST_LIGHT + light * FIELDS_PER_LIGHT];
+    LightState& state = draw.lights[light];
+    state.type = field[LIGHT_TYPE].i;
+    for (int c = 0; c < 3; ++c)
+    {
+      state.diffuse[c] = field[LIGHT_DIFFUSE].f[c];
+      state.specular[c] = field[LIGHT_SPECULAR].f[c];
+      state.attenuation[c] = field[LIGHT_ATTENUATION].f[c];
+    }
+    // Everything below is constant across the draw call, so it is hoisted out
+    //   of the per-fragment code of GeneralShader.frag.
+    const float* position = field[LIGHT_POSITION].f.data ();
+    const float* direction = field[LIGHT_DIRECTION].f.data ();
+    float toward[3] = { -direction[0], -direction[1], -direction[2] };
+    transform3 (viewNormal, toward, state.lightVector);
+    normalize3 (state.lightVector);
+    transform3 (viewRotation, position, state.rotatedPosition);
+    float eye[4];
+    transform4 (view, position[0], position[1], position[2], 1.0f, eye);
+    std::copy (eye, eye + 3, state.eyePosition);
+    transform3 (viewNormal, direction, state.spotDirection);
+    state.cutoffCosAngle = field[LIGHT_CUTOFF].f[0];
+    state.falloff = field[LIGHT_FALLOFF].f[0];
+  }
+  m_draws.push_back (draw);
+}
+
+void
+SoftwareOpenGLContext::setupTriangle (const ClipVertex& a, const ClipVertex& b, const ClipVertex& c)
+{
+  const ClipVertex* in[3] = { &a, &b, &c };
+  // Trivially reject triangles entirely outside one of the frustum planes.
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    int below = 0, above = 0;
+    for (const ClipVertex* v : in)
+    {
+      below += (v->position[axis] < -v->position[3]);
+      above += (v->position[axis] > v->position[3]);
+    }
+    if (below == 3 || above == 3)
+      return;
+  }
+
+  // Clip against the near plane (z >= -w); the other planes are handled by
+  //   the scissoring in binTriangle and the depth range check.
+  ClipVertex polygon[4];
+  int count = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    const ClipVertex& current = *in[i];
+    const ClipVertex& next = *in[(i + 1) % 3];
+    float dCurrent = current.position[2] + current.position[3];
+    float dNext = next.position[2] + next.position[3];
+    if (dCurrent >= 0.0f)
+      polygon[count++] = current;
+    if ((dCurrent >= 0.0f) != (dNext >= 0.0f))
+    {
+      float t = dCurrent / (dCurrent - dNext);
+      ClipVertex& split = polygon[count++];
+      for (int k = 0; k < 4; ++k)
+	split.position[k] = current.position[k] + t * (next.position[k] - current.position[k]);
+      for (int k = 0; k < NUM_VARYINGS; ++k)
+	split.varyings[k] = current.varyings[k] + t * (next.varyings[k] - current.varyings[k]);
+    }
+  }
+  if (count < 3)
+    return;
+
+  ScreenVertex screen[4];
+  for (int i = 0; i < count; ++i)
+  {
+    const ClipVertex& v = polygon[i];
+    ScreenVertex& s = screen[i];
+    if (v.position[3] <= 0.0f)
+      return;
+    s.invW = 1.0f / v.position[3];
+    s.x = m_viewportX + (v.position[0] * s.invW + 1.0f) * 0.5f * m_viewportWidth;
+    s.y = m_viewportY + (v.position[1] * s.invW + 1.0f) * 0.5f * m_viewportHeight;
+    s.z = (v.position[2] * s.invW + 1.0f) * 0.5f;
+    // Pre-divide so that interpolation is perspective-correct.
+    for (int k = 0; k < NUM_VARYINGS; ++k)
+      s.varyings[k] = v.varyings[k] * s.invW;
+  }
+  for (int i = 1; i + 1 < count; ++i)
+    binTriangle (screen[0], screen[i], screen[i + 1]);
+}
+
+void
+SoftwareOpenGLContext::binTriangle (const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c)
+{
+  float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+  if (area == 0.0f)
+    return;
+  bool front = (area > 0.0f) == (m_frontFace == GL_CCW);
+  if (m_cullFace && (m_cullMode == GL_FRONT_AND_BACK
+		     || (m_cullMode == GL_BACK && !front)
+		     || (m_cullMode == GL_FRONT && front)))
+    return;
+
+  float minX = std::min ({ a.x, b.x, c.x });
+  float maxX = std::max ({ a.x, b.x, c.x });
+  float minY = std::min ({ a.y, b.y, c.y });
+  float maxY = std::max ({ a.y, b.y, c.y });
+  GLint left = std::max (static_cast<GLint> (std::floor (minX)), std::max (m_viewportX, 0));
+  GLint right = std::min (static_cast<GLint> (std::ceil (maxX)), std::min (m_viewportX + m_viewportWidth, m_width) - 1);
+  GLint bottom = std::max (static_cast<GLint> (std::floor (minY)), std::max (m_viewportY, 0));
+  GLint top = std::min (static_cast<GLint> (std::ceil (maxY)), std::min (m_viewportY + m_viewportHeight, m_height) - 1);
+  if (left > right || bottom > top)
+    return;
+
+  // Rasterization expects counterclockwise vertices.
+  BinnedTriangle triangle;
+  triangle.v[0] = a;
+  triangle.v[1] = (area > 0.0f) ? b : c;
+  triangle.v[2] = (area > 0.0f) ? c : b;
+  triangle.draw = m_draws.size () - 1;
+  unsigned int index = m_triangles.size ();
+  m_triangles.push_back (triangle);
+  for (GLint ty = bottom / TILE_SIZE; ty <= top / TILE_SIZE; ++ty)
+    for (GLint tx = left / TILE_SIZE; tx <= right / TILE_SIZE; ++tx)
+      m_bins[ty * m_tilesX + tx].push_back (index);
+}
+
+void
+SoftwareOpenGLContext::rasterizeBins ()
+{
+  if (m_triangles.empty ())
+  {
+    m_draws.clear ();
+    return;
+  }
+  m_nextTile.store (0);
+  {
+    std::lock_guard<std::mutex> lock (m_poolMutex);
+    ++m_generation;
+    m_busyWorkers = m_workers.size ();
+  }
+  m_poolWake.notify_all ();
+  // The calling thread takes tiles too, rather than just waiting.
+  rasterizeTiles ();
+  {
+    std::unique_lock<std::mutex> lock (m_poolMutex);
+    m_poolDone.wait (lock, [this] { return m_busyWorkers == 0; });
+  }
+  for (std::vector<unsigned int>& bin : m_bins)
+    bin.clear ();
+  m_triangles.clear ();
+  m_draws.clear ();
+}
+
+void
+SoftwareOpenGLContext::workerLoop ()
+{
+  unsigned int seen = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock (m_poolMutex);
+      m_poolWake.wait (lock, [this, seen] { return m_stopping || m_generation != seen; });
+      if (m_stopping)
+	return;
+      seen = m_generation;
+    }
+    rasterizeTiles ();
+    {
+      std::lock_guard<std::mutex> lock (m_poolMutex);
+      if (--m_busyWorkers == 0)
+	m_poolDone.notify_one ();
+    }
+  }
+}
+
+void
+SoftwareOpenGLContext::rasterizeTiles ()
+{
+  unsigned int numTiles = m_bins.size ();
+  for (unsigned int tile = m_nextTile.fetch_add (1); tile < numTiles;
+       tile = m_nextTile.fetch_add (1))
+  {
+    if (!m_bins[tile].empty ())
+      rasterizeTile (tile);
+  }
+}
+
+void
+SoftwareOpenGLContext::rasterizeTile (unsigned int tile)
+{
+  GLint tileLeft = (tile % m_tilesX) * TILE_SIZE;
+  GLint tileBottom = (tile / m_tilesX) * TILE_SIZE;
+  GLint tileRight = std::min (tileLeft + TILE_SIZE, m_width) - 1;
+  GLint tileTop = std::min (tileBottom + TILE_SIZE, m_height) - 1;
+  tileRight = std::min (tileRight, m_viewportX + m_viewportWidth - 1);
+  tileTop = std::min (tileTop, m_viewportY + m_viewportHeight - 1);
+  tileLeft = std::max (tileLeft, m_viewportX);
+  tileBottom = std::max (tileBottom, m_viewportY);
+
+  float varyings[NUM_VARYINGS];
+  for (unsigned int index : m_bins[tile])
+  {
+    const BinnedTriangle& triangle = m_triangles[index];
+    const ScreenVertex& v0 = triangle.v[0];
+    const ScreenVertex& v1 = triangle.v[1];
+    const ScreenVertex& v2 = triangle.v[2];
+    const DrawState& draw = m_draws[triangle.draw];
+
+    GLint left = std::max (tileLeft, static_cast<GLint> (std::floor (std::min ({ v0.x, v1.x, v2.x }))));
+    GLint right = std::min (tileRight, static_cast<GLint> (std::ceil (std::max ({ v0.x, v1.x, v2.x }))));
+    GLint bottom = std::max (tileBottom, static_cast<GLint> (std::floor (std::min ({ v0.y, v1.y, v2.y }))));
+    GLint top = std::min (tileTop, static_cast<GLint> (std::ceil (std::max ({ v0.y, v1.y, v2.y }))));
+    if (left > right || bottom > top)
+      continue;
+
+    // Edge functions, each of which is the weight of the opposite vertex.
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    float invArea = 1.0f / area;
+    float dx0 = v1.y - v2.y, dy0 = v2.x - v1.x;
+    float dx1 = v2.y - v0.y, dy1 = v0.x - v2.x;
+    float dx2 = v0.y - v1.y, dy2 = v1.x - v0.x;
+    float px = left + 0.5f, py = bottom + 0.5f;
+    float row0 = dy0 * (py - v1.y) + dx0 * (px - v1.x);
+    float row1 = dy1 * (py - v2.y) + dx1 * (px - v2.x);
+    float row2 = dy2 * (py - v0.y) + dx2 * (px - v0.x);
+
+    for (GLint y = bottom; y <= top; ++y, row0 += dy0, row1 += dy1, row2 += dy2)
+    {
+      float e0 = row0, e1 = row1, e2 = row2;
+      for (GLint x = left; x <= right; ++x, e0 += dx0, e1 += dx1, e2 += dx2)
+      {
+	if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f)
+	  continue;
+	float b0 = e0 * invArea, b1 = e1 * invArea, b2 = e2 * invArea;
+	float z = b0 * v0.z + b1 * v1.z + b2 * v2.z;
+	size_t pixel = static_cast<size_t> (y) * m_width + x;
+	if (z < 0.0f || z > 1.0f)
+	  continue;
+	if (m_depthTest)
+	{
+	  if (z >= m_depth[pixel])
+	    continue;
+	  m_depth[pixel] = z;
+	}
+	float w = 1.0f / (b0 * v0.invW + b1 * v1.invW + b2 * v2.invW);
+	for (int k = 0; k < NUM_VARYINGS; ++k)
+	  varyings[k] = (b0 * v0.varyings[k] + b1 * v1.varyings[k] + b2 * v2.varyings[k]) * w;
+	shadeFragment (draw, varyings, &m_color[pixel * 4]);
+      }
+    }
+  }
+}
+
+void
+SoftwareOpenGLContext::shadeFragment (const DrawState& draw, const float* varyings, GLubyte* out) const
+{
+  float color[3];
+  if (!draw.lit)
+    std::copy (varyings, varyings + 3, color);
+  else
+  {
+    // A port of main and calculateLighting from GeneralShader.frag.
+    const float* position = varyings;
+    const float* normal = varyings + 3;
+    for (int c = 0; c < 3; ++c)
+      color[c] = draw.ambient[c] + draw.emissive[c];
+    float eyeVector[3] = { draw.eye[0] - position[0], draw.eye[1] - position[1], draw.eye[2] - position[2] };
+    normalize3 (eyeVector);
+    for (int i = 0; i < draw.numLights; ++i)
+    {
+      const LightState& light = draw.lights[i];
+      float lightVector[3];
+      if (light.type == 0)
+	std::copy (light.lightVector, light.lightVector + 3, lightVector);
+      else
+      {
+	for (int c = 0; c < 3; ++c)
+	  lightVector[c] = light.rotatedPosition[c] - position[c];
+	normalize3 (lightVector);
+      }
+      float lambertianCoef = std::max (dot3 (lightVector, normal), 0.0f);
+      if (lambertianCoef <= 0.0f)
+	continue;
+      // reflect (-L, N) = -L + 2 (N . L) N
+      float nDotL = dot3 (normal, lightVector);
+      float reflection[3];
+      for (int c = 0; c < 3; ++c)
+	reflection[c] = -lightVector[c] + 2.0f * nDotL * normal[c];
+      float specularCoef = std::pow (std::max (dot3 (eyeVector, reflection), 0.0f), draw.specularPower);
+      float attenuation = 1.0f;
+      if (light.type != 0)
+      {
+	float offset[3] = { position[0] - light.eyePosition[0], position[1] - light.eyePosition[1],
+			    position[2] - light.eyePosition[2] };
+	float distance = std::sqrt (dot3 (offset, offset));
+	attenuation = 1.0f / (light.attenuation[0] + light.attenuation[1] * distance
+			      + light.attenuation[2] * distance * distance);
+      }
+      float spotFactor = 1.0f;
+      if (light.type == 2)
+      {
+	float away[3] = { -lightVector[0], -lightVector[1], -lightVector[2] };
+	float cosTheta = std::max (dot3 (away, light.spotDirection), 0.0f);
+	spotFactor = (cosTheta >= light.cutoffCosAngle) ? cosTheta : 0.0f;
+	spotFactor = std::pow (spotFactor, light.falloff);
+      }
+      for (int c = 0; c < 3; ++c)
+	color[c] += spotFactor * attenuation
+	  * (draw.diffuseReflection[c] * light.diffuse[c] * lambertianCoef
+	     + draw.specularReflection[c] * light.specular[c] * specularCoef);
+    }
+  }
+  for (int c = 0; c < 3; ++c)
+    out[c] = static_cast<GLubyte> (std::min (std::max (color[c], 0.0f), 1.0f) * 255.0f + 0.5f);
+  out[3] = 255;
+}
+
+void
+SoftwareOpenGLContext::resizeFramebuffer (GLsizei width, GLsizei height)
+{
+  rasterizeBins ();
+  m_width = std::max (width, 1);
+  m_height = std::max (height, 1);
+  m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+  m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+  m_color.assign (static_cast<size_t> (m_width) * m_height * 4, 0);
+  m_depth.assign (static_cast<size_t> (m_width) * m_height, 1.0f);
+  m_bins.assign (m_tilesX * m_tilesY, std::vector<unsigned int> ());
+}
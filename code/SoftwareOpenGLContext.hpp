@@ -0,0 +1,465 @@
+/// \file SoftwareOpenGLContext.hpp
+/// \brief Declaration of SoftwareOpenGLContext and any associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef SOFTWARE_OPENGL_CONTEXT_HPP
+#define SOFTWARE_OPENGL_CONTEXT_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A subclass of OpenGLContext that renders on the CPU instead of
+///   passing calls to a GPU driver.
+///
+/// Only the subset of OpenGL that this program uses is implemented: vertex
+///   array objects, array and element buffers, indexed and non-indexed
+///   triangles, depth testing and back-face culling.  Multi-draws walk their
+///   indirect commands, but instanced attributes are ignored, so each command
+///   is drawn with the program's current uniforms.  Programs are not
+///   actually compiled.  Instead, a program whose shaders declare "uLights" is
+///   shaded with a C++ port of GeneralShader, and any other program simply
+///   interpolates the color attribute like Vec3.vert / Vec3.frag.
+///
+/// Draw calls transform their vertices immediately and bin the resulting
+///   screen-space triangles into fixed-size tiles.  The tiles are rasterized
+///   in parallel by a pool of worker threads whenever the frame is flushed or
+///   cleared.  No window is needed, so this can be used to measure the CPU
+///   side of a frame on machines that have no GPU.
+class SoftwareOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// \brief Constructs a SoftwareOpenGLContext.
+  /// \param[in] numThreads The number of threads that rasterize tiles,
+  ///   including the calling thread.  Zero means one per hardware thread.
+  /// \post A 800x600 color and depth buffer exist and worker threads have
+  ///   been started.
+  SoftwareOpenGLContext (unsigned int numThreads = 0);
+
+  /// \brief Destructs a SoftwareOpenGLContext.
+  /// \post All worker threads have been joined.
+  virtual
+  ~SoftwareOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   SoftwareOpenGLContexts.
+  SoftwareOpenGLContext (const SoftwareOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   SoftwareOpenGLContexts.
+  SoftwareOpenGLContext&
+  operator= (const SoftwareOpenGLContext&) = delete;
+
+  /// \brief Gets the width of the framebuffer.
+  /// \return The number of pixels in each row.
+  GLsizei
+  getWidth () const;
+
+  /// \brief Gets the height of the framebuffer.
+  /// \return The number of rows of pixels.
+  GLsizei
+  getHeight () const;
+
+  /// \brief Gets the color buffer.
+  /// \return RGBA bytes for each pixel, with row 0 at the bottom as in
+  ///   glReadPixels.
+  /// \pre flush has been called since the last draw.
+  const std::vector<GLubyte>&
+  getColorBuffer () const;
+
+  /// \brief Gets the number of threads used for rasterization.
+  /// \return The number of threads, including the calling thread.
+  unsigned int
+  getThreadCount () const;
+
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  beginQuery (GLenum target, GLuint id);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
+  virtual void
+  drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint basevertex);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual void
+  endQuery (GLenum target);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  flush ();
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3fv (GLint location, GLsizei count, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexAttribDivisor (GLuint index, GLuint divisor);
+
+  virtual void
+  vertexAttribIPointer (GLuint index, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// The number of vertex attributes a VAO can hold.
+  static const GLuint MAX_ATTRIBS = 4;
+  /// The number of lights GeneralShader supports.
+  static const int MAX_LIGHTS = 8;
+  /// The number of floats interpolated across each triangle.
+  static const int NUM_VARYINGS = 6;
+  /// The width and height of a tile, in pixels.
+  static const GLsizei TILE_SIZE = 64;
+
+  /// The state of one vertex attribute in a VAO.
+  struct VertexAttrib
+  {
+    bool enabled;
+    GLuint buffer;
+    GLint size;
+    GLsizei stride;
+    size_t offset;
+  };
+
+  /// Everything that glBindVertexArray switches.
+  struct VertexArray
+  {
+    std::array<VertexAttrib, MAX_ATTRIBS> attribs;
+    GLuint elementBuffer;
+  };
+
+  /// A shader object, which only needs to remember its source.
+  struct Shader
+  {
+    std::string source;
+  };
+
+  /// The value of one uniform.  Every uniform gets room for a 4x4 matrix.
+  struct UniformValue
+  {
+    std::array<float, 16> f;
+    GLint i;
+  };
+
+  /// A program object and the values of its uniforms.
+  struct Program
+  {
+    std::vector<GLuint> shaders;
+    bool linked;
+    bool lit;
+    std::vector<UniformValue> uniforms;
+  };
+
+  /// A GL_TIME_ELAPSED query, which times on the CPU.
+  struct Query
+  {
+    std::chrono::steady_clock::time_point begin;
+    GLuint64 elapsed;
+  };
+
+  /// One light, as seen by the fragment stage of GeneralShader.
+  struct LightState
+  {
+    int type;
+    float diffuse[3];
+    float specular[3];
+    /// Direction toward a directional light, in eye space.
+    float lightVector[3];
+    /// mat3 (uView) * position, which GeneralShader uses for the light vector.
+    float rotatedPosition[3];
+    /// uView * vec4 (position, 1), which GeneralShader uses for attenuation.
+    float eyePosition[3];
+    float attenuation[3];
+    /// Spot direction, in eye space.
+    float spotDirection[3];
+    float cutoffCosAngle;
+    float falloff;
+  };
+
+  /// The uniform values a draw call's fragments need, captured when the draw
+  ///   call was made so that rasterization can happen later.
+  struct DrawState
+  {
+    bool lit;
+    float ambient[3];
+    float emissive[3];
+    float diffuseReflection[3];
+    float specularReflection[3];
+    float specularPower;
+    float eye[3];
+    int numLights;
+    std::array<LightState, MAX_LIGHTS> lights;
+  };
+
+  /// A vertex after the vertex stage, in clip space.
+  struct ClipVertex
+  {
+    float position[4];
+    float varyings[NUM_VARYINGS];
+  };
+
+  /// A vertex after the viewport transform.
+  struct ScreenVertex
+  {
+    float x, y, z, invW;
+    float varyings[NUM_VARYINGS];
+  };
+
+  /// A triangle that survived clipping and culling, waiting in the bins.
+  struct BinnedTriangle
+  {
+    ScreenVertex v[3];
+    unsigned int draw;
+  };
+
+  void
+  drawIndexed (GLsizei count, const GLuint* indices);
+
+  /// \brief Gets how many whole vertices the bound VAO's position buffer
+  ///   holds, which any index must be below.
+  GLuint
+  countVertices () const;
+
+  void
+  shadeVertices (const Program& program, GLuint minIndex, GLuint maxIndex);
+
+  void
+  captureDrawState (const Program& program);
+
+  void
+  setupTriangle (const ClipVertex& a, const ClipVertex& b, const ClipVertex& c);
+
+  void
+  binTriangle (const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c);
+
+  void
+  rasterizeBins ();
+
+  void
+  rasterizeTiles ();
+
+  void
+  rasterizeTile (unsigned int tile);
+
+  void
+  shadeFragment (const DrawState& draw, const float* varyings, GLubyte* out) const;
+
+  void
+  resizeFramebuffer (GLsizei width, GLsizei height);
+
+  void
+  workerLoop ();
+
+  Program*
+  currentProgram ();
+
+  GLuint
+  getBoundBuffer (GLenum target) const;
+
+  /// Objects are named by their index, so element 0 of each is a placeholder.
+  std::vector<std::vector<GLubyte>> m_buffers;
+  std::vector<VertexArray> m_vertexArrays;
+  std::vector<Shader> m_shaders;
+  std::vector<Program> m_programs;
+  std::vector<Query> m_queries;
+
+  GLuint m_arrayBuffer;
+  GLuint m_copyReadBuffer;
+  GLuint m_copyWriteBuffer;
+  GLuint m_drawIndirectBuffer;
+  GLuint m_vertexArray;
+  GLuint m_program;
+  GLuint m_activeQuery;
+  /// The last fence handed out, which is only a name.
+  uintptr_t m_lastSync;
+
+  bool m_depthTest;
+  bool m_cullFace;
+  GLenum m_cullMode;
+  GLenum m_frontFace;
+  std::array<float, 4> m_clearColor;
+
+  GLint m_viewportX;
+  GLint m_viewportY;
+  GLsizei m_viewportWidth;
+  GLsizei m_viewportHeight;
+
+  GLsizei m_width;
+  GLsizei m_height;
+  unsigned int m_tilesX;
+  unsigned int m_tilesY;
+  std::vector<GLubyte> m_color;
+  std::vector<float> m_depth;
+
+  /// Vertex stage output for the current draw call, indexed like the VBO.
+  std::vector<ClipVertex> m_clipVertices;
+  std::vector<DrawState> m_draws;
+  std::vector<BinnedTriangle> m_triangles;
+  std::vector<std::vector<unsigned int>> m_bins;
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_poolMutex;
+  std::condition_variable m_poolWake;
+  std::condition_variable m_poolDone;
+  unsigned int m_generation;
+  unsigned int m_busyWorkers;
+  bool m_stopping;
+  std::atomic<unsigned int> m_nextTile;
+};
+
+#endif//SOFTWARE_OPENGL_CONTEXT_HPP
@@ -0,0 +1,147 @@
+/// \file TestBenchStats.cpp
+/// \brief A collection of Catch2 unit tests for the statistics BenchCompare
+///   uses.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <string>
+#include <vector>
+
+#include "BenchStats.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  // The samples first, first + 1, ..., first + count - 1.
+  std::vector<double>
+  sequence (double first, int count)
+  {
+    std::vector<double> values;
+    for (int i = 0; i < count; ++i)
+      values.push_back (first + i);
+    return values;
+  }
+}
+
+SCENARIO ("Benchmark sample medians and spreads.", "[BenchStats][A10]") {
+  GIVEN ("Some samples with one outlier.") {
+    std::vector<double> values { 4, 100, 2, 3, 1 };
+    WHEN ("I take their median and relative spread.") {
+      THEN ("The median is the middle value, and the outlier does not inflate the spread.") {
+	REQUIRE (median (values) == Approx (3.0));
+	// The deviations are 1, 97, 1, 0 and 2, whose median is 1.
+	REQUIRE (relativeSpread (values) == Approx (1.4826 / 3.0));
+      }
+    }
+  }
+
+  GIVEN ("An even number of samples, and none.") {
+    THEN ("The median of an even number is the mean of the middle two, and of none is 0.") {
+      REQUIRE (median ({ 1, 2, 3, 10 }) == Approx (2.5));
+      REQUIRE (median ({ }) == 0.0);
+    }
+  }
+
+  GIVEN ("Samples that are all the same.") {
+    std::vector<double> values (8, 5.0);
+    THEN ("Their relative spread is 0.") {
+      REQUIRE (relativeSpread (values) == 0.0);
+    }
+  }
+}
+
+SCENARIO ("Mann-Whitney U test.", "[BenchStats][A10]") {
+  GIVEN ("Two identical sets of samples.") {
+    std::vector<double> samples = sequence (1, 10);
+    WHEN ("I test whether either is larger.") {
+      THEN ("The p-value is about a half, either way.") {
+	REQUIRE (mannWhitney (samples, samples, true) == Approx (0.5151).epsilon (0.001));
+	REQUIRE (mannWhitney (samples, samples, false) == Approx (0.5151).epsilon (0.001));
+      }
+    }
+  }
+
+  GIVEN ("Candidate samples that are all larger than the baseline.") {
+    std::vector<double> baseline = sequence (1, 10);
+    std::vector<double> candidate = sequence (11, 10);
+    WHEN ("I test whether they are larger.") {
+      THEN ("The p-value is small, and matches the normal approximation.") {
+	// U = 100, with mean 50 and variance 175.
+	REQUIRE (mannWhitney (baseline, candidate, true) == Approx (9.1336e-5).epsilon (0.001));
+      }
+    }
+    WHEN ("I test whether they are smaller.") {
+      THEN ("The p-value is close to 1.") {
+	REQUIRE (mannWhitney (baseline, candidate, false) > 0.999);
+      }
+    }
+  }
+
+  GIVEN ("Samples that are all tied.") {
+    std::vector<double> baseline (6, 7.0);
+    std::vector<double> candidate (9, 7.0);
+    WHEN ("I test whether either is larger.") {
+      THEN ("The variance is 0, so the p-value is 1.") {
+	REQUIRE (mannWhitney (baseline, candidate, true) == 1.0);
+	REQUIRE (mannWhitney (baseline, candidate, false) == 1.0);
+      }
+    }
+  }
+}
+
+SCENARIO ("Comparing one benchmark's runs.", "[BenchStats][A10]") {
+  GIVEN ("A baseline of 20 samples near 100.") {
+    std::vector<double> baseline = sequence (90, 20);
+    WHEN ("The candidate is the same.") {
+      SampleComparison result = compareSamples (baseline, baseline, 0.10, 0.01);
+      THEN ("It is the same, with no change.") {
+	REQUIRE (result.verdict == SampleComparison::SAME);
+	REQUIRE (result.change == Approx (0.0));
+	REQUIRE (result.p > 0.4);
+	REQUIRE (getVerdictName (result.verdict) == std::string ("same"));
+      }
+    }
+
+    WHEN ("The candidate is about 45% slower.") {
+      SampleComparison result = compareSamples (baseline, sequence (135, 20), 0.10, 0.01);
+      THEN ("It regressed.") {
+	REQUIRE (result.verdict == SampleComparison::REGRESSED);
+	REQUIRE (result.change == Approx (0.45).epsilon (0.01));
+	REQUIRE (result.p < 0.01);
+      }
+    }
+
+    WHEN ("The candidate is about 30% faster.") {
+      SampleComparison result = compareSamples (baseline, sequence (60, 20), 0.10, 0.01);
+      THEN ("It improved.") {
+	REQUIRE (result.verdict == SampleComparison::IMPROVED);
+	REQUIRE (result.change < 0.0);
+      }
+    }
+
+    WHEN ("The candidate is slower by less than the threshold.") {
+      SampleComparison result = compareSamples (baseline, sequence (95, 20), 0.10, 0.01);
+      THEN ("It is the same, however significant the change.") {
+	REQUIRE (result.verdict == SampleComparison::SAME);
+      }
+    }
+
+    WHEN ("The candidate is slower, but much noisier.") {
+      std::vector<double> noisy { 50, 250, 60, 240, 70, 230, 80, 220, 90, 210 };
+      SampleComparison result = compareSamples (baseline, noisy, 0.10, 0.01);
+      THEN ("The noise threshold grows with the spread, so it is the same.") {
+	REQUIRE (result.noise > 2 * 0.10);
+	REQUIRE (result.verdict == SampleComparison::SAME);
+      }
+    }
+
+    WHEN ("The candidate has too few samples.") {
+      SampleComparison result = compareSamples (baseline, sequence (300, 4), 0.10, 0.01);
+      THEN ("It is not judged.") {
+	REQUIRE (result.verdict == SampleComparison::TOO_FEW_SAMPLES);
+      }
+    }
+  }
+}
@@ -0,0 +1,247 @@
+/// \file TestBufferArena.cpp
+/// \brief A collection of Catch2 unit tests for the BufferArena class.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "BufferArena.hpp"
+#include "NullOpenGLContext.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief A NullOpenGLContext that keeps the contents of its buffers, so
+  ///   that what a BufferArena copies where can be read back.
+  class BufferContext : public NullOpenGLContext
+  {
+  public:
+
+    void
+    bindBuffer (GLenum target, GLuint buffer) override
+    {
+      m_bound[target] = buffer;
+    }
+
+    void
+    bufferData (GLenum target, GLsizeiptr size, const GLvoid* data,
+		GLenum usage) override
+    {
+      std::vector<char>& bytes = m_buffers[m_bound[target]];
+      // Like new storage from a driver, what is not given is garbage.
+      bytes.assign (size, '\x5a');
+      if (data != nullptr)
+	std::memcpy (bytes.data (), data, size);
+    }
+
+    void
+    bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size,
+		   const GLvoid* data) override
+    {
+      std::vector<char>& bytes = m_buffers[m_bound[target]];
+      REQUIRE (offset + size <= static_cast<GLsizeiptr> (bytes.size ()));
+      std::memcpy (bytes.data () + offset, data, size);
+    }
+
+    void
+    copyBufferSubData (GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+		       GLintptr writeOffset, GLsizeiptr size) override
+    {
+      std::vector<char>& from = m_buffers[m_bound[readTarget]];
+      std::vector<char>& to = m_buffers[m_bound[writeTarget]];
+      REQUIRE (&from != &to);
+      REQUIRE (readOffset + size <= static_cast<GLsizeiptr> (from.size ()));
+      REQUIRE (writeOffset + size <= static_cast<GLsizeiptr> (to.size ()));
+      std::memcpy (to.data () + writeOffset, from.data () + readOffset, size);
+    }
+
+    /// \brief Gets the buffer an arena's VAO reads a target from.
+    GLuint
+    getVertexArrayBuffer (GLenum target) const
+    {
+      return m_vaoBound.at (target);
+    }
+
+    void
+    bindVertexArray (GLuint array) override
+    {
+      m_vao = array;
+    }
+
+    void
+    vertexAttribPointer (GLuint index, GLint size, GLenum type,
+			 GLboolean normalized, GLsizei stride,
+			 const GLvoid* pointer) override
+    {
+      m_vaoBound[GL_ARRAY_BUFFER] = m_bound[GL_ARRAY_BUFFER];
+    }
+
+    /// \brief Reads floats out of a buffer.
+    std::vector<float>
+    readFloats (GLuint buffer, size_t first, size_t count) const
+    {
+      std::vector<float> values (count);
+      std::memcpy (values.data (), m_buffers.at (buffer).data () + first * sizeof(float),
+		   count * sizeof(float));
+      return values;
+    }
+
+    /// \brief Reads indices out of a buffer.
+    std::vector<unsigned int>
+    readIndices (GLuint buffer, size_t first, size_t count) const
+    {
+      std::vector<unsigned int> values (count);
+      std::memcpy (values.data (),
+		   m_buffers.at (buffer).data () + first * sizeof(unsigned int),
+		   count * sizeof(unsigned int));
+      return values;
+    }
+
+    std::map<GLenum, GLuint> m_bound;
+    std::map<GLuint, std::vector<char>> m_buffers;
+    std::map<GLenum, GLuint> m_vaoBound;
+    GLuint m_vao = 0;
+  };
+
+  // Vertices of two floats each.
+  const unsigned int FLOATS_PER_VERTEX = 2;
+
+  // A Mesh's worth of vertices, each holding (id, vertex number), and
+  //   indices that run backwards over them.
+  void
+  makeGeometry (float id, size_t vertexCount, std::vector<float>& geometry,
+		std::vector<unsigned int>& indices)
+  {
+    geometry.clear ();
+    indices.clear ();
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+      geometry.push_back (id);
+      geometry.push_back (i);
+      indices.push_back (vertexCount - 1 - i);
+    }
+  }
+
+  // Requires that the arena's buffers hold what makeGeometry made at a
+  //   range.
+  void
+  requireGeometryAt (const BufferContext& context, GLuint vbo, GLuint ibo,
+		     const ArenaRange& range, float id)
+  {
+    std::vector<float> geometry;
+    std::vector<unsigned int> indices;
+    makeGeometry (id, range.vertexCount, geometry, indices);
+    REQUIRE (context.readFloats (vbo, range.baseVertex * FLOATS_PER_VERTEX,
+				 geometry.size ()) == geometry);
+    REQUIRE (context.readIndices (ibo, range.firstIndex, range.indexCount) == indices);
+  }
+}
+
+SCENARIO ("BufferArena allocation and relocation.", "[BufferArena][A10]") {
+  GIVEN ("An arena with room for 100 vertices and 100 indices.") {
+    BufferContext context;
+    BufferArena arena (&context, { { 0, 2, 0 } }, FLOATS_PER_VERTEX, 100, 100);
+    GLuint vbo = context.getVertexArrayBuffer (GL_ARRAY_BUFFER);
+    // The IBO is the other buffer the arena made.
+    GLuint ibo = 0;
+    for (const auto& buffer : context.m_buffers)
+      if (buffer.first != vbo)
+	ibo = buffer.first;
+    REQUIRE (context.m_buffers[vbo].size () == 100 * FLOATS_PER_VERTEX * sizeof(float));
+    REQUIRE (context.m_buffers[ibo].size () == 100 * sizeof(unsigned int));
+
+    std::vector<float> geometry;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> ids;
+    const size_t COUNTS[] = { 10, 20, 30 };
+    for (int i = 0; i < 3; ++i)
+    {
+      makeGeometry (i + 1, COUNTS[i], geometry, indices);
+      ids.push_back (arena.allocate (geometry, indices));
+    }
+
+    WHEN ("I allocate three ranges.") {
+      THEN ("They are packed from the start of both buffers, and hold their data.") {
+	REQUIRE (arena.getRange (ids[0]).baseVertex == 0);
+	REQUIRE (arena.getRange (ids[1]).baseVertex == 10);
+	REQUIRE (arena.getRange (ids[2]).baseVertex == 30);
+	REQUIRE (arena.getRange (ids[2]).firstIndex == 30);
+	REQUIRE (arena.getRange (ids[2]).vertexCount == 30);
+	REQUIRE (arena.getRange (ids[2]).indexCount == 30);
+	for (int i = 0; i < 3; ++i)
+	  requireGeometryAt (context, vbo, ibo, arena.getRange (ids[i]), i + 1);
+	REQUIRE (arena.getFragmentation () == 0.0);
+      }
+    }
+
+    WHEN ("I free the middle range and allocate a smaller one.") {
+      arena.free (ids[1]);
+      REQUIRE (arena.getFragmentation () == Approx (1.0 - 40.0 / 60.0));
+      makeGeometry (4, 15, geometry, indices);
+      unsigned int id = arena.allocate (geometry, indices);
+      THEN ("It reuses the slot and the freed space, and the others are untouched.") {
+	REQUIRE (id == ids[1]);
+	REQUIRE (arena.getRange (id).baseVertex == 10);
+	REQUIRE (arena.getRange (id).firstIndex == 10);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (id), 4);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (ids[0]), 1);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (ids[2]), 3);
+	REQUIRE (arena.getCompactionCount () == 0);
+      }
+    }
+
+    WHEN ("I free the first range and compact.") {
+      arena.free (ids[0]);
+      arena.compact ();
+      THEN ("The others move to the start, in order, with their data.") {
+	REQUIRE (arena.getCompactionCount () == 1);
+	REQUIRE (arena.getRange (ids[1]).baseVertex == 0);
+	REQUIRE (arena.getRange (ids[1]).firstIndex == 0);
+	REQUIRE (arena.getRange (ids[2]).baseVertex == 20);
+	REQUIRE (arena.getRange (ids[2]).firstIndex == 20);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (ids[1]), 2);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (ids[2]), 3);
+	REQUIRE (arena.getVertexCapacity () == 100);
+	REQUIRE (arena.getFragmentation () == 0.0);
+      }
+    }
+
+    WHEN ("I free the middle range and allocate one that fits only after packing.") {
+      arena.free (ids[1]);
+      // 20 are free in the middle and 40 at the end, so 50 needs both.
+      makeGeometry (5, 50, geometry, indices);
+      unsigned int id = arena.allocate (geometry, indices);
+      THEN ("The arena packs without growing, and every range keeps its data.") {
+	REQUIRE (arena.getCompactionCount () == 1);
+	REQUIRE (arena.getVertexCapacity () == 100);
+	REQUIRE (arena.getRange (ids[0]).baseVertex == 0);
+	REQUIRE (arena.getRange (ids[2]).baseVertex == 10);
+	REQUIRE (arena.getRange (id).baseVertex == 40);
+	REQUIRE (arena.getRange (id).firstIndex == 40);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (ids[0]), 1);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (ids[2]), 3);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (id), 5);
+      }
+    }
+
+    WHEN ("I allocate more than is left.") {
+      makeGeometry (6, 90, geometry, indices);
+      unsigned int id = arena.allocate (geometry, indices);
+      THEN ("The buffers double until it fits, keeping their names and data.") {
+	REQUIRE (arena.getVertexCapacity () == 200);
+	REQUIRE (arena.getIndexCapacity () == 200);
+	REQUIRE (context.m_buffers[vbo].size () == 200 * FLOATS_PER_VERTEX * sizeof(float));
+	REQUIRE (context.m_buffers[ibo].size () == 200 * sizeof(unsigned int));
+	REQUIRE (context.getVertexArrayBuffer (GL_ARRAY_BUFFER) == vbo);
+	REQUIRE (arena.getRange (id).baseVertex == 60);
+	for (int i = 0; i < 3; ++i)
+	  requireGeometryAt (context, vbo, ibo, arena.getRange (ids[i]), i + 1);
+	requireGeometryAt (context, vbo, ibo, arena.getRange (id), 6);
+      }
+    }
+  }
+}
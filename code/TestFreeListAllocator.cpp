@@ -0,0 +1,165 @@
+/// \file TestFreeListAllocator.cpp
+/// \brief A collection of Catch2 unit tests for the FreeListAllocator class.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <map>
+
+#include "FreeListAllocator.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  typedef std::map<size_t, size_t> FreeRanges;
+}
+
+SCENARIO ("FreeListAllocator best-fit allocation.", "[FreeListAllocator][A10]") {
+  GIVEN ("An allocator of 100 units.") {
+    FreeListAllocator allocator (100);
+    THEN ("All of it is one free range.") {
+      REQUIRE (allocator.getCapacity () == 100);
+      REQUIRE (allocator.getFreeSize () == 100);
+      REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 0, 100 } }));
+    }
+
+    WHEN ("I allocate 10, 20 and 30 units.") {
+      size_t a, b, c;
+      REQUIRE (allocator.allocate (10, a));
+      REQUIRE (allocator.allocate (20, b));
+      REQUIRE (allocator.allocate (30, c));
+      THEN ("They are packed from the start, and the rest is free.") {
+	REQUIRE (a == 0);
+	REQUIRE (b == 10);
+	REQUIRE (c == 30);
+	REQUIRE (allocator.getFreeSize () == 40);
+	REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 60, 40 } }));
+      }
+
+      WHEN ("I free the 20 and allocate 15.") {
+	allocator.free (b, 20);
+	size_t d;
+	REQUIRE (allocator.allocate (15, d));
+	THEN ("It takes the smallest range it fits in, not the first or the largest.") {
+	  REQUIRE (d == 10);
+	  REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 25, 5 }, { 60, 40 } }));
+	  REQUIRE (allocator.getFreeSize () == 45);
+	  REQUIRE (allocator.getLargestFree () == 40);
+	}
+      }
+
+      WHEN ("I free the 10 and the 30, and allocate 25.") {
+	allocator.free (a, 10);
+	allocator.free (c, 30);
+	size_t d;
+	REQUIRE (allocator.allocate (25, d));
+	THEN ("The 10 is too small, and the freed 30 is joined to the free end, so it is taken from there.") {
+	  REQUIRE (d == 30);
+	  REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 0, 10 }, { 55, 45 } }));
+	}
+      }
+
+      WHEN ("I ask for more than any free range holds.") {
+	allocator.free (a, 10);
+	size_t d = 12345;
+	THEN ("It fails, even though that much is free in total, and nothing changes.") {
+	  REQUIRE (allocator.getFreeSize () == 50);
+	  REQUIRE_FALSE (allocator.allocate (45, d));
+	  REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 0, 10 }, { 60, 40 } }));
+	}
+      }
+    }
+
+    WHEN ("I ask for nothing.") {
+      size_t offset;
+      THEN ("It fails.") {
+	REQUIRE_FALSE (allocator.allocate (0, offset));
+	REQUIRE (allocator.getFreeSize () == 100);
+      }
+    }
+  }
+}
+
+SCENARIO ("FreeListAllocator merging.", "[FreeListAllocator][A10]") {
+  GIVEN ("An allocator of 100 units, all in five ranges of 20.") {
+    FreeListAllocator allocator (100);
+    size_t offsets[5];
+    for (size_t& offset : offsets)
+      REQUIRE (allocator.allocate (20, offset));
+    REQUIRE (allocator.getFreeSize () == 0);
+    REQUIRE (allocator.getFreeRanges ().empty ());
+
+    WHEN ("I free the second and fourth.") {
+      allocator.free (offsets[1], 20);
+      allocator.free (offsets[3], 20);
+      THEN ("They stay apart.") {
+	REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 20, 20 }, { 60, 20 } }));
+	REQUIRE (allocator.getLargestFree () == 20);
+      }
+
+      WHEN ("I free the third, between them.") {
+	allocator.free (offsets[2], 20);
+	THEN ("All three merge into one range.") {
+	  REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 20, 60 } }));
+	  REQUIRE (allocator.getLargestFree () == 60);
+	  REQUIRE (allocator.getFreeSize () == 60);
+	}
+
+	WHEN ("I free the first and last too.") {
+	  allocator.free (offsets[0], 20);
+	  allocator.free (offsets[4], 20);
+	  THEN ("Everything is one free range again, which can be allocated whole.") {
+	    REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 0, 100 } }));
+	    size_t offset;
+	    REQUIRE (allocator.allocate (100, offset));
+	    REQUIRE (offset == 0);
+	  }
+	}
+      }
+    }
+
+    WHEN ("I free the first, which only has a neighbor after it.") {
+      allocator.free (offsets[1], 20);
+      allocator.free (offsets[0], 20);
+      THEN ("It merges with the free range after it.") {
+	REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 0, 40 } }));
+      }
+    }
+
+    WHEN ("I free the last, which only has a neighbor before it.") {
+      allocator.free (offsets[3], 20);
+      allocator.free (offsets[4], 20);
+      THEN ("It merges with the free range before it.") {
+	REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 60, 40 } }));
+      }
+    }
+  }
+}
+
+SCENARIO ("FreeListAllocator reset.", "[FreeListAllocator][A10]") {
+  GIVEN ("A fragmented allocator.") {
+    FreeListAllocator allocator (100);
+    size_t a, b, c;
+    allocator.allocate (10, a);
+    allocator.allocate (10, b);
+    allocator.allocate (10, c);
+    allocator.free (a, 10);
+    WHEN ("I reset it to a larger capacity with the first 20 units used, as after packing.") {
+      allocator.reset (200, 20);
+      THEN ("The rest of it is one free range.") {
+	REQUIRE (allocator.getCapacity () == 200);
+	REQUIRE (allocator.getFreeSize () == 180);
+	REQUIRE (allocator.getFreeRanges () == FreeRanges ({ { 20, 180 } }));
+      }
+    }
+    WHEN ("I reset it with all of it used.") {
+      allocator.reset (50, 50);
+      THEN ("Nothing is free.") {
+	REQUIRE (allocator.getFreeSize () == 0);
+	REQUIRE (allocator.getLargestFree () == 0);
+	REQUIRE (allocator.getFreeRanges ().empty ());
+      }
+    }
+  }
+}
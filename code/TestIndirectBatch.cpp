@@ -0,0 +1,192 @@
+/// \file TestIndirectBatch.cpp
+/// \brief A collection of Catch2 unit tests for the IndirectBatch class.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "BufferArena.hpp"
+#include "IndirectBatch.hpp"
+#include "InstrumentedOpenGLContext.hpp"
+#include "NullOpenGLContext.hpp"
+#include "ShaderProgram.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief A NullOpenGLContext that keeps every draw command it is given,
+  ///   whether from the indirect buffer or from glDrawElementsBaseVertex.
+  class DrawContext : public NullOpenGLContext
+  {
+  public:
+
+    void
+    bindBuffer (GLenum target, GLuint buffer) override
+    {
+      m_bound[target] = buffer;
+    }
+
+    void
+    bufferData (GLenum target, GLsizeiptr size, const GLvoid* data,
+		GLenum usage) override
+    {
+      std::vector<char>& bytes = m_buffers[m_bound[target]];
+      bytes.assign (size, 0);
+      if (data != nullptr)
+	std::memcpy (bytes.data (), data, size);
+    }
+
+    void
+    drawElementsBaseVertex (GLenum mode, GLsizei count, GLenum type,
+			    const GLvoid* indices, GLint basevertex) override
+    {
+      DrawElementsIndirectCommand command;
+      command.count = count;
+      command.instanceCount = 1;
+      command.firstIndex = reinterpret_cast<size_t> (indices) / sizeof(GLuint);
+      command.baseVertex = basevertex;
+      command.baseInstance = 0;
+      m_draws.push_back (command);
+    }
+
+    void
+    multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect,
+			       GLsizei drawcount, GLsizei stride) override
+    {
+      const std::vector<char>& bytes = m_buffers[m_bound[GL_DRAW_INDIRECT_BUFFER]];
+      size_t offset = reinterpret_cast<size_t> (indirect);
+      REQUIRE (stride == 0);
+      REQUIRE (offset + drawcount * sizeof(DrawElementsIndirectCommand) <= bytes.size ());
+      for (GLsizei draw = 0; draw < drawcount; ++draw)
+      {
+	DrawElementsIndirectCommand command;
+	std::memcpy (&command, bytes.data () + offset
+		     + draw * sizeof(DrawElementsIndirectCommand), sizeof(command));
+	m_draws.push_back (command);
+      }
+      ++m_multiDraws;
+    }
+
+    std::map<GLenum, GLuint> m_bound;
+    std::map<GLuint, std::vector<char>> m_buffers;
+    /// Every command drawn, in order.
+    std::vector<DrawElementsIndirectCommand> m_draws;
+    /// The number of glMultiDrawElementsIndirect calls.
+    int m_multiDraws = 0;
+  };
+
+  // Vertices of two floats each.
+  const unsigned int FLOATS_PER_VERTEX = 2;
+
+  // Puts a Mesh's worth of vertices and the indices of some triangles of
+  //   them into an arena.
+  const ArenaRange&
+  addGeometry (BufferArena& arena, size_t vertexCount, size_t triangleCount)
+  {
+    std::vector<float> geometry (vertexCount * FLOATS_PER_VERTEX, 0.0f);
+    std::vector<unsigned int> indices;
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+      indices.push_back (i % vertexCount);
+    return arena.getRange (arena.allocate (geometry, indices));
+  }
+
+  // Requires that a command draws a range as the draw at some index.
+  void
+  requireCommand (const DrawElementsIndirectCommand& command,
+		  const ArenaRange& range, GLuint baseInstance)
+  {
+    REQUIRE (command.count == static_cast<GLuint> (range.indexCount));
+    REQUIRE (command.instanceCount == 1);
+    REQUIRE (command.firstIndex == range.firstIndex);
+    REQUIRE (command.baseVertex == range.baseVertex);
+    REQUIRE (command.baseInstance == baseInstance);
+  }
+}
+
+SCENARIO ("IndirectBatch command streams.", "[IndirectBatch][A10]") {
+  GIVEN ("Three meshes in an arena, the first two drawn with one program and the third with another.") {
+    DrawContext* draws = new DrawContext;
+    InstrumentedOpenGLContext context (draws);
+    BufferArena arena (&context, { { 0, 2, 0 } }, FLOATS_PER_VERTEX, 100, 100);
+    ArenaRange ranges[3] = { addGeometry (arena, 4, 2), addGeometry (arena, 3, 1),
+			     addGeometry (arena, 6, 4) };
+    ShaderProgram first (&context);
+    first.link ();
+    ShaderProgram second (&context);
+    second.link ();
+    Transform world;
+    Material red (Vector3 (1, 0, 0));
+    Material green (Vector3 (0, 1, 0));
+
+    for (bool multiDraw : { true, false })
+    {
+      WHEN ((multiDraw ? "I submit them with glMultiDrawElementsIndirect."
+	     : "I submit them one by one.")) {
+	IndirectBatch batch (&context, arena, multiDraw);
+	REQUIRE (batch.add (&first, ranges[0], world, red));
+	REQUIRE (batch.add (&first, ranges[1], world, green));
+	REQUIRE (batch.add (&second, ranges[2], world, red));
+	context.endFrame ();
+	batch.submit (world, Matrix4 (), Vector3 (0, 0, 0));
+	context.endFrame ();
+
+	THEN ("Each range is drawn once, in order, as its own instance.") {
+	  const std::vector<DrawElementsIndirectCommand>& commands = batch.getCommands ();
+	  REQUIRE (commands.size () == 3);
+	  for (GLuint i = 0; i < 3; ++i)
+	    requireCommand (commands[i], ranges[i], i);
+	  REQUIRE (batch.getDrawData ()[0].material == 0);
+	  REQUIRE (batch.getDrawData ()[1].material == 1);
+	  REQUIRE (batch.getDrawData ()[2].material == 0);
+	}
+
+	THEN ("The context is given the same draws, and counts each one.") {
+	  REQUIRE (draws->m_draws.size () == 3);
+	  for (GLuint i = 0; i < 3; ++i)
+	  {
+	    // Draws made one by one have no instance.
+	    GLuint instance = multiDraw ? i : 0;
+	    requireCommand (draws->m_draws[i], ranges[i], instance);
+	  }
+	  // One multi-draw per program.
+	  REQUIRE (draws->m_multiDraws == (multiDraw ? 2 : 0));
+	  const GlCallCounts& counts = context.getPreviousCounts ();
+	  REQUIRE (counts.draws == 3);
+	  REQUIRE (counts.triangles == 2 + 1 + 4);
+	}
+
+	WHEN ("I clear it and submit nothing.") {
+	  batch.clear ();
+	  batch.submit (world, Matrix4 (), Vector3 (0, 0, 0));
+	  context.endFrame ();
+	  THEN ("Nothing is drawn.") {
+	    REQUIRE (batch.getCommands ().empty ());
+	    REQUIRE (context.getPreviousCounts ().draws == 0);
+	  }
+	}
+      }
+    }
+
+    WHEN ("I add more materials than a multi-draw's table holds.") {
+      IndirectBatch multiBatch (&context, arena, true);
+      IndirectBatch eachBatch (&context, arena, false);
+      for (unsigned int i = 0; i < IndirectBatch::MAX_MATERIALS; ++i)
+      {
+	Material material (Vector3 (i, 0, 0));
+	REQUIRE (multiBatch.add (&first, ranges[0], world, material));
+	REQUIRE (eachBatch.add (&first, ranges[0], world, material));
+      }
+      Material extra (Vector3 (0, 0, 1));
+      THEN ("The multi-draw batch refuses the draw, and the other takes it.") {
+	REQUIRE_FALSE (multiBatch.add (&first, ranges[1], world, extra));
+	REQUIRE (multiBatch.getCommands ().size () == size_t (IndirectBatch::MAX_MATERIALS));
+	REQUIRE (multiBatch.add (&first, ranges[1], world, Material (Vector3 (0, 0, 0))));
+	REQUIRE (eachBatch.add (&first, ranges[1], world, extra));
+      }
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/// \file TestJobSystem.cpp
+/// \brief A collection of Catch2 unit tests for the JobSystem class.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("JobSystem parallelFor.", "[JobSystem][A10]") {
+  GIVEN ("A JobSystem with four threads.") {
+    JobSystem jobs (4);
+    WHEN ("I run parallelFor over 10000 items with a grain size of 7.") {
+      const size_t count = 10000;
+      std::vector<std::atomic<int>> writes (count);
+      for (std::atomic<int>& w : writes)
+	w = 0;
+      std::atomic<bool> badRange (false);
+      jobs.parallelFor (count, 7, [&] (size_t begin, size_t end) {
+	  if (begin >= end || end > count)
+	    badRange = true;
+	  for (size_t i = begin; i < end; ++i)
+	    ++writes[i];
+	});
+      THEN ("Every index has been written exactly once, by non-empty ranges.") {
+	REQUIRE_FALSE (badRange);
+	size_t once = 0;
+	for (const std::atomic<int>& w : writes)
+	  once += (w == 1);
+	REQUIRE (once == count);
+      }
+    }
+
+    WHEN ("I run parallelFor over no items.") {
+      std::atomic<int> calls (0);
+      jobs.parallelFor (0, 7, [&] (size_t, size_t) { ++calls; });
+      THEN ("The body is never called.") {
+	REQUIRE (calls == 0);
+      }
+    }
+  }
+}
+
+SCENARIO ("JobSystem waiting on nested jobs.", "[JobSystem][A10]") {
+  GIVEN ("A JobSystem with four threads.") {
+    JobSystem jobs (4);
+    WHEN ("Each of 20 jobs starts 20 more with the same counter, and I wait on it.") {
+      JobCounter counter;
+      std::atomic<int> outer (0);
+      std::atomic<int> inner (0);
+      for (int i = 0; i < 20; ++i)
+      {
+	jobs.run ([&] {
+	    for (int j = 0; j < 20; ++j)
+	      jobs.run ([&] {
+		  std::this_thread::sleep_for (std::chrono::microseconds (50));
+		  ++inner;
+		}, &counter);
+	    ++outer;
+	  }, &counter);
+      }
+      jobs.wait (counter);
+      THEN ("Every job, nested or not, has finished by the time wait returns.") {
+	REQUIRE (counter.isDone ());
+	REQUIRE (outer == 20);
+	REQUIRE (inner == 400);
+      }
+    }
+
+    WHEN ("A job is queued with runAfter a counter of slow jobs.") {
+      JobCounter first;
+      JobCounter second;
+      std::atomic<int> finished (0);
+      std::atomic<int> seenByLater (-1);
+      for (int i = 0; i < 8; ++i)
+	jobs.run ([&] {
+	    std::this_thread::sleep_for (std::chrono::milliseconds (2));
+	    ++finished;
+	  }, &first);
+      jobs.runAfter (first, [&] { seenByLater = finished.load (); }, &second);
+      jobs.wait (second);
+      THEN ("It only runs once all of them have finished.") {
+	REQUIRE (seenByLater == 8);
+      }
+    }
+  }
+}
+
+SCENARIO ("JobSystem work stealing.", "[JobSystem][A10]") {
+  GIVEN ("A JobSystem with four threads.") {
+    JobSystem jobs (4);
+    WHEN ("One thread queues 5000 jobs on its own deque.") {
+      JobCounter counter;
+      const int count = 5000;
+      std::vector<std::atomic<int>> runs (count);
+      for (std::atomic<int>& r : runs)
+	r = 0;
+      for (int i = 0; i < count; ++i)
+	jobs.run ([&runs, i] { ++runs[i]; }, &counter);
+      jobs.wait (counter);
+      THEN ("Each job runs exactly once, whichever thread takes it.") {
+	int once = 0;
+	for (const std::atomic<int>& r : runs)
+	  once += (r == 1);
+	REQUIRE (once == count);
+      }
+    }
+  }
+}
@@ -0,0 +1,133 @@
+/// \file TestScene.cpp
+/// \brief A collection of Catch2 unit tests for the Scene class's handles.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include "Mesh.hpp"
+#include "NullOpenGLContext.hpp"
+#include "Scene.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("Scene handles through adds and removes.", "[Scene][A10]") {
+  GIVEN ("A scene with three named meshes, a, b and c.") {
+    NullOpenGLContext context;
+    Scene scene;
+    Mesh* a = new Mesh (&context, nullptr);
+    Mesh* b = new Mesh (&context, nullptr);
+    Mesh* c = new Mesh (&context, nullptr);
+    MeshHandle ha = scene.add ("a", a);
+    MeshHandle hb = scene.add ("b", b);
+    MeshHandle hc = scene.add ("c", c);
+
+    THEN ("Each handle finds its mesh, and the first mesh is active.") {
+      REQUIRE (scene.getMeshCount () == 3);
+      REQUIRE (scene.getMesh (ha) == a);
+      REQUIRE (scene.getMesh (hb) == b);
+      REQUIRE (scene.getMesh (hc) == c);
+      REQUIRE (scene.findMesh ("b") == hb);
+      REQUIRE (scene.getActiveMeshHandle () == ha);
+      REQUIRE_FALSE (scene.isValid (MeshHandle ()));
+    }
+
+    WHEN ("I remove the middle one.") {
+      scene.remove (hb);
+      THEN ("Its handle and name are stale, and the last mesh takes its place.") {
+	REQUIRE (scene.getMeshCount () == 2);
+	REQUIRE_FALSE (scene.isValid (hb));
+	REQUIRE_FALSE (scene.isValid (scene.findMesh ("b")));
+	REQUIRE (scene.getMesh ("b") == nullptr);
+	REQUIRE (scene.getMesh (ha) == a);
+	REQUIRE (scene.getMesh (hc) == c);
+	// a is first and c second, so cycling either way alternates them.
+	scene.activateNextMesh ();
+	REQUIRE (scene.getActiveMesh () == c);
+	scene.activateNextMesh ();
+	REQUIRE (scene.getActiveMesh () == a);
+	scene.activatePreviousMesh ();
+	REQUIRE (scene.getActiveMesh () == c);
+      }
+
+      WHEN ("I add another mesh.") {
+	Mesh* d = new Mesh (&context, nullptr);
+	MeshHandle hd = scene.add ("b", d);
+	THEN ("It reuses the freed slot, but the old handle stays stale.") {
+	  REQUIRE (hd.index == hb.index);
+	  REQUIRE (hd != hb);
+	  REQUIRE_FALSE (scene.isValid (hb));
+	  REQUIRE (scene.getMesh (hd) == d);
+	  REQUIRE (scene.findMesh ("b") == hd);
+	  REQUIRE (scene.getMesh (hc) == c);
+	  // It is drawn last, after a and c.
+	  scene.activatePreviousMesh ();
+	  REQUIRE (scene.getActiveMesh () == d);
+	  scene.activatePreviousMesh ();
+	  REQUIRE (scene.getActiveMesh () == c);
+	}
+      }
+    }
+
+    WHEN ("I remove the first two and add two more.") {
+      scene.remove ("a");
+      scene.remove (hb);
+      MeshHandle hd = scene.add (new Mesh (&context, nullptr));
+      MeshHandle he = scene.add (new Mesh (&context, nullptr));
+      THEN ("Both freed slots are reused before the scene grows.") {
+	REQUIRE (scene.getMeshCount () == 3);
+	REQUIRE (hd.index == hb.index);
+	REQUIRE (he.index == ha.index);
+	REQUIRE_FALSE (scene.isValid (ha));
+	REQUIRE_FALSE (scene.isValid (hb));
+	REQUIRE (scene.getMesh (hc) == c);
+	MeshHandle hf = scene.add (new Mesh (&context, nullptr));
+	REQUIRE (hf.index == 3);
+      }
+    }
+
+    WHEN ("I remove the active mesh.") {
+      scene.setActiveMesh (hb);
+      scene.remove (hb);
+      THEN ("The next mesh becomes active.") {
+	REQUIRE (scene.getActiveMeshHandle () == hc);
+	REQUIRE (scene.getActiveMesh () == c);
+      }
+    }
+
+    WHEN ("I remove the active mesh, which is drawn last.") {
+      scene.setActiveMesh (hc);
+      scene.remove (hc);
+      THEN ("The first mesh becomes active.") {
+	REQUIRE (scene.getActiveMeshHandle () == ha);
+      }
+    }
+
+    WHEN ("I remove every mesh, one at a time.") {
+      scene.remove (ha);
+      scene.remove (hb);
+      scene.remove (hc);
+      THEN ("There is no active mesh, and switching does nothing.") {
+	REQUIRE (scene.getMeshCount () == 0);
+	REQUIRE (scene.getActiveMesh () == nullptr);
+	scene.activateNextMesh ();
+	scene.activatePreviousMesh ();
+	REQUIRE (scene.getActiveMesh () == nullptr);
+      }
+    }
+
+    WHEN ("I clear it and add a mesh.") {
+      scene.clear ();
+      Mesh* d = new Mesh (&context, nullptr);
+      MeshHandle hd = scene.add ("a", d);
+      THEN ("Every old handle is stale, and the new mesh reuses a slot.") {
+	REQUIRE_FALSE (scene.isValid (ha));
+	REQUIRE_FALSE (scene.isValid (hb));
+	REQUIRE_FALSE (scene.isValid (hc));
+	REQUIRE (hd.index < 3);
+	REQUIRE (scene.getMeshCount () == 1);
+	REQUIRE (scene.findMesh ("a") == hd);
+	REQUIRE (scene.getActiveMesh () == d);
+      }
+    }
+  }
+}
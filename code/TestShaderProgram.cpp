@@ -0,0 +1,295 @@
+/// \file TestShaderProgram.cpp
+/// \brief A collection of Catch2 unit tests for the ShaderProgram binary
+///   cache.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "NullOpenGLContext.hpp"
+#include "ShaderProgram.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief A NullOpenGLContext whose programs remember whether they are
+  ///   linked, and which hands out and accepts program binaries like a
+  ///   driver would.
+  ///
+  /// Linking a program gives it the binary "driver:<m_driver>".  Loading a
+  ///   binary links the program only if it is the one this driver makes and
+  ///   m_rejectBinaries is false, so a binary from another version of the
+  ///   driver is rejected.
+  class BinaryCacheContext : public NullOpenGLContext
+  {
+  public:
+
+    void
+    compileShader (GLuint shader) override
+    {
+      ++m_compiles;
+    }
+
+    void
+    linkProgram (GLuint program) override
+    {
+      ++m_links;
+      m_linked[program] = true;
+    }
+
+    void
+    getProgramiv (GLuint program, GLenum pname, GLint* params) override
+    {
+      if (pname == GL_LINK_STATUS)
+	*params = m_linked[program] ? GL_TRUE : GL_FALSE;
+      else if (pname == GL_PROGRAM_BINARY_LENGTH)
+	*params = m_linked[program] ? getBinary ().size () : 0;
+      else
+	NullOpenGLContext::getProgramiv (program, pname, params);
+    }
+
+    void
+    getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length,
+		      GLenum* binaryFormat, void* binary) override
+    {
+      std::string bytes = getBinary ();
+      GLsizei written = std::min<GLsizei> (bufSize, bytes.size ());
+      bytes.copy (static_cast<char*> (binary), written);
+      if (length != nullptr)
+	*length = written;
+      *binaryFormat = FORMAT;
+    }
+
+    void
+    programBinary (GLuint program, GLenum binaryFormat, const void* binary,
+		   GLsizei length) override
+    {
+      ++m_binaryLoads;
+      std::string bytes (static_cast<const char*> (binary), length);
+      m_linked[program] = !m_rejectBinaries && binaryFormat == FORMAT
+	&& bytes == getBinary ();
+    }
+
+    std::string
+    getBinary () const
+    {
+      return "driver:" + m_driver;
+    }
+
+    static const GLenum FORMAT = 0x1234;
+
+    std::string m_driver = "1";
+    bool m_rejectBinaries = false;
+    int m_compiles = 0;
+    int m_links = 0;
+    int m_binaryLoads = 0;
+    std::map<GLuint, bool> m_linked;
+  };
+
+  /// \brief Makes an empty directory for one test's cache and shaders.
+  std::string
+  makeTempDirectory ()
+  {
+    char name[] = "/tmp/TestShaderProgramXXXXXX";
+    REQUIRE (mkdtemp (name) != nullptr);
+    return name;
+  }
+
+  /// \brief Writes a file.
+  void
+  writeFile (const std::string& fileName, const std::string& contents)
+  {
+    std::ofstream file (fileName, std::ios::binary);
+    file << contents;
+  }
+
+  /// \brief Reads a whole file.
+  std::string
+  readFile (const std::string& fileName)
+  {
+    std::ifstream file (fileName, std::ios::binary);
+    return { std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> () };
+  }
+
+  /// \brief Lists the files in a directory, with their paths.
+  std::vector<std::string>
+  listFiles (const std::string& directory)
+  {
+    std::vector<std::string> files;
+    DIR* dir = opendir (directory.c_str ());
+    if (dir == nullptr)
+      return files;
+    while (dirent* entry = readdir (dir))
+    {
+      std::string name = entry->d_name;
+      if (name != "." && name != "..")
+	files.push_back (directory + "/" + name);
+    }
+    closedir (dir);
+    return files;
+  }
+
+  /// \brief Removes a directory and everything in it, recursively.
+  void
+  removeDirectory (const std::string& directory)
+  {
+    for (const std::string& file : listFiles (directory))
+    {
+      if (std::remove (file.c_str ()) != 0)
+	removeDirectory (file);
+    }
+    rmdir (directory.c_str ());
+  }
+
+  /// \brief Makes and links a program from the test shaders in a directory.
+  void
+  linkProgram (ShaderProgram& program, const std::string& directory)
+  {
+    program.createVertexShader (directory + "/Test.vert");
+    program.createFragmentShader (directory + "/Test.frag");
+    program.link ();
+  }
+
+  /// \brief What a cache file holds for a binary: its format, then its bytes.
+  std::string
+  cacheContents (const std::string& binary)
+  {
+    GLenum format = BinaryCacheContext::FORMAT;
+    return std::string (reinterpret_cast<const char*> (&format), sizeof (format))
+      + binary;
+  }
+}
+
+SCENARIO ("ShaderProgram binary cache.", "[ShaderProgram][A10]") {
+  GIVEN ("Two shaders and an empty cache directory.") {
+    std::string directory = makeTempDirectory ();
+    writeFile (directory + "/Test.vert", "#version 330\nvoid main () {}\n");
+    writeFile (directory + "/Test.frag", "#version 330\nvoid main () {}\n");
+    std::string cache = directory + "/cache";
+    ShaderProgram::setBinaryCacheDirectory (cache);
+    BinaryCacheContext context;
+
+    WHEN ("I link a program.") {
+      ShaderProgram program (&context);
+      linkProgram (program, directory);
+      THEN ("It misses, so it is compiled and linked, and its binary is stored.") {
+	REQUIRE_FALSE (program.isFromBinaryCache ());
+	REQUIRE (context.m_compiles == 2);
+	REQUIRE (context.m_links == 1);
+	REQUIRE (context.m_binaryLoads == 0);
+	std::vector<std::string> files = listFiles (cache);
+	REQUIRE (files.size () == 1);
+	REQUIRE (readFile (files[0]) == cacheContents ("driver:1"));
+      }
+    }
+
+    WHEN ("I link the same program twice.") {
+      ShaderProgram first (&context);
+      linkProgram (first, directory);
+      ShaderProgram second (&context);
+      linkProgram (second, directory);
+      THEN ("The second hits, and loads the stored binary without compiling.") {
+	REQUIRE (second.isFromBinaryCache ());
+	REQUIRE (context.m_compiles == 2);
+	REQUIRE (context.m_links == 1);
+	REQUIRE (context.m_binaryLoads == 1);
+	REQUIRE (context.m_linked[second.getProgramId ()]);
+	REQUIRE (listFiles (cache).size () == 1);
+      }
+    }
+
+    WHEN ("I link a program with a different define.") {
+      ShaderProgram program (&context);
+      linkProgram (program, directory);
+      ShaderProgram* variant = program.getVariant ({ { "VARIANT", "1" } });
+      THEN ("Its sources differ, so it misses and gets its own file.") {
+	REQUIRE_FALSE (variant->isFromBinaryCache ());
+	REQUIRE (context.m_compiles == 4);
+	REQUIRE (listFiles (cache).size () == 2);
+      }
+    }
+
+    WHEN ("The driver rejects the stored binary.") {
+      ShaderProgram first (&context);
+      linkProgram (first, directory);
+      context.m_rejectBinaries = true;
+      ShaderProgram second (&context);
+      linkProgram (second, directory);
+      THEN ("The program falls back to compiling and linking, and is linked.") {
+	REQUIRE_FALSE (second.isFromBinaryCache ());
+	REQUIRE (context.m_binaryLoads == 1);
+	REQUIRE (context.m_compiles == 4);
+	REQUIRE (context.m_links == 2);
+	REQUIRE (context.m_linked[second.getProgramId ()]);
+      }
+    }
+
+    WHEN ("The stored binary is stale, from another build of the same driver.") {
+      ShaderProgram first (&context);
+      linkProgram (first, directory);
+      context.m_driver = "2";
+      ShaderProgram second (&context);
+      linkProgram (second, directory);
+      THEN ("It is rejected, the program is relinked and the new binary replaces it.") {
+	REQUIRE_FALSE (second.isFromBinaryCache ());
+	REQUIRE (context.m_links == 2);
+	REQUIRE (context.m_linked[second.getProgramId ()]);
+	std::vector<std::string> files = listFiles (cache);
+	REQUIRE (files.size () == 1);
+	REQUIRE (readFile (files[0]) == cacheContents ("driver:2"));
+      }
+    }
+
+    WHEN ("The stored file is too short to hold a format.") {
+      ShaderProgram first (&context);
+      linkProgram (first, directory);
+      std::vector<std::string> files = listFiles (cache);
+      REQUIRE (files.size () == 1);
+      writeFile (files[0], "x");
+      ShaderProgram second (&context);
+      linkProgram (second, directory);
+      THEN ("It is not given to the driver, and the program is relinked.") {
+	REQUIRE_FALSE (second.isFromBinaryCache ());
+	REQUIRE (context.m_binaryLoads == 0);
+	REQUIRE (context.m_links == 2);
+	REQUIRE (readFile (files[0]) == cacheContents ("driver:1"));
+      }
+    }
+
+    ShaderProgram::setBinaryCacheDirectory ("");
+    removeDirectory (directory);
+  }
+
+  GIVEN ("No cache directory.") {
+    std::string directory = makeTempDirectory ();
+    writeFile (directory + "/Test.vert", "#version 330\nvoid main () {}\n");
+    writeFile (directory + "/Test.frag", "#version 330\nvoid main () {}\n");
+    ShaderProgram::setBinaryCacheDirectory ("");
+    BinaryCacheContext context;
+    WHEN ("I link the same program twice.") {
+      ShaderProgram first (&context);
+      linkProgram (first, directory);
+      ShaderProgram second (&context);
+      linkProgram (second, directory);
+      THEN ("Both are compiled and linked, and no binary is loaded.") {
+	REQUIRE_FALSE (second.isFromBinaryCache ());
+	REQUIRE (context.m_compiles == 4);
+	REQUIRE (context.m_links == 2);
+	REQUIRE (context.m_binaryLoads == 0);
+      }
+    }
+    removeDirectory (directory);
+  }
+}
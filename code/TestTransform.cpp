@@ -0,0 +1,156 @@
+/// \file TestTransform.cpp
+/// \brief A collection of Catch2 unit tests for decomposed Transforms and
+///   Quaternion slerp.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cmath>
+
+#include "Transform.hpp"
+#include "Quaternion.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  // Requires every element of two transforms' matrices to match.
+  void
+  requireSameMatrix (const Transform& actual, const Transform& expected)
+  {
+    float a[16], e[16];
+    actual.getTransform (a);
+    expected.getTransform (e);
+    for (int i = 0; i < 16; ++i)
+      REQUIRE (a[i] == Approx (e[i]).margin (1e-4));
+  }
+
+  // Requires two quaternions to be the same rotation, which q and -q are.
+  void
+  requireSameRotation (const Quaternion& actual, const Quaternion& expected)
+  {
+    REQUIRE (std::fabs (actual.dot (expected)) == Approx (1.0f).margin (1e-4));
+  }
+
+  // A rotation about an axis that is not one of the coordinate axes.
+  Transform
+  rotatedScaledMoved ()
+  {
+    Transform t;
+    t.rotateLocal (30, Vector3 (1, 2, 3));
+    t.scaleLocal (2.0f, 0.5f, 3.0f);
+    t.setPosition (1, -2, 3);
+    return t;
+  }
+}
+
+SCENARIO ("Transform decompose and recompose.", "[Transform][A10]") {
+  GIVEN ("A transform with a rotation, a non-uniform scale and a translation.") {
+    Transform original = rotatedScaledMoved ();
+    WHEN ("I decompose it.") {
+      Transform t = original;
+      t.decompose ();
+      THEN ("It is decomposed, has the scale it was given and the same matrix.") {
+	REQUIRE (t.isDecomposed ());
+	REQUIRE (t.getScale ().m_x == Approx (2.0f));
+	REQUIRE (t.getScale ().m_y == Approx (0.5f));
+	REQUIRE (t.getScale ().m_z == Approx (3.0f));
+	requireSameMatrix (t, original);
+      }
+      THEN ("Rebuilding it from its rotation, scale and position gives the same matrix.") {
+	Transform rebuilt (t.getRotation (), t.getScale (), t.getPosition ());
+	requireSameMatrix (rebuilt, original);
+      }
+      THEN ("Its rotation is the one it was given.") {
+	requireSameRotation (t.getRotation (), Quaternion (30, Vector3 (1, 2, 3)));
+      }
+    }
+
+    WHEN ("I decompose it and then rotate it locally.") {
+      Transform t = original;
+      t.decompose ();
+      Quaternion rotation = t.getRotation ();
+      t.yaw (40);
+      t.pitch (-15);
+      THEN ("The rotation changes, the scale does not, and the matrix is rebuilt to match.") {
+	Quaternion expected = rotation * Quaternion (40, Vector3 (0, 1, 0))
+	  * Quaternion (-15, Vector3 (1, 0, 0));
+	requireSameRotation (t.getRotation (), expected);
+	REQUIRE (t.getScale ().m_y == Approx (0.5f));
+	requireSameMatrix (t, Transform (expected, t.getScale (), t.getPosition ()));
+      }
+    }
+
+    WHEN ("I decompose it and then shear it.") {
+      Transform t = original;
+      t.decompose ();
+      t.shearLocalXByYz (0.5f, 0.0f);
+      Transform matrix = original;
+      matrix.shearLocalXByYz (0.5f, 0.0f);
+      THEN ("It goes back to keeping the matrix, which matches shearing the original.") {
+	REQUIRE_FALSE (t.isDecomposed ());
+	requireSameMatrix (t, matrix);
+      }
+    }
+  }
+
+  GIVEN ("A transform with a uniform scale.") {
+    Transform original;
+    original.rotateLocal (-70, Vector3 (0, 1, 1));
+    original.scaleLocal (1.5f);
+    original.setPosition (4, 5, 6);
+    WHEN ("A decomposed copy and the original are rotated and moved the same way.") {
+      Transform t = original;
+      t.decompose ();
+      for (Transform* each : { &t, &original })
+      {
+	each->yaw (25);
+	each->roll (10);
+	each->moveLocal (2, Vector3 (1, 0, 0));
+      }
+      THEN ("They still have the same matrix.") {
+	requireSameMatrix (t, original);
+      }
+    }
+  }
+}
+
+SCENARIO ("Quaternion matrix round trip and slerp.", "[Quaternion][A10]") {
+  GIVEN ("A rotation about an arbitrary axis.") {
+    Quaternion q (123, Vector3 (-1, 2, 0.5f));
+    WHEN ("I turn it into a matrix and back.") {
+      Quaternion back;
+      back.setFromMatrix (q.getMatrix ());
+      THEN ("It is the same rotation.") {
+	requireSameRotation (back, q);
+      }
+    }
+  }
+
+  GIVEN ("Rotations of 0 and 90 degrees about the Y axis.") {
+    Quaternion from (0, Vector3 (0, 1, 0));
+    Quaternion to (90, Vector3 (0, 1, 0));
+    WHEN ("I slerp between them.") {
+      THEN ("The endpoints are the rotations themselves.") {
+	requireSameRotation (slerp (from, to, 0.0f), from);
+	requireSameRotation (slerp (from, to, 1.0f), to);
+      }
+      THEN ("Halfway is 45 degrees, and a unit quaternion.") {
+	Quaternion half = slerp (from, to, 0.5f);
+	requireSameRotation (half, Quaternion (45, Vector3 (0, 1, 0)));
+	REQUIRE (half.length () == Approx (1.0f));
+      }
+    }
+  }
+
+  GIVEN ("A rotation and the same rotation with its sign flipped.") {
+    Quaternion from (60, Vector3 (1, 0, 0));
+    Quaternion to (100, Vector3 (1, 0, 0));
+    Quaternion flipped (-to.m_w, -to.m_x, -to.m_y, -to.m_z);
+    WHEN ("I slerp to the flipped one.") {
+      THEN ("It takes the short way, through 80 degrees.") {
+	requireSameRotation (slerp (from, flipped, 0.5f), Quaternion (80, Vector3 (1, 0, 0)));
+      }
+    }
+  }
+}
@@ -0,0 +1,181 @@
+/// \file TraceRecorder.cpp
+/// \brief Definitions of TraceRecorder class member and associated global
+///   functions.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#include <cstdio>
+#include <cstring>
+
+#include "TraceRecorder.hpp"
+
+namespace
+{
+  // The calling thread's buffer, found once and then reused.  Its type is
+  //   private to TraceRecorder.
+  thread_local void* t_buffer = nullptr;
+  // The calling thread's name, kept so that naming a thread does not make a
+  //   buffer for it before it records anything.
+  thread_local std::string t_name;
+
+  // Writes a string as a JSON string literal.
+  void
+  writeString (FILE* out, const char* text)
+  {
+    fputc ('"', out);
+    for (const char* c = text; *c != '\0'; ++c)
+    {
+      if (*c == '"' || *c == '\\')
+	fprintf (out, "\\%c", *c);
+      else if (static_cast<unsigned char> (*c) < 0x20)
+	fprintf (out, "\\u%04x", *c);
+      else
+	fputc (*c, out);
+    }
+    fputc ('"', out);
+  }
+}
+
+TraceRecorder::ThreadBuffer::ThreadBuffer (unsigned int id)
+  : id (id), name ("thread " + std::to_string (id)), events (EVENTS_PER_THREAD),
+    head (0)
+{
+}
+
+TraceRecorder::TraceRecorder ()
+  : m_recording (false), m_start (std::chrono::steady_clock::now ())
+{
+}
+
+TraceRecorder&
+TraceRecorder::getGlobal ()
+{
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+void
+TraceRecorder::start ()
+{
+  m_start = std::chrono::steady_clock::now ();
+  m_recording.store (true, std::memory_order_release);
+}
+
+void
+TraceRecorder::stop ()
+{
+  m_recording.store (false, std::memory_order_release);
+}
+
+bool
+TraceRecorder::isRecording () const
+{
+  return m_recording.load (std::memory_order_relaxed);
+}
+
+void
+TraceRecorder::setThreadName (const std::string& name)
+{
+  t_name = name;
+  if (t_buffer != nullptr)
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    static_cast<ThreadBuffer*> (t_buffer)->name = name;
+  }
+}
+
+void
+TraceRecorder::record (const char* name, const char* category,
+		       const char* detail,
+		       std::chrono::steady_clock::time_point begin,
+		       std::chrono::steady_clock::time_point end)
+{
+  ThreadBuffer& buffer = getThreadBuffer ();
+  uint64_t head = buffer.head.load (std::memory_order_relaxed);
+  Event& event = buffer.events[head % EVENTS_PER_THREAD];
+  event.name = name;
+  event.category = category;
+  event.begin = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (begin - m_start).count ();
+  event.duration = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (end - begin).count ();
+  if (detail == nullptr)
+    event.detail[0] = '\0';
+  else
+  {
+    strncpy (event.detail, detail, MAX_DETAIL - 1);
+    event.detail[MAX_DETAIL - 1] = '\0';
+  }
+  // Publishes the event to writeJson.
+  buffer.head.store (head + 1, std::memory_order_release);
+}
+
+bool
+TraceRecorder::writeJson (const std::string& fileName) const
+{
+  FILE* out = fopen (fileName.c_str (), "w");
+  if (out == nullptr)
+    return false;
+  std::lock_guard<std::mutex> lock (m_mutex);
+  fprintf (out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  for (const std::unique_ptr<ThreadBuffer>& buffer : m_threads)
+  {
+    fprintf (out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+	     "\"args\":{\"name\":", first ? "" : ",\n", buffer->id);
+    writeString (out, buffer->name.c_str ());
+    fprintf (out, "}}");
+    first = false;
+    uint64_t head = buffer->head.load (std::memory_order_acquire);
+    uint64_t oldest = (head > EVENTS_PER_THREAD) ? head - EVENTS_PER_THREAD : 0;
+    for (uint64_t i = oldest; i < head; ++i)
+    {
+      const Event& event = buffer->events[i % EVENTS_PER_THREAD];
+      fprintf (out, ",\n{\"name\":");
+      writeString (out, event.name);
+      fprintf (out, ",\"cat\":");
+      writeString (out, event.category);
+      fprintf (out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+	       event.begin / 1000.0, event.duration / 1000.0, buffer->id);
+      if (event.detail[0] != '\0')
+      {
+	fprintf (out, ",\"args\":{\"detail\":");
+	writeString (out, event.detail);
+	fprintf (out, "}");
+      }
+      fprintf (out, "}");
+    }
+  }
+  fprintf (out, "\n]}\n");
+  return fclose (out) == 0;
+}
+
+TraceRecorder::ThreadBuffer&
+TraceRecorder::getThreadBuffer ()
+{
+  if (t_buffer == nullptr)
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_threads.emplace_back (new ThreadBuffer (m_threads.size () + 1));
+    if (!t_name.empty ())
+      m_threads.back ()->name = t_name;
+    t_buffer = m_threads.back ().get ();
+  }
+  return *static_cast<ThreadBuffer*> (t_buffer);
+}
+
+TraceScope::TraceScope (const char* name, const char* category,
+			const char* detail)
+  : m_name (name), m_category (category), m_detail (detail),
+    m_recording (TraceRecorder::getGlobal ().isRecording ())
+{
+  if (m_recording)
+    m_start = std::chrono::steady_clock::now ();
+}
+
+TraceScope::~TraceScope ()
+{
+  if (m_recording)
+    TraceRecorder::getGlobal ().record (m_name, m_category, m_detail, m_start,
+					std::chrono::steady_clock::now ());
+}
@@ -0,0 +1,177 @@
+/// \file TraceRecorder.hpp
+/// \brief Declaration of TraceRecorder class, the scoped events that feed
+///   it, and the macros that place them.
+/// \author Aaron Heinbaugh
+/// \version A10
+
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \brief Records when things happened on each thread, to be written out as
+///   Chrome trace_event JSON that chrome://tracing and Perfetto can show as a
+///   timeline with one track per thread.
+///
+/// Each thread that records gets its own ring buffer the first time it does,
+///   and is the only one to write to it, so recording an event takes no lock:
+///   it is two clock reads, a copy into the ring and one atomic store.  When
+///   a ring fills, the oldest events are overwritten.
+///
+/// There is one TraceRecorder, from getGlobal.  It records nothing until
+///   start is called.
+class TraceRecorder
+{
+public:
+
+  /// The number of events each thread's ring holds.
+  static const size_t EVENTS_PER_THREAD = 1 << 15;
+  /// The longest detail string an event keeps, including its terminator.
+  static const size_t MAX_DETAIL = 64;
+
+  /// Copy constructor deleted because there is only one TraceRecorder.
+  TraceRecorder (const TraceRecorder&) = delete;
+
+  /// Assignment operator deleted because there is only one TraceRecorder.
+  TraceRecorder&
+  operator= (const TraceRecorder&) = delete;
+
+  /// \brief Gets the TraceRecorder.
+  /// \return The only TraceRecorder.
+  static TraceRecorder&
+  getGlobal ();
+
+  /// \brief Starts recording.
+  /// \post Events from every thread are recorded, timed from now.
+  void
+  start ();
+
+  /// \brief Stops recording.
+  /// \post Events that have not started yet are not recorded.
+  void
+  stop ();
+
+  /// \brief Tells whether or not events are being recorded.
+  /// \return Whether or not start has been called without stop after it.
+  bool
+  isRecording () const;
+
+  /// \brief Names the calling thread's track.  Threads that are not named
+  ///   are shown as "thread N".
+  /// \param[in] name The name to show.
+  void
+  setThreadName (const std::string& name);
+
+  /// \brief Records an event on the calling thread's track.
+  /// \param[in] name What happened, which must be a string literal or
+  ///   otherwise outlive the recorder.
+  /// \param[in] category The kind of event, which must also outlive it.
+  /// \param[in] detail More about the event, such as a file name, or
+  ///   nullptr.  It is copied, and cut to MAX_DETAIL - 1 characters.
+  /// \param[in] begin When the event began.
+  /// \param[in] end When the event ended.
+  void
+  record (const char* name, const char* category, const char* detail,
+	  std::chrono::steady_clock::time_point begin,
+	  std::chrono::steady_clock::time_point end);
+
+  /// \brief Writes every recorded event as trace_event JSON.
+  /// \param[in] fileName The name of the file to create.
+  /// \pre No thread is recording, as after stop once threads are idle.
+  /// \return Whether or not the file could be written.
+  bool
+  writeJson (const std::string& fileName) const;
+
+private:
+
+  /// One complete event.
+  struct Event
+  {
+    const char* name;
+    const char* category;
+    /// Nanoseconds since start.
+    int64_t begin;
+    int64_t duration;
+    char detail[MAX_DETAIL];
+  };
+
+  /// One thread's events.
+  struct ThreadBuffer
+  {
+    ThreadBuffer (unsigned int id);
+
+    unsigned int id;
+    std::string name;
+    std::vector<Event> events;
+    /// The number of events ever recorded, so the next goes at head modulo
+    ///   the ring size.  Only the owning thread writes it.
+    std::atomic<uint64_t> head;
+  };
+
+  TraceRecorder ();
+
+  ThreadBuffer&
+  getThreadBuffer ();
+
+  std::atomic<bool> m_recording;
+  std::chrono::steady_clock::time_point m_start;
+  /// Protects m_threads, which is only changed when a thread records for
+  ///   the first time.
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+};
+
+/// \brief Records the time between its construction and destruction as an
+///   event in the TraceRecorder.
+class TraceScope
+{
+public:
+
+  /// \brief Starts the event, if the TraceRecorder is recording.
+  /// \param[in] name What is happening, which must outlive the recorder.
+  /// \param[in] category The kind of event, which must outlive the recorder.
+  /// \param[in] detail More about the event, or nullptr.
+  TraceScope (const char* name, const char* category,
+	      const char* detail = nullptr);
+
+  /// \brief Ends the event and records it.
+  ~TraceScope ();
+
+  TraceScope (const TraceScope&) = delete;
+
+  TraceScope&
+  operator= (const TraceScope&) = delete;
+
+private:
+
+  const char* m_name;
+  const char* m_category;
+  const char* m_detail;
+  bool m_recording;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#define TRACE_CONCATENATE_(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_ (a, b)
+
+#ifdef NO_PROFILING
+#define TRACE_SCOPE(name, category)
+#define TRACE_SCOPE_DETAIL(name, category, detail)
+#else
+/// \brief Records the rest of the enclosing block as an event.
+#define TRACE_SCOPE(name, category)					\
+  TraceScope TRACE_CONCATENATE (traceScope, __LINE__) (name, category)
+/// \brief Records the rest of the enclosing block as an event with a
+///   detail string, such as the file being worked on.
+#define TRACE_SCOPE_DETAIL(name, category, detail)			\
+  TraceScope TRACE_CONCATENATE (traceScope, __LINE__) (name, category, detail)
+#endif
+
+#endif//TRACE_RECORDER_HPP
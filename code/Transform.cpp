@@ -9,11 +9,49 @@
 #include "Vector3.hpp"
 #include "Matrix4.hpp"
 #include "Transform.hpp"
+#include "JobSystem.hpp"
+#include "Simd.hpp"
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <math.h>
 
+namespace
+{
+  // Batches of more points than this are split among threads.
+  const size_t POINTS_PER_JOB = 16384;
+
+  // Multiplies the vectors in [begin, end) by the matrix with columns m and
+  //   then adds position, which is zero for directions.
+  void
+  transformRange (const float* m, const float* position, const float* in,
+		  float* out, size_t begin, size_t end, size_t stride)
+  {
+    Simd::Float4 right = Simd::loadColumn3(m);
+    Simd::Float4 up = Simd::loadColumn3(m + 3);
+    Simd::Float4 back = Simd::loadColumn3(m + 6);
+    Simd::Float4 translation = Simd::loadColumn3(position);
+    for (size_t i = begin * stride; i < end * stride; i += stride)
+      Simd::storeColumn3(out + i, Simd::add(Simd::transform3(right, up, back, Simd::loadColumn3(in + i)),
+                                             translation));
+  }
+
+  void
+  transformBatch (const float* m, const float* position, const float* in,
+		  float* out, size_t count, size_t stride)
+  {
+    if (count <= POINTS_PER_JOB)
+    {
+      transformRange(m, position, in, out, 0, count, stride);
+      return;
+    }
+    JobSystem::getGlobal().parallelFor(count, POINTS_PER_JOB, [=] (size_t begin, size_t end)
+    {
+      transformRange(m, position, in, out, begin, end, stride);
+    });
+  }
+}
+
 /// \brief A 4x4 matrix of floats with the requirement that the bottom row
 ///   must be 0, 0, 0, 1.  This type of matrix can be used to represent any
 ///   affine transformation.
@@ -33,7 +71,8 @@
   /// \post The Matrix3 component is the identity matrix, while the Vector3
   ///   component is the zero vector.
   Transform::Transform ()
-  : m_rotScale(Matrix3()), m_position(Vector3(0,0,0))
+  : m_rotScale(Matrix3()), m_position(Vector3(0,0,0)), m_decomposed(false),
+    m_rotScaleStale(false), m_scale(1,1,1)
   {}
 
   /// \brief Initializes a new transform from its orientation and position.
@@ -41,14 +80,109 @@
   /// \param[in] position The position of the new transform.
   /// \post The components have been copied from the parameters.
   Transform::Transform (const Matrix3& orientation, const Vector3& position)
-  : m_rotScale(orientation), m_position(position)
+  : m_rotScale(orientation), m_position(position), m_decomposed(false),
+    m_rotScaleStale(false), m_scale(1,1,1)
+  {}
+
+  /// \brief Initializes a new decomposed transform from a rotation, a scale,
+  ///   and a position.
+  /// \param[in] rotation The rotation, which must be a unit quaternion.
+  /// \param[in] scale The scale along each of the local axes.
+  /// \param[in] position The position of the new transform.
+  /// \post The transform is decomposed, and its matrix is rotation * scale.
+  Transform::Transform (const Quaternion& rotation, const Vector3& scale,
+			const Vector3& position)
+  : m_rotScale(Matrix3()), m_position(position), m_decomposed(true),
+    m_rotScaleStale(true), m_rotation(rotation), m_scale(scale)
   {}
+
+  /// \brief Switches to keeping the orientation as a rotation and a scale.
+  /// \pre The basis vectors are perpendicular to each other (there is no
+  ///   shear).
+  /// \post The transform is decomposed and represents the same matrix, up to
+  ///   rounding.
+  void
+  Transform::decompose ()
+  {
+      if (m_decomposed)
+        return;
+      m_scale = Vector3(m_rotScale.getRight().length(), m_rotScale.getUp().length(),
+                        m_rotScale.getBack().length());
+      // A reflection is kept as a negative scale, so that what is left is a
+      //   rotation.
+      if (m_rotScale.determinant() < 0)
+        m_scale.m_x = -m_scale.m_x;
+      Matrix3 rotation(m_rotScale.getRight() / m_scale.m_x, m_rotScale.getUp() / m_scale.m_y,
+                       m_rotScale.getBack() / m_scale.m_z);
+      m_rotation.setFromMatrix(rotation);
+      m_decomposed = true;
+      m_rotScaleStale = true;
+  }
+
+  /// \brief Tests whether the orientation is kept as a rotation and a scale.
+  /// \return Whether or not this transform is decomposed.
+  bool
+  Transform::isDecomposed () const
+  {
+      return m_decomposed;
+  }
+
+  /// \brief Gets the rotation of a decomposed transform.
+  /// \pre This transform is decomposed.
+  /// \return A copy of the rotation quaternion.
+  Quaternion
+  Transform::getRotation () const
+  {
+      return m_rotation;
+  }
+
+  /// \brief Gets the scale of a decomposed transform.
+  /// \pre This transform is decomposed.
+  /// \return A copy of the scale along each local axis.
+  Vector3
+  Transform::getScale () const
+  {
+      return m_scale;
+  }
+
+  /// \brief Gets the orientation/scale matrix, rebuilding it first if it is
+  ///   out of date.
+  /// \return m_rotScale.
+  const Matrix3&
+  Transform::rotScale () const
+  {
+      if (m_rotScaleStale)
+      {
+        Matrix3 rotation = m_rotation.getMatrix();
+        m_rotScale = Matrix3(rotation.getRight() * m_scale.m_x, rotation.getUp() * m_scale.m_y,
+                             rotation.getBack() * m_scale.m_z);
+        m_rotScaleStale = false;
+      }
+      return m_rotScale;
+  }
+
+  /// \brief Switches back to keeping the matrix, for operations that only
+  ///   work on the matrix.
+  /// \post m_rotScale is up to date and the transform is not decomposed.
+  void
+  Transform::recompose ()
+  {
+      rotScale();
+      m_decomposed = false;
+  }
   
   /// \brief Orthonormalizes the Matrix3 component.
   /// \post The Matrix3 component contains three perpendicular unit vectors.
   void
   Transform::orthonormalize ()
   {
+      if (m_decomposed)
+      {
+        m_rotation.normalize();
+        m_scale = Vector3(1,1,1);
+        m_rotScaleStale = true;
+        return;
+      }
       m_rotScale.orthonormalize();
   }
   
@@ -60,6 +194,9 @@
   {
       m_rotScale.setToIdentity();
       m_position.set(0,0,0);
+      m_rotation = Quaternion();
+      m_scale = Vector3(1,1,1);
+      m_rotScaleStale = false;
   }
   
   /// \brief Converts this to a 4x4 GLM matrix, so that it can be passed to our
@@ -68,17 +205,9 @@
   Matrix4
   Transform::getTransform () const 
   {
-      
-      /*
-      return glm::mat4(glm::vec4(m_rotScale.getRight().convert(), 0), glm::vec4(m_rotScale.getUp().convert(), 0),
-        glm::vec4(m_rotScale.getBack().convert(), 0), glm::vec4(m_position.m_x, m_position.m_y, m_position.m_z, 1));
-      */
-      return Matrix4(
-        Vector4(m_rotScale.getRight().m_x, m_rotScale.getRight().m_y, m_rotScale.getRight().m_z, 0),
-        Vector4(m_rotScale.getUp().m_x, m_rotScale.getUp().m_y, m_rotScale.getUp().m_z, 0),
-        Vector4(m_rotScale.getBack().m_x, m_rotScale.getBack().m_y, m_rotScale.getBack().m_z, 0), 
-        Vector4(m_position.m_x, m_position.m_y, m_position.m_z, 1));    
-  
+      Matrix4 matrix;
+      getTransform(matrix.data());
+      return matrix;
   }
   
   /// \brief Copies the elements of this transform into an array, in column-
@@ -88,22 +217,47 @@
   void
   Transform::getTransform (float array[16]) const
   {
-      array[0] = m_rotScale.getRight().m_x;
-      array[1] = m_rotScale.getRight().m_y;
-      array[2] = m_rotScale.getRight().m_z;
-      array[3] = 0.0f;
-      array[4] = m_rotScale.getUp().m_x;
-      array[5] = m_rotScale.getUp().m_y;
-      array[6] = m_rotScale.getUp().m_z;
-      array[7] = 0.0f;
-      array[8] = m_rotScale.getBack().m_x;
-      array[9] = m_rotScale.getBack().m_y;
-      array[10] = m_rotScale.getBack().m_z;
-      array[11] = 0.0f;
-      array[12] = m_position.m_x;
-      array[13] = m_position.m_y;
-      array[14] = m_position.m_z;
-      array[15] = 1.0f;
+      // loadColumn3 zeroes the fourth lane, which is the 0 in each column.
+      const float* m = rotScale().data();
+      Simd::storeUnaligned(array, Simd::loadColumn3(m));
+      Simd::storeUnaligned(array + 4, Simd::loadColumn3(m + 3));
+      Simd::storeUnaligned(array + 8, Simd::loadColumn3(m + 6));
+      Simd::storeUnaligned(array + 12, Simd::set(m_position.m_x, m_position.m_y, m_position.m_z, 1.0f));
+  }
+
+  /// \brief Transforms many points at once, applying the orientation/scale
+  ///   matrix and then the translation.
+  /// \param[in] in The first point's x; y and z follow it.
+  /// \param[out] out Where to write the first transformed point, which may
+  ///   be in.
+  /// \param[in] count The number of points.
+  /// \param[in] stride The number of floats from one point to the next, in
+  ///   both in and out.
+  /// \post out holds this * p for each point p.
+  void
+  Transform::transformPoints (const float* in, float* out, size_t count,
+			      size_t stride) const
+  {
+      // rotScale() is called here, not by the jobs, since it may rebuild
+      //   the matrix.
+      transformBatch(rotScale().data(), &m_position.m_x, in, out, count, stride);
+  }
+
+  /// \brief Transforms many directions at once, applying only the
+  ///   orientation/scale matrix.
+  /// \param[in] in The first direction's x; y and z follow it.
+  /// \param[out] out Where to write the first transformed direction, which
+  ///   may be in.
+  /// \param[in] count The number of directions.
+  /// \param[in] stride The number of floats from one direction to the next,
+  ///   in both in and out.
+  /// \post out holds the orientation/scale matrix times each direction.
+  void
+  Transform::transformDirections (const float* in, float* out, size_t count,
+				  size_t stride) const
+  {
+      const float zero[3] = { 0, 0, 0 };
+      transformBatch(rotScale().data(), zero, in, out, count, stride);
   }
 
   /// \brief Gets the position component.
@@ -141,7 +295,7 @@
   Vector3
   Transform::getRight () const
   {
-      return m_rotScale.getRight();
+      return rotScale().getRight();
   }
   
   /// \brief Gets the up basis vector.
@@ -149,7 +303,7 @@
   Vector3
   Transform::getUp () const
   {
-      return m_rotScale.getUp();
+      return rotScale().getUp();
   }
   
   /// \brief Gets the back basis vector.
@@ -157,7 +311,7 @@
   Vector3
   Transform::getBack () const
   {
-      return m_rotScale.getBack();
+      return rotScale().getBack();
   }
 
   /// \brief Gets the orientation/scale matrix.
@@ -165,7 +319,7 @@
   Matrix3
   Transform::getOrientation () const
   {
-      return m_rotScale;
+      return rotScale();
   }
 
   /// \brief Sets the orientation/scale matrix.
@@ -174,6 +328,7 @@
   void
   Transform::setOrientation (const Matrix3& orientation)
   {
+      recompose();
       m_rotScale = orientation;
   }
 
@@ -186,6 +341,7 @@
   Transform::setOrientation (const Vector3& right, const Vector3& up,
 		  const Vector3& back)
   {
+      recompose();
       m_rotScale.setRight(right);
       m_rotScale.setUp(up);
       m_rotScale.setBack(back);
@@ -197,7 +353,7 @@
   void
   Transform::moveRight (float distance)
   {
-      m_position += (distance * m_rotScale.getRight());
+      m_position += (distance * rotScale().getRight());
   }
 
   /// \brief Moves "distance" units along the up vector.
@@ -206,7 +362,7 @@
   void
   Transform::moveUp (float distance)
   {
-      m_position += (distance * m_rotScale.getUp());
+      m_position += (distance * rotScale().getUp());
   }
 
   /// \brief Moves "distance" units along the back vector.
@@ -215,7 +371,7 @@
   void
   Transform::moveBack (float distance)
   {
-      m_position += (distance * m_rotScale.getBack());
+      m_position += (distance * rotScale().getBack());
   }
 
   /// \brief Moves "distance" units in "localDirection", which is relative
@@ -226,7 +382,7 @@
   void
   Transform::moveLocal (float distance, const Vector3& localDirection)
   {
-      m_position += (m_rotScale * distance * localDirection);
+      m_position += (rotScale() * distance * localDirection);
   }
 
   /// \brief Moves "distance" units in "worldDirection", which is relative
@@ -247,6 +403,13 @@
   void
   Transform::pitch (float angleDegrees)
   {
+    if (m_decomposed)
+    {
+      m_rotation *= Quaternion(angleDegrees, Vector3(1,0,0));
+      m_rotation.normalize();
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setToRotationX (angleDegrees);
     m_rotScale *= rotation;
@@ -259,6 +422,13 @@
   void
   Transform::yaw (float angleDegrees)
   {
+    if (m_decomposed)
+    {
+      m_rotation *= Quaternion(angleDegrees, Vector3(0,1,0));
+      m_rotation.normalize();
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setToRotationY(angleDegrees);
     m_rotScale *= rotation;
@@ -271,6 +441,13 @@
   void
   Transform::roll (float angleDegrees)
   {
+    if (m_decomposed)
+    {
+      m_rotation *= Quaternion(angleDegrees, Vector3(0,0,1));
+      m_rotation.normalize();
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setToRotationZ (angleDegrees);
     m_rotScale *= rotation;
@@ -284,6 +461,13 @@
   void
   Transform::rotateLocal (float angleDegrees, const Vector3& axis)
   {
+    if (m_decomposed)
+    {
+      m_rotation *= Quaternion(angleDegrees, axis);
+      m_rotation.normalize();
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setFromAngleAxis (angleDegrees, axis);
     m_rotScale = m_rotScale * rotation;
@@ -302,6 +486,7 @@
   void
   Transform::alignWithWorldY ()
   {
+      recompose();
       m_rotScale.setUp(Vector3(0,1,0));
       Vector3 normback = m_rotScale.getRight().cross(m_rotScale.getUp());
       normback.normalize();
@@ -317,6 +502,15 @@
   void
   Transform::rotateWorld (float angleDegrees, const Vector3& axis)
   {
+    if (m_decomposed)
+    {
+      Quaternion rotation(angleDegrees, axis);
+      m_rotation = rotation * m_rotation;
+      m_rotation.normalize();
+      m_position = rotation.rotate(m_position);
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setFromAngleAxis (angleDegrees, axis);
     m_rotScale = rotation * m_rotScale;
@@ -330,6 +524,12 @@
   void
   Transform::scaleLocal (float scale)
   {
+    if (m_decomposed)
+    {
+      m_scale *= scale;
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setToScale(scale);
     m_rotScale = m_rotScale * rotation;
@@ -344,6 +544,14 @@
   void
   Transform::scaleLocal (float scaleX, float scaleY, float scaleZ)
   {
+    if (m_decomposed)
+    {
+      m_scale.m_x *= scaleX;
+      m_scale.m_y *= scaleY;
+      m_scale.m_z *= scaleZ;
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setToScale(scaleX, scaleY, scaleZ);
     m_rotScale = m_rotScale * rotation;      
@@ -356,6 +564,13 @@
   void
   Transform::scaleWorld (float scale)
   {
+    if (m_decomposed)
+    {
+      m_scale *= scale;
+      m_position *= scale;
+      m_rotScaleStale = true;
+      return;
+    }
     Matrix3 rotation(0,0,0);
     rotation.setToScale(scale);
     m_rotScale = rotation * m_rotScale;    
@@ -371,6 +586,7 @@
   void
   Transform::scaleWorld (float scaleX, float scaleY, float scaleZ)
   {
+    recompose();
     Matrix3 rotation(0,0,0);
     rotation.setToScale(scaleX, scaleY, scaleZ);
     m_rotScale = rotation * m_rotScale;
@@ -385,6 +601,7 @@
   void
   Transform::shearLocalXByYz (float shearY, float shearZ)
   {
+    recompose();
     Matrix3 rotation(0,0,0);
     rotation.setToShearXByYz(shearY, shearZ);
     m_rotScale = m_rotScale * rotation;     
@@ -398,6 +615,7 @@
   void
   Transform::shearLocalYByXz (float shearX, float shearZ)
   {
+    recompose();
     Matrix3 rotation(0,0,0);
     rotation.setToShearYByXz(shearX, shearZ);
     m_rotScale = m_rotScale * rotation;      
@@ -411,6 +629,7 @@
   void
   Transform::shearLocalZByXy (float shearX, float shearY)
   {
+    recompose();
     Matrix3 rotation(0,0,0);
     rotation.setToShearZByXy(shearX, shearY);
     m_rotScale = m_rotScale * rotation;       
@@ -424,8 +643,19 @@
   void
   Transform::invertRt ()
   {
-      m_rotScale.invertRotation();
-      m_position = m_rotScale * (-1 * m_position);
+      recompose();
+      // The inverse rotation is the transpose, and the inverse translation
+      //   is the old position rotated by it and negated.
+      float* m = m_rotScale.data();
+      Simd::Float4 right = Simd::loadColumn3(m);
+      Simd::Float4 up = Simd::loadColumn3(m + 3);
+      Simd::Float4 back = Simd::loadColumn3(m + 6);
+      Simd::transpose3(right, up, back);
+      Simd::Float4 position = Simd::transform3(right, up, back, Simd::loadColumn3(&m_position.m_x));
+      Simd::storeColumn3(m, right);
+      Simd::storeColumn3(m + 3, up);
+      Simd::storeColumn3(m + 6, back);
+      Simd::storeColumn3(&m_position.m_x, Simd::subtract(Simd::splat(0), position));
   }
   
   /// \brief Combines this with "t" in the order this * t.
@@ -434,24 +664,22 @@
   void
   Transform::combine (const Transform& t)
   {
-      float rx = m_rotScale.getRight().m_x * t.getRight().m_x + m_rotScale.getUp().m_x * t.getRight().m_y + m_rotScale.getBack().m_x * t.getRight().m_z; 
-      float ry = m_rotScale.getRight().m_y * t.getRight().m_x + m_rotScale.getUp().m_y * t.getRight().m_y + m_rotScale.getBack().m_y * t.getRight().m_z;
-      float rz = m_rotScale.getRight().m_z * t.getRight().m_x + m_rotScale.getUp().m_z * t.getRight().m_y + m_rotScale.getBack().m_z * t.getRight().m_z;
-      float ux = m_rotScale.getRight().m_x * t.getUp().m_x + m_rotScale.getUp().m_x * t.getUp().m_y + m_rotScale.getBack().m_x * t.getUp().m_z;
-      float uy = m_rotScale.getRight().m_y * t.getUp().m_x + m_rotScale.getUp().m_y * t.getUp().m_y + m_rotScale.getBack().m_y * t.getUp().m_z;
-      float uz = m_rotScale.getRight().m_z * t.getUp().m_x + m_rotScale.getUp().m_z * t.getUp().m_y + m_rotScale.getBack().m_z * t.getUp().m_z;
-      float bx = m_rotScale.getRight().m_x * t.getBack().m_x + m_rotScale.getUp().m_x * t.getBack().m_y + m_rotScale.getBack().m_x * t.getBack().m_z; 
-      float by = m_rotScale.getRight().m_y * t.getBack().m_x + m_rotScale.getUp().m_y * t.getBack().m_y + m_rotScale.getBack().m_y * t.getBack().m_z; 
-      float bz = m_rotScale.getRight().m_z * t.getBack().m_x + m_rotScale.getUp().m_z * t.getBack().m_y + m_rotScale.getBack().m_z * t.getBack().m_z;
-      float tx = m_rotScale.getRight().m_x * t.getPosition().m_x + m_rotScale.getUp().m_x * t.getPosition().m_y + m_rotScale.getBack().m_x * t.getPosition().m_z + m_position.m_x; 
-      float ty = m_rotScale.getRight().m_y * t.getPosition().m_x + m_rotScale.getUp().m_y * t.getPosition().m_y + m_rotScale.getBack().m_y * t.getPosition().m_z + m_position.m_y; 
-      float tz = m_rotScale.getRight().m_z * t.getPosition().m_x + m_rotScale.getUp().m_z * t.getPosition().m_y + m_rotScale.getBack().m_z * t.getPosition().m_z + m_position.m_z;
-      m_rotScale.setRight(Vector3(rx,ry,rz));
-      m_rotScale.setUp(Vector3(ux,uy,uz));
-      m_rotScale.setBack(Vector3(bx,by,bz));
-      m_position.m_x = tx;
-      m_position.m_y = ty;
-      m_position.m_z = tz;
+      recompose();
+      // Everything is loaded before anything is stored, in case t is this.
+      float* m = m_rotScale.data();
+      const float* other = t.rotScale().data();
+      Simd::Float4 right = Simd::loadColumn3(m);
+      Simd::Float4 up = Simd::loadColumn3(m + 3);
+      Simd::Float4 back = Simd::loadColumn3(m + 6);
+      Simd::Float4 newRight = Simd::transform3(right, up, back, Simd::loadColumn3(other));
+      Simd::Float4 newUp = Simd::transform3(right, up, back, Simd::loadColumn3(other + 3));
+      Simd::Float4 newBack = Simd::transform3(right, up, back, Simd::loadColumn3(other + 6));
+      Simd::Float4 newPosition = Simd::add(Simd::transform3(right, up, back, Simd::loadColumn3(&t.m_position.m_x)),
+                                           Simd::loadColumn3(&m_position.m_x));
+      Simd::storeColumn3(m, newRight);
+      Simd::storeColumn3(m + 3, newUp);
+      Simd::storeColumn3(m + 6, newBack);
+      Simd::storeColumn3(&m_position.m_x, newPosition);
   }
 
 
@@ -462,19 +690,26 @@
 Transform
 operator* (const Transform& t1, const Transform& t2)
 {
-      float rx = t1.getRight().m_x * t2.getRight().m_x + t1.getUp().m_x * t2.getRight().m_y + t1.getBack().m_x * t2.getRight().m_z; 
-      float ry = t1.getRight().m_y * t2.getRight().m_x + t1.getUp().m_y * t2.getRight().m_y + t1.getBack().m_y * t2.getRight().m_z;
-      float rz = t1.getRight().m_z * t2.getRight().m_x + t1.getUp().m_z * t2.getRight().m_y + t1.getBack().m_z * t2.getRight().m_z;
-      float ux = t1.getRight().m_x * t2.getUp().m_x + t1.getUp().m_x * t2.getUp().m_y + t1.getBack().m_x * t2.getUp().m_z;
-      float uy = t1.getRight().m_y * t2.getUp().m_x + t1.getUp().m_y * t2.getUp().m_y + t1.getBack().m_y * t2.getUp().m_z;
-      float uz = t1.getRight().m_z * t2.getUp().m_x + t1.getUp().m_z * t2.getUp().m_y + t1.getBack().m_z * t2.getUp().m_z;
-      float bx = t1.getRight().m_x * t2.getBack().m_x + t1.getUp().m_x * t2.getBack().m_y + t1.getBack().m_x * t2.getBack().m_z; 
-      float by = t1.getRight().m_y * t2.getBack().m_x + t1.getUp().m_y * t2.getBack().m_y + t1.getBack().m_y * t2.getBack().m_z; 
-      float bz = t1.getRight().m_z * t2.getBack().m_x + t1.getUp().m_z * t2.getBack().m_y + t1.getBack().m_z * t2.getBack().m_z;
-      float tx = t1.getRight().m_x * t2.getPosition().m_x + t1.getUp().m_x * t2.getPosition().m_y + t1.getBack().m_x * t2.getPosition().m_z + t1.getPosition().m_x; 
-      float ty = t1.getRight().m_y * t2.getPosition().m_x + t1.getUp().m_y * t2.getPosition().m_y + t1.getBack().m_y * t2.getPosition().m_z + t1.getPosition().m_y; 
-      float tz = t1.getRight().m_z * t2.getPosition().m_x + t1.getUp().m_z * t2.getPosition().m_y + t1.getBack().m_z * t2.getPosition().m_z + t1.getPosition().m_z;
-      return Transform(Matrix3(rx,ry,rz,ux,uy,uz,bx,by,bz),Vector3(tx,ty,tz));
+      Transform product = t1;
+      product.combine(t2);
+      return product;
+}
+
+/// \brief Blends two transforms component by component.
+/// \param[in] from The transform when amount is 0.
+/// \param[in] to The transform when amount is 1.
+/// \param[in] amount How far to go from "from" towards "to".
+/// \return from * (1 - amount) + to * amount.
+Transform
+interpolate (const Transform& from, const Transform& to, float amount)
+{
+      if (from.isDecomposed() && to.isDecomposed())
+        return Transform(slerp(from.getRotation(), to.getRotation(), amount),
+                         from.getScale() * (1 - amount) + to.getScale() * amount,
+                         from.getPosition() * (1 - amount) + to.getPosition() * amount);
+      Matrix3 orientation = from.getOrientation() * (1 - amount) + to.getOrientation() * amount;
+      Vector3 position = from.getPosition() * (1 - amount) + to.getPosition() * amount;
+      return Transform(orientation, position);
 }
 
 /// \brief Prints the complete 4x4 matrix the Transform represents.
@@ -12,6 +12,7 @@
 #include <glm/mat4x4.hpp>
 #include "Matrix4.hpp"
 #include "Matrix3.hpp"
+#include "Quaternion.hpp"
 #include "Vector3.hpp"
 
 /// \brief A 4x4 matrix of floats with the requirement that the bottom row
@@ -26,6 +27,12 @@
 ///   and position vectors, respectively. 
 /// The last row is not explicitly stored since it is always
 ///    [  0  0  0  1 ].
+/// A transform can optionally keep its orientation as a rotation quaternion
+///   and a scale for each local axis instead (see decompose).  Rotations then
+///   compose as quaternions, which is cheaper and never drifts away from a
+///   rotation, and the 3x3 matrix is only rebuilt when something asks for
+///   it.  Operations that cannot be expressed that way, like shearing, switch
+///   the transform back to keeping the matrix.
 class Transform
 {
 public:
@@ -41,6 +48,42 @@ public:
   /// \param[in] position The position of the new transform.
   /// \post The components have been copied from the parameters.
   Transform (const Matrix3& orientation, const Vector3& position);
+
+  /// \brief Initializes a new decomposed transform from a rotation, a scale,
+  ///   and a position.
+  /// \param[in] rotation The rotation, which must be a unit quaternion.
+  /// \param[in] scale The scale along each of the local axes.
+  /// \param[in] position The position of the new transform.
+  /// \post The transform is decomposed, and its matrix is rotation * scale.
+  Transform (const Quaternion& rotation, const Vector3& scale,
+	     const Vector3& position);
+
+  /// \brief Switches to keeping the orientation as a rotation and a scale.
+  /// \pre The basis vectors are perpendicular to each other (there is no
+  ///   shear).
+  /// \post The transform is decomposed and represents the same matrix, up to
+  ///   rounding.
+  /// \post Local rotations apply outside of the local scale from now on,
+  ///   which only makes a difference if the scale is not uniform.
+  void
+  decompose ();
+
+  /// \brief Tests whether the orientation is kept as a rotation and a scale.
+  /// \return Whether or not this transform is decomposed.
+  bool
+  isDecomposed () const;
+
+  /// \brief Gets the rotation of a decomposed transform.
+  /// \pre This transform is decomposed.
+  /// \return A copy of the rotation quaternion.
+  Quaternion
+  getRotation () const;
+
+  /// \brief Gets the scale of a decomposed transform.
+  /// \pre This transform is decomposed.
+  /// \return A copy of the scale along each local axis.
+  Vector3
+  getScale () const;
   
   /// \brief Orthonormalizes the Matrix3 component.
   /// \post The Matrix3 component contains three perpendicular unit vectors.
@@ -66,6 +109,35 @@ public:
   void
   getTransform (float array[16]) const;
 
+  /// \brief Transforms many points at once, applying the orientation/scale
+  ///   matrix and then the translation.
+  /// \param[in] in The first point's x; y and z follow it.
+  /// \param[out] out Where to write the first transformed point, which may
+  ///   be in.
+  /// \param[in] count The number of points.
+  /// \param[in] stride The number of floats from one point to the next, in
+  ///   both in and out, so that points can be interleaved with other
+  ///   vertex attributes.  Only the three position floats are written.
+  /// \post out holds this * p for each point p.  Large batches are split
+  ///   among the global JobSystem's threads.
+  void
+  transformPoints (const float* in, float* out, size_t count,
+		   size_t stride = 3) const;
+
+  /// \brief Transforms many directions at once, applying only the
+  ///   orientation/scale matrix.
+  /// \param[in] in The first direction's x; y and z follow it.
+  /// \param[out] out Where to write the first transformed direction, which
+  ///   may be in.
+  /// \param[in] count The number of directions.
+  /// \param[in] stride The number of floats from one direction to the next,
+  ///   in both in and out.
+  /// \post out holds the orientation/scale matrix times each direction.  The
+  ///   results are not normalized.
+  void
+  transformDirections (const float* in, float* out, size_t count,
+		       size_t stride = 3) const;
+
   /// \brief Gets the position component.
   /// \return A copy of the position in this transformation.
   Vector3
@@ -275,10 +347,31 @@ public:
   combine (const Transform& t);
 
 private:
+  /// \brief Gets the orientation/scale matrix, rebuilding it first if it is
+  ///   out of date.
+  /// \return m_rotScale.
+  const Matrix3&
+  rotScale () const;
+
+  /// \brief Switches back to keeping the matrix, for operations that only
+  ///   work on the matrix.
+  /// \post m_rotScale is up to date and the transform is not decomposed.
+  void
+  recompose ();
+
   /// \brief A 3x3 matrix that stores the right, up, and back vectors.
-  Matrix3 m_rotScale;
+  ///   When decomposed, it is a cache of m_rotation and m_scale.
+  mutable Matrix3 m_rotScale;
   /// \brief A 3D vector that stores the position/translation vector.
   Vector3 m_position;
+  /// \brief Whether m_rotation and m_scale are the orientation.
+  bool m_decomposed;
+  /// \brief Whether m_rotScale needs to be rebuilt from them.
+  mutable bool m_rotScaleStale;
+  /// \brief The rotation, when decomposed.
+  Quaternion m_rotation;
+  /// \brief The scale along each local axis, when decomposed.
+  Vector3 m_scale;
 };
 
 /// \brief Combines two transforms into their product.
@@ -288,6 +381,19 @@ private:
 Transform
 operator* (const Transform& t1, const Transform& t2);
 
+/// \brief Blends two transforms component by component.
+/// If both are decomposed, their rotations are blended with slerp, so any
+///   two states can be blended.  Otherwise this is meant for nearby states,
+///   such as one object in two consecutive simulation steps, where rotations
+///   are small enough that blending the basis vectors linearly stays very
+///   close to a true rotation.
+/// \param[in] from The transform when amount is 0.
+/// \param[in] to The transform when amount is 1.
+/// \param[in] amount How far to go from "from" towards "to".
+/// \return from * (1 - amount) + to * amount.
+Transform
+interpolate (const Transform& from, const Transform& to, float amount);
+
 /// \brief Prints the complete 4x4 matrix the Transform represents.
 /// Each element of the matrix should have 2 digits of precision and a field
 ///   width of 10.  Elements should be in this order: